@@ -25,19 +25,21 @@ void CMeshEntity::Update(float32 dt)
 }
 void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projection)
 {
+    VV_PROFILE_SCOPE("CMeshEntity::Render");
+    
     assert ( shader != NULL );
     
     //send modelViewprojection matrix to the current shader
     if(shader->matprojviewmodel != -1 )
     {
         mat4f mat = projection * view * m_mTransformationMatrix;
-        glUniformMatrix4fv(shader->matprojviewmodel, 1, GL_FALSE, &mat[0]);
+        shader->SetUniformMatrix4x4fv("matProjViewModel", 1, GL_FALSE, &mat[0], shader->matprojviewmodel);
     }
     
     //send model matrix if the shader needs
     if(shader->matmodel != -1 )
     {
-        glUniformMatrix4fv(shader->matmodel, 1, GL_FALSE, &m_mTransformationMatrix[0]);
+        shader->SetUniformMatrix4x4fv("matModel", 1, GL_FALSE, &m_mTransformationMatrix[0], shader->matmodel);
     }
     
     //this part can be merged with a renderer class
@@ -60,9 +62,7 @@ void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projec
             if( material->diffuseTexture != NULL && shader->texture0 != -1)
             {
                 material->diffuseTexture->ActivateAndBind(GL_TEXTURE0);
-                //shader->SetUniform1i("texture0", 0, shader->texture0);
-                //or
-                glUniform1i(shader->texture0, 0);
+                shader->SetUniform1i("texture0", 0, shader->texture0);
             }
         }
         
@@ -70,7 +70,7 @@ void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projec
         grp->MapToGPU(0);
         
         //perform GL draw for each group
-        glDrawElements(grp->GetDrawingMode(), grp->GetIndices().size(), GL_UNSIGNED_SHORT, 0);
+        glDrawElements(grp->GetDrawingMode(), grp->GetIndexCount(), grp->GetIndexType(), grp->GetIndexOffset());
     }
 
 }
\ No newline at end of file
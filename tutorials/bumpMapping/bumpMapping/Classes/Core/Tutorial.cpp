@@ -9,6 +9,9 @@
 
 #include "Tutorial.h"
 
+//uniforms specific to the tutorial shaders
+VV_DECLARE_UNIFORM(U_LIGHT_POS_MODEL, "LightPosModel")
+
 //cache resource manager
 CCacheResourceManager& crm = CCacheResourceManager::Instance();
 
@@ -65,9 +68,9 @@ bool Tutorial::Deploy()
     }
     
     glClearColor(0.2, 0.2, 0.2, 1.f);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    CRenderStateCache::Instance().Enable(GL_DEPTH_TEST);
+    CRenderStateCache::Instance().Enable(GL_CULL_FACE);
+    CRenderStateCache::Instance().CullFace(GL_BACK);
     
     return true;
 }
@@ -86,7 +89,7 @@ void Tutorial::RenderFromPosition(const mat4f& view, const mat4f& projection)
     //transform light to model space, so light calculation can be peformed in model space within shader
     //to do so we multiply the light position by the inverse of the model matrix of the model.
     vec4f lightPos = modelBumpMeshMat.inverse() * vec4f(x, y, 0, 1.f);//dont forget that inverse of rotation matrix is the transpose
-    m_pShaderBump->SetUniform3fv("LightPosModel", 1, &lightPos.x);
+    m_pShaderBump->Set(U_LIGHT_POS_MODEL, lightPos);
     m_pBumpModel->Render(m_pShaderBump, view, projection);
     m_pShaderBump->End();
 }
@@ -25,17 +25,19 @@ void CMeshEntity::Update(float32 dt)
 }
 void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projection)
 {
+    VV_PROFILE_SCOPE("CMeshEntity::Render");
+    
     assert ( shader != NULL );
     
     if(shader->matprojviewmodel != -1 )
     {
         mat4f mat = projection * view * m_mTransformationMatrix;
-        glUniformMatrix4fv(shader->matprojviewmodel, 1, GL_FALSE, &mat[0]);
+        shader->SetUniformMatrix4x4fv("matProjViewModel", 1, GL_FALSE, &mat[0], shader->matprojviewmodel);
     }
     
     if(shader->matmodel != -1 )
     {
-        glUniformMatrix4fv(shader->matmodel, 1, GL_FALSE, &m_mTransformationMatrix[0]);
+        shader->SetUniformMatrix4x4fv("matModel", 1, GL_FALSE, &m_mTransformationMatrix[0], shader->matmodel);
     }
     
     CMeshBuffer* buffer = m_pMesh->GetMeshBuffer();
@@ -53,24 +55,20 @@ void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projec
             if( material->diffuseTexture != NULL && shader->texture0 != -1)
             {
                 material->diffuseTexture->ActivateAndBind(GL_TEXTURE0);
-                //shader->SetUniform1i("texture0", 0, shader->texture0);
-                //or
-                glUniform1i(shader->texture0, 0);
+                shader->SetUniform1i("texture0", 0, shader->texture0);
             }
             
             //send bump texture
             if(shader->textureBump != -1 && material->bumpTexture != NULL)
             {
                 material->bumpTexture->ActivateAndBind(GL_TEXTURE1);
-                //shader->SetUniform1i("textureBump", 1, shader->textureBump);
-                //or
-                glUniform1i(shader->textureBump, 1);
+                shader->SetUniform1i("textureBump", 1, shader->textureBump);
             }
                 
         }
         
         grp->MapToGPU(0);
-        glDrawElements(grp->GetDrawingMode(), grp->GetIndices().size(), GL_UNSIGNED_SHORT, 0);
+        glDrawElements(grp->GetDrawingMode(), grp->GetIndexCount(), grp->GetIndexType(), grp->GetIndexOffset());
     }
 
 }
\ No newline at end of file
@@ -9,6 +9,11 @@
 
 #include "Tutorial.h"
 
+//uniforms specific to the tutorial shaders
+VV_DECLARE_UNIFORM(U_LIGHT_POS_MODEL, "lightPosModel")
+VV_DECLARE_UNIFORM(U_CAM_POS_MODEL, "camPosModel")
+VV_DECLARE_UNIFORM(U_REPEAT_TEXTURE, "repeatTexture")
+
 #define DIFFUSE_TEXTURE1 "rocks_diffuse.jpg"
 #define NORMAL_TEXTURE1 "rocks_normal.jpg"
 //try this
@@ -52,13 +57,13 @@ void Tutorial::Cleanup()
 }
 bool Tutorial::LoadShaders()
 {
-    //bmp shader
-    m_pShaderBump = crm.LoadShader("Bump");
+    //bmp shader, the lighting shader specialized with the bump feature
+    m_pShaderBump = crm.LoadShader("Lighting", SShaderPermutation(kSHADER_FEATURE_BUMP));
     if(!m_pShaderBump)
         return false;
     
-    //no bump shader
-    m_pShaderNoBump = crm.LoadShader("NoBump");
+    //no bump shader, the base lighting shader
+    m_pShaderNoBump = crm.LoadShader("Lighting");
     if(!m_pShaderNoBump)
         return false;
     
@@ -117,7 +122,7 @@ bool Tutorial::Deploy()
     }
     
     glClearColor(0.2, 0.2, 0.2, 1.f);
-    glEnable(GL_DEPTH_TEST);
+    CRenderStateCache::Instance().Enable(GL_DEPTH_TEST);
     return true;
 }
 void Tutorial::MapShaderLightCamPosForMesh(CMeshEntity* mesh, const vec4f& lightPos, const vec4f& camPos)
@@ -133,8 +138,8 @@ void Tutorial::MapShaderLightCamPosForMesh(CMeshEntity* mesh, const vec4f& light
     vec4f cameraPos= modelInv * camPos;
     
     //send uniforms to shader
-    m_pActiveShader->SetUniform3fv("lightPosModel", 1, &lightPosition.x);
-    m_pActiveShader->SetUniform3fv("camPosModel", 1, &cameraPos.x);
+    m_pActiveShader->Set(U_LIGHT_POS_MODEL, lightPosition);
+    m_pActiveShader->Set(U_CAM_POS_MODEL, cameraPos);
     
 }
 void Tutorial::RenderFromPosition(const mat4f& view, const mat4f& projection)
@@ -149,16 +154,16 @@ void Tutorial::RenderFromPosition(const mat4f& view, const mat4f& projection)
     vec4f lightAmbient = LIGHT_AMBIENT;
     vec4f lightDiffuse = LIGHT_DIFFUSE;
     vec4f lightSpecular = LIGHT_SPECULAR;
-    m_pActiveShader->SetUniform4fv("lightColorAmbient", 1, &lightAmbient.x);
-    m_pActiveShader->SetUniform4fv("lightColorDiffuse", 1, &lightDiffuse.x);
-    m_pActiveShader->SetUniform4fv("lightColorSpecular", 1, &lightSpecular.x);
+    m_pActiveShader->Set(U_LIGHT_COLOR_AMBIENT, lightAmbient);
+    m_pActiveShader->Set(U_LIGHT_COLOR_DIFFUSE, lightDiffuse);
+    m_pActiveShader->Set(U_LIGHT_COLOR_SPECULAR, lightSpecular);
     
     
-    m_pActiveShader->SetUniform1f("repeatTexture", 1.2f);
+    m_pActiveShader->Set(U_REPEAT_TEXTURE, 1.2f);
     MapShaderLightCamPosForMesh(m_pBumpModel, lightPos, camPos);
     m_pBumpModel->Render(m_pActiveShader, view, projection);
     
-    m_pActiveShader->SetUniform1f("repeatTexture", 4.f);
+    m_pActiveShader->Set(U_REPEAT_TEXTURE, 4.f);
     MapShaderLightCamPosForMesh(m_pBumpModel, lightPos, camPos);
     m_pBumpModel2->Render(m_pActiveShader, view, projection);
    
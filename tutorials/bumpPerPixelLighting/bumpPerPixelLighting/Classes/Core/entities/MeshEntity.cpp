@@ -25,17 +25,19 @@ void CMeshEntity::Update(float32 dt)
 }
 void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projection)
 {
+    VV_PROFILE_SCOPE("CMeshEntity::Render");
+    
     assert ( shader != NULL );
     
     if(shader->matprojviewmodel != -1 )
     {
         mat4f mat = projection * view * m_mTransformationMatrix;
-        glUniformMatrix4fv(shader->matprojviewmodel, 1, GL_FALSE, &mat[0]);
+        shader->SetUniformMatrix4x4fv("matProjViewModel", 1, GL_FALSE, &mat[0], shader->matprojviewmodel);
     }
     
     if(shader->matmodel != -1 )
     {
-        glUniformMatrix4fv(shader->matmodel, 1, GL_FALSE, &m_mTransformationMatrix[0]);
+        shader->SetUniformMatrix4x4fv("matModel", 1, GL_FALSE, &m_mTransformationMatrix[0], shader->matmodel);
     }
     
     CMeshBuffer* buffer = m_pMesh->GetMeshBuffer();
@@ -53,57 +55,51 @@ void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projec
             if( material->diffuseTexture != NULL && shader->texture0 != -1)
             {
                 material->diffuseTexture->ActivateAndBind(GL_TEXTURE0);
-                //shader->SetUniform1i("texture0", 0, shader->texture0);
-                //or
-                glUniform1i(shader->texture0, 0);
+                shader->SetUniform1i("texture0", 0, shader->texture0);
             }
             
             //send bump texture
             if(shader->textureBump != -1 && material->bumpTexture != NULL)
             {
                 material->bumpTexture->ActivateAndBind(GL_TEXTURE1);
-                //shader->SetUniform1i("textureBump", 1, shader->textureBump);
-                //or
-                glUniform1i(shader->textureBump, 1);
+                shader->SetUniform1i("textureBump", 1, shader->textureBump);
             }
             
             //send specular texture
             if(shader->textureSpecular != -1 && material->specularTexture != NULL)
             {
                 material->specularTexture->ActivateAndBind(GL_TEXTURE2);
-                //shader->SetUniform1i("textureBump", 1, shader->textureBump);
-                //or
-                glUniform1i(shader->textureSpecular, 2);
+                shader->SetUniform1i("textureSpecular", 2, shader->textureSpecular);
             }
             
             //send ambient
             if(shader->matColorAmbient != -1)
             {
-                glUniform4fv(shader->matColorAmbient, 1, material->ambient);
+                shader->SetUniform4fv("matColorAmbient", 1, material->ambient, shader->matColorAmbient);
             }
             
             //send diffuse
             if(shader->matColorDiffuse != -1)
             {
-                glUniform4fv(shader->matColorDiffuse, 1, material->diffuse);
+                shader->SetUniform4fv("matColorDiffuse", 1, material->diffuse, shader->matColorDiffuse);
             }
             
             //send specular
             if(shader->matColorSpecular != -1)
             {
-                glUniform4fv(shader->matColorSpecular, 1, material->specular);
+                shader->SetUniform4fv("matColorSpecular", 1, material->specular, shader->matColorSpecular);
             }
             
             //send shininess
             if(shader->matShininess != -1)
             {
-                glUniform1f(shader->matShininess, material->shininess);
+                shader->SetUniform1f("matShininess", material->shininess, shader->matShininess);
             }
             
         }
         
         grp->MapToGPU(0);
-        glDrawElements(grp->GetDrawingMode(), grp->GetIndices().size(), GL_UNSIGNED_SHORT, 0);
+        glDrawElements(grp->GetDrawingMode(), grp->GetIndexCount(), grp->GetIndexType(), grp->GetIndexOffset());
     }
 
 }
\ No newline at end of file
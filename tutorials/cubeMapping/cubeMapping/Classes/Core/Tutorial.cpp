@@ -9,6 +9,10 @@
 
 #include "Tutorial.h"
 
+//uniforms specific to the tutorial shaders
+VV_DECLARE_UNIFORM(U_CAM_POS_MODEL, "camPosModel")
+VV_DECLARE_UNIFORM(U_MAT_MODEL_TO_WORLD, "matModelToWorld")
+
 //#define RENDER_SKYBOX
 
 //cache resource manager
@@ -86,9 +90,9 @@ bool Tutorial::Deploy()
     
     glClearColor(0.2, 0.2, 0.2, 1.f);
     //enable depth test an back face culling
-    glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    CRenderStateCache::Instance().Enable(GL_DEPTH_TEST);
+	CRenderStateCache::Instance().Enable(GL_CULL_FACE);
+    CRenderStateCache::Instance().CullFace(GL_BACK);
     
     return true;
 }
@@ -167,8 +171,8 @@ void Tutorial::RenderFromPosition(const mat4f& view, const mat4f& projection)
     mat3f model_mat3 = mat3f(model);
 
     //send uniforms to shader
-    m_pShaderMesh->SetUniform4fv("camPosModel", 1, &camera_pos.x);
-    m_pShaderMesh->SetUniformMatrix3x3fv("matModelToWorld", 1, GL_FALSE, &model_mat3[0]);
+    m_pShaderMesh->Set(U_CAM_POS_MODEL, camera_pos);
+    m_pShaderMesh->Set(U_MAT_MODEL_TO_WORLD, model_mat3);
     
     //render the mesh 
     m_pMesh->Render(m_pShaderMesh, view, projection);
@@ -180,11 +184,11 @@ void Tutorial::RenderFromPosition(const mat4f& view, const mat4f& projection)
 #ifdef RENDER_SKYBOX
     //draw all objects of the scene
     m_pShaderSkybox->Begin();
-    glDepthMask(GL_FALSE);//this can be added as a material property so a scene manager can set th GL state accordingly
-    glDisable(GL_CULL_FACE); // this is a material property (CMaterial has an attribute named twoSided)
+    CRenderStateCache::Instance().DepthMask(GL_FALSE);//this can be added as a material property so a scene manager can set th GL state accordingly
+    CRenderStateCache::Instance().Disable(GL_CULL_FACE); // this is a material property (CMaterial has an attribute named twoSided)
     m_pSkybox->Render(m_pShaderSkybox, view, projection);
-    glDepthMask(GL_TRUE);
-    glEnable(GL_CULL_FACE);
+    CRenderStateCache::Instance().DepthMask(GL_TRUE);
+    CRenderStateCache::Instance().Enable(GL_CULL_FACE);
     m_pShaderSkybox->End();
 #endif
     
@@ -25,17 +25,19 @@ void CMeshEntity::Update(float32 dt)
 }
 void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projection)
 {
+    VV_PROFILE_SCOPE("CMeshEntity::Render");
+    
     assert ( shader != NULL );
     
     if(shader->matprojviewmodel != -1 )
     {
         mat4f mat = projection * view * m_mTransformationMatrix;
-        glUniformMatrix4fv(shader->matprojviewmodel, 1, GL_FALSE, &mat[0]);
+        shader->SetUniformMatrix4x4fv("matProjViewModel", 1, GL_FALSE, &mat[0], shader->matprojviewmodel);
     }
     
     if(shader->matmodel != -1 )
     {
-        glUniformMatrix4fv(shader->matmodel, 1, GL_FALSE, &m_mTransformationMatrix[0]);
+        shader->SetUniformMatrix4x4fv("matModel", 1, GL_FALSE, &m_mTransformationMatrix[0], shader->matmodel);
     }
     
     CMeshBuffer* buffer = m_pMesh->GetMeshBuffer();
@@ -60,26 +62,25 @@ void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projec
             if(material->detailTexture !=0 && shader->textureDetail != -1)
             {
                 material->detailTexture->ActivateAndBind(GL_TEXTURE1);
-                glUniform1i(shader->textureDetail, 1);
-                glUniform1f(shader->detailFactor, material->detailFactor);
+                shader->SetUniform1i("textureDetail", 1, shader->textureDetail);
+                shader->SetUniform1f("detailFactor", material->detailFactor, shader->detailFactor);
             }
             
             //send detail texture with the corresponding detail factor of the material
             if(material->cubeMapTexture != NULL && shader->textureCubeMap != -1)
             {
                 material->cubeMapTexture->ActivateAndBind(GL_TEXTURE2);
-                glUniform1i(shader->textureCubeMap, 2);
+                shader->SetUniform1i("textureCubeMap", 2, shader->textureCubeMap);
             }
         }
         
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP,0);
+        CTextureStateTracker::Instance().Bind(GL_TEXTURE0, GL_TEXTURE_CUBE_MAP, 0);
         
         //bind vao
         grp->MapToGPU(0);
         
         //issue gl drawing command
-        glDrawElements(grp->GetDrawingMode(), grp->GetIndices().size(), GL_UNSIGNED_SHORT, 0);
+        glDrawElements(grp->GetDrawingMode(), grp->GetIndexCount(), grp->GetIndexType(), grp->GetIndexOffset());
     }
 
 }
\ No newline at end of file
@@ -24,7 +24,7 @@ bool CSkyBoxEntity::Create(CTextureCubeMap* texture_cubeMap)
 {
     CMeshGroup* group = new CMeshGroup();
     std::vector<CGpuVertex> &vert = group->GetVertices();
-    std::vector<ushort16> &ind = group->GetIndices();
+    std::vector<uint32> &ind = group->GetIndices();
     group->SetMaterialIndex(0);
 
     CGpuVertex vertex;
@@ -104,53 +104,53 @@ bool CSkyBoxEntity::Create(CTextureCubeMap* texture_cubeMap)
     vertex.pos = vec3f(t,  t, -t);
     vert.push_back(vertex);
     
-    ind.push_back((ushort16)0);
-    ind.push_back((ushort16)2);
-    ind.push_back((ushort16)1);
+    ind.push_back(0);
+    ind.push_back(2);
+    ind.push_back(1);
     
-    ind.push_back((ushort16)0);
-    ind.push_back((ushort16)3);
-    ind.push_back((ushort16)2);
+    ind.push_back(0);
+    ind.push_back(3);
+    ind.push_back(2);
     
-    ind.push_back((ushort16)4);
-    ind.push_back((ushort16)5);
-    ind.push_back((ushort16)6);
+    ind.push_back(4);
+    ind.push_back(5);
+    ind.push_back(6);
     
-    ind.push_back((ushort16)4);
-    ind.push_back((ushort16)6);
-    ind.push_back((ushort16)7);
+    ind.push_back(4);
+    ind.push_back(6);
+    ind.push_back(7);
     
-    ind.push_back((ushort16)8);
-    ind.push_back((ushort16)9);
-    ind.push_back((ushort16)10);
+    ind.push_back(8);
+    ind.push_back(9);
+    ind.push_back(10);
     
-    ind.push_back((ushort16)8);
-    ind.push_back((ushort16)10);
-    ind.push_back((ushort16)11);
+    ind.push_back(8);
+    ind.push_back(10);
+    ind.push_back(11);
     
-    ind.push_back((ushort16)12);
-    ind.push_back((ushort16)15);
-    ind.push_back((ushort16)14);
+    ind.push_back(12);
+    ind.push_back(15);
+    ind.push_back(14);
     
-    ind.push_back((ushort16)12);
-    ind.push_back((ushort16)14);
-    ind.push_back((ushort16)13);
+    ind.push_back(12);
+    ind.push_back(14);
+    ind.push_back(13);
     
-    ind.push_back((ushort16)16);
-    ind.push_back((ushort16)17);
-    ind.push_back((ushort16)18);
+    ind.push_back(16);
+    ind.push_back(17);
+    ind.push_back(18);
     
-    ind.push_back((ushort16)16);
-    ind.push_back((ushort16)18);
-    ind.push_back((ushort16)19);
+    ind.push_back(16);
+    ind.push_back(18);
+    ind.push_back(19);
     
-    ind.push_back((ushort16)20);
-    ind.push_back((ushort16)23);
-    ind.push_back((ushort16)22);
+    ind.push_back(20);
+    ind.push_back(23);
+    ind.push_back(22);
     
-    ind.push_back((ushort16)20);
-    ind.push_back((ushort16)22);
-    ind.push_back((ushort16)21);
+    ind.push_back(20);
+    ind.push_back(22);
+    ind.push_back(21);
     
     //create gpu storage for the gourp
     group->AllocateOnGpuMemory(kGL_BUFFER_USAGE_HINT_STATIC);
@@ -184,7 +184,7 @@ void CSkyBoxEntity::Render(CShader* shader, const mat4f &view, const mat4f &proj
     if(shader->matprojviewmodel != -1 )
     {
         mat4f mat = projection * view * m_mTransformationMatrix;
-        glUniformMatrix4fv(shader->matprojviewmodel, 1, GL_FALSE, &mat[0]);
+        shader->SetUniformMatrix4x4fv("matProjViewModel", 1, GL_FALSE, &mat[0], shader->matprojviewmodel);
     }
     
     for(uint32 g = 0; g<m_pMeshBuffer->GroupsCount(); g++)
@@ -197,9 +197,7 @@ void CSkyBoxEntity::Render(CShader* shader, const mat4f &view, const mat4f &proj
         if( material != NULL && material->cubeMapTexture != NULL && shader->textureCubeMap != -1)
 		{
 			material->cubeMapTexture->ActivateAndBind(GL_TEXTURE2);
-			//shader->SetUniform1i("textureCubeMap", 2, shader->textureCubeMap);
-            //or
-            glUniform1i(shader->textureCubeMap, 2);
+            shader->SetUniform1i("textureCubeMap", 2, shader->textureCubeMap);
 
         }
         
@@ -207,9 +205,8 @@ void CSkyBoxEntity::Render(CShader* shader, const mat4f &view, const mat4f &proj
         
         //bind vertex array
         grp->MapToGPU(0);
-        glDrawElements(grp->GetDrawingMode(), grp->GetIndices().size(), GL_UNSIGNED_SHORT, 0);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP,0);
+        glDrawElements(grp->GetDrawingMode(), grp->GetIndexCount(), grp->GetIndexType(), grp->GetIndexOffset());
+        CTextureStateTracker::Instance().Bind(GL_TEXTURE0, GL_TEXTURE_CUBE_MAP, 0);
     }
 }
 
@@ -0,0 +1,105 @@
+#!/usr/bin/env python
+# vvbench.py
+#
+# Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+# All rights reserved. Email: Abdallah.dib@virtual-vison.net
+# Web: <http://www.virutal-vision.net/>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+"""Compare a headless run of a tutorial against its baseline.
+
+The report is the csv written by the headless runner ( check
+engine/vvision/Platform/HeadlessRunner.cpp), one line per frame. The per frame
+average of each metric is compared with the baseline:
+
+  calls, redundant_calls, draws, indices, triangles, uploaded_bytes, uniform_bytes, errors
+      are deterministic, any increase is a regression.
+  cpu_ms
+      depends on the machine, an increase above --cpu-tolerance is a regression.
+
+A metric missing from one of the reports ( written before it was added) is not
+compared. A run with gl errors always fails. With --update the baseline is replaced by
+the current report once it passes ( or always with --force).
+
+usage: vvbench.py baseline.csv current.csv [--cpu-tolerance 0.1] [--update [--force]]
+"""
+
+import argparse
+import csv
+import shutil
+import sys
+
+DETERMINISTIC = ('calls', 'redundant_calls', 'draws', 'indices', 'triangles', 'uploaded_bytes', 'uniform_bytes', 'errors')
+TIMED = ('cpu_ms',)
+DEFAULT_CPU_TOLERANCE = 0.1
+
+
+def averages(path):
+    with open(path) as report:
+        rows = list(csv.DictReader(report))
+    if not rows:
+        raise ValueError('%s: no frame' % path)
+    metrics = [metric for metric in DETERMINISTIC + TIMED if metric in rows[0]]
+    return dict((metric, sum(float(row[metric]) for row in rows) / len(rows)) for metric in metrics), len(rows)
+
+
+def compare(baseline, current, cpu_tolerance):
+    regressions = []
+    for metric in DETERMINISTIC + TIMED:
+        if metric not in baseline or metric not in current:
+            continue
+        before, after = baseline[metric], current[metric]
+        tolerance = cpu_tolerance if metric in TIMED else 0.0
+        # a tenth of a call per frame is noise from the averaging, not a change
+        limit = before * (1.0 + tolerance) + (0.0 if metric in TIMED else 0.1)
+        change = (after - before) / before * 100.0 if before else 0.0
+        status = 'REGRESSION' if after > limit else ('better' if after < before else 'ok')
+        print('  %-16s %14.2f %14.2f %+8.1f%%  %s' % (metric, before, after, change, status))
+        if after > limit:
+            regressions.append(metric)
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description='compare a Virtual Vision headless report against its baseline')
+    parser.add_argument('baseline', help='baseline report ( csv)')
+    parser.add_argument('current', help='report of the current run ( csv)')
+    parser.add_argument('--cpu-tolerance', type=float, default=DEFAULT_CPU_TOLERANCE, help='allowed relative cpu_ms increase')
+    parser.add_argument('--update', action='store_true', help='replace the baseline by the current report if it passes')
+    parser.add_argument('--force', action='store_true', help='with --update, replace the baseline even on regression')
+    args = parser.parse_args()
+
+    current, frames = averages(args.current)
+    try:
+        baseline, baseline_frames = averages(args.baseline)
+    except (IOError, OSError):
+        baseline = None
+
+    regressions = []
+    if baseline is None:
+        print('vvbench: no baseline %s' % args.baseline)
+    else:
+        print('vvbench: per frame average, %d baseline frames, %d current frames' % (baseline_frames, frames))
+        print('  %-16s %14s %14s %9s' % ('metric', 'baseline', 'current', 'change'))
+        regressions = compare(baseline, current, args.cpu_tolerance)
+
+    if current['errors'] > 0 and 'errors' not in regressions:
+        regressions.append('errors')
+
+    if args.update and (not regressions or args.force):
+        shutil.copyfile(args.current, args.baseline)
+        print('vvbench: baseline %s updated' % args.baseline)
+
+    if regressions:
+        print('vvbench: regression in %s' % ', '.join(regressions))
+        return 1
+    print('vvbench: no regression')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
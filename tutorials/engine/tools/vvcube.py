@@ -0,0 +1,122 @@
+#!/usr/bin/env python
+# vvcube.py
+#
+# Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+# All rights reserved. Email: Abdallah.dib@virtual-vison.net
+# Web: <http://www.virutal-vision.net/>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+"""Build a pre-packed cube map ( .vvcube) from six face images or from a single cross/strip image.
+
+The layout is described by SCubeMapHeader in engine/vvision/Renderer/TextureCubeMap.h.
+The faces are stored decoded ( RGBA8, premultiplied alpha like LoadImage) so the
+CCacheResourceManager uploads them without decoding. The container compresses well,
+pack it with vvpack.py to keep the bundle small.
+
+usage: vvcube.py sky.jpg [-o sky.vvcube]
+       sky.jpg is either a single cross/strip image or the base name of sky_xp.jpg ... sky_zn.jpg
+
+requires Pillow ( pip install Pillow)
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+try:
+    from PIL import Image
+except ImportError:
+    sys.stderr.write('vvcube: [ERROR] Pillow is required ( pip install Pillow)\n')
+    sys.exit(1)
+
+MAGIC = 0x4D435656          # "VVCM"
+VERSION = 1
+ALIGNMENT = 16
+
+HEADER = struct.Struct('<4I')
+
+# gl order
+SUFFIXES = ('_xp', '_xn', '_yp', '_yn', '_zp', '_zn')
+
+# face cells ( column, row) in gl order, same as LoadCubeLayout
+HORIZONTAL_CROSS = ((2, 1), (0, 1), (1, 0), (1, 2), (1, 1), (3, 1))
+VERTICAL_CROSS = ((2, 1), (0, 1), (1, 0), (1, 2), (1, 1), (1, 3))
+
+
+def premultiply(image):
+    image = image.convert('RGBA')
+    if image.getextrema()[3][0] == 255:
+        return image
+    # same bytes as core graphics with kCGImageAlphaPremultipliedLast
+    return Image.frombytes('RGBA', image.size, image.convert('RGBa').tobytes())
+
+
+def load_faces(path):
+    if os.path.isfile(path):
+        image = Image.open(path)
+        width, height = image.size
+        if width * 6 == height:
+            size = width
+            cells = [(0, i) for i in range(6)]
+        elif width == height * 6:
+            size = height
+            cells = [(i, 0) for i in range(6)]
+        elif width * 3 == height * 4:
+            size = width // 4
+            cells = HORIZONTAL_CROSS
+        elif width * 4 == height * 3:
+            size = width // 3
+            cells = VERTICAL_CROSS
+        else:
+            raise ValueError('unknown cube map layout ( %dx%d): %s' % (width, height, path))
+        faces = [image.crop((c * size, r * size, (c + 1) * size, (r + 1) * size)) for c, r in cells]
+        if cells is VERTICAL_CROSS:
+            faces[5] = faces[5].rotate(180)
+        return faces
+
+    base, extension = os.path.splitext(path)
+    faces = [Image.open(base + suffix + extension) for suffix in SUFFIXES]
+    size = faces[0].size
+    for suffix, face in zip(SUFFIXES, faces):
+        if face.size != size or size[0] != size[1]:
+            raise ValueError('cube map faces must be square and share the same size: %s%s%s' % (base, suffix, extension))
+    return faces
+
+
+def build(path, output):
+    faces = [premultiply(face) for face in load_faces(path)]
+    size = faces[0].size[0]
+    face_bytes = size * size * 4
+    stride = (face_bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1)
+
+    with open(output, 'wb') as out:
+        out.write(HEADER.pack(MAGIC, VERSION, size, stride))
+        for face in faces:
+            out.write(face.tobytes())
+            out.write(b'\0' * (stride - face_bytes))
+
+    print('vvcube: %s -> %s ( %dx%d faces, %d bytes)' % (path, output, size, size, os.path.getsize(output)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='build a Virtual Vision cube map container')
+    parser.add_argument('image', help='cross/strip image or base name of the six faces ( sky.jpg for sky_xp.jpg ...)')
+    parser.add_argument('-o', '--output', help='output container, defaults to the image name with the .vvcube extension')
+    args = parser.parse_args()
+
+    output = args.output or os.path.splitext(os.path.basename(args.image))[0] + '.vvcube'
+    try:
+        build(args.image, output)
+    except (IOError, ValueError) as e:
+        sys.stderr.write('vvcube: [ERROR] %s\n' % e)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,151 @@
+#!/usr/bin/env python
+# vvpack.py
+#
+# Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+# All rights reserved. Email: Abdallah.dib@virtual-vison.net
+# Web: <http://www.virutal-vision.net/>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+"""Build an asset pack ( resources.vvpack) from a tutorial Resources directory.
+
+The layout is described in engine/vvision/Utils/AssetPack.h. Files are stored
+by name only, like Xcode copies them flat into the application bundle. Add the
+generated pack to the "Copy Bundle Resources" phase of the tutorial and the
+CCacheResourceManager mounts it automatically.
+
+usage: vvpack.py <Resources directory> [-o resources.vvpack] [--no-compress]
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = 0x4B505656          # "VVPK"
+VERSION = 1
+ALIGNMENT = 16
+EMPTY_BUCKET = 0xFFFFFFFF
+COMPRESSION_NONE = 0
+COMPRESSION_ZLIB = 1
+
+HEADER = struct.Struct('<8I')
+ENTRY = struct.Struct('<8I')
+
+# already compressed formats are stored as is, they can then be used straight from the mapped pack
+STORED_EXTENSIONS = ('.png', '.jpg', '.jpeg', '.pvr')
+
+# files that never end up in the bundle
+IGNORED_FILES = ('.DS_Store',)
+
+
+def fnv1a(name):
+    h = 2166136261
+    for c in bytearray(name):
+        h ^= c
+        h = (h * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def align(offset):
+    return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1)
+
+
+def collect(resources):
+    files = {}
+    for root, dirs, names in os.walk(resources):
+        dirs.sort()
+        for name in sorted(names):
+            if name in IGNORED_FILES or name.startswith('.') or name.endswith('.vvpack'):
+                continue
+            path = os.path.join(root, name)
+            if name in files:
+                sys.stderr.write('vvpack: [WARNING] %s shadows %s ( the bundle is flat)\n' % (path, files[name]))
+            files[name] = path
+    return files
+
+
+def build(resources, output, compress):
+    files = collect(resources)
+    contents = {}
+    for name in files:
+        with open(files[name], 'rb') as f:
+            contents[name] = f.read()
+
+    raw, packed = write(contents, output, compress)
+    print('vvpack: %d files, %d bytes -> %s ( %d bytes)' % (len(files), raw, output, packed))
+
+
+def write(contents, output, compress):
+    """write a pack holding contents ( file name -> bytes), returns the raw and the packed size"""
+    names = sorted(contents)
+
+    bucket_count = 1
+    while bucket_count < 2 * max(len(names), 1):
+        bucket_count *= 2
+
+    entries_offset = HEADER.size
+    buckets_offset = entries_offset + ENTRY.size * len(names)
+    names_offset = buckets_offset + 4 * bucket_count
+
+    name_blob = b''
+    payloads = []
+    for name in names:
+        data = contents[name]
+        method, stored = COMPRESSION_NONE, data
+        if compress and not name.lower().endswith(STORED_EXTENSIONS):
+            packed = zlib.compress(data, 9)
+            # only keep the compressed payload when it is worth inflating at load time
+            if len(packed) < len(data) * 0.9:
+                method, stored = COMPRESSION_ZLIB, packed
+        payloads.append((name, method, stored, len(data)))
+
+    entries = []
+    buckets = [EMPTY_BUCKET] * bucket_count
+    offset = align(names_offset + sum(len(n.encode('utf-8')) for n in names))
+    for index, (name, method, stored, size) in enumerate(payloads):
+        encoded = name.encode('utf-8')
+        h = fnv1a(encoded)
+        entries.append(ENTRY.pack(h, len(name_blob), len(encoded), method, offset, len(stored), size, 0))
+        name_blob += encoded
+        offset = align(offset + len(stored))
+
+        slot = h & (bucket_count - 1)
+        while buckets[slot] != EMPTY_BUCKET:
+            slot = (slot + 1) & (bucket_count - 1)
+        buckets[slot] = index
+
+    with open(output, 'wb') as out:
+        out.write(HEADER.pack(MAGIC, VERSION, len(names), bucket_count,
+                              entries_offset, buckets_offset, names_offset, 0))
+        out.write(b''.join(entries))
+        out.write(struct.pack('<%dI' % bucket_count, *buckets))
+        out.write(name_blob)
+        for name, method, stored, size in payloads:
+            out.write(b'\0' * (align(out.tell()) - out.tell()))
+            out.write(stored)
+
+    return sum(p[3] for p in payloads), os.path.getsize(output)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='build a Virtual Vision asset pack')
+    parser.add_argument('resources', help='tutorial Resources directory')
+    parser.add_argument('-o', '--output', default='resources.vvpack', help='output pack')
+    parser.add_argument('--no-compress', action='store_true', help='store every file uncompressed')
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.resources):
+        sys.stderr.write('vvpack: [ERROR] %s is not a directory\n' % args.resources)
+        return 1
+
+    build(args.resources, args.output, not args.no_compress)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,421 @@
+#!/usr/bin/env python
+# vvshader.py
+#
+# Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+# All rights reserved. Email: Abdallah.dib@virtual-vison.net
+# Web: <http://www.virutal-vision.net/>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+"""Validate and preprocess the shaders of the tutorials offline.
+
+Every Name.vsh/Name.fsh pair is a program. Each program is checked in its base
+form and in every permutation it references ( the VV_* defines injected by
+engine/vvision/Renderer/ShaderPermutation.h). Programs are validated in parallel
+with glslangValidator when it is found in the PATH ( compile and link as
+glsl es 100), with built-in checks otherwise ( preprocessor balance, main,
+default float precision, attribute/varying/uniform interface between stages).
+
+#include "file" is resolved relative to the including file, then in the -I
+directories, a file is included once per stage. Comments and whitespace are
+stripped, #ifdef VV_* blocks are kept for the runtime permutations.
+
+With -o the preprocessed shaders are written to a shader pack ( asset pack
+layout, check tools/vvpack.py). Add it to the "Copy Bundle Resources" phase of
+the tutorial, CCacheResourceManager mounts it automatically and loads shaders
+from it instead of the loose files. A program that fails validation is stored
+as Name.invalid with its log, the runtime then refuses to load it.
+
+usage: vvshader.py [Shaders directory ...] [-o shaders.vvpack] [-I dir] [-j jobs]
+       without directory, every tutorials/*/Resources/Shaders directory is validated.
+"""
+
+import argparse
+import glob
+import multiprocessing
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import vvpack
+
+# the permutation features are read from the engine so this list can not drift from kSHADER_FEATURE_*
+PERMUTATION = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'vvision', 'Renderer', 'ShaderPermutation')
+FEATURE_DEFINE = re.compile(r'\{\s*kSHADER_FEATURE_\w+\s*,\s*"(VV_\w+)"\s*\}')
+INSTANCES_COUNT = re.compile(r'\bkSHADER_INSTANCING_UNIFORM_COUNT\s*=\s*(\d+)')
+DEFAULT_BONES = 60
+
+
+def read_permutation():
+    """define names of s_vFeatureDefines in ShaderPermutation.cpp, instances of kSHADER_INSTANCING_UNIFORM_COUNT"""
+    try:
+        with open(PERMUTATION + '.cpp') as f:
+            features = tuple(FEATURE_DEFINE.findall(f.read()))
+        with open(PERMUTATION + '.h') as f:
+            instances = INSTANCES_COUNT.search(f.read())
+    except IOError as e:
+        sys.exit('vvshader: [ERROR] cant read the shader features: %s' % e)
+    if not features or not instances:
+        sys.exit('vvshader: [ERROR] no shader features found in %s.cpp/.h' % PERMUTATION)
+    return features, int(instances.group(1))
+
+
+# VV_BONES comes with VV_SKINNING, VV_INSTANCES with VV_INSTANCING_UNIFORMS
+FEATURES, INSTANCES = read_permutation()
+
+# runtime refuses a program stored with this extension ( check VV_SHADER_INVALID_EXTENSION)
+INVALID_EXTENSION = '.invalid'
+
+STAGES = (('.vsh', 'vert'), ('.fsh', 'frag'))
+
+INCLUDE = re.compile(r'^\s*#\s*include\s+"([^"]+)"\s*$')
+DIRECTIVE = re.compile(r'^\s*#\s*(\w+)\s*(.*)$')
+DECLARATION = re.compile(r'\b(attribute|varying|uniform)\s+(?:(?:highp|mediump|lowp)\s+)?(\w+)\s+(\w+)')
+# float declaration without precision, an error in a fragment shader without default float precision
+UNQUALIFIED_FLOAT = re.compile(r'(?<!highp )(?<!mediump )(?<!lowp )\b(?:float|vec[234]|mat[234])\s+\w+')
+PUNCTUATION = ';,{}()[]'
+OPERATORS = '=+-*/<>!&|^%?:.'
+
+
+class ShaderError(Exception):
+    pass
+
+
+def strip_comments(text):
+    """remove // and /* */ comments, newlines are kept so line numbers stay valid"""
+    out = []
+    i, n = 0, len(text)
+    while i < n:
+        if text.startswith('//', i):
+            end = text.find('\n', i)
+            i = n if end < 0 else end
+        elif text.startswith('/*', i):
+            end = text.find('*/', i + 2)
+            if end < 0:
+                raise ShaderError('unterminated comment')
+            out.append('\n' * text.count('\n', i, end))
+            i = end + 2
+        else:
+            out.append(text[i])
+            i += 1
+    return ''.join(out)
+
+
+def resolve(path, search, included=None, stack=()):
+    """text of path without comments and with every #include expanded"""
+    path = os.path.normpath(path)
+    if path in stack:
+        raise ShaderError('recursive include: %s' % ' -> '.join(stack + (path,)))
+    if included is None:
+        included = set()
+    included.add(path)
+
+    with open(path, 'rb') as f:
+        text = f.read().decode('utf-8').replace('\r\n', '\n').replace('\r', '\n')
+
+    lines = []
+    for number, line in enumerate(strip_comments(text).split('\n'), 1):
+        match = INCLUDE.match(line)
+        if not match:
+            lines.append(line)
+            continue
+
+        name = match.group(1)
+        for directory in (os.path.dirname(path),) + tuple(search):
+            candidate = os.path.normpath(os.path.join(directory, name))
+            if os.path.isfile(candidate):
+                break
+        else:
+            raise ShaderError('%s:%d: include not found: %s' % (path, number, name))
+
+        if candidate not in included:
+            lines.append(resolve(candidate, search, included, stack + (path,)))
+    return '\n'.join(lines)
+
+
+def squeeze(line):
+    """collapse whitespace, spaces next to punctuation or between an operator and an identifier are dropped"""
+    line = ' '.join(line.split())
+    out = []
+    for i, c in enumerate(line):
+        if c == ' ':
+            left, right = line[i - 1], line[i + 1]
+            if left in PUNCTUATION or right in PUNCTUATION:
+                continue
+            if (left in OPERATORS) != (right in OPERATORS):
+                continue
+        out.append(c)
+    return ''.join(out)
+
+
+def minify(text):
+    """directives stay on their own line, code lines between two directives are joined"""
+    out, code = [], []
+    for line in text.split('\n'):
+        if not line.strip():
+            continue
+        if line.lstrip().startswith('#'):
+            if code:
+                out.append(squeeze(' '.join(code)))
+                code = []
+            out.append(' '.join(line.split()))
+        else:
+            code.append(line)
+    if code:
+        out.append(squeeze(' '.join(code)))
+    return '\n'.join(out) + '\n'
+
+
+def inject(text, defines):
+    """insert the permutation defines like BuildShaderPermutation does ( after #version/#extension)"""
+    lines = text.split('\n')
+    insert = 0
+    for index, line in enumerate(lines):
+        match = DIRECTIVE.match(line)
+        if match and match.group(1) in ('version', 'extension'):
+            insert = index + 1
+    block = ['#define %s %s' % (name, value) for name, value in defines]
+    return '\n'.join(lines[:insert] + block + lines[insert:])
+
+
+def variants(sources, bones):
+    """define sets to validate: base, every referenced feature alone and all of them"""
+    referenced = set(re.findall(r'\bVV_\w+', '\n'.join(l for s in sources for l in s.split('\n') if l.lstrip().startswith('#'))))
+    if 'VV_BONES' in referenced:
+        referenced.add('VV_SKINNING')
+    if 'VV_INSTANCES' in referenced:
+        referenced.add('VV_INSTANCING_UNIFORMS')
+    features = [f for f in FEATURES if f in referenced]
+
+    sets = [()]
+    sets += [(f,) for f in features]
+    if len(features) > 1:
+        sets.append(tuple(features))
+
+    result = []
+    for features in sets:
+        defines = [(f, '1') for f in features]
+        if 'VV_SKINNING' in features:
+            defines.append(('VV_BONES', str(bones)))
+        if 'VV_INSTANCING_UNIFORMS' in features:
+            defines.append(('VV_INSTANCES', str(INSTANCES)))
+        result.append(defines)
+    return result
+
+
+def evaluate(expression, macros):
+    expression = re.sub(r'\bdefined\s*\(\s*(\w+)\s*\)|\bdefined\s+(\w+)',
+                        lambda m: '1' if (m.group(1) or m.group(2)) in macros else '0', expression)
+    expression = re.sub(r'\b[A-Za-z_]\w*\b', lambda m: macros.get(m.group(0), '0') or '0', expression)
+    expression = expression.replace('&&', ' and ').replace('||', ' or ')
+    expression = re.sub(r'!(?!=)', ' not ', expression)
+    try:
+        return bool(eval(expression, {'__builtins__': {}}, {}))
+    except Exception:
+        raise ShaderError('invalid #if expression: %s' % expression)
+
+
+def preprocess(text):
+    """evaluate the conditional directives ( object like macros only), returns the active code"""
+    macros, stack, code = {}, [], []
+    for number, line in enumerate(text.split('\n'), 1):
+        active = all(s[0] for s in stack)
+        match = DIRECTIVE.match(line)
+        if not match:
+            code.append(line if active else '')
+            continue
+
+        directive, argument = match.group(1), match.group(2).strip()
+        if directive in ('ifdef', 'ifndef'):
+            taken = (argument in macros) == (directive == 'ifdef')
+            stack.append([taken, taken])
+        elif directive == 'if':
+            taken = active and evaluate(argument, macros)
+            stack.append([taken, taken])
+        elif directive in ('elif', 'else'):
+            if not stack:
+                raise ShaderError('line %d: #%s without #if' % (number, directive))
+            taken = not stack[-1][1] and (directive == 'else' or evaluate(argument, macros))
+            stack[-1] = [taken, stack[-1][1] or taken]
+        elif directive == 'endif':
+            if not stack:
+                raise ShaderError('line %d: #endif without #if' % number)
+            stack.pop()
+        elif not active:
+            pass
+        elif directive == 'define':
+            parts = argument.split(None, 1)
+            if parts:
+                macros[parts[0]] = parts[1] if len(parts) > 1 else ''
+        elif directive == 'undef':
+            macros.pop(argument, None)
+        elif directive == 'error':
+            raise ShaderError('line %d: #error %s' % (number, argument))
+        code.append('')
+
+    if stack:
+        raise ShaderError('unterminated #if')
+    return '\n'.join(code)
+
+
+def interface(code):
+    declarations = {}
+    for qualifier, kind, name in DECLARATION.findall(code):
+        declarations[(qualifier, name)] = kind
+    return declarations
+
+
+def check_builtin(vertex, fragment):
+    """catch what the driver would reject at compile or link time, errors are returned as strings"""
+    errors = []
+    stages = {}
+    for stage, text in (('vertex', vertex), ('fragment', fragment)):
+        try:
+            code = preprocess(text)
+        except ShaderError as e:
+            errors.append('%s: %s' % (stage, e))
+            continue
+
+        for open_, close in ('()', '[]', '{}'):
+            if code.count(open_) != code.count(close):
+                errors.append('%s: unbalanced %s%s' % (stage, open_, close))
+        if len(re.findall(r'\bvoid\s+main\s*\(', code)) != 1:
+            errors.append('%s: main not found' % stage)
+        stages[stage] = code
+
+    if len(stages) != 2:
+        return errors
+
+    fragment_code = stages['fragment']
+    if not re.search(r'\bprecision\s+(highp|mediump|lowp)\s+float\s*;', fragment_code):
+        unqualified = UNQUALIFIED_FLOAT.search(' '.join(fragment_code.split()))
+        if unqualified:
+            errors.append('fragment: no default float precision for %s' % unqualified.group(0))
+
+    vs, fs = interface(stages['vertex']), interface(fragment_code)
+    for (qualifier, name), kind in sorted(fs.items()):
+        if qualifier == 'attribute':
+            errors.append('fragment: attribute %s in fragment shader' % name)
+        elif qualifier == 'varying' and vs.get(('varying', name)) != kind:
+            errors.append('link: varying %s %s not written by the vertex shader' % (kind, name))
+        elif qualifier == 'uniform' and ('uniform', name) in vs and vs[('uniform', name)] != kind:
+            errors.append('link: uniform %s declared as %s and %s' % (name, vs[('uniform', name)], kind))
+    return errors
+
+
+def check_glslang(validator, vertex, fragment):
+    directory = tempfile.mkdtemp(prefix='vvshader')
+    try:
+        paths = []
+        for text, (extension, stage) in zip((vertex, fragment), STAGES):
+            path = os.path.join(directory, 'shader.' + stage)
+            with open(path, 'w') as f:
+                f.write(text)
+            paths.append(path)
+        process = subprocess.Popen([validator, '-l'] + paths, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+        output = process.communicate()[0].decode('utf-8', 'replace')
+        if process.returncode == 0:
+            return []
+        return [l for l in output.split('\n') if 'ERROR' in l] or [output.strip()]
+    finally:
+        shutil.rmtree(directory, ignore_errors=True)
+
+
+def process(job):
+    """validate one program, returns ( directory, name, stripped sources or None, log)"""
+    directory, name, search, bones, validator = job
+    base = os.path.join(directory, name)
+    try:
+        sources = [resolve(base + extension, search) for extension, stage in STAGES]
+    except (ShaderError, IOError, OSError, UnicodeDecodeError) as e:
+        return directory, name, None, [str(e)]
+
+    log = []
+    for defines in variants(sources, bones):
+        vertex, fragment = [inject(s, defines) for s in sources]
+        if validator:
+            errors = check_glslang(validator, vertex, fragment)
+        else:
+            errors = check_builtin(vertex, fragment)
+        label = ' '.join(d[0] for d in defines) or 'base'
+        log += ['[%s] %s' % (label, e) for e in errors]
+
+    if log:
+        return directory, name, None, log
+    return directory, name, [minify(s) for s in sources], []
+
+
+def programs(directory):
+    """program names of a directory, a stage without its pair is reported as a broken program"""
+    names = set()
+    for extension, stage in STAGES:
+        names.update(os.path.splitext(os.path.basename(p))[0] for p in glob.glob(os.path.join(directory, '*' + extension)))
+    return sorted(names)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='validate and preprocess Virtual Vision shaders')
+    parser.add_argument('directories', nargs='*', help='Shaders directories ( default: every tutorial)')
+    parser.add_argument('-o', '--output', help='shader pack to write ( one directory only)')
+    parser.add_argument('-I', '--include', action='append', default=[], help='additional include directory')
+    parser.add_argument('-j', '--jobs', type=int, default=multiprocessing.cpu_count(), help='parallel jobs')
+    parser.add_argument('--bones', type=int, default=DEFAULT_BONES, help='VV_BONES used to validate skinning permutations')
+    parser.add_argument('--builtin', action='store_true', help='do not use glslangValidator')
+    args = parser.parse_args()
+
+    directories = args.directories
+    if not directories:
+        tutorials = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..')
+        directories = sorted(glob.glob(os.path.join(tutorials, '*', 'Resources', 'Shaders')) +
+                             glob.glob(os.path.join(tutorials, '*', '*', 'Resources', 'Shaders')))
+        directories = [os.path.normpath(d) for d in directories]
+
+    for directory in directories:
+        if not os.path.isdir(directory):
+            sys.stderr.write('vvshader: [ERROR] %s is not a directory\n' % directory)
+            return 1
+    if args.output and len(directories) != 1:
+        sys.stderr.write('vvshader: [ERROR] -o needs exactly one Shaders directory\n')
+        return 1
+
+    validator = None
+    if not args.builtin:
+        validator = shutil.which('glslangValidator') if hasattr(shutil, 'which') else None
+
+    jobs = [(d, name, args.include, args.bones, validator) for d in directories for name in programs(d)]
+    pool = multiprocessing.Pool(max(1, args.jobs))
+    try:
+        results = pool.map(process, jobs)
+    finally:
+        pool.close()
+        pool.join()
+
+    contents, failed = {}, 0
+    for directory, name, sources, log in results:
+        if sources is None:
+            failed += 1
+            sys.stderr.write('vvshader: [ERROR] %s\n' % os.path.join(directory, name))
+            for line in log:
+                sys.stderr.write('    %s\n' % line)
+            contents[name + INVALID_EXTENSION] = '\n'.join(log).encode('utf-8')
+        else:
+            for (extension, stage), text in zip(STAGES, sources):
+                contents[name + extension] = text.encode('utf-8')
+
+    print('vvshader: %d programs validated ( %s), %d failed' % (len(results), 'glslangValidator' if validator else 'built-in checks', failed))
+
+    if args.output:
+        raw, packed = vvpack.write(contents, args.output, True)
+        print('vvshader: %d files, %d bytes -> %s ( %d bytes)' % (len(contents), raw, args.output, packed))
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
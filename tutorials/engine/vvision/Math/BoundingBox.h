@@ -107,6 +107,55 @@ namespace vvision
         /** and min*/
         void SetMin(vec3f _min) {m_vMin=_min;}
         
+        /** diameter in pixels of the sphere around the box, once projected ( FLT_MAX if the eye is inside the sphere)
+         * @param model_view transform of the box to view space
+         * @param projection perspective projection
+         * @param viewport_height in pixels
+         */
+        float GetProjectedSize(const mat4f& model_view, const mat4f& projection, float viewport_height) const
+        {
+            if(m_vMax.x < m_vMin.x)
+                return 0.f;
+            
+            vec3f c = GetCenter();
+            vec4f center = model_view * vec4f(c.x, c.y, c.z, 1.f);
+            
+            //largest scale of the transform
+            float scale = 0.f;
+            for(int i = 0; i < 3; i++)
+            {
+                float s = vec3f(model_view[i * 4], model_view[i * 4 + 1], model_view[i * 4 + 2]).length();
+                if(s > scale)
+                    scale = s;
+            }
+            
+            float radius = (m_vMax - m_vMin).length() * 0.5f * scale;
+            float distance = -center.z;
+            if(distance <= radius)
+                return FLT_MAX;
+            
+            return radius * projection[5] * viewport_height / distance;
+        }
+        
+        /** true if the box is entirely outside of the frustum of model_view_projection ( the planes are its rows)*/
+        bool IsOutsideFrustum(const mat4f& model_view_projection) const
+        {
+            const mat4f& m = model_view_projection;
+            for(int i = 0; i < 6; i++)
+            {
+                //w + row or w - row
+                int row = i / 2;
+                float sign = (i % 2) ? -1.f : 1.f;
+                vec4f plane(m[3] + sign * m[row], m[7] + sign * m[4 + row], m[11] + sign * m[8 + row], m[15] + sign * m[12 + row]);
+                
+                //the corner farthest along the plane normal
+                vec3f corner(plane.x >= 0 ? m_vMax.x : m_vMin.x, plane.y >= 0 ? m_vMax.y : m_vMin.y, plane.z >= 0 ? m_vMax.z : m_vMin.z);
+                if(plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0)
+                    return true;
+            }
+            return false;
+        }
+        
         /** test if a point is inside bounding box,
          * @return true if inside
          */
@@ -127,7 +176,7 @@ namespace vvision
          * the maximum
          */
         vec3f m_vMax;
-        
+    
     };
 }
 
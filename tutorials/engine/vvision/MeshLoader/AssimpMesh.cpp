@@ -47,7 +47,7 @@ namespace vvision
             
             if(!ExtractMeshGroup(i, paiMesh))
                 return false;
-            
+        
         }
         
         //extract materials ( groups can share materials
@@ -60,7 +60,7 @@ namespace vvision
         }
         
         return ret;
-        
+    
     }
     
     void CAssimpMesh::DeleteCachedResources()
@@ -110,9 +110,9 @@ namespace vvision
         bool hasTangents = paiMesh->HasTangentsAndBitangents();
         bool hasNormals = paiMesh->HasNormals();
         
-   
+        
         std::vector<CGpuVertex> &Vertices = group->GetVertices();
-        std::vector<ushort16> &Indices = group->GetIndices();
+        std::vector<uint32> &Indices = group->GetIndices();
         
         const aiVector3D Zero3D(0.0f, 0.0f, 0.0f);
         
@@ -126,7 +126,7 @@ namespace vvision
             
             for (uint32 b = 0; b<bone->mNumWeights; b++) {
                 weightsPerVertex[bone->mWeights[b].mVertexId].push_back(aiVertexWeight(a, bone->mWeights[b].mWeight));
-                
+            
             }
         }
         
@@ -174,12 +174,16 @@ namespace vvision
         for (uint32 i = 0 ; i < paiMesh->mNumFaces ; i++) {
             const aiFace& Face = paiMesh->mFaces[i];
             //assert(Face.mNumIndices == 3);
-            Indices.push_back((ushort16)Face.mIndices[0]);
-            Indices.push_back((ushort16)Face.mIndices[1]);
-            Indices.push_back((ushort16)Face.mIndices[2]);
+            Indices.push_back(Face.mIndices[0]);
+            Indices.push_back(Face.mIndices[1]);
+            Indices.push_back(Face.mIndices[2]);
         }
         
-        //allocate buffer on gpu
+        //levels of detail for the static meshes, skinned meshes move too much for a simplification of their bind pose
+        if(!paiMesh->HasBones())
+            group->SetLodLevels(kMESH_LOD_DEFAULT_LEVELS);
+        
+        //allocate buffer on gpu ( the index width follows the vertex count)
         if(!group->AllocateOnGpuMemory(kGL_BUFFER_USAGE_HINT_STATIC))
         {
             delete group;
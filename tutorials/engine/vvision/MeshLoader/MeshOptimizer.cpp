@@ -0,0 +1,279 @@
+/*
+ *  MeshOptimizer.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "MeshOptimizer.h"
+#include <algorithm>
+
+namespace vvision
+{
+    /** stats of every OptimizeMesh*/
+    static SMeshOptimizerStats s_sTotals;
+    
+    uint32 SimulateVertexCache(const std::vector<uint32>& indices, uint32 vertex_count, uint32 cache_size)
+    {
+        //a vertex is in the cache if it entered less than cache_size misses ago
+        std::vector<uint32> entered(vertex_count, 0);
+        uint32 misses = 0;
+        
+        for(uint32 i = 0; i < indices.size(); i++)
+        {
+            uint32 v = indices[i];
+            if(entered[v] == 0 || misses - entered[v] >= cache_size)
+            {
+                misses++;
+                entered[v] = misses;
+            }
+        }
+        return misses;
+    }
+    
+    /** next fanning vertex: the candidate that stays in the cache while its remaining triangles are emitted,
+     * the oldest such one first, or a dead-end vertex, or the next vertex with triangles left
+     */
+    static int32 NextVertex(const std::vector<uint32>& candidates, const std::vector<uint32>& live, const std::vector<uint32>& timestamps,
+                            uint32 stamp, uint32 cache_size, std::vector<uint32>& dead_ends, uint32& cursor, bool& jumped)
+    {
+        int32 best = -1;
+        int32 bestPriority = -1;
+        for(uint32 i = 0; i < candidates.size(); i++)
+        {
+            uint32 v = candidates[i];
+            if(live[v] == 0)
+                continue;
+            
+            int32 priority = 0;
+            if(stamp - timestamps[v] + 2 * live[v] <= cache_size)
+                priority = stamp - timestamps[v];
+            
+            if(priority > bestPriority)
+            {
+                bestPriority = priority;
+                best = v;
+            }
+        }
+        
+        jumped = false;
+        if(best != -1)
+            return best;
+        
+        //dead end, the most recent vertices first
+        while(!dead_ends.empty())
+        {
+            uint32 v = dead_ends.back();
+            dead_ends.pop_back();
+            if(live[v] > 0)
+                return v;
+        }
+        
+        //nothing around, continue in input order
+        jumped = true;
+        for(; cursor < live.size(); cursor++)
+        {
+            if(live[cursor] > 0)
+                return cursor;
+        }
+        return -1;
+    }
+    
+    void OptimizeVertexCache(std::vector<uint32>& indices, uint32 vertex_count, std::vector<uint32>& clusters, uint32 cache_size)
+    {
+        clusters.clear();
+        uint32 triangleCount = indices.size() / 3;
+        if(triangleCount == 0 || vertex_count == 0)
+            return;
+        
+        //triangles of each vertex
+        std::vector<uint32> live(vertex_count, 0);
+        for(uint32 i = 0; i < triangleCount * 3; i++)
+            live[indices[i]]++;
+        
+        std::vector<uint32> offsets(vertex_count + 1, 0);
+        for(uint32 v = 0; v < vertex_count; v++)
+            offsets[v + 1] = offsets[v] + live[v];
+        
+        std::vector<uint32> adjacency(offsets[vertex_count]);
+        std::vector<uint32> fill(offsets.begin(), offsets.end() - 1);
+        for(uint32 t = 0; t < triangleCount; t++)
+        {
+            for(uint32 c = 0; c < 3; c++)
+                adjacency[fill[indices[t * 3 + c]]++] = t;
+        }
+        
+        std::vector<uint32> timestamps(vertex_count, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32> deadEnds;
+        std::vector<uint32> candidates;
+        std::vector<uint32> output;
+        output.reserve(triangleCount * 3);
+        
+        uint32 stamp = cache_size + 1;
+        uint32 cursor = 0;
+        bool jumped = true;
+        int32 fan = 0;
+        
+        //the first fanning vertex has triangles
+        while(live[fan] == 0)
+            fan++;
+        
+        while(fan >= 0)
+        {
+            if(jumped)
+                clusters.push_back(output.size() / 3);
+            
+            candidates.clear();
+            for(uint32 a = offsets[fan]; a < offsets[fan + 1]; a++)
+            {
+                uint32 t = adjacency[a];
+                if(emitted[t])
+                    continue;
+                
+                for(uint32 c = 0; c < 3; c++)
+                {
+                    uint32 v = indices[t * 3 + c];
+                    output.push_back(v);
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    
+                    //the vertex enters the cache
+                    if(stamp - timestamps[v] > cache_size)
+                        timestamps[v] = stamp++;
+                }
+                emitted[t] = true;
+            }
+            
+            fan = NextVertex(candidates, live, timestamps, stamp, cache_size, deadEnds, cursor, jumped);
+        }
+        
+        //trailing indices of an incomplete triangle are kept
+        output.insert(output.end(), indices.begin() + triangleCount * 3, indices.end());
+        indices.swap(output);
+    }
+    
+    /** cluster of triangles and its overdraw sort key*/
+    struct SMeshCluster
+    {
+        uint32 first;
+        uint32 count;
+        float32 key;
+    };
+    
+    /** clusters facing out first*/
+    static bool SortByOcclusion(const SMeshCluster& a, const SMeshCluster& b)
+    {
+        return a.key > b.key;
+    }
+    
+    void OptimizeOverdraw(const std::vector<CGpuVertex>& vertices, std::vector<uint32>& indices, const std::vector<uint32>& clusters)
+    {
+        uint32 triangleCount = indices.size() / 3;
+        if(clusters.size() < 2 || triangleCount == 0)
+            return;
+        
+        //mesh centroid, area weighted
+        std::vector<SMeshCluster> sorted(clusters.size());
+        std::vector<vec3f> centroids(clusters.size());
+        std::vector<vec3f> normals(clusters.size());
+        vec3f meshCentroid(0, 0, 0);
+        float32 meshArea = 0;
+        
+        for(uint32 c = 0; c < clusters.size(); c++)
+        {
+            uint32 first = clusters[c];
+            uint32 last = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+            
+            vec3f centroid(0, 0, 0);
+            vec3f normal(0, 0, 0);
+            float32 area = 0;
+            for(uint32 t = first; t < last; t++)
+            {
+                const vec3f& p0 = vertices[indices[t * 3]].pos;
+                const vec3f& p1 = vertices[indices[t * 3 + 1]].pos;
+                const vec3f& p2 = vertices[indices[t * 3 + 2]].pos;
+                
+                //twice the area along the normal
+                vec3f n = (p1 - p0).crossProduct(p2 - p0);
+                float32 a = n.length();
+                
+                centroid += (p0 + p1 + p2) * (a / 3.f);
+                normal += n;
+                area += a;
+            }
+            
+            meshCentroid += centroid;
+            meshArea += area;
+            
+            centroids[c] = area > 0 ? centroid / area : vertices[indices[first * 3]].pos;
+            normals[c] = normal;
+            sorted[c].first = first;
+            sorted[c].count = last - first;
+        }
+        
+        if(meshArea > 0)
+            meshCentroid /= meshArea;
+        
+        //a cluster whose normal points away from the center is more likely to occlude the others
+        for(uint32 c = 0; c < clusters.size(); c++)
+            sorted[c].key = (centroids[c] - meshCentroid).dotProduct(normals[c]);
+        
+        std::stable_sort(sorted.begin(), sorted.end(), SortByOcclusion);
+        
+        std::vector<uint32> output;
+        output.reserve(indices.size());
+        for(uint32 c = 0; c < sorted.size(); c++)
+            output.insert(output.end(), indices.begin() + sorted[c].first * 3, indices.begin() + (sorted[c].first + sorted[c].count) * 3);
+        
+        output.insert(output.end(), indices.begin() + triangleCount * 3, indices.end());
+        indices.swap(output);
+    }
+    
+    void OptimizeVertexFetch(std::vector<CGpuVertex>& vertices, std::vector<uint32>& indices)
+    {
+        const uint32 unused = 0xFFFFFFFF;
+        std::vector<uint32> remap(vertices.size(), unused);
+        std::vector<CGpuVertex> output;
+        output.reserve(vertices.size());
+        
+        for(uint32 i = 0; i < indices.size(); i++)
+        {
+            uint32& index = indices[i];
+            if(remap[index] == unused)
+            {
+                remap[index] = output.size();
+                output.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        
+        vertices.swap(output);
+    }
+    
+    SMeshOptimizerStats OptimizeMesh(std::vector<CGpuVertex>& vertices, std::vector<uint32>& indices)
+    {
+        SMeshOptimizerStats stats;
+        stats.triangles = indices.size() / 3;
+        stats.vertices = vertices.size();
+        stats.transformedBefore = SimulateVertexCache(indices, vertices.size());
+        
+        std::vector<uint32> clusters;
+        OptimizeVertexCache(indices, vertices.size(), clusters);
+        OptimizeOverdraw(vertices, indices, clusters);
+        OptimizeVertexFetch(vertices, indices);
+        
+        stats.vertices = vertices.size();
+        stats.transformedAfter = SimulateVertexCache(indices, vertices.size());
+        s_sTotals.Add(stats);
+        return stats;
+    }
+    
+    const SMeshOptimizerStats& GetMeshOptimizerTotals()
+    {
+        return s_sTotals;
+    }
+}
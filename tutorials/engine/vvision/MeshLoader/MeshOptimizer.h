@@ -0,0 +1,88 @@
+/* MeshOptimizer.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_MESH_OPTIMIZER_H
+#define VVISION_MESH_OPTIMIZER_H
+
+#include "types.h"
+#include "VertexFormat.h"
+
+namespace vvision
+{
+    /** size of the fifo post transform cache simulated by the optimizer*/
+    enum
+    {
+        kMESH_OPTIMIZER_CACHE_SIZE = 16
+    };
+    
+    /** vertex transforms of a triangle list before and after optimization, in a fifo cache of kMESH_OPTIMIZER_CACHE_SIZE*/
+    struct SMeshOptimizerStats
+    {
+        /** constructor*/
+        SMeshOptimizerStats() : triangles(0), vertices(0), transformedBefore(0), transformedAfter(0) {}
+        
+        /** average cache miss ratio, vertices transformed per triangle ( 0.5 is the best a regular grid can get, 3 is no reuse)*/
+        inline float32 GetACMRBefore() const {return triangles ? (float32)transformedBefore / triangles : 0.f;}
+        inline float32 GetACMRAfter() const {return triangles ? (float32)transformedAfter / triangles : 0.f;}
+        
+        /** average transform to vertex ratio, vertices transformed per vertex ( 1 is optimal)*/
+        inline float32 GetATVRBefore() const {return vertices ? (float32)transformedBefore / vertices : 0.f;}
+        inline float32 GetATVRAfter() const {return vertices ? (float32)transformedAfter / vertices : 0.f;}
+        
+        /** add the stats of another mesh*/
+        inline void Add(const SMeshOptimizerStats& stats)
+        {
+            triangles += stats.triangles;
+            vertices += stats.vertices;
+            transformedBefore += stats.transformedBefore;
+            transformedAfter += stats.transformedAfter;
+        }
+        
+        uint32 triangles;
+        uint32 vertices;
+        uint32 transformedBefore;
+        uint32 transformedAfter;
+    };
+    
+    /** vertices transformed to draw a triangle list with a fifo post transform cache of cache_size entries*/
+    uint32 SimulateVertexCache(const std::vector<uint32>& indices, uint32 vertex_count, uint32 cache_size = kMESH_OPTIMIZER_CACHE_SIZE);
+    
+    /** reorder the triangles for the post transform cache ( tipsify, Sander et al. 2007, linear time)
+     * @param clusters filled with the first triangle of each cluster: a cluster ends where tipsify had to jump to a vertex out of the cache
+     */
+    void OptimizeVertexCache(std::vector<uint32>& indices, uint32 vertex_count, std::vector<uint32>& clusters, uint32 cache_size = kMESH_OPTIMIZER_CACHE_SIZE);
+    
+    /** reorder the clusters so those facing out of the mesh are drawn first and hide the rest ( Sander et al. 2007),
+     * the order inside a cluster is kept so the cache efficiency is preserved
+     */
+    void OptimizeOverdraw(const std::vector<CGpuVertex>& vertices, std::vector<uint32>& indices, const std::vector<uint32>& clusters);
+    
+    /** reorder the vertices in the order the indices first use them, so the vertex fetch reads memory linearly.
+     * vertices no index uses are removed
+     */
+    void OptimizeVertexFetch(std::vector<CGpuVertex>& vertices, std::vector<uint32>& indices);
+    
+    /** run the three passes on a triangle list, the stats are also added to GetMeshOptimizerTotals*/
+    SMeshOptimizerStats OptimizeMesh(std::vector<CGpuVertex>& vertices, std::vector<uint32>& indices);
+    
+    /** stats of every OptimizeMesh since the start*/
+    const SMeshOptimizerStats& GetMeshOptimizerTotals();
+}
+
+#endif
@@ -0,0 +1,377 @@
+/*
+ *  MeshSimplifier.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <map>
+#include <math.h>
+
+namespace vvision
+{
+    /** weight of the planes holding the border in place, relative to the faces*/
+    #define VV_SIMPLIFIER_BORDER_WEIGHT 10.f
+    
+    /** a collapse is refused if it turns a triangle more than this ( cosine of the angle between the normals)*/
+    #define VV_SIMPLIFIER_MIN_NORMAL_COSINE 0.5f
+    
+    void SQuadric::AddPlane(const vec3f& n, float32 d, float32 w)
+    {
+        a00 += w * n.x * n.x;
+        a01 += w * n.x * n.y;
+        a02 += w * n.x * n.z;
+        a11 += w * n.y * n.y;
+        a12 += w * n.y * n.z;
+        a22 += w * n.z * n.z;
+        b0 += w * n.x * d;
+        b1 += w * n.y * d;
+        b2 += w * n.z * d;
+        c += w * d * d;
+        weight += w;
+    }
+    
+    void SQuadric::Add(const SQuadric& q)
+    {
+        a00 += q.a00;
+        a01 += q.a01;
+        a02 += q.a02;
+        a11 += q.a11;
+        a12 += q.a12;
+        a22 += q.a22;
+        b0 += q.b0;
+        b1 += q.b1;
+        b2 += q.b2;
+        c += q.c;
+        weight += q.weight;
+    }
+    
+    float64 SQuadric::Evaluate(const vec3f& p) const
+    {
+        if(weight <= 0)
+            return 0;
+        
+        float64 x = p.x, y = p.y, z = p.z;
+        float64 e = a00 * x * x + a11 * y * y + a22 * z * z
+                  + 2 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                  + 2 * (b0 * x + b1 * y + b2 * z) + c;
+        
+        //rounding can make it slightly negative
+        return fabs(e) / weight;
+    }
+    
+    /** vertex order by position, to find the vertices sharing one*/
+    struct SPositionLess
+    {
+        const std::vector<CGpuVertex>* vertices;
+        
+        bool operator()(uint32 a, uint32 b) const
+        {
+            const vec3f& p = (*vertices)[a].pos;
+            const vec3f& q = (*vertices)[b].pos;
+            if(p.x != q.x)
+                return p.x < q.x;
+            if(p.y != q.y)
+                return p.y < q.y;
+            return p.z < q.z;
+        }
+    };
+    
+    /** what a position can do*/
+    enum SIMPLIFIER_VERTEX_KIND
+    {
+        /** collapses onto any neighbour*/
+        kSIMPLIFIER_VERTEX_MANIFOLD,
+        
+        /** collapses along the border only*/
+        kSIMPLIFIER_VERTEX_BORDER,
+        
+        /** never collapses ( attribute seam or non manifold edge)*/
+        kSIMPLIFIER_VERTEX_LOCKED
+    };
+    
+    /** collapse of the vertex from onto the vertex to*/
+    struct SCollapse
+    {
+        uint32 from;
+        uint32 to;
+        float64 error;
+    };
+    
+    /** cheapest collapse first*/
+    static bool SortByError(const SCollapse& a, const SCollapse& b)
+    {
+        return a.error < b.error;
+    }
+    
+    /** key of an edge between two positions, whatever its direction*/
+    static inline uint64 EdgeKey(uint32 a, uint32 b)
+    {
+        return a < b ? ((uint64)a << 32) | b : ((uint64)b << 32) | a;
+    }
+    
+    /** triangles using each edge*/
+    static void CountEdges(const std::vector<uint32>& indices, const std::vector<uint32>& position, std::map<uint64, uint32>& edges)
+    {
+        edges.clear();
+        for(uint32 i = 0; i < indices.size(); i += 3)
+        {
+            for(uint32 c = 0; c < 3; c++)
+                edges[EdgeKey(position[indices[i + c]], position[indices[i + (c + 1) % 3]])]++;
+        }
+    }
+    
+    /** true if the triangle has two corners at the same position*/
+    static inline bool IsDegenerate(const std::vector<uint32>& position, uint32 a, uint32 b, uint32 c)
+    {
+        return position[a] == position[b] || position[b] == position[c] || position[a] == position[c];
+    }
+    
+    float32 SimplifyMesh(const std::vector<CGpuVertex>& vertices, const std::vector<uint32>& indices, uint32 target_index_count, float32 max_error, std::vector<uint32>& result)
+    {
+        uint32 vertexCount = vertices.size();
+        result.clear();
+        if(vertexCount == 0)
+            return 0.f;
+        
+        //vertices sharing a position ( wedges) move together
+        std::vector<uint32> order(vertexCount);
+        for(uint32 v = 0; v < vertexCount; v++)
+            order[v] = v;
+        
+        SPositionLess less = {&vertices};
+        std::sort(order.begin(), order.end(), less);
+        
+        std::vector<bool> used(vertexCount, false);
+        for(uint32 i = 0; i < indices.size(); i++)
+            used[indices[i]] = true;
+        
+        std::vector<uint32> position(vertexCount);
+        std::vector<uint32> wedges;
+        for(uint32 i = 0; i < vertexCount; i++)
+        {
+            if(i == 0 || less(order[i - 1], order[i]))
+                wedges.push_back(0);
+            position[order[i]] = wedges.size() - 1;
+            if(used[order[i]])
+                wedges.back()++;
+        }
+        uint32 positionCount = wedges.size();
+        
+        //triangles without area are dropped from the start
+        for(uint32 i = 0; i + 2 < indices.size(); i += 3)
+        {
+            if(!IsDegenerate(position, indices[i], indices[i + 1], indices[i + 2]))
+                result.insert(result.end(), indices.begin() + i, indices.begin() + i + 3);
+        }
+        
+        if(result.size() <= target_index_count)
+            return 0.f;
+        
+        //a position whose wedges differ can not move without tearing the seam
+        std::vector<uchar8> kinds(positionCount, kSIMPLIFIER_VERTEX_MANIFOLD);
+        for(uint32 p = 0; p < positionCount; p++)
+        {
+            if(wedges[p] > 1)
+                kinds[p] = kSIMPLIFIER_VERTEX_LOCKED;
+        }
+        
+        //planes of the faces around each position, area weighted
+        std::vector<SQuadric> quadrics(positionCount);
+        std::map<uint64, uint32> edges;
+        CountEdges(result, position, edges);
+        
+        for(uint32 i = 0; i < result.size(); i += 3)
+        {
+            const vec3f& p0 = vertices[result[i]].pos;
+            const vec3f& p1 = vertices[result[i + 1]].pos;
+            const vec3f& p2 = vertices[result[i + 2]].pos;
+            
+            vec3f n = (p1 - p0).crossProduct(p2 - p0);
+            float32 area = n.length();
+            if(area <= 0)
+                continue;
+            n /= area;
+            
+            for(uint32 c = 0; c < 3; c++)
+                quadrics[position[result[i + c]]].AddPlane(n, -n.dotProduct(p0), area * 0.5f);
+            
+            //an edge of a single triangle is on the border: a plane through it, perpendicular to the face, keeps it in place
+            for(uint32 c = 0; c < 3; c++)
+            {
+                uint32 a = position[result[i + c]];
+                uint32 b = position[result[i + (c + 1) % 3]];
+                uint32 count = edges[EdgeKey(a, b)];
+                
+                if(count > 2)
+                {
+                    kinds[a] = kSIMPLIFIER_VERTEX_LOCKED;
+                    kinds[b] = kSIMPLIFIER_VERTEX_LOCKED;
+                }
+                
+                if(count != 1)
+                    continue;
+                
+                const vec3f& pa = vertices[result[i + c]].pos;
+                const vec3f& pb = vertices[result[i + (c + 1) % 3]].pos;
+                vec3f e = pb - pa;
+                vec3f m = e.crossProduct(n);
+                float32 length = m.length();
+                if(length <= 0)
+                    continue;
+                m /= length;
+                
+                quadrics[a].AddPlane(m, -m.dotProduct(pa), e.lengthSq() * VV_SIMPLIFIER_BORDER_WEIGHT);
+                quadrics[b].AddPlane(m, -m.dotProduct(pa), e.lengthSq() * VV_SIMPLIFIER_BORDER_WEIGHT);
+                
+                if(kinds[a] == kSIMPLIFIER_VERTEX_MANIFOLD)
+                    kinds[a] = kSIMPLIFIER_VERTEX_BORDER;
+                if(kinds[b] == kSIMPLIFIER_VERTEX_MANIFOLD)
+                    kinds[b] = kSIMPLIFIER_VERTEX_BORDER;
+            }
+        }
+        
+        float64 errorLimit = (float64)max_error * max_error;
+        float64 error = 0;
+        
+        std::vector<SCollapse> collapses;
+        std::vector<uint32> remap(vertexCount);
+        std::vector<bool> touched(positionCount);
+        std::vector<uint32> offsets(positionCount + 1);
+        std::vector<uint32> adjacency;
+        
+        //each pass collapses the cheapest edges that do not share a position, until the target or the error is reached
+        while(result.size() > target_index_count)
+        {
+            uint32 triangleCount = result.size() / 3;
+            CountEdges(result, position, edges);
+            
+            collapses.clear();
+            for(uint32 i = 0; i < result.size(); i++)
+            {
+                uint32 from = result[i];
+                uint32 to = result[i - i % 3 + (i + 1) % 3];
+                
+                //both directions of the edge
+                for(uint32 d = 0; d < 2; d++, std::swap(from, to))
+                {
+                    uint32 pf = position[from];
+                    uint32 pt = position[to];
+                    
+                    if(kinds[pf] == kSIMPLIFIER_VERTEX_LOCKED)
+                        continue;
+                    if(kinds[pf] == kSIMPLIFIER_VERTEX_BORDER && edges[EdgeKey(pf, pt)] != 1)
+                        continue;
+                    
+                    SQuadric q = quadrics[pf];
+                    q.Add(quadrics[pt]);
+                    SCollapse collapse = {from, to, q.Evaluate(vertices[to].pos)};
+                    if(collapse.error <= errorLimit)
+                        collapses.push_back(collapse);
+                }
+            }
+            
+            if(collapses.empty())
+                break;
+            std::sort(collapses.begin(), collapses.end(), SortByError);
+            
+            //triangles around each position
+            std::fill(offsets.begin(), offsets.end(), 0);
+            for(uint32 i = 0; i < result.size(); i++)
+                offsets[position[result[i]] + 1]++;
+            for(uint32 p = 0; p < positionCount; p++)
+                offsets[p + 1] += offsets[p];
+            
+            adjacency.resize(result.size());
+            std::vector<uint32> fill(offsets.begin(), offsets.end() - 1);
+            for(uint32 i = 0; i < result.size(); i++)
+                adjacency[fill[position[result[i]]]++] = i / 3;
+            
+            for(uint32 v = 0; v < vertexCount; v++)
+                remap[v] = v;
+            std::fill(touched.begin(), touched.end(), false);
+            
+            uint32 indexCount = result.size();
+            uint32 collapsed = 0;
+            
+            for(uint32 k = 0; k < collapses.size() && indexCount > target_index_count; k++)
+            {
+                const SCollapse& collapse = collapses[k];
+                uint32 pf = position[collapse.from];
+                uint32 pt = position[collapse.to];
+                if(touched[pf] || touched[pt])
+                    continue;
+                
+                //the triangles sharing the edge disappear, the others must keep their orientation
+                const vec3f& target = vertices[collapse.to].pos;
+                uint32 removed = 0;
+                bool flips = false;
+                
+                for(uint32 a = offsets[pf]; a < offsets[pf + 1] && !flips; a++)
+                {
+                    //the corners as left by the collapses already done in this pass
+                    uint32 t = adjacency[a];
+                    uint32 corners[3] = {remap[result[t * 3]], remap[result[t * 3 + 1]], remap[result[t * 3 + 2]]};
+                    if(IsDegenerate(position, corners[0], corners[1], corners[2]))
+                        continue;
+                    
+                    if(position[corners[0]] == pt || position[corners[1]] == pt || position[corners[2]] == pt)
+                    {
+                        removed++;
+                        continue;
+                    }
+                    
+                    vec3f before[3];
+                    vec3f after[3];
+                    for(uint32 c = 0; c < 3; c++)
+                    {
+                        before[c] = vertices[corners[c]].pos;
+                        after[c] = position[corners[c]] == pf ? target : before[c];
+                    }
+                    
+                    vec3f n0 = (before[1] - before[0]).crossProduct(before[2] - before[0]);
+                    vec3f n1 = (after[1] - after[0]).crossProduct(after[2] - after[0]);
+                    flips = n1.dotProduct(n0) <= VV_SIMPLIFIER_MIN_NORMAL_COSINE * n0.length() * n1.length();
+                }
+                
+                if(flips)
+                    continue;
+                
+                //the position has a single wedge ( it is not locked), its triangles take the wedge of the edge
+                remap[collapse.from] = collapse.to;
+                quadrics[pt].Add(quadrics[pf]);
+                touched[pf] = true;
+                touched[pt] = true;
+                
+                indexCount -= removed * 3;
+                error = std::max(error, collapse.error);
+                collapsed++;
+            }
+            
+            if(collapsed == 0)
+                break;
+            
+            //rewrite the triangles, those that lost an edge are removed
+            uint32 write = 0;
+            for(uint32 t = 0; t < triangleCount; t++)
+            {
+                uint32 a = remap[result[t * 3]];
+                uint32 b = remap[result[t * 3 + 1]];
+                uint32 c = remap[result[t * 3 + 2]];
+                if(IsDegenerate(position, a, b, c))
+                    continue;
+                
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+        
+        return (float32)sqrt(error);
+    }
+}
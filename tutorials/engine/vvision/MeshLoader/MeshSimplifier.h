@@ -0,0 +1,61 @@
+/* MeshSimplifier.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_MESH_SIMPLIFIER_H
+#define VVISION_MESH_SIMPLIFIER_H
+
+#include "types.h"
+#include "VertexFormat.h"
+
+namespace vvision
+{
+    /** quadric error of a set of planes, the error of a point is the weighted sum of its squared distances to the planes*/
+    struct SQuadric
+    {
+        /** constructor*/
+        SQuadric() : a00(0), a01(0), a02(0), a11(0), a12(0), a22(0), b0(0), b1(0), b2(0), c(0), weight(0) {}
+        
+        /** add the plane n.p + d = 0 ( n normalized)*/
+        void AddPlane(const vec3f& n, float32 d, float32 w);
+        
+        /** add another quadric*/
+        void Add(const SQuadric& q);
+        
+        /** mean squared distance of p to the planes*/
+        float64 Evaluate(const vec3f& p) const;
+        
+        float64 a00, a01, a02, a11, a12, a22;
+        float64 b0, b1, b2;
+        float64 c;
+        float64 weight;
+    };
+    
+    /** simplify a triangle list by edge collapses ordered by quadric error ( Garland and Heckbert 1997).
+     * a vertex collapses onto a neighbour, so the result indexes the same vertices and can share their buffer.
+     * vertices split on an attribute seam ( same position, different normal or texcoord) are kept, border vertices only
+     * move along the border and no collapse flips a triangle
+     * @param target_index_count stop once the result has this many indices or less
+     * @param max_error stop before a collapse that moves the surface more than this distance ( object space)
+     * @param result the indices of the simplified mesh
+     * @return the error of the result ( object space distance)
+     */
+    float32 SimplifyMesh(const std::vector<CGpuVertex>& vertices, const std::vector<uint32>& indices, uint32 target_index_count, float32 max_error, std::vector<uint32>& result);
+}
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ *  MeshletBuilder.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "MeshletBuilder.h"
+#include <math.h>
+#include <algorithm>
+
+namespace vvision
+{
+    /** bounding sphere and normal cone of the triangles of a meshlet*/
+    static void ComputeMeshletBounds(const std::vector<CGpuVertex>& vertices, const std::vector<uint32>& indices, SMeshlet& meshlet)
+    {
+        uint32 first = meshlet.firstIndex;
+        uint32 last = meshlet.firstIndex + meshlet.indexCount;
+        
+        //sphere around the box of the meshlet
+        vec3f low = vertices[indices[first]].pos;
+        vec3f high = low;
+        for(uint32 i = first; i < last; i++)
+        {
+            const vec3f& p = vertices[indices[i]].pos;
+            for(int32 c = 0; c < 3; c++)
+            {
+                low[c] = std::min(low[c], p[c]);
+                high[c] = std::max(high[c], p[c]);
+            }
+        }
+        
+        meshlet.center = (low + high) * 0.5f;
+        meshlet.radius = 0.f;
+        for(uint32 i = first; i < last; i++)
+            meshlet.radius = std::max(meshlet.radius, (vertices[indices[i]].pos - meshlet.center).length());
+        
+        //cone around the area weighted normal
+        std::vector<vec3f> normals;
+        vec3f axis(0, 0, 0);
+        for(uint32 i = first; i + 2 < last; i += 3)
+        {
+            const vec3f& p0 = vertices[indices[i]].pos;
+            vec3f n = (vertices[indices[i + 1]].pos - p0).crossProduct(vertices[indices[i + 2]].pos - p0);
+            float32 area = n.length();
+            if(area <= 0)
+                continue;
+            
+            axis += n;
+            normals.push_back(n / area);
+        }
+        
+        meshlet.coneAxis = vec3f(0, 0, 0);
+        meshlet.coneCutoff = 1.f;
+        
+        float32 length = axis.length();
+        if(length <= 0)
+            return;
+        axis /= length;
+        
+        float32 spread = 1.f;
+        for(uint32 i = 0; i < normals.size(); i++)
+            spread = std::min(spread, axis.dotProduct(normals[i]));
+        
+        meshlet.coneAxis = axis;
+        
+        //the cone is the half space or more, no eye position sees only back faces
+        if(spread <= 0)
+            return;
+        
+        //sine of the half angle of the cone
+        meshlet.coneCutoff = sqrtf(1.f - spread * spread);
+    }
+    
+    void BuildMeshlets(const std::vector<CGpuVertex>& vertices, const std::vector<uint32>& indices, std::vector<SMeshlet>& meshlets,
+                       uint32 max_vertices, uint32 max_triangles)
+    {
+        meshlets.clear();
+        uint32 triangleCount = indices.size() / 3;
+        if(triangleCount == 0)
+            return;
+        
+        //meshlet that last used each vertex
+        const uint32 none = 0xFFFFFFFF;
+        std::vector<uint32> owner(vertices.size(), none);
+        
+        SMeshlet meshlet;
+        meshlet.firstIndex = 0;
+        meshlet.vertexCount = 0;
+        
+        for(uint32 t = 0; t < triangleCount; t++)
+        {
+            const uint32* corners = &indices[t * 3];
+            uint32 id = meshlets.size();
+            
+            uint32 added = 0;
+            for(uint32 c = 0; c < 3; c++)
+            {
+                if(owner[corners[c]] != id && (c == 0 || corners[c] != corners[0]) && (c < 2 || corners[c] != corners[1]))
+                    added++;
+            }
+            
+            //the triangle starts the next meshlet
+            uint32 triangles = t - meshlet.firstIndex / 3;
+            if(triangles > 0 && (meshlet.vertexCount + added > max_vertices || triangles >= max_triangles))
+            {
+                meshlet.indexCount = t * 3 - meshlet.firstIndex;
+                ComputeMeshletBounds(vertices, indices, meshlet);
+                meshlets.push_back(meshlet);
+                
+                meshlet.firstIndex = t * 3;
+                meshlet.vertexCount = 0;
+                id++;
+                
+                added = 0;
+                for(uint32 c = 0; c < 3; c++)
+                {
+                    if((c == 0 || corners[c] != corners[0]) && (c < 2 || corners[c] != corners[1]))
+                        added++;
+                }
+            }
+            
+            for(uint32 c = 0; c < 3; c++)
+                owner[corners[c]] = id;
+            meshlet.vertexCount += added;
+        }
+        
+        meshlet.indexCount = triangleCount * 3 - meshlet.firstIndex;
+        ComputeMeshletBounds(vertices, indices, meshlet);
+        meshlets.push_back(meshlet);
+    }
+}
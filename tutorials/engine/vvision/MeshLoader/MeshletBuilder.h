@@ -0,0 +1,64 @@
+/* MeshletBuilder.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_MESHLET_BUILDER_H
+#define VVISION_MESHLET_BUILDER_H
+
+#include "types.h"
+#include "VertexFormat.h"
+
+namespace vvision
+{
+    /** size of the meshlets*/
+    enum
+    {
+        kMESHLET_MAX_VERTICES = 64,
+        kMESHLET_MAX_TRIANGLES = 124
+    };
+    
+    /** a cluster of neighbour triangles of a group, the unit of the cpu culling ( check CMeshletCuller)*/
+    struct SMeshlet
+    {
+        /** indices of the meshlet, relative to the first index of the group*/
+        uint32 firstIndex;
+        uint32 indexCount;
+        
+        /** distinct vertices used*/
+        uint32 vertexCount;
+        
+        /** bounding sphere ( object space)*/
+        vec3f center;
+        float32 radius;
+        
+        /** the normals of the triangles are in a cone around coneAxis, the meshlet faces away from an eye at e if
+         * dot(center - e, coneAxis) >= coneCutoff * |center - e| + radius. a cutoff of 1 never culls ( normals spread over 90 degrees)
+         */
+        vec3f coneAxis;
+        float32 coneCutoff;
+    };
+    
+    /** split a triangle list in meshlets of consecutive triangles, a meshlet is closed when the next triangle would use more
+     * than max_vertices vertices or max_triangles triangles. the triangles are not moved: run the vertex cache optimization
+     * first so consecutive triangles are neighbours ( check MeshOptimizer.h)
+     */
+    void BuildMeshlets(const std::vector<CGpuVertex>& vertices, const std::vector<uint32>& indices, std::vector<SMeshlet>& meshlets,
+                       uint32 max_vertices = kMESHLET_MAX_VERTICES, uint32 max_triangles = kMESHLET_MAX_TRIANGLES);
+}
+
+#endif
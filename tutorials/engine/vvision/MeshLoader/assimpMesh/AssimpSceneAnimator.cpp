@@ -44,6 +44,7 @@
  */
 
 #include "AssimpSceneAnimator.h"
+#include "Profiler.h"
 
 
 namespace vvision
@@ -131,6 +132,8 @@ namespace vvision
     // Calculates the node transformations for the scene.
     void AssimpSceneAnimator::Calculate( double pTime)
     {
+        VV_PROFILE_SCOPE("AssimpSceneAnimator::Calculate");
+        
         // invalid anim
         if( !mAnimEvaluator)
             return;
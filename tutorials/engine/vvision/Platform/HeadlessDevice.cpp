@@ -0,0 +1,176 @@
+/*
+ *  HeadlessDevice.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "HeadlessDevice.h"
+
+#ifdef VVISION_PLATFORM_HEADLESS
+
+#include <stdio.h>
+#include <algorithm>
+
+namespace vvision
+{
+    /** most called entry points printed by PrintReport*/
+    #define VV_HEADLESS_REPORT_TOP_CALLS 12
+    
+    /** sort entry points by call count*/
+    static bool SortByCalls(const std::pair<const char8*, uint32>& a, const std::pair<const char8*, uint32>& b)
+    {
+        return a.second > b.second;
+    }
+    
+    CHeadlessDevice::CHeadlessDevice()
+    : m_iWidth(1024), m_iHeight(768), m_bInFrame(false), m_eError(GL_NO_ERROR), m_bLogErrors(true)
+    {
+        memset(&m_sFrame, 0, sizeof(SHeadlessFrameStats));
+    }
+    
+    void CHeadlessDevice::SetDefaultFramebufferSize(int32 width, int32 height)
+    {
+        m_iWidth = width;
+        m_iHeight = height;
+    }
+    
+    void CHeadlessDevice::BeginFrame()
+    {
+        memset(&m_sFrame, 0, sizeof(SHeadlessFrameStats));
+        m_sFrame.frame = m_vHistory.size();
+        m_bInFrame = true;
+        m_cTimer.Reset();
+    }
+    
+    void CHeadlessDevice::EndFrame()
+    {
+        if(!m_bInFrame)
+            return;
+        
+        m_sFrame.cpuMs = m_cTimer.GetElapsedMs();
+        m_vHistory.push_back(m_sFrame);
+        m_bInFrame = false;
+    }
+    
+    void CHeadlessDevice::OnCall(const char8* function)
+    {
+        m_sFrame.calls++;
+        m_mCalls[function]++;
+    }
+    
+    void CHeadlessDevice::OnError(const char8* function, GLenum error, const char8* message)
+    {
+        m_sFrame.errors++;
+        
+        //like gl, the first error is kept until it is read
+        if(m_eError == GL_NO_ERROR)
+            m_eError = error;
+        
+        if(m_bLogErrors)
+            std::cerr<<"CHeadlessDevice: [ERROR] "<<function<<": 0x"<<std::hex<<error<<std::dec<<" "<<message<<"\n";
+    }
+    
+    GLenum CHeadlessDevice::PopError()
+    {
+        GLenum error = m_eError;
+        m_eError = GL_NO_ERROR;
+        return error;
+    }
+    
+    uint32 CHeadlessDevice::GetCallCount(const string& function) const
+    {
+        uint32 count = 0;
+        for(std::map<const char8*, uint32>::const_iterator it = m_mCalls.begin(); it != m_mCalls.end(); ++it)
+        {
+            if(function == it->first)
+                count += it->second;
+        }
+        return count;
+    }
+    
+    void CHeadlessDevice::PrintReport() const
+    {
+        uint32 frames = m_vHistory.size();
+        if(frames == 0)
+        {
+            std::cerr<<"CHeadlessDevice: [INFO] no frame\n";
+            return;
+        }
+        
+        //averages
+        float64 calls = 0, redundant = 0, draws = 0, indices = 0, triangles = 0, uploaded = 0, uniforms = 0, errors = 0, cpu = 0, cpuMax = 0;
+        for(uint32 i = 0; i < frames; ++i)
+        {
+            const SHeadlessFrameStats& f = m_vHistory[i];
+            calls += f.calls;
+            redundant += f.redundantCalls;
+            draws += f.draws;
+            indices += f.indices;
+            triangles += f.triangles;
+            uploaded += f.uploadedBytes;
+            uniforms += f.uniformBytes;
+            errors += f.errors;
+            cpu += f.cpuMs;
+            cpuMax = std::max(cpuMax, f.cpuMs);
+        }
+        
+        std::cerr<<"CHeadlessDevice: [INFO] "<<frames<<" frames, per frame average:\n";
+        std::cerr<<"    gl calls:        "<<calls / frames<<" ( "<<redundant / frames<<" redundant)\n";
+        std::cerr<<"    draws:           "<<draws / frames<<" ( "<<indices / frames<<" indices, "<<triangles / frames<<" triangles)\n";
+        std::cerr<<"    uploaded bytes:  "<<uploaded / frames<<" ( "<<uniforms / frames<<" uniform bytes)\n";
+        std::cerr<<"    gl errors:       "<<errors / frames<<"\n";
+        std::cerr<<"    cpu time:        "<<cpu / frames<<" ms ( max "<<cpuMax<<" ms)\n";
+        
+        //most called entry points, loading included
+        std::vector< std::pair<const char8*, uint32> > sorted(m_mCalls.begin(), m_mCalls.end());
+        std::sort(sorted.begin(), sorted.end(), SortByCalls);
+        std::cerr<<"    most called entry points:\n";
+        for(uint32 i = 0; i < sorted.size() && i < VV_HEADLESS_REPORT_TOP_CALLS; ++i)
+            std::cerr<<"        "<<sorted[i].first<<": "<<sorted[i].second<<"\n";
+    }
+    
+    void CHeadlessDevice::OnDraw(GLenum mode, uint32 indices)
+    {
+        m_sFrame.draws++;
+        m_sFrame.indices += indices;
+        
+        if(mode == GL_TRIANGLES)
+            m_sFrame.triangles += indices / 3;
+        else if((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && indices > 2)
+            m_sFrame.triangles += indices - 2;
+    }
+    
+    bool CHeadlessDevice::SaveReport(const string& path) const
+    {
+        FILE* file = fopen(path.c_str(), "w");
+        if(!file)
+        {
+            std::cerr<<"CHeadlessDevice: [ERROR] cant write report "<<path<<"\n";
+            return false;
+        }
+        
+        fprintf(file, "frame,calls,redundant_calls,draws,indices,triangles,uploaded_bytes,uniform_bytes,errors,cpu_ms\n");
+        for(uint32 i = 0; i < m_vHistory.size(); ++i)
+        {
+            const SHeadlessFrameStats& f = m_vHistory[i];
+            fprintf(file, "%u,%u,%u,%u,%u,%u,%u,%u,%u,%.4f\n", f.frame, f.calls, f.redundantCalls, f.draws, f.indices, f.triangles, f.uploadedBytes, f.uniformBytes, f.errors, f.cpuMs);
+        }
+        
+        fclose(file);
+        return true;
+    }
+    
+    void CHeadlessDevice::Reset()
+    {
+        m_vHistory.clear();
+        m_mCalls.clear();
+        memset(&m_sFrame, 0, sizeof(SHeadlessFrameStats));
+        m_bInFrame = false;
+        m_eError = GL_NO_ERROR;
+    }
+}
+
+#endif
@@ -0,0 +1,147 @@
+/* HeadlessDevice.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef VVISION_HEADLESS_DEVICE_H
+#define VVISION_HEADLESS_DEVICE_H
+
+#include "types.h"
+#include "Singleton.h"
+#include "Timer.h"
+
+namespace vvision
+{
+    /** what the headless device saw during a frame*/
+    struct SHeadlessFrameStats
+    {
+        /** frame index*/
+        uint32 frame;
+        
+        /** gl calls*/
+        uint32 calls;
+        
+        /** gl calls that set a state to its current value ( binds, enables, blend/depth/cull state, viewport)*/
+        uint32 redundantCalls;
+        
+        /** draw calls, indices and triangles drawn*/
+        uint32 draws;
+        uint32 indices;
+        uint32 triangles;
+        
+        /** bytes uploaded to buffers and textures*/
+        uint32 uploadedBytes;
+        
+        /** bytes uploaded to uniforms*/
+        uint32 uniformBytes;
+        
+        /** calls that raised a gl error*/
+        uint32 errors;
+        
+        /** cpu time between BeginFrame and EndFrame in ms*/
+        float64 cpuMs;
+    };
+    
+    /** counters and validation report of the headless gl backend ( check Platform.h).
+     * every gl call of the engine is counted per entry point, calls that would raise a gl error on a device
+     * ( invalid enum, draw without linked program or element buffer, index range outside of the buffer, uniform type mismatch...)
+     * are reported. frames are delimited by BeginFrame/EndFrame, their stats are kept to be compared between runs ( check tools/vvbench.py).
+     */
+    CREATE_SINGLETON( CHeadlessDevice )
+    
+    public :
+    
+    /** size of the default framebuffer ( the viewport of a new context)*/
+    void SetDefaultFramebufferSize(int32 width, int32 height);
+    inline int32 GetDefaultFramebufferWidth() const {return m_iWidth;}
+    inline int32 GetDefaultFramebufferHeight() const {return m_iHeight;}
+    
+    /** print every gl error when it is raised ( enabled by default)*/
+    inline void SetLogErrors(bool log) {m_bLogErrors = log;}
+    
+    /** start a frame, the counters of the frame are reset and the cpu timer is started*/
+    void BeginFrame();
+    
+    /** end the frame, its stats are appended to the history*/
+    void EndFrame();
+    
+    /** stats of the current frame ( or of the calls made outside of a frame, loading for example)*/
+    inline const SHeadlessFrameStats& GetFrameStats() const {return m_sFrame;}
+    
+    /** stats of every ended frame*/
+    inline const std::vector<SHeadlessFrameStats>& GetHistory() const {return m_vHistory;}
+    
+    /** number of calls of a gl entry point since the device was created*/
+    uint32 GetCallCount(const string& function) const;
+    
+    /** print the average frame and the most called entry points*/
+    void PrintReport() const;
+    
+    /** write the history as csv ( one line per frame), check tools/vvbench.py
+     * @return true if success
+     */
+    bool SaveReport(const string& path) const;
+    
+    /** forget the history and the call counts*/
+    void Reset();
+    
+    /** hooks of the gl entry points*/
+    void OnCall(const char8* function);
+    inline void OnRedundantCall() {m_sFrame.redundantCalls++;}
+    void OnDraw(GLenum mode, uint32 indices);
+    inline void OnUpload(uint32 bytes) {m_sFrame.uploadedBytes += bytes;}
+    inline void OnUniformUpload(uint32 bytes) {m_sFrame.uniformBytes += bytes;}
+    void OnError(const char8* function, GLenum error, const char8* message);
+    
+    /** first error raised since the last call ( glGetError)*/
+    GLenum PopError();
+
+private:
+    
+    /** not allowed*/
+    CHeadlessDevice();
+    
+    /** not allowed*/
+    ~CHeadlessDevice() {}
+    
+    /** not allowed*/
+    CHeadlessDevice(const CHeadlessDevice&);
+    
+    /** not allowed*/
+    CHeadlessDevice& operator=(const CHeadlessDevice&);
+    
+    /** default framebuffer*/
+    int32 m_iWidth;
+    int32 m_iHeight;
+    
+    /** current frame*/
+    SHeadlessFrameStats m_sFrame;
+    CTimer m_cTimer;
+    bool m_bInFrame;
+    
+    /** ended frames*/
+    std::vector<SHeadlessFrameStats> m_vHistory;
+    
+    /** calls per entry point ( keyed by the function name literal)*/
+    std::map<const char8*, uint32> m_mCalls;
+    
+    /** pending gl error*/
+    GLenum m_eError;
+    bool m_bLogErrors;
+};
+}
+
+#endif
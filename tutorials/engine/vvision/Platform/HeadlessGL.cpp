@@ -0,0 +1,2177 @@
+/*
+ *  HeadlessGL.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "HeadlessDevice.h"
+
+#ifdef VVISION_PLATFORM_HEADLESS
+
+#include <ctype.h>
+#include <algorithm>
+#include <set>
+
+/** headless implementation of the gl es 2.0 entry points used by the engine.
+ * the context is emulated on the cpu: objects, bindings and fixed function state are tracked so queries answer like a device,
+ * shaders "compile" when they have a main function and their uniforms and attributes are reflected from the source.
+ * nothing is rasterized. every call is reported to CHeadlessDevice, invalid calls raise the gl error a device would raise.
+ */
+
+using namespace vvision;
+
+enum
+{
+    /** device limits*/
+    kHEADLESS_MAX_TEXTURE_UNITS = 8,
+    kHEADLESS_MAX_TEXTURE_SIZE = 4096,
+    kHEADLESS_MAX_VERTEX_ATTRIBS = 16,
+    kHEADLESS_MAX_RENDERBUFFER_SIZE = 4096
+};
+
+/** extensions of the ios devices used by the engine*/
+#define VV_HEADLESS_EXTENSIONS "GL_OES_vertex_array_object GL_OES_vertex_half_float GL_OES_element_index_uint GL_OES_depth24 GL_OES_rgb8_rgba8 GL_OES_packed_depth_stencil GL_OES_standard_derivatives GL_EXT_texture_filter_anisotropic GL_APPLE_texture_format_BGRA8888 GL_EXT_disjoint_timer_query GL_EXT_instanced_arrays GL_OES_mapbuffer GL_EXT_map_buffer_range GL_APPLE_sync"
+
+/** max anisotropy of the headless device*/
+#define VV_HEADLESS_MAX_ANISOTROPY 16.0f
+
+/** report the call, errors and redundant state changes to the device*/
+#define VV_GL_CALL() CHeadlessDevice::Instance().OnCall(__FUNCTION__)
+#define VV_GL_ERROR(error, message) CHeadlessDevice::Instance().OnError(__FUNCTION__, error, message)
+#define VV_GL_REDUNDANT() CHeadlessDevice::Instance().OnRedundantCall()
+
+struct SBufferObject
+{
+    uint32 size;
+
+    /** host memory of the mapped range, uploaded by glUnmapBufferOES*/
+    bool mapped;
+    std::vector<uchar8> mapping;
+};
+
+struct SVertexArrayObject
+{
+    /** element buffer binding is vertex array state*/
+    GLuint elementBuffer;
+
+    /** enabled attributes, a bit per attribute*/
+    uint32 enabledAttribs;
+};
+
+struct STextureObject
+{
+    /** 0 until first bind*/
+    GLenum target;
+
+    /** level 0*/
+    int32 width;
+    int32 height;
+    bool defined;
+};
+
+struct SShaderObject
+{
+    GLenum type;
+    string source;
+    bool compiled;
+    bool deleted;
+    string log;
+};
+
+struct SUniformInfo
+{
+    string name;
+    GLenum type;
+    GLint size;
+    GLint location;
+};
+
+struct SAttribInfo
+{
+    string name;
+    GLenum type;
+    GLint location;
+};
+
+struct SProgramObject
+{
+    std::vector<GLuint> shaders;
+    std::map<string, GLuint> boundAttribs;
+    std::vector<SUniformInfo> uniforms;
+    std::vector<SAttribInfo> attributes;
+    bool linked;
+    bool validated;
+    bool deleted;
+    string log;
+};
+
+struct SFramebufferObject
+{
+    /** attachments ( texture or renderbuffer names)*/
+    GLuint color;
+    GLuint depth;
+    bool colorIsTexture;
+    bool depthIsTexture;
+};
+
+struct SQueryObject
+{
+    /** the query was ended at least once, its result is available*/
+    bool ended;
+};
+
+struct SRenderbufferObject
+{
+    GLenum format;
+    int32 width;
+    int32 height;
+};
+
+/** the emulated context*/
+struct SHeadlessContext
+{
+    /** names are never recycled, a stale name is always detected*/
+    GLuint nextName;
+
+    std::map<GLuint, SBufferObject> buffers;
+    std::map<GLuint, SVertexArrayObject> vertexArrays;
+    std::map<GLuint, STextureObject> textures;
+    std::map<GLuint, SShaderObject> shaders;
+    std::map<GLuint, SProgramObject> programs;
+    std::map<GLuint, SFramebufferObject> framebuffers;
+    std::map<GLuint, SRenderbufferObject> renderbuffers;
+    std::map<GLuint, SQueryObject> queries;
+    std::set<GLuint> syncs;
+
+    /** bindings*/
+    GLuint arrayBuffer;
+    GLuint vertexArray;
+    GLuint program;
+    GLuint framebuffer;
+    GLuint renderbuffer;
+    GLuint activeQuery;
+    uint32 activeUnit;
+    GLuint boundTextures[kHEADLESS_MAX_TEXTURE_UNITS][2];
+
+    /** fixed function state*/
+    std::map<GLenum, bool> caps;
+    GLenum blendSrc;
+    GLenum blendDst;
+    GLboolean depthMask;
+    GLenum depthFunc;
+    GLenum cullFace;
+    GLint viewport[4];
+    bool viewportSet;
+    GLfloat clearColor[4];
+
+    SHeadlessContext()
+    : nextName(1), arrayBuffer(0), vertexArray(0), program(0), framebuffer(0), renderbuffer(0), activeQuery(0), activeUnit(0),
+    blendSrc(GL_ONE), blendDst(GL_ZERO), depthMask(GL_TRUE), depthFunc(GL_LESS), cullFace(GL_BACK), viewportSet(false)
+    {
+        memset(boundTextures, 0, sizeof(boundTextures));
+        memset(viewport, 0, sizeof(viewport));
+        memset(clearColor, 0, sizeof(clearColor));
+
+        //the default vertex array
+        SVertexArrayObject vao = {0, 0};
+        vertexArrays[0] = vao;
+
+        //every cap is disabled but dither
+        caps[GL_BLEND] = false;
+        caps[GL_CULL_FACE] = false;
+        caps[GL_DEPTH_TEST] = false;
+        caps[GL_DITHER] = true;
+        caps[GL_POLYGON_OFFSET_FILL] = false;
+        caps[GL_SAMPLE_ALPHA_TO_COVERAGE] = false;
+        caps[GL_SAMPLE_COVERAGE] = false;
+        caps[GL_SCISSOR_TEST] = false;
+        caps[GL_STENCIL_TEST] = false;
+    }
+};
+
+static SHeadlessContext s_context;
+
+/** the viewport of a new context is the size of the default framebuffer*/
+static GLint* GetViewport()
+{
+    if(!s_context.viewportSet)
+    {
+        s_context.viewport[2] = CHeadlessDevice::Instance().GetDefaultFramebufferWidth();
+        s_context.viewport[3] = CHeadlessDevice::Instance().GetDefaultFramebufferHeight();
+        s_context.viewportSet = true;
+    }
+    return s_context.viewport;
+}
+
+/** slot of a texture target in boundTextures, -1 for an invalid target*/
+static int32 TextureTargetSlot(GLenum target)
+{
+    if(target == GL_TEXTURE_2D)
+        return 0;
+    if(target == GL_TEXTURE_CUBE_MAP)
+        return 1;
+    return -1;
+}
+
+/** texture bound to the target of a glTexImage2D ( cube faces use the cube map binding), -1 for an invalid target*/
+static int32 TextureImageSlot(GLenum target)
+{
+    if(target == GL_TEXTURE_2D)
+        return 0;
+    if(target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
+        return 1;
+    return -1;
+}
+
+/** bytes per pixel of a client format/type, 0 if the combination is invalid*/
+static uint32 BytesPerPixel(GLenum format, GLenum type)
+{
+    if(type == GL_UNSIGNED_SHORT_5_6_5 || type == GL_UNSIGNED_SHORT_4_4_4_4 || type == GL_UNSIGNED_SHORT_5_5_5_1)
+        return 2;
+
+    if(format == GL_DEPTH_COMPONENT)
+        return type == GL_UNSIGNED_INT ? 4 : 2;
+
+    if(type != GL_UNSIGNED_BYTE)
+        return 0;
+
+    switch (format)
+    {
+        case GL_RGBA:
+        case GL_BGRA:
+            return 4;
+        case GL_RGB:
+            return 3;
+        case GL_LUMINANCE_ALPHA:
+            return 2;
+        case GL_LUMINANCE:
+        case GL_ALPHA:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/** size of an index type, 0 if invalid*/
+static uint32 IndexSize(GLenum type)
+{
+    switch (type)
+    {
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_UNSIGNED_SHORT:
+            return 2;
+        case GL_UNSIGNED_INT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------
+// shader reflection
+//-------------------------------------------------------------------------------------------------------------
+
+/** glsl type name to gl type, 0 if unknown*/
+static GLenum GlslType(const string& name)
+{
+    static const struct {const char8* name; GLenum type;} types[] =
+    {
+        {"float", GL_FLOAT}, {"vec2", GL_FLOAT_VEC2}, {"vec3", GL_FLOAT_VEC3}, {"vec4", GL_FLOAT_VEC4},
+        {"int", GL_INT}, {"ivec2", GL_INT_VEC2}, {"ivec3", GL_INT_VEC3}, {"ivec4", GL_INT_VEC4},
+        {"bool", GL_BOOL}, {"bvec2", GL_BOOL_VEC2}, {"bvec3", GL_BOOL_VEC3}, {"bvec4", GL_BOOL_VEC4},
+        {"mat2", GL_FLOAT_MAT2}, {"mat3", GL_FLOAT_MAT3}, {"mat4", GL_FLOAT_MAT4},
+        {"sampler2D", GL_SAMPLER_2D}, {"samplerCube", GL_SAMPLER_CUBE}
+    };
+
+    for(uint32 i = 0; i < sizeof(types) / sizeof(types[0]); ++i)
+    {
+        if(name == types[i].name)
+            return types[i].type;
+    }
+    return 0;
+}
+
+/** split a glsl source in tokens ( comments removed), defines are collected and preprocessor lines are skipped*/
+static void Tokenize(const string& source, std::vector<string>& tokens, std::map<string, string>& defines)
+{
+    uint32 i = 0;
+    uint32 length = source.size();
+    bool lineStart = true;
+
+    while(i < length)
+    {
+        char8 c = source[i];
+
+        //comments
+        if(c == '/' && i + 1 < length && source[i + 1] == '/')
+        {
+            while(i < length && source[i] != '\n')
+                i++;
+            continue;
+        }
+        if(c == '/' && i + 1 < length && source[i + 1] == '*')
+        {
+            i += 2;
+            while(i + 1 < length && !(source[i] == '*' && source[i + 1] == '/'))
+                i++;
+            i += 2;
+            continue;
+        }
+
+        if(c == '\n')
+        {
+            lineStart = true;
+            i++;
+            continue;
+        }
+
+        if(isspace(c))
+        {
+            i++;
+            continue;
+        }
+
+        //preprocessor line, only #define NAME VALUE is kept ( conditionals are ignored, every branch is reflected)
+        if(c == '#' && lineStart)
+        {
+            uint32 end = source.find('\n', i);
+            if(end == string::npos)
+                end = length;
+
+            std::istringstream line(source.substr(i + 1, end - i - 1));
+            string directive, name, value;
+            line>>directive>>name>>value;
+            if(directive == "define" && !name.empty())
+                defines[name] = value;
+
+            i = end;
+            continue;
+        }
+
+        lineStart = false;
+
+        if(isalnum(c) || c == '_')
+        {
+            uint32 start = i;
+            while(i < length && (isalnum(source[i]) || source[i] == '_'))
+                i++;
+            tokens.push_back(source.substr(start, i - start));
+            continue;
+        }
+
+        tokens.push_back(string(1, c));
+        i++;
+    }
+}
+
+/** value of an array size ( a number or a define), 0 if it cant be resolved*/
+static GLint ResolveArraySize(string token, const std::map<string, string>& defines)
+{
+    for(uint32 depth = 0; depth < 8; ++depth)
+    {
+        if(!token.empty() && isdigit(token[0]))
+            return atoi(token.c_str());
+
+        std::map<string, string>::const_iterator it = defines.find(token);
+        if(it == defines.end())
+            return 0;
+        token = it->second;
+    }
+    return 0;
+}
+
+/** collect the uniform and attribute declarations of a shader source*/
+static void ReflectSource(const string& source, SProgramObject& program)
+{
+    std::vector<string> tokens;
+    std::map<string, string> defines;
+    Tokenize(source, tokens, defines);
+
+    for(uint32 t = 0; t < tokens.size(); ++t)
+    {
+        bool isUniform = tokens[t] == "uniform";
+        if(!isUniform && tokens[t] != "attribute")
+            continue;
+
+        uint32 i = t + 1;
+
+        //precision qualifier
+        if(i < tokens.size() && (tokens[i] == "lowp" || tokens[i] == "mediump" || tokens[i] == "highp"))
+            i++;
+
+        if(i >= tokens.size())
+            break;
+
+        GLenum type = GlslType(tokens[i++]);
+        if(type == 0)
+            continue;
+
+        //declarators: name[size], name...;
+        while(i < tokens.size() && tokens[i] != ";")
+        {
+            string name = tokens[i++];
+            GLint size = 1;
+
+            if(i + 2 < tokens.size() && tokens[i] == "[")
+            {
+                size = ResolveArraySize(tokens[i + 1], defines);
+                if(size <= 0)
+                    size = 1;
+                while(i < tokens.size() && tokens[i] != "]")
+                    i++;
+                i++;
+            }
+
+            if(isUniform)
+            {
+                //uniforms shared by both stages are reflected once
+                bool found = false;
+                for(uint32 u = 0; u < program.uniforms.size(); ++u)
+                    found = found || program.uniforms[u].name == name;
+
+                if(!found)
+                {
+                    SUniformInfo uniform;
+                    uniform.name = name;
+                    uniform.type = type;
+                    uniform.size = size;
+                    uniform.location = -1;
+                    program.uniforms.push_back(uniform);
+                }
+            }
+            else
+            {
+                SAttribInfo attribute;
+                attribute.name = name;
+                attribute.type = type;
+                attribute.location = -1;
+                program.attributes.push_back(attribute);
+            }
+
+            if(i < tokens.size() && tokens[i] == ",")
+                i++;
+        }
+
+        t = i;
+    }
+}
+
+/** reflect the attached shaders and assign locations*/
+static void ReflectProgram(SProgramObject& program)
+{
+    program.uniforms.clear();
+    program.attributes.clear();
+
+    for(uint32 s = 0; s < program.shaders.size(); ++s)
+        ReflectSource(s_context.shaders[program.shaders[s]].source, program);
+
+    //uniform arrays use consecutive locations
+    GLint location = 0;
+    for(uint32 u = 0; u < program.uniforms.size(); ++u)
+    {
+        program.uniforms[u].location = location;
+        location += program.uniforms[u].size;
+    }
+
+    //attributes bound with glBindAttribLocation first, the others take the free slots
+    uint32 used = 0;
+    for(uint32 a = 0; a < program.attributes.size(); ++a)
+    {
+        std::map<string, GLuint>::const_iterator it = program.boundAttribs.find(program.attributes[a].name);
+        if(it != program.boundAttribs.end())
+        {
+            program.attributes[a].location = it->second;
+            used |= 1u << it->second;
+        }
+    }
+    for(uint32 a = 0; a < program.attributes.size(); ++a)
+    {
+        if(program.attributes[a].location != -1)
+            continue;
+
+        for(uint32 slot = 0; slot < kHEADLESS_MAX_VERTEX_ATTRIBS; ++slot)
+        {
+            if(!(used & (1u << slot)))
+            {
+                program.attributes[a].location = slot;
+                used |= 1u << slot;
+                break;
+            }
+        }
+    }
+}
+
+/** program in use, NULL if none*/
+static SProgramObject* CurrentProgram()
+{
+    if(s_context.program == 0)
+        return NULL;
+
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(s_context.program);
+    return it == s_context.programs.end() ? NULL : &it->second;
+}
+
+/** the kind of value set by a glUniform* entry point*/
+enum UNIFORM_SETTER
+{
+    kUNIFORM_SETTER_FLOAT,
+    kUNIFORM_SETTER_INT,
+    kUNIFORM_SETTER_MATRIX
+};
+
+/** check a glUniform* call against the program in use and account the uploaded bytes*/
+static void SetUniform(const char8* function, GLint location, GLsizei count, uint32 components, UNIFORM_SETTER setter)
+{
+    CHeadlessDevice& device = CHeadlessDevice::Instance();
+
+    SProgramObject* program = CurrentProgram();
+    if(program == NULL || !program->linked)
+    {
+        device.OnError(function, GL_INVALID_OPERATION, "no linked program in use");
+        return;
+    }
+
+    //silently ignored, like gl
+    if(location == -1)
+        return;
+
+    if(count < 0)
+    {
+        device.OnError(function, GL_INVALID_VALUE, "negative count");
+        return;
+    }
+
+    for(uint32 u = 0; u < program->uniforms.size(); ++u)
+    {
+        const SUniformInfo& uniform = program->uniforms[u];
+        if(location < uniform.location || location >= uniform.location + uniform.size)
+            continue;
+
+        if(count > 1 && uniform.size == 1)
+        {
+            device.OnError(function, GL_INVALID_OPERATION, ("count above 1 for uniform " + uniform.name).c_str());
+            return;
+        }
+
+        //type check
+        bool valid;
+        switch (uniform.type)
+        {
+            case GL_FLOAT: valid = setter == kUNIFORM_SETTER_FLOAT && components == 1; break;
+            case GL_FLOAT_VEC2: valid = setter == kUNIFORM_SETTER_FLOAT && components == 2; break;
+            case GL_FLOAT_VEC3: valid = setter == kUNIFORM_SETTER_FLOAT && components == 3; break;
+            case GL_FLOAT_VEC4: valid = setter == kUNIFORM_SETTER_FLOAT && components == 4; break;
+            case GL_INT: valid = setter == kUNIFORM_SETTER_INT && components == 1; break;
+            case GL_INT_VEC2: valid = setter == kUNIFORM_SETTER_INT && components == 2; break;
+            case GL_INT_VEC3: valid = setter == kUNIFORM_SETTER_INT && components == 3; break;
+            case GL_INT_VEC4: valid = setter == kUNIFORM_SETTER_INT && components == 4; break;
+            case GL_BOOL: valid = setter != kUNIFORM_SETTER_MATRIX && components == 1; break;
+            case GL_BOOL_VEC2: valid = setter != kUNIFORM_SETTER_MATRIX && components == 2; break;
+            case GL_BOOL_VEC3: valid = setter != kUNIFORM_SETTER_MATRIX && components == 3; break;
+            case GL_BOOL_VEC4: valid = setter != kUNIFORM_SETTER_MATRIX && components == 4; break;
+            case GL_FLOAT_MAT2: valid = setter == kUNIFORM_SETTER_MATRIX && components == 4; break;
+            case GL_FLOAT_MAT3: valid = setter == kUNIFORM_SETTER_MATRIX && components == 9; break;
+            case GL_FLOAT_MAT4: valid = setter == kUNIFORM_SETTER_MATRIX && components == 16; break;
+            case GL_SAMPLER_2D:
+            case GL_SAMPLER_CUBE: valid = setter == kUNIFORM_SETTER_INT && components == 1; break;
+            default: valid = false; break;
+        }
+
+        if(!valid)
+        {
+            device.OnError(function, GL_INVALID_OPERATION, ("type mismatch for uniform " + uniform.name).c_str());
+            return;
+        }
+
+        device.OnUniformUpload(count * components * 4);
+        return;
+    }
+
+    device.OnError(function, GL_INVALID_OPERATION, "location does not belong to the program in use");
+}
+
+/** framebuffer status of the bound framebuffer*/
+static GLenum FramebufferStatus()
+{
+    if(s_context.framebuffer == 0)
+        return GL_FRAMEBUFFER_COMPLETE;
+
+    const SFramebufferObject& fbo = s_context.framebuffers[s_context.framebuffer];
+    if(fbo.color == 0 && fbo.depth == 0)
+        return GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT;
+
+    //every attachment has the same size
+    int32 width = -1, height = -1;
+    GLuint attachments[2] = {fbo.color, fbo.depth};
+    bool isTexture[2] = {fbo.colorIsTexture, fbo.depthIsTexture};
+    for(uint32 a = 0; a < 2; ++a)
+    {
+        if(attachments[a] == 0)
+            continue;
+
+        int32 w, h;
+        if(isTexture[a])
+        {
+            const STextureObject& texture = s_context.textures[attachments[a]];
+            if(!texture.defined)
+                return GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT;
+            w = texture.width;
+            h = texture.height;
+        }
+        else
+        {
+            const SRenderbufferObject& renderbuffer = s_context.renderbuffers[attachments[a]];
+            if(renderbuffer.width == 0)
+                return GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT;
+            w = renderbuffer.width;
+            h = renderbuffer.height;
+        }
+
+        if(width != -1 && (w != width || h != height))
+            return GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS;
+        width = w;
+        height = h;
+    }
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+extern "C" {
+
+//-------------------------------------------------------------------------------------------------------------
+// errors and queries
+//-------------------------------------------------------------------------------------------------------------
+
+GLenum glGetError(void)
+{
+    VV_GL_CALL();
+    return CHeadlessDevice::Instance().PopError();
+}
+
+const GLubyte* glGetString(GLenum name)
+{
+    VV_GL_CALL();
+    switch (name)
+    {
+        case GL_VENDOR: return (const GLubyte*)"Virtual Vision";
+        case GL_RENDERER: return (const GLubyte*)"Virtual Vision Headless";
+        case GL_VERSION: return (const GLubyte*)"OpenGL ES 2.0 Headless";
+        case GL_SHADING_LANGUAGE_VERSION: return (const GLubyte*)"OpenGL ES GLSL ES 1.00";
+        case GL_EXTENSIONS: return (const GLubyte*)VV_HEADLESS_EXTENSIONS;
+        default:
+            VV_GL_ERROR(GL_INVALID_ENUM, "invalid name");
+            return NULL;
+    }
+}
+
+void glGetIntegerv(GLenum pname, GLint* params)
+{
+    VV_GL_CALL();
+    switch (pname)
+    {
+        case GL_MAX_TEXTURE_IMAGE_UNITS:
+        case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:
+            *params = kHEADLESS_MAX_TEXTURE_UNITS; break;
+        case GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS: *params = 0; break;
+        case GL_MAX_TEXTURE_SIZE:
+        case GL_MAX_CUBE_MAP_TEXTURE_SIZE:
+            *params = kHEADLESS_MAX_TEXTURE_SIZE; break;
+        case GL_MAX_RENDERBUFFER_SIZE: *params = kHEADLESS_MAX_RENDERBUFFER_SIZE; break;
+        case GL_MAX_VERTEX_ATTRIBS: *params = kHEADLESS_MAX_VERTEX_ATTRIBS; break;
+        case GL_MAX_VERTEX_UNIFORM_VECTORS: *params = 128; break;
+        case GL_MAX_FRAGMENT_UNIFORM_VECTORS: *params = 64; break;
+        case GL_MAX_VARYING_VECTORS: *params = 8; break;
+        case GL_NUM_PROGRAM_BINARY_FORMATS_OES: *params = 0; break;
+        case GL_NUM_COMPRESSED_TEXTURE_FORMATS: *params = 0; break;
+        case GL_FRAMEBUFFER_BINDING: *params = s_context.framebuffer; break;
+        case GL_RENDERBUFFER_BINDING: *params = s_context.renderbuffer; break;
+        case GL_CURRENT_PROGRAM: *params = s_context.program; break;
+        case GL_VERTEX_ARRAY_BINDING_OES: *params = s_context.vertexArray; break;
+        case GL_ARRAY_BUFFER_BINDING: *params = s_context.arrayBuffer; break;
+        case GL_ELEMENT_ARRAY_BUFFER_BINDING: *params = s_context.vertexArrays[s_context.vertexArray].elementBuffer; break;
+        case GL_ACTIVE_TEXTURE: *params = GL_TEXTURE0 + s_context.activeUnit; break;
+        case GL_TEXTURE_BINDING_2D: *params = s_context.boundTextures[s_context.activeUnit][0]; break;
+        case GL_TEXTURE_BINDING_CUBE_MAP: *params = s_context.boundTextures[s_context.activeUnit][1]; break;
+        case GL_VIEWPORT: memcpy(params, GetViewport(), 4 * sizeof(GLint)); break;
+        case GL_BLEND_SRC_RGB:
+        case GL_BLEND_SRC_ALPHA:
+            *params = s_context.blendSrc; break;
+        case GL_BLEND_DST_RGB:
+        case GL_BLEND_DST_ALPHA:
+            *params = s_context.blendDst; break;
+        case GL_DEPTH_WRITEMASK: *params = s_context.depthMask; break;
+        case GL_DEPTH_FUNC: *params = s_context.depthFunc; break;
+        case GL_CULL_FACE_MODE: *params = s_context.cullFace; break;
+        case GL_GPU_DISJOINT_EXT: *params = GL_FALSE; break;
+        default:
+            VV_GL_ERROR(GL_INVALID_ENUM, "pname not supported by the headless device");
+            break;
+    }
+}
+
+void glGetFloatv(GLenum pname, GLfloat* params)
+{
+    VV_GL_CALL();
+    switch (pname)
+    {
+        case GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT: *params = VV_HEADLESS_MAX_ANISOTROPY; break;
+        case GL_COLOR_CLEAR_VALUE: memcpy(params, s_context.clearColor, 4 * sizeof(GLfloat)); break;
+        default:
+            VV_GL_ERROR(GL_INVALID_ENUM, "pname not supported by the headless device");
+            break;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------
+// fixed function state
+//-------------------------------------------------------------------------------------------------------------
+
+void glEnable(GLenum cap)
+{
+    VV_GL_CALL();
+    std::map<GLenum, bool>::iterator it = s_context.caps.find(cap);
+    if(it == s_context.caps.end())
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid capability");
+        return;
+    }
+    if(it->second)
+        VV_GL_REDUNDANT();
+    it->second = true;
+}
+
+void glDisable(GLenum cap)
+{
+    VV_GL_CALL();
+    std::map<GLenum, bool>::iterator it = s_context.caps.find(cap);
+    if(it == s_context.caps.end())
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid capability");
+        return;
+    }
+    if(!it->second)
+        VV_GL_REDUNDANT();
+    it->second = false;
+}
+
+GLboolean glIsEnabled(GLenum cap)
+{
+    VV_GL_CALL();
+    std::map<GLenum, bool>::iterator it = s_context.caps.find(cap);
+    if(it == s_context.caps.end())
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid capability");
+        return GL_FALSE;
+    }
+    return it->second ? GL_TRUE : GL_FALSE;
+}
+
+void glBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    VV_GL_CALL();
+    if(sfactor == s_context.blendSrc && dfactor == s_context.blendDst)
+        VV_GL_REDUNDANT();
+    s_context.blendSrc = sfactor;
+    s_context.blendDst = dfactor;
+}
+
+void glDepthMask(GLboolean flag)
+{
+    VV_GL_CALL();
+    if(flag == s_context.depthMask)
+        VV_GL_REDUNDANT();
+    s_context.depthMask = flag;
+}
+
+void glDepthFunc(GLenum func)
+{
+    VV_GL_CALL();
+    if(func < GL_NEVER || func > GL_ALWAYS)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid depth function");
+        return;
+    }
+    if(func == s_context.depthFunc)
+        VV_GL_REDUNDANT();
+    s_context.depthFunc = func;
+}
+
+void glCullFace(GLenum mode)
+{
+    VV_GL_CALL();
+    if(mode != GL_FRONT && mode != GL_BACK && mode != GL_FRONT_AND_BACK)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid cull face mode");
+        return;
+    }
+    if(mode == s_context.cullFace)
+        VV_GL_REDUNDANT();
+    s_context.cullFace = mode;
+}
+
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    VV_GL_CALL();
+    if(width < 0 || height < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "negative viewport size");
+        return;
+    }
+
+    GLint* viewport = GetViewport();
+    if(viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height)
+        VV_GL_REDUNDANT();
+    viewport[0] = x;
+    viewport[1] = y;
+    viewport[2] = width;
+    viewport[3] = height;
+}
+
+void glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{
+    VV_GL_CALL();
+    s_context.clearColor[0] = red;
+    s_context.clearColor[1] = green;
+    s_context.clearColor[2] = blue;
+    s_context.clearColor[3] = alpha;
+}
+
+void glClear(GLbitfield mask)
+{
+    VV_GL_CALL();
+    if(mask & ~(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT))
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "invalid clear mask");
+        return;
+    }
+    if(FramebufferStatus() != GL_FRAMEBUFFER_COMPLETE)
+        VV_GL_ERROR(GL_INVALID_FRAMEBUFFER_OPERATION, "clear of an incomplete framebuffer");
+}
+
+//-------------------------------------------------------------------------------------------------------------
+// buffers and vertex arrays
+//-------------------------------------------------------------------------------------------------------------
+
+void glGenBuffers(GLsizei n, GLuint* buffers)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        buffers[i] = s_context.nextName++;
+        SBufferObject buffer = SBufferObject();
+        s_context.buffers[buffers[i]] = buffer;
+    }
+}
+
+void glDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        if(buffers[i] == 0)
+            continue;
+
+        s_context.buffers.erase(buffers[i]);
+        if(s_context.arrayBuffer == buffers[i])
+            s_context.arrayBuffer = 0;
+
+        //only the current vertex array loses its element buffer
+        SVertexArrayObject& vao = s_context.vertexArrays[s_context.vertexArray];
+        if(vao.elementBuffer == buffers[i])
+            vao.elementBuffer = 0;
+    }
+}
+
+GLboolean glIsBuffer(GLuint buffer)
+{
+    VV_GL_CALL();
+    return s_context.buffers.count(buffer) ? GL_TRUE : GL_FALSE;
+}
+
+void glBindBuffer(GLenum target, GLuint buffer)
+{
+    VV_GL_CALL();
+
+    GLuint* binding;
+    if(target == GL_ARRAY_BUFFER)
+        binding = &s_context.arrayBuffer;
+    else if(target == GL_ELEMENT_ARRAY_BUFFER)
+        binding = &s_context.vertexArrays[s_context.vertexArray].elementBuffer;
+    else
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid buffer target");
+        return;
+    }
+
+    if(*binding == buffer)
+        VV_GL_REDUNDANT();
+
+    //binding an unused name creates the buffer
+    if(buffer != 0 && !s_context.buffers.count(buffer))
+    {
+        SBufferObject object = SBufferObject();
+        s_context.buffers[buffer] = object;
+    }
+    *binding = buffer;
+}
+
+/** buffer bound to target, NULL ( and error raised by the caller) if none*/
+static SBufferObject* BoundBuffer(GLenum target)
+{
+    GLuint name;
+    if(target == GL_ARRAY_BUFFER)
+        name = s_context.arrayBuffer;
+    else if(target == GL_ELEMENT_ARRAY_BUFFER)
+        name = s_context.vertexArrays[s_context.vertexArray].elementBuffer;
+    else
+        return NULL;
+
+    if(name == 0)
+        return NULL;
+    return &s_context.buffers[name];
+}
+
+void glBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+    VV_GL_CALL();
+    if(usage != GL_STATIC_DRAW && usage != GL_DYNAMIC_DRAW && usage != GL_STREAM_DRAW)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid usage");
+        return;
+    }
+    if(size < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "negative size");
+        return;
+    }
+
+    SBufferObject* buffer = BoundBuffer(target);
+    if(buffer == NULL)
+    {
+        VV_GL_ERROR(target == GL_ARRAY_BUFFER || target == GL_ELEMENT_ARRAY_BUFFER ? GL_INVALID_OPERATION : GL_INVALID_ENUM, "no buffer bound to target");
+        return;
+    }
+
+    //a new storage is not mapped
+    buffer->size = size;
+    buffer->mapped = false;
+    if(data != NULL)
+        CHeadlessDevice::Instance().OnUpload(size);
+}
+
+void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* /*data*/)
+{
+    VV_GL_CALL();
+    SBufferObject* buffer = BoundBuffer(target);
+    if(buffer == NULL)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "no buffer bound to target");
+        return;
+    }
+    if(offset < 0 || size < 0 || (uint32)(offset + size) > buffer->size)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "range outside of the buffer");
+        return;
+    }
+    if(buffer->mapped)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "buffer is mapped");
+        return;
+    }
+    CHeadlessDevice::Instance().OnUpload(size);
+}
+
+void* glMapBufferRangeEXT(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    VV_GL_CALL();
+    SBufferObject* buffer = BoundBuffer(target);
+    if(buffer == NULL)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "no buffer bound to target");
+        return NULL;
+    }
+    if(offset < 0 || length <= 0 || (uint32)(offset + length) > buffer->size)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "range outside of the buffer");
+        return NULL;
+    }
+    if(!(access & (GL_MAP_READ_BIT_EXT | GL_MAP_WRITE_BIT_EXT)) || ((access & GL_MAP_READ_BIT_EXT) && (access & (GL_MAP_INVALIDATE_RANGE_BIT_EXT | GL_MAP_INVALIDATE_BUFFER_BIT_EXT | GL_MAP_UNSYNCHRONIZED_BIT_EXT))))
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "invalid access");
+        return NULL;
+    }
+    if(buffer->mapped)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "buffer is already mapped");
+        return NULL;
+    }
+
+    buffer->mapped = true;
+    buffer->mapping.resize(length);
+    return &buffer->mapping[0];
+}
+
+GLboolean glUnmapBufferOES(GLenum target)
+{
+    VV_GL_CALL();
+    SBufferObject* buffer = BoundBuffer(target);
+    if(buffer == NULL || !buffer->mapped)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "buffer is not mapped");
+        return GL_FALSE;
+    }
+
+    //the mapped range reaches the buffer
+    buffer->mapped = false;
+    CHeadlessDevice::Instance().OnUpload(buffer->mapping.size());
+    return GL_TRUE;
+}
+
+void glGenVertexArraysOES(GLsizei n, GLuint* arrays)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        arrays[i] = s_context.nextName++;
+        SVertexArrayObject vao = {0, 0};
+        s_context.vertexArrays[arrays[i]] = vao;
+    }
+}
+
+void glDeleteVertexArraysOES(GLsizei n, const GLuint* arrays)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        if(arrays[i] == 0)
+            continue;
+        s_context.vertexArrays.erase(arrays[i]);
+        if(s_context.vertexArray == arrays[i])
+            s_context.vertexArray = 0;
+    }
+}
+
+GLboolean glIsVertexArrayOES(GLuint array)
+{
+    VV_GL_CALL();
+    return array != 0 && s_context.vertexArrays.count(array) ? GL_TRUE : GL_FALSE;
+}
+
+void glBindVertexArrayOES(GLuint array)
+{
+    VV_GL_CALL();
+    if(!s_context.vertexArrays.count(array))
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "unknown vertex array");
+        return;
+    }
+    if(s_context.vertexArray == array)
+        VV_GL_REDUNDANT();
+    s_context.vertexArray = array;
+}
+
+void glEnableVertexAttribArray(GLuint index)
+{
+    VV_GL_CALL();
+    if(index >= kHEADLESS_MAX_VERTEX_ATTRIBS)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "attribute index above GL_MAX_VERTEX_ATTRIBS");
+        return;
+    }
+    s_context.vertexArrays[s_context.vertexArray].enabledAttribs |= 1u << index;
+}
+
+void glDisableVertexAttribArray(GLuint index)
+{
+    VV_GL_CALL();
+    if(index >= kHEADLESS_MAX_VERTEX_ATTRIBS)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "attribute index above GL_MAX_VERTEX_ATTRIBS");
+        return;
+    }
+    s_context.vertexArrays[s_context.vertexArray].enabledAttribs &= ~(1u << index);
+}
+
+void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* ptr)
+{
+    VV_GL_CALL();
+    if(index >= kHEADLESS_MAX_VERTEX_ATTRIBS)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "attribute index above GL_MAX_VERTEX_ATTRIBS");
+        return;
+    }
+    if(size < 1 || size > 4 || stride < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "invalid size or stride");
+        return;
+    }
+    if(type != GL_BYTE && type != GL_UNSIGNED_BYTE && type != GL_SHORT && type != GL_UNSIGNED_SHORT && type != GL_FIXED && type != GL_FLOAT && type != GL_HALF_FLOAT_OES)
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid attribute type");
+}
+
+void glVertexAttribDivisorEXT(GLuint index, GLuint divisor)
+{
+    VV_GL_CALL();
+    if(index >= kHEADLESS_MAX_VERTEX_ATTRIBS)
+        VV_GL_ERROR(GL_INVALID_VALUE, "attribute index above GL_MAX_VERTEX_ATTRIBS");
+}
+
+//-------------------------------------------------------------------------------------------------------------
+// draw
+//-------------------------------------------------------------------------------------------------------------
+
+/** validate an indexed draw against the bound program, framebuffer and element buffer*/
+static bool CheckDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{
+    if(mode > GL_TRIANGLE_FAN)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid primitive mode");
+        return false;
+    }
+
+    uint32 indexSize = IndexSize(type);
+    if(indexSize == 0)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid index type");
+        return false;
+    }
+    if(count < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "negative count");
+        return false;
+    }
+
+    SProgramObject* program = CurrentProgram();
+    if(program == NULL || !program->linked)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "draw without a linked program");
+        return false;
+    }
+
+    if(FramebufferStatus() != GL_FRAMEBUFFER_COMPLETE)
+    {
+        VV_GL_ERROR(GL_INVALID_FRAMEBUFFER_OPERATION, "draw to an incomplete framebuffer");
+        return false;
+    }
+
+    //the engine always draws from element buffers, client side indices would be a bug
+    GLuint elementBuffer = s_context.vertexArrays[s_context.vertexArray].elementBuffer;
+    if(elementBuffer == 0)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "draw without element buffer");
+        return false;
+    }
+
+    size_t offset = (size_t)indices;
+    if(offset + (size_t)count * indexSize > s_context.buffers[elementBuffer].size)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "index range outside of the element buffer");
+        return false;
+    }
+    if(s_context.buffers[elementBuffer].mapped || (s_context.arrayBuffer != 0 && s_context.buffers[s_context.arrayBuffer].mapped))
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "draw from a mapped buffer");
+        return false;
+    }
+
+    return true;
+}
+
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{
+    VV_GL_CALL();
+    if(CheckDrawElements(mode, count, type, indices))
+        CHeadlessDevice::Instance().OnDraw(mode, count);
+}
+
+void glDrawElementsInstancedEXT(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei primcount)
+{
+    VV_GL_CALL();
+    if(primcount < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "negative instance count");
+        return;
+    }
+
+    //one draw, the triangles of every instance
+    if(CheckDrawElements(mode, count, type, indices))
+        CHeadlessDevice::Instance().OnDraw(mode, count * primcount);
+}
+
+//-------------------------------------------------------------------------------------------------------------
+// textures
+//-------------------------------------------------------------------------------------------------------------
+
+void glGenTextures(GLsizei n, GLuint* textures)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        textures[i] = s_context.nextName++;
+        STextureObject texture = {0, 0, 0, false};
+        s_context.textures[textures[i]] = texture;
+    }
+}
+
+void glDeleteTextures(GLsizei n, const GLuint* textures)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        if(textures[i] == 0)
+            continue;
+        s_context.textures.erase(textures[i]);
+
+        //deleted textures are unbound from every unit
+        for(uint32 unit = 0; unit < kHEADLESS_MAX_TEXTURE_UNITS; ++unit)
+        {
+            for(uint32 slot = 0; slot < 2; ++slot)
+            {
+                if(s_context.boundTextures[unit][slot] == textures[i])
+                    s_context.boundTextures[unit][slot] = 0;
+            }
+        }
+    }
+}
+
+GLboolean glIsTexture(GLuint texture)
+{
+    VV_GL_CALL();
+    std::map<GLuint, STextureObject>::const_iterator it = s_context.textures.find(texture);
+    return it != s_context.textures.end() && it->second.target != 0 ? GL_TRUE : GL_FALSE;
+}
+
+void glActiveTexture(GLenum texture)
+{
+    VV_GL_CALL();
+    if(texture < GL_TEXTURE0 || texture >= GL_TEXTURE0 + kHEADLESS_MAX_TEXTURE_UNITS)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "texture unit above GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS");
+        return;
+    }
+    if(s_context.activeUnit == texture - GL_TEXTURE0)
+        VV_GL_REDUNDANT();
+    s_context.activeUnit = texture - GL_TEXTURE0;
+}
+
+void glBindTexture(GLenum target, GLuint texture)
+{
+    VV_GL_CALL();
+    int32 slot = TextureTargetSlot(target);
+    if(slot < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid texture target");
+        return;
+    }
+
+    if(texture != 0)
+    {
+        //binding an unused name creates the texture, a texture keeps the target of its first bind
+        STextureObject& object = s_context.textures[texture];
+        if(object.target == 0)
+            object.target = target;
+        else if(object.target != target)
+        {
+            VV_GL_ERROR(GL_INVALID_OPERATION, "texture bound to a different target");
+            return;
+        }
+    }
+
+    GLuint& binding = s_context.boundTextures[s_context.activeUnit][slot];
+    if(binding == texture)
+        VV_GL_REDUNDANT();
+    binding = texture;
+}
+
+void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels)
+{
+    VV_GL_CALL();
+    int32 slot = TextureImageSlot(target);
+    if(slot < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid texture target");
+        return;
+    }
+    if(level < 0 || width < 0 || height < 0 || border != 0 || width > kHEADLESS_MAX_TEXTURE_SIZE || height > kHEADLESS_MAX_TEXTURE_SIZE)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "invalid level, size or border");
+        return;
+    }
+
+    uint32 bpp = BytesPerPixel(format, type);
+    if(bpp == 0)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "invalid format/type combination");
+        return;
+    }
+
+    GLuint name = s_context.boundTextures[s_context.activeUnit][slot];
+    if(level == 0 && name != 0)
+    {
+        STextureObject& texture = s_context.textures[name];
+        texture.width = width;
+        texture.height = height;
+        texture.defined = true;
+    }
+
+    if(pixels != NULL)
+        CHeadlessDevice::Instance().OnUpload(width * height * bpp);
+}
+
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels)
+{
+    VV_GL_CALL();
+    int32 slot = TextureImageSlot(target);
+    if(slot < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid texture target");
+        return;
+    }
+
+    uint32 bpp = BytesPerPixel(format, type);
+    if(bpp == 0)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "invalid format/type combination");
+        return;
+    }
+
+    GLuint name = s_context.boundTextures[s_context.activeUnit][slot];
+    const STextureObject& texture = s_context.textures[name];
+    if(name == 0 || !texture.defined)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "texture has no storage");
+        return;
+    }
+    if(level == 0 && (xoffset < 0 || yoffset < 0 || xoffset + width > texture.width || yoffset + height > texture.height))
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "region outside of the texture");
+        return;
+    }
+
+    CHeadlessDevice::Instance().OnUpload(width * height * bpp);
+}
+
+void glTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    VV_GL_CALL();
+    if(TextureTargetSlot(target) < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid texture target");
+        return;
+    }
+    if(pname != GL_TEXTURE_MIN_FILTER && pname != GL_TEXTURE_MAG_FILTER && pname != GL_TEXTURE_WRAP_S && pname != GL_TEXTURE_WRAP_T && pname != GL_TEXTURE_MAX_ANISOTROPY_EXT)
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid texture parameter");
+}
+
+void glTexParameterf(GLenum target, GLenum pname, GLfloat param)
+{
+    VV_GL_CALL();
+    if(TextureTargetSlot(target) < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid texture target");
+        return;
+    }
+    if(pname == GL_TEXTURE_MAX_ANISOTROPY_EXT && (param < 1.0f || param > VV_HEADLESS_MAX_ANISOTROPY))
+        VV_GL_ERROR(GL_INVALID_VALUE, "anisotropy outside of [1, max]");
+    else if(pname != GL_TEXTURE_MIN_FILTER && pname != GL_TEXTURE_MAG_FILTER && pname != GL_TEXTURE_WRAP_S && pname != GL_TEXTURE_WRAP_T && pname != GL_TEXTURE_MAX_ANISOTROPY_EXT)
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid texture parameter");
+}
+
+void glGenerateMipmap(GLenum target)
+{
+    VV_GL_CALL();
+    int32 slot = TextureTargetSlot(target);
+    if(slot < 0)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid texture target");
+        return;
+    }
+
+    GLuint name = s_context.boundTextures[s_context.activeUnit][slot];
+    if(name == 0 || !s_context.textures[name].defined)
+        VV_GL_ERROR(GL_INVALID_OPERATION, "texture has no storage");
+}
+
+//-------------------------------------------------------------------------------------------------------------
+// shaders and programs
+//-------------------------------------------------------------------------------------------------------------
+
+GLuint glCreateShader(GLenum type)
+{
+    VV_GL_CALL();
+    if(type != GL_VERTEX_SHADER && type != GL_FRAGMENT_SHADER)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid shader type");
+        return 0;
+    }
+
+    GLuint name = s_context.nextName++;
+    SShaderObject& shader = s_context.shaders[name];
+    shader.type = type;
+    shader.compiled = false;
+    shader.deleted = false;
+    return name;
+}
+
+void glShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* length)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SShaderObject>::iterator it = s_context.shaders.find(shader);
+    if(it == s_context.shaders.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown shader");
+        return;
+    }
+
+    it->second.source.clear();
+    for(GLsizei i = 0; i < count; ++i)
+    {
+        if(length != NULL && length[i] >= 0)
+            it->second.source.append(strings[i], length[i]);
+        else
+            it->second.source.append(strings[i]);
+    }
+}
+
+void glCompileShader(GLuint shader)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SShaderObject>::iterator it = s_context.shaders.find(shader);
+    if(it == s_context.shaders.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown shader");
+        return;
+    }
+
+    //the headless compiler only checks for an entry point
+    it->second.compiled = it->second.source.find("main") != string::npos;
+    it->second.log = it->second.compiled ? "" : "ERROR: missing main function\n";
+}
+
+void glGetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SShaderObject>::iterator it = s_context.shaders.find(shader);
+    if(it == s_context.shaders.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown shader");
+        return;
+    }
+
+    switch (pname)
+    {
+        case GL_COMPILE_STATUS: *params = it->second.compiled; break;
+        case GL_SHADER_TYPE: *params = it->second.type; break;
+        case GL_DELETE_STATUS: *params = it->second.deleted; break;
+        case GL_INFO_LOG_LENGTH: *params = it->second.log.empty() ? 0 : it->second.log.size() + 1; break;
+        case GL_SHADER_SOURCE_LENGTH: *params = it->second.source.empty() ? 0 : it->second.source.size() + 1; break;
+        default:
+            VV_GL_ERROR(GL_INVALID_ENUM, "invalid shader parameter");
+            break;
+    }
+}
+
+/** copy a log to a client buffer*/
+static void CopyLog(const string& log, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+    GLsizei n = 0;
+    if(bufsize > 0)
+    {
+        n = std::min((GLsizei)log.size(), bufsize - 1);
+        memcpy(infolog, log.c_str(), n);
+        infolog[n] = '\0';
+    }
+    if(length != NULL)
+        *length = n;
+}
+
+void glGetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SShaderObject>::iterator it = s_context.shaders.find(shader);
+    if(it == s_context.shaders.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown shader");
+        return;
+    }
+    CopyLog(it->second.log, bufsize, length, infolog);
+}
+
+/** check if a program references the shader*/
+static bool IsShaderAttached(GLuint shader)
+{
+    for(std::map<GLuint, SProgramObject>::const_iterator it = s_context.programs.begin(); it != s_context.programs.end(); ++it)
+    {
+        if(std::find(it->second.shaders.begin(), it->second.shaders.end(), shader) != it->second.shaders.end())
+            return true;
+    }
+    return false;
+}
+
+void glDeleteShader(GLuint shader)
+{
+    VV_GL_CALL();
+    if(shader == 0)
+        return;
+
+    std::map<GLuint, SShaderObject>::iterator it = s_context.shaders.find(shader);
+    if(it == s_context.shaders.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown shader");
+        return;
+    }
+
+    //attached shaders are deleted with their program
+    it->second.deleted = true;
+    if(!IsShaderAttached(shader))
+        s_context.shaders.erase(it);
+}
+
+GLuint glCreateProgram(void)
+{
+    VV_GL_CALL();
+    GLuint name = s_context.nextName++;
+    SProgramObject& program = s_context.programs[name];
+    program.linked = false;
+    program.validated = false;
+    program.deleted = false;
+    return name;
+}
+
+void glAttachShader(GLuint program, GLuint shader)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end() || !s_context.shaders.count(shader))
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown program or shader");
+        return;
+    }
+
+    std::vector<GLuint>& shaders = it->second.shaders;
+    if(std::find(shaders.begin(), shaders.end(), shader) != shaders.end())
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "shader already attached");
+        return;
+    }
+    shaders.push_back(shader);
+}
+
+void glBindAttribLocation(GLuint program, GLuint index, const GLchar* name)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown program");
+        return;
+    }
+    if(index >= kHEADLESS_MAX_VERTEX_ATTRIBS)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "attribute index above GL_MAX_VERTEX_ATTRIBS");
+        return;
+    }
+    it->second.boundAttribs[name] = index;
+}
+
+void glLinkProgram(GLuint program)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown program");
+        return;
+    }
+
+    //a compiled shader per stage
+    SProgramObject& object = it->second;
+    bool vertex = false, fragment = false;
+    for(uint32 s = 0; s < object.shaders.size(); ++s)
+    {
+        const SShaderObject& shader = s_context.shaders[object.shaders[s]];
+        if(!shader.compiled)
+            continue;
+        vertex = vertex || shader.type == GL_VERTEX_SHADER;
+        fragment = fragment || shader.type == GL_FRAGMENT_SHADER;
+    }
+
+    object.linked = vertex && fragment;
+    object.log = object.linked ? "" : "ERROR: a compiled vertex and fragment shader are required\n";
+    if(object.linked)
+        ReflectProgram(object);
+}
+
+void glValidateProgram(GLuint program)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown program");
+        return;
+    }
+    it->second.validated = it->second.linked;
+}
+
+void glGetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown program");
+        return;
+    }
+
+    const SProgramObject& object = it->second;
+    switch (pname)
+    {
+        case GL_LINK_STATUS: *params = object.linked; break;
+        case GL_VALIDATE_STATUS: *params = object.validated; break;
+        case GL_DELETE_STATUS: *params = object.deleted; break;
+        case GL_ATTACHED_SHADERS: *params = object.shaders.size(); break;
+        case GL_INFO_LOG_LENGTH: *params = object.log.empty() ? 0 : object.log.size() + 1; break;
+        case GL_ACTIVE_UNIFORMS: *params = object.uniforms.size(); break;
+        case GL_ACTIVE_ATTRIBUTES: *params = object.attributes.size(); break;
+        case GL_PROGRAM_BINARY_LENGTH_OES: *params = 0; break;
+        case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+        {
+            //array names are reported with [0]
+            GLint length = 0;
+            for(uint32 u = 0; u < object.uniforms.size(); ++u)
+                length = std::max(length, (GLint)object.uniforms[u].name.size() + (object.uniforms[u].size > 1 ? 3 : 0) + 1);
+            *params = length;
+            break;
+        }
+        case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH:
+        {
+            GLint length = 0;
+            for(uint32 a = 0; a < object.attributes.size(); ++a)
+                length = std::max(length, (GLint)object.attributes[a].name.size() + 1);
+            *params = length;
+            break;
+        }
+        default:
+            VV_GL_ERROR(GL_INVALID_ENUM, "invalid program parameter");
+            break;
+    }
+}
+
+void glGetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown program");
+        return;
+    }
+    CopyLog(it->second.log, bufsize, length, infolog);
+}
+
+void glGetActiveUniform(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end() || index >= it->second.uniforms.size())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown program or uniform index");
+        return;
+    }
+
+    const SUniformInfo& uniform = it->second.uniforms[index];
+    *size = uniform.size;
+    *type = uniform.type;
+    CopyLog(uniform.size > 1 ? uniform.name + "[0]" : uniform.name, bufsize, length, name);
+}
+
+void glGetActiveAttrib(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end() || index >= it->second.attributes.size())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown program or attribute index");
+        return;
+    }
+
+    const SAttribInfo& attribute = it->second.attributes[index];
+    *size = 1;
+    *type = attribute.type;
+    CopyLog(attribute.name, bufsize, length, name);
+}
+
+GLint glGetUniformLocation(GLuint program, const GLchar* name)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end() || !it->second.linked)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "unknown or unlinked program");
+        return -1;
+    }
+
+    //name or name[index]
+    string base(name);
+    GLint element = 0;
+    size_t bracket = base.find('[');
+    if(bracket != string::npos)
+    {
+        element = atoi(base.c_str() + bracket + 1);
+        base = base.substr(0, bracket);
+    }
+
+    const std::vector<SUniformInfo>& uniforms = it->second.uniforms;
+    for(uint32 u = 0; u < uniforms.size(); ++u)
+    {
+        if(uniforms[u].name == base)
+            return element < uniforms[u].size ? uniforms[u].location + element : -1;
+    }
+    return -1;
+}
+
+GLint glGetAttribLocation(GLuint program, const GLchar* name)
+{
+    VV_GL_CALL();
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end() || !it->second.linked)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "unknown or unlinked program");
+        return -1;
+    }
+
+    const std::vector<SAttribInfo>& attributes = it->second.attributes;
+    for(uint32 a = 0; a < attributes.size(); ++a)
+    {
+        if(attributes[a].name == name)
+            return attributes[a].location;
+    }
+    return -1;
+}
+
+void glUseProgram(GLuint program)
+{
+    VV_GL_CALL();
+    if(program != 0)
+    {
+        std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+        if(it == s_context.programs.end())
+        {
+            VV_GL_ERROR(GL_INVALID_VALUE, "unknown program");
+            return;
+        }
+        if(!it->second.linked)
+        {
+            VV_GL_ERROR(GL_INVALID_OPERATION, "program is not linked");
+            return;
+        }
+    }
+
+    if(s_context.program == program)
+        VV_GL_REDUNDANT();
+    s_context.program = program;
+}
+
+void glDeleteProgram(GLuint program)
+{
+    VV_GL_CALL();
+    if(program == 0)
+        return;
+
+    std::map<GLuint, SProgramObject>::iterator it = s_context.programs.find(program);
+    if(it == s_context.programs.end())
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown program");
+        return;
+    }
+
+    //shaders flagged for deletion go with their last program
+    std::vector<GLuint> shaders = it->second.shaders;
+    s_context.programs.erase(it);
+    for(uint32 s = 0; s < shaders.size(); ++s)
+    {
+        std::map<GLuint, SShaderObject>::iterator shader = s_context.shaders.find(shaders[s]);
+        if(shader != s_context.shaders.end() && shader->second.deleted && !IsShaderAttached(shaders[s]))
+            s_context.shaders.erase(shader);
+    }
+
+    if(s_context.program == program)
+        s_context.program = 0;
+}
+
+void glGetProgramBinaryOES(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, GLvoid* binary)
+{
+    VV_GL_CALL();
+    VV_GL_ERROR(GL_INVALID_OPERATION, "the headless device has no program binary format");
+}
+
+void glProgramBinaryOES(GLuint program, GLenum binaryFormat, const GLvoid* binary, GLint length)
+{
+    VV_GL_CALL();
+    VV_GL_ERROR(GL_INVALID_ENUM, "the headless device has no program binary format");
+}
+
+//-------------------------------------------------------------------------------------------------------------
+// uniforms
+//-------------------------------------------------------------------------------------------------------------
+
+void glUniform1f(GLint location, GLfloat x) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, 1, 1, kUNIFORM_SETTER_FLOAT);}
+void glUniform1i(GLint location, GLint x) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, 1, 1, kUNIFORM_SETTER_INT);}
+void glUniform1fv(GLint location, GLsizei count, const GLfloat* v) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 1, kUNIFORM_SETTER_FLOAT);}
+void glUniform2fv(GLint location, GLsizei count, const GLfloat* v) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 2, kUNIFORM_SETTER_FLOAT);}
+void glUniform3fv(GLint location, GLsizei count, const GLfloat* v) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 3, kUNIFORM_SETTER_FLOAT);}
+void glUniform4fv(GLint location, GLsizei count, const GLfloat* v) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 4, kUNIFORM_SETTER_FLOAT);}
+void glUniform1iv(GLint location, GLsizei count, const GLint* v) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 1, kUNIFORM_SETTER_INT);}
+void glUniform2iv(GLint location, GLsizei count, const GLint* v) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 2, kUNIFORM_SETTER_INT);}
+void glUniform3iv(GLint location, GLsizei count, const GLint* v) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 3, kUNIFORM_SETTER_INT);}
+void glUniform4iv(GLint location, GLsizei count, const GLint* v) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 4, kUNIFORM_SETTER_INT);}
+void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 4, kUNIFORM_SETTER_MATRIX);}
+void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 9, kUNIFORM_SETTER_MATRIX);}
+void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {VV_GL_CALL(); SetUniform(__FUNCTION__, location, count, 16, kUNIFORM_SETTER_MATRIX);}
+
+//-------------------------------------------------------------------------------------------------------------
+// framebuffers and renderbuffers
+//-------------------------------------------------------------------------------------------------------------
+
+void glGenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        framebuffers[i] = s_context.nextName++;
+        SFramebufferObject fbo = {0, 0, false, false};
+        s_context.framebuffers[framebuffers[i]] = fbo;
+    }
+}
+
+void glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        if(framebuffers[i] == 0)
+            continue;
+        s_context.framebuffers.erase(framebuffers[i]);
+        if(s_context.framebuffer == framebuffers[i])
+            s_context.framebuffer = 0;
+    }
+}
+
+GLboolean glIsFramebuffer(GLuint framebuffer)
+{
+    VV_GL_CALL();
+    return framebuffer != 0 && s_context.framebuffers.count(framebuffer) ? GL_TRUE : GL_FALSE;
+}
+
+void glBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    VV_GL_CALL();
+    if(target != GL_FRAMEBUFFER)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid framebuffer target");
+        return;
+    }
+    if(framebuffer != 0 && !s_context.framebuffers.count(framebuffer))
+    {
+        SFramebufferObject fbo = {0, 0, false, false};
+        s_context.framebuffers[framebuffer] = fbo;
+    }
+    if(s_context.framebuffer == framebuffer)
+        VV_GL_REDUNDANT();
+    s_context.framebuffer = framebuffer;
+}
+
+void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    VV_GL_CALL();
+    if(s_context.framebuffer == 0)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "default framebuffer bound");
+        return;
+    }
+    if(texture != 0 && !s_context.textures.count(texture))
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "unknown texture");
+        return;
+    }
+
+    SFramebufferObject& fbo = s_context.framebuffers[s_context.framebuffer];
+    if(attachment == GL_COLOR_ATTACHMENT0)
+    {
+        fbo.color = texture;
+        fbo.colorIsTexture = true;
+    }
+    else if(attachment == GL_DEPTH_ATTACHMENT)
+    {
+        fbo.depth = texture;
+        fbo.depthIsTexture = true;
+    }
+    else if(attachment != GL_STENCIL_ATTACHMENT)
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid attachment");
+}
+
+void glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+{
+    VV_GL_CALL();
+    if(s_context.framebuffer == 0)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "default framebuffer bound");
+        return;
+    }
+    if(renderbuffer != 0 && !s_context.renderbuffers.count(renderbuffer))
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "unknown renderbuffer");
+        return;
+    }
+
+    SFramebufferObject& fbo = s_context.framebuffers[s_context.framebuffer];
+    if(attachment == GL_COLOR_ATTACHMENT0)
+    {
+        fbo.color = renderbuffer;
+        fbo.colorIsTexture = false;
+    }
+    else if(attachment == GL_DEPTH_ATTACHMENT)
+    {
+        fbo.depth = renderbuffer;
+        fbo.depthIsTexture = false;
+    }
+    else if(attachment != GL_STENCIL_ATTACHMENT)
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid attachment");
+}
+
+GLenum glCheckFramebufferStatus(GLenum target)
+{
+    VV_GL_CALL();
+    if(target != GL_FRAMEBUFFER)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid framebuffer target");
+        return 0;
+    }
+    return FramebufferStatus();
+}
+
+void glGenRenderbuffers(GLsizei n, GLuint* renderbuffers)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        renderbuffers[i] = s_context.nextName++;
+        SRenderbufferObject renderbuffer = {0, 0, 0};
+        s_context.renderbuffers[renderbuffers[i]] = renderbuffer;
+    }
+}
+
+void glDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        if(renderbuffers[i] == 0)
+            continue;
+        s_context.renderbuffers.erase(renderbuffers[i]);
+        if(s_context.renderbuffer == renderbuffers[i])
+            s_context.renderbuffer = 0;
+    }
+}
+
+void glBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    VV_GL_CALL();
+    if(target != GL_RENDERBUFFER)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid renderbuffer target");
+        return;
+    }
+    if(renderbuffer != 0 && !s_context.renderbuffers.count(renderbuffer))
+    {
+        SRenderbufferObject object = {0, 0, 0};
+        s_context.renderbuffers[renderbuffer] = object;
+    }
+    if(s_context.renderbuffer == renderbuffer)
+        VV_GL_REDUNDANT();
+    s_context.renderbuffer = renderbuffer;
+}
+
+void glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    VV_GL_CALL();
+    if(s_context.renderbuffer == 0)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "no renderbuffer bound");
+        return;
+    }
+    if(width < 0 || height < 0 || width > kHEADLESS_MAX_RENDERBUFFER_SIZE || height > kHEADLESS_MAX_RENDERBUFFER_SIZE)
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "invalid renderbuffer size");
+        return;
+    }
+
+    SRenderbufferObject& renderbuffer = s_context.renderbuffers[s_context.renderbuffer];
+    renderbuffer.format = internalformat;
+    renderbuffer.width = width;
+    renderbuffer.height = height;
+}
+
+
+//-------------------------------------------------------------------------------------------------------------
+// timer queries, the headless device has no gpu: every scope takes no time
+//-------------------------------------------------------------------------------------------------------------
+
+void glGenQueriesEXT(GLsizei n, GLuint* ids)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        ids[i] = s_context.nextName++;
+        SQueryObject query = {false};
+        s_context.queries[ids[i]] = query;
+    }
+}
+
+void glDeleteQueriesEXT(GLsizei n, const GLuint* ids)
+{
+    VV_GL_CALL();
+    for(GLsizei i = 0; i < n; ++i)
+    {
+        if(ids[i] != 0 && ids[i] == s_context.activeQuery)
+        {
+            VV_GL_ERROR(GL_INVALID_OPERATION, "query is active");
+            continue;
+        }
+        s_context.queries.erase(ids[i]);
+    }
+}
+
+GLboolean glIsQueryEXT(GLuint id)
+{
+    VV_GL_CALL();
+    return id != 0 && s_context.queries.count(id) ? GL_TRUE : GL_FALSE;
+}
+
+void glBeginQueryEXT(GLenum target, GLuint id)
+{
+    VV_GL_CALL();
+    if(target != GL_TIME_ELAPSED_EXT)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid query target");
+        return;
+    }
+    if(s_context.activeQuery != 0)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "a query is already active");
+        return;
+    }
+    if(id == 0 || !s_context.queries.count(id))
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "unknown query");
+        return;
+    }
+    s_context.activeQuery = id;
+}
+
+void glEndQueryEXT(GLenum target)
+{
+    VV_GL_CALL();
+    if(target != GL_TIME_ELAPSED_EXT)
+    {
+        VV_GL_ERROR(GL_INVALID_ENUM, "invalid query target");
+        return;
+    }
+    if(s_context.activeQuery == 0)
+    {
+        VV_GL_ERROR(GL_INVALID_OPERATION, "no active query");
+        return;
+    }
+    s_context.queries[s_context.activeQuery].ended = true;
+    s_context.activeQuery = 0;
+}
+
+/** result of a query object, false ( and error raised) if the query cant be read*/
+static bool QueryResult(const char8* function, GLuint id, GLenum pname, GLuint64* result)
+{
+    std::map<GLuint, SQueryObject>::const_iterator it = s_context.queries.find(id);
+    if(it == s_context.queries.end() || id == s_context.activeQuery || !it->second.ended)
+    {
+        CHeadlessDevice::Instance().OnError(function, GL_INVALID_OPERATION, "query is unknown, active or never ended");
+        return false;
+    }
+
+    if(pname == GL_QUERY_RESULT_AVAILABLE_EXT)
+        *result = GL_TRUE;
+    else if(pname == GL_QUERY_RESULT_EXT)
+        *result = 0;
+    else
+    {
+        CHeadlessDevice::Instance().OnError(function, GL_INVALID_ENUM, "invalid query parameter");
+        return false;
+    }
+    return true;
+}
+
+void glGetQueryObjectuivEXT(GLuint id, GLenum pname, GLuint* params)
+{
+    VV_GL_CALL();
+    GLuint64 result;
+    if(QueryResult(__FUNCTION__, id, pname, &result))
+        *params = (GLuint)result;
+}
+
+void glGetQueryObjectui64vEXT(GLuint id, GLenum pname, GLuint64* params)
+{
+    VV_GL_CALL();
+    GLuint64 result;
+    if(QueryResult(__FUNCTION__, id, pname, &result))
+        *params = result;
+}
+
+}
+
+//-------------------------------------------------------------------------------------------------------------
+// sync objects, the headless device has no gpu: every fence is signaled
+//-------------------------------------------------------------------------------------------------------------
+
+GLsync glFenceSyncAPPLE(GLenum condition, GLbitfield flags)
+{
+    VV_GL_CALL();
+    if(condition != GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE || flags != 0)
+    {
+        VV_GL_ERROR(condition != GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE ? GL_INVALID_ENUM : GL_INVALID_VALUE, "invalid fence");
+        return 0;
+    }
+
+    GLuint name = s_context.nextName++;
+    s_context.syncs.insert(name);
+    return (GLsync)(size_t)name;
+}
+
+GLboolean glIsSyncAPPLE(GLsync sync)
+{
+    VV_GL_CALL();
+    return s_context.syncs.count((GLuint)(size_t)sync) ? GL_TRUE : GL_FALSE;
+}
+
+void glDeleteSyncAPPLE(GLsync sync)
+{
+    VV_GL_CALL();
+    if(sync == 0)
+        return;
+    if(!s_context.syncs.erase((GLuint)(size_t)sync))
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown sync object");
+}
+
+GLenum glClientWaitSyncAPPLE(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    VV_GL_CALL();
+    if(!s_context.syncs.count((GLuint)(size_t)sync))
+    {
+        VV_GL_ERROR(GL_INVALID_VALUE, "unknown sync object");
+        return GL_WAIT_FAILED_APPLE;
+    }
+    return GL_ALREADY_SIGNALED_APPLE;
+}
+
+#endif
@@ -0,0 +1,38 @@
+/* HeadlessGL.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef VVISION_HEADLESS_GL_H
+#define VVISION_HEADLESS_GL_H
+
+/** gl declarations of the headless platform ( check Platform.h).
+ * the khronos es 2.0 headers declare the api, every entry point used by the engine is implemented by HeadlessGL.cpp,
+ * no gl library is linked. the extensions exposed by the headless device are the ones of the ios sdk used by the engine.
+ */
+#include <GLES2/gl2.h>
+
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES 1
+#endif
+#include <GLES2/gl2ext.h>
+
+/** APPLE_texture_format_BGRA8888 names the format without suffix*/
+#ifndef GL_BGRA
+#define GL_BGRA GL_BGRA_EXT
+#endif
+
+#endif
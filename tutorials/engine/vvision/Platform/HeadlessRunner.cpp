@@ -0,0 +1,143 @@
+/*
+ *  HeadlessRunner.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+// headless frame loop of a tutorial, replaces GPUManager.mm off device ( not part of the xcode projects).
+// the tutorial is deployed and its Frame is run a fixed number of times against the headless gl backend,
+// the per frame gl calls, draws, triangles, uploaded bytes and cpu time are printed and saved as csv for tools/vvbench.py,
+// the vertex cache efficiency of the loaded meshes ( ACMR/ATVR before and after MeshOptimizer) and the host memory
+// their residency policies released are printed,
+// the profiler scopes of the run can be saved as a chrome trace ( build with -DVVISION_PROFILE).
+//
+// build, from the tutorials directory ( waterReflection for example):
+//
+//   E=engine/vvision; T=waterReflection/waterReflection/Classes/Core
+//   I="-I$E -I$E/Utils -I$E/Math -I$E/Renderer -I$E/MeshLoader -I$E/MeshLoader/assimpMesh -I$E/ResourceManager -I$E/Platform -I$E/ext/assimp/include -I$T -I$T/entities"
+//   S="$E/Utils/*.cpp $E/Math/*.cpp $E/Renderer/*.cpp $E/MeshLoader/*.cpp $E/MeshLoader/assimpMesh/*.cpp $E/ResourceManager/*.cpp $E/Platform/*.cpp $T/*.cpp $T/entities/*.cpp"
+//   g++ -O2 -DVVISION_HEADLESS -DVVISION_HEADLESS_WINDOW_SIZE $I $S -lassimp -lz -o vvheadless
+//
+//   ./vvheadless waterReflection/waterReflection/Resources 600 waterReflection.csv [waterReflection.json]
+//
+// VVISION_HEADLESS_WINDOW_SIZE is defined for the tutorials that have Tutorial::SetWindowSize.
+// VVISION_HEADLESS_FLYTHROUGH moves the camera with Tutorial::UpdateControls, back during the first half of the frames
+// and forth during the second, so the triangles per frame follow the levels of detail selected along the path.
+
+#include "HeadlessDevice.h"
+
+#ifdef VVISION_PLATFORM_HEADLESS
+
+#include "FilePath.h"
+#include "RenderStateCache.h"
+#include "GPUProfiler.h"
+#include "MeshOptimizer.h"
+#include "MeshBuffer.h"
+#include "Tutorial.h"
+#include <string.h>
+#include <algorithm>
+
+using namespace vvision;
+
+/** frames run when not given*/
+#define VV_HEADLESS_DEFAULT_FRAMES 300
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        std::cerr<<"usage: "<<argv[0]<<" resource_directory [frames] [report.csv] [trace.json]\n";
+        return 1;
+    }
+
+    setResourceDirectory(argv[1]);
+    int32 frames = argc > 2 ? atoi(argv[2]) : VV_HEADLESS_DEFAULT_FRAMES;
+
+    CHeadlessDevice& device = CHeadlessDevice::Instance();
+    int32 width = device.GetDefaultFramebufferWidth();
+    int32 height = device.GetDefaultFramebufferHeight();
+
+    //loading is part of the first captured frame
+    CProfiler& profiler = CProfiler::Instance();
+    if(argc > 4)
+        profiler.StartCapture(frames);
+
+    Tutorial* tutorial = new Tutorial();
+    if(!tutorial->Deploy())
+    {
+        std::cerr<<"HeadlessRunner: [ERROR] cant deploy the tutorial\n";
+        SAFE_DELETE(tutorial);
+        return 1;
+    }
+
+    //loading is not part of the frames
+    uint32 loadingErrors = device.GetFrameStats().errors;
+
+    //post transform cache efficiency of the static meshes loaded by the tutorial
+    const SMeshOptimizerStats& meshes = GetMeshOptimizerTotals();
+    std::cerr<<"HeadlessRunner: [INFO] mesh optimizer, "<<meshes.triangles<<" triangles, "<<meshes.vertices<<" vertices\n";
+    std::cerr<<"    ACMR: "<<meshes.GetACMRBefore()<<" -> "<<meshes.GetACMRAfter()<<"\n";
+    std::cerr<<"    ATVR: "<<meshes.GetATVRBefore()<<" -> "<<meshes.GetATVRAfter()<<"\n";
+
+    //host copies of the meshes released once on the gpu ( check CMeshGroup::SetResidency)
+    const SMeshResidencyStats& residency = GetMeshResidencyTotals();
+    std::cerr<<"HeadlessRunner: [INFO] mesh host memory, "<<residency.groups<<" groups, "<<residency.releasedBytes<<" bytes released, "<<residency.keptBytes<<" bytes kept\n";
+
+    for(int32 i = 0; i < frames; ++i)
+    {
+        device.BeginFrame();
+        profiler.BeginFrame();
+        CGPUProfiler::Instance().BeginFrame();
+
+        //the default framebuffer, like DrawFrame of GPUManager.mm
+        CRenderStateCache::Instance().BeginFrame(0, width, height);
+#ifdef VVISION_HEADLESS_WINDOW_SIZE
+        tutorial->SetWindowSize(width, height);
+#endif
+#ifdef VVISION_HEADLESS_FLYTHROUGH
+        CControlPad pad;
+        memset(&pad, 0, sizeof(pad));
+        pad.keyMoveDown = i < frames / 2;
+        pad.keyMoveUp = !pad.keyMoveDown;
+        tutorial->UpdateControls(pad);
+#endif
+        tutorial->Frame();
+
+        profiler.EndFrame();
+        device.EndFrame();
+    }
+
+    CGPUProfiler::Instance().Release();
+    SAFE_DELETE(tutorial);
+
+    device.PrintReport();
+    
+    //triangles along the run, they change with the levels of detail
+    const std::vector<SHeadlessFrameStats>& history = device.GetHistory();
+    if(!history.empty())
+    {
+        uint32 fewest = history[0].triangles, most = history[0].triangles;
+        for(uint32 i = 1; i < history.size(); i++)
+        {
+            fewest = std::min(fewest, history[i].triangles);
+            most = std::max(most, history[i].triangles);
+        }
+        std::cerr<<"HeadlessRunner: [INFO] triangles per frame, first "<<history[0].triangles<<", min "<<fewest<<", max "<<most<<", last "<<history.back().triangles<<"\n";
+    }
+    if(argc > 3 && !device.SaveReport(argv[3]))
+        return 1;
+    if(argc > 4 && !profiler.SaveChromeTrace(argv[4]))
+        return 1;
+
+    //gl errors fail the run
+    uint32 errors = loadingErrors;
+    for(uint32 i = 0; i < device.GetHistory().size(); ++i)
+        errors += device.GetHistory()[i].errors;
+
+    return errors == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,353 @@
+/*
+ *  BufferArena.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "BufferArena.h"
+#include "VertexBuffer.h"
+#include "RenderStateCache.h"
+#include <string.h>
+#include <algorithm>
+
+namespace vvision
+{
+    CRangeAllocator::CRangeAllocator()
+    : m_uCapacity(0), m_uUsed(0)
+    {
+    }
+    
+    void CRangeAllocator::Reset(uint32 capacity)
+    {
+        m_mFree.clear();
+        if(capacity > 0)
+            m_mFree[0] = capacity;
+        m_uCapacity = capacity;
+        m_uUsed = 0;
+    }
+    
+    bool CRangeAllocator::Allocate(uint32 size, uint32 alignment, uint32& offset)
+    {
+        if(size == 0)
+        {
+            offset = 0;
+            return true;
+        }
+        
+        for(std::map<uint32, uint32>::iterator it = m_mFree.begin(); it != m_mFree.end(); ++it)
+        {
+            uint32 start = it->first;
+            uint32 length = it->second;
+            uint32 aligned = (start + alignment - 1) & ~(alignment - 1);
+            if(aligned - start + size > length)
+                continue;
+            
+            //the alignment padding and the tail stay free
+            m_mFree.erase(it);
+            if(aligned > start)
+                m_mFree[start] = aligned - start;
+            if(aligned + size < start + length)
+                m_mFree[aligned + size] = start + length - aligned - size;
+            
+            m_uUsed += size;
+            offset = aligned;
+            return true;
+        }
+        return false;
+    }
+    
+    void CRangeAllocator::Release(uint32 offset, uint32 size)
+    {
+        if(size == 0)
+            return;
+        
+        m_uUsed -= size;
+        
+        //merge with the following free range
+        std::map<uint32, uint32>::iterator next = m_mFree.lower_bound(offset);
+        if(next != m_mFree.end() && offset + size == next->first)
+        {
+            size += next->second;
+            m_mFree.erase(next++);
+        }
+        
+        //merge with the previous free range
+        if(next != m_mFree.begin())
+        {
+            std::map<uint32, uint32>::iterator previous = next;
+            --previous;
+            if(previous->first + previous->second == offset)
+            {
+                previous->second += size;
+                return;
+            }
+        }
+        
+        m_mFree[offset] = size;
+    }
+    
+    uint32 CRangeAllocator::GetLargestFreeRange() const
+    {
+        uint32 largest = 0;
+        for(std::map<uint32, uint32>::const_iterator it = m_mFree.begin(); it != m_mFree.end(); ++it)
+            largest = std::max(largest, it->second);
+        return largest;
+    }
+    
+    /** a vertex and an index buffer shared by groups of the same vertex format and usage, attributes are mapped once in the vao*/
+    struct SBufferArenaBlock
+    {
+        /** SVertexFormat key and usage of the groups*/
+        uint32 formatKey;
+        GL_BUFFER_USAGE_HINT usage;
+        uint32 stride;
+        CVertexLayout layout;
+        
+        /** vao, vbo and ibo*/
+        GLuint vao;
+        CVertexBuffer vertices;
+        CVertexBuffer indices;
+        
+        /** vertex ranges ( in vertices) and index ranges ( in bytes)*/
+        CRangeAllocator vertexRanges;
+        CRangeAllocator indexRanges;
+        
+        /** groups allocated in the block*/
+        uint32 groups;
+    };
+    
+    /** delete the gl objects of a block and the block*/
+    static void DestroyBlock(SBufferArenaBlock* block)
+    {
+        //gl unbinds a deleted vao, keep the cache in sync
+        CRenderStateCache::Instance().BindVertexArray(0);
+        if(block->vao)
+            glDeleteVertexArraysOES(1, &block->vao);
+        
+        block->vertices.Destroy();
+        block->indices.Destroy();
+        delete block;
+    }
+    
+    /** create a block and map the attributes of layout in its vao*/
+    static SBufferArenaBlock* CreateBlock(const CVertexLayout& layout, GL_BUFFER_USAGE_HINT usage, uint32 vertex_capacity, uint32 index_capacity)
+    {
+        SBufferArenaBlock* block = new SBufferArenaBlock();
+        block->formatKey = layout.GetFormat().GetKey();
+        block->usage = usage;
+        block->stride = layout.GetStride();
+        block->layout = layout;
+        block->vao = 0;
+        block->groups = 0;
+        block->vertexRanges.Reset(vertex_capacity);
+        block->indexRanges.Reset(index_capacity);
+        
+        CRenderStateCache& cache = CRenderStateCache::Instance();
+        glGenVertexArraysOES(1, &block->vao);
+        cache.BindVertexArray(block->vao);
+        
+        if(!block->vertices.AllocateStorage(kGL_BUFFER_TYPE_ARRAY, usage, vertex_capacity * block->stride, NULL) ||
+           !block->indices.AllocateStorage(kGL_BUFFER_TYPE_ELEMENT, usage, index_capacity, NULL))
+        {
+            DestroyBlock(block);
+            return NULL;
+        }
+        
+        block->vertices.Bind();
+        layout.MapAttributes();
+        
+        block->indices.Bind();
+        block->vertices.Unbind();
+        cache.BindVertexArray(0);
+        return block;
+    }
+    
+    CBufferArena::~CBufferArena()
+    {
+        for(uint32 i = 0; i < m_vBlocks.size(); i++)
+            DestroyBlock(m_vBlocks[i]);
+        m_vBlocks.clear();
+    }
+    
+    bool CBufferArena::AllocateInBlock(SBufferArenaBlock* block, const std::vector<uchar8>& vertices, const std::vector<uint32>& indices, SBufferArenaAllocation& allocation, INDEX_TYPE& type)
+    {
+        uint32 vertexCount = vertices.size() / block->stride;
+        uint32 firstVertex = 0;
+        if(!block->vertexRanges.Allocate(vertexCount, 1, firstVertex))
+            return false;
+        
+        //the rebased indices address up to firstVertex + vertexCount
+        INDEX_TYPE indexType;
+        if(!SelectIndexType(firstVertex + vertexCount, indexType))
+        {
+            block->vertexRanges.Release(firstVertex, vertexCount);
+            return false;
+        }
+        
+        uint32 indexSize = GetIndexTypeSize(indexType);
+        uint32 indexBytes = indices.size() * indexSize;
+        uint32 indexOffset = 0;
+        if(!block->indexRanges.Allocate(indexBytes, indexSize, indexOffset))
+        {
+            block->vertexRanges.Release(firstVertex, vertexCount);
+            return false;
+        }
+        
+        std::vector<uint32> rebased(indices.size());
+        for(uint32 i = 0; i < indices.size(); i++)
+            rebased[i] = indices[i] + firstVertex;
+        
+        std::vector<uchar8> packed;
+        EncodeIndices(rebased, indexType, packed);
+        
+        //the element buffer binding belongs to the bound vao, upload with none bound
+        CRenderStateCache::Instance().BindVertexArray(0);
+        if(!vertices.empty())
+            block->vertices.UpdateContent(firstVertex * block->stride, vertices.size(), (void*)&vertices[0]);
+        if(!packed.empty())
+            block->indices.UpdateContent(indexOffset, packed.size(), &packed[0]);
+        
+        block->groups++;
+        
+        allocation.block = block;
+        allocation.vao = block->vao;
+        allocation.firstVertex = firstVertex;
+        allocation.vertexCount = vertexCount;
+        allocation.indexOffset = indexOffset;
+        allocation.indexBytes = indexBytes;
+        type = indexType;
+        return true;
+    }
+    
+    bool CBufferArena::Allocate(const CVertexLayout& layout, GL_BUFFER_USAGE_HINT usage, const std::vector<uchar8>& vertices, const std::vector<uint32>& indices, SBufferArenaAllocation& allocation, INDEX_TYPE& type)
+    {
+        uint32 stride = layout.GetStride();
+        uint32 key = layout.GetFormat().GetKey();
+        uint32 vertexCount = stride ? vertices.size() / stride : 0;
+        
+        for(uint32 i = 0; i < m_vBlocks.size(); i++)
+        {
+            SBufferArenaBlock* block = m_vBlocks[i];
+            if(block->formatKey == key && block->usage == usage && AllocateInBlock(block, vertices, indices, allocation, type))
+                return true;
+        }
+        
+        //a new block, a group larger than a block gets a block of its size
+        INDEX_TYPE indexType;
+        if(stride == 0 || !SelectIndexType(vertexCount, indexType))
+        {
+            std::cerr<<"CBufferArena: [ERROR] cant allocate "<<vertexCount<<" vertices, 32 bits indices are not supported\n";
+            return false;
+        }
+        
+        uint32 vertexCapacity = std::max(std::min((uint32)kBUFFER_ARENA_VERTEX_BLOCK_SIZE / stride, (uint32)kBUFFER_ARENA_MAX_BLOCK_VERTICES), vertexCount);
+        uint32 indexCapacity = std::max((uint32)kBUFFER_ARENA_INDEX_BLOCK_SIZE, (uint32)indices.size() * GetIndexTypeSize(indexType));
+        
+        SBufferArenaBlock* block = CreateBlock(layout, usage, vertexCapacity, indexCapacity);
+        if(!block)
+        {
+            std::cerr<<"CBufferArena: [ERROR] cant create a block of "<<vertexCapacity * stride<<" + "<<indexCapacity<<" bytes\n";
+            return false;
+        }
+        
+        m_vBlocks.push_back(block);
+        return AllocateInBlock(block, vertices, indices, allocation, type);
+    }
+    
+    void CBufferArena::Release(SBufferArenaAllocation& allocation)
+    {
+        SBufferArenaBlock* block = allocation.block;
+        if(!block)
+            return;
+        
+        block->vertexRanges.Release(allocation.firstVertex, allocation.vertexCount);
+        block->indexRanges.Release(allocation.indexOffset, allocation.indexBytes);
+        allocation = SBufferArenaAllocation();
+        
+        if(--block->groups > 0)
+            return;
+        
+        m_vBlocks.erase(std::find(m_vBlocks.begin(), m_vBlocks.end(), block));
+        DestroyBlock(block);
+    }
+    
+    GLuint CBufferArena::CreateVertexArray(const SBufferArenaAllocation& allocation, CVertexBuffer& indices)
+    {
+        SBufferArenaBlock* block = allocation.block;
+        if(block == NULL)
+            return 0;
+        
+        CRenderStateCache& cache = CRenderStateCache::Instance();
+        GLuint vao = 0;
+        glGenVertexArraysOES(1, &vao);
+        cache.BindVertexArray(vao);
+        
+        block->vertices.Bind();
+        block->layout.MapAttributes();
+        
+        indices.Bind();
+        block->vertices.Unbind();
+        cache.BindVertexArray(0);
+        return vao;
+    }
+    
+    GLuint CBufferArena::CreateVertexArray(const SBufferArenaAllocation& allocation)
+    {
+        SBufferArenaBlock* block = allocation.block;
+        if(block == NULL)
+            return 0;
+        
+        GLuint vao = 0;
+        glGenVertexArraysOES(1, &vao);
+        CRenderStateCache::Instance().BindVertexArray(vao);
+        
+        block->vertices.Bind();
+        block->layout.MapAttributes();
+        
+        block->indices.Bind();
+        block->vertices.Unbind();
+        return vao;
+    }
+    
+    SBufferArenaStats CBufferArena::GetStats() const
+    {
+        SBufferArenaStats stats;
+        memset(&stats, 0, sizeof(SBufferArenaStats));
+        stats.blocks = m_vBlocks.size();
+        
+        uint32 free = 0, largest = 0;
+        for(uint32 i = 0; i < m_vBlocks.size(); i++)
+        {
+            const SBufferArenaBlock* block = m_vBlocks[i];
+            stats.groups += block->groups;
+            stats.vertexCapacity += block->vertexRanges.GetCapacity() * block->stride;
+            stats.vertexUsed += block->vertexRanges.GetUsed() * block->stride;
+            stats.indexCapacity += block->indexRanges.GetCapacity();
+            stats.indexUsed += block->indexRanges.GetUsed();
+            
+            free += (block->vertexRanges.GetCapacity() - block->vertexRanges.GetUsed()) * block->stride;
+            free += block->indexRanges.GetCapacity() - block->indexRanges.GetUsed();
+            largest += block->vertexRanges.GetLargestFreeRange() * block->stride + block->indexRanges.GetLargestFreeRange();
+        }
+        
+        stats.fragmentation = free ? 1.f - (float32)largest / (float32)free : 0.f;
+        return stats;
+    }
+
+#ifdef DEBUG
+    void CBufferArena::PrintReport() const
+    {
+        SBufferArenaStats stats = GetStats();
+        const SRenderStateCounters& counters = CRenderStateCache::Instance().GetFrameCounters();
+        
+        std::cerr<<"CBufferArena: [INFO] "<<stats.groups<<" groups in "<<stats.blocks<<" blocks\n";
+        std::cerr<<"    vertices:      "<<stats.vertexUsed<<" / "<<stats.vertexCapacity<<" bytes\n";
+        std::cerr<<"    indices:       "<<stats.indexUsed<<" / "<<stats.indexCapacity<<" bytes\n";
+        std::cerr<<"    fragmentation: "<<stats.fragmentation * 100.f<<" %\n";
+        std::cerr<<"    vertex array binds last frame: "<<counters.vertexArrayIssued<<" issued, "<<counters.vertexArrayElided<<" elided\n";
+    }
+#endif
+}
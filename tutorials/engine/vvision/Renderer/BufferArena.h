@@ -0,0 +1,184 @@
+/* BufferArena.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_BUFFER_ARENA_H
+#define VVISION_BUFFER_ARENA_H
+
+#include "types.h"
+#include "Singleton.h"
+#include "VertexFormat.h"
+
+namespace vvision
+{
+    /** default size of the blocks of the arena, a larger group gets a block of its size*/
+    enum
+    {
+        kBUFFER_ARENA_VERTEX_BLOCK_SIZE = 256 * 1024,
+        kBUFFER_ARENA_INDEX_BLOCK_SIZE = 128 * 1024,
+        
+        /** vertices of a shared block, every group of the block can be drawn with 16 bits indices*/
+        kBUFFER_ARENA_MAX_BLOCK_VERTICES = 0x10000
+    };
+    
+    /** first fit free list over a range of offsets ( no memory is owned), a released range is merged with its free neighbours*/
+    class CRangeAllocator
+    {
+    public:
+        
+        /** constructor, empty range*/
+        CRangeAllocator();
+        
+        /** forget every allocation, the whole range is free*/
+        void Reset(uint32 capacity);
+        
+        /** allocate size units aligned on alignment ( power of two)
+         * @return false if no free range is large enough
+         */
+        bool Allocate(uint32 size, uint32 alignment, uint32& offset);
+        
+        /** release a range returned by Allocate*/
+        void Release(uint32 offset, uint32 size);
+        
+        /** size of the range*/
+        inline uint32 GetCapacity() const {return m_uCapacity;}
+        
+        /** allocated units*/
+        inline uint32 GetUsed() const {return m_uUsed;}
+        
+        /** number of free ranges*/
+        inline uint32 GetFreeRangeCount() const {return m_mFree.size();}
+        
+        /** size of the largest free range, the largest allocation that can succeed ( without alignment)*/
+        uint32 GetLargestFreeRange() const;
+    
+    private:
+        
+        /** free ranges, offset -> size*/
+        std::map<uint32, uint32> m_mFree;
+        
+        /** range size and allocated units*/
+        uint32 m_uCapacity;
+        uint32 m_uUsed;
+    };
+    
+    /** a vertex and an index buffer shared by groups of the same vertex format, check BufferArena.cpp*/
+    struct SBufferArenaBlock;
+    
+    class CVertexBuffer;
+    
+    /** ranges of a mesh group in the arena*/
+    struct SBufferArenaAllocation
+    {
+        /** constructor, nothing allocated*/
+        SBufferArenaAllocation()
+        : block(NULL), vao(0), firstVertex(0), vertexCount(0), indexOffset(0), indexBytes(0)
+        {}
+        
+        /** block of the group*/
+        SBufferArenaBlock* block;
+        
+        /** vertex array object of the block, shared by its groups*/
+        GLuint vao;
+        
+        /** vertices in the block, the indices of the group are rebased on firstVertex*/
+        uint32 firstVertex;
+        uint32 vertexCount;
+        
+        /** indices in the element buffer of the block, in bytes*/
+        uint32 indexOffset;
+        uint32 indexBytes;
+    };
+    
+    /** arena usage*/
+    struct SBufferArenaStats
+    {
+        /** blocks and groups allocated in them*/
+        uint32 blocks;
+        uint32 groups;
+        
+        /** vertex and index memory, in bytes*/
+        uint32 vertexCapacity;
+        uint32 vertexUsed;
+        uint32 indexCapacity;
+        uint32 indexUsed;
+        
+        /** 1 - largest free ranges / free memory, 0 when the free memory of each block is contiguous*/
+        float32 fragmentation;
+    };
+    
+    /** gpu memory of the mesh groups: instead of a vbo, an ibo and a vao per group, groups of the same vertex format and usage
+     * get ranges of large shared buffers and draw through the vao of their block with rebased indices
+     * ( gl es 2 has no base vertex draw). consecutive draws of a block need no vertex array or buffer change.
+     */
+    CREATE_SINGLETON( CBufferArena )
+    
+    public :
+    
+    /** upload the vertices and indices of a group
+     * @param vertices vertices packed in layout
+     * @param indices indices relative to the first vertex of the group, rebased and packed in the narrowest type for their block position
+     * @param type index type of the group
+     * @return false if the group cant be allocated ( its vertex count needs 32 bits indices and OES_element_index_uint is missing)
+     */
+    bool Allocate(const CVertexLayout& layout, GL_BUFFER_USAGE_HINT usage, const std::vector<uchar8>& vertices, const std::vector<uint32>& indices, SBufferArenaAllocation& allocation, INDEX_TYPE& type);
+    
+    /** release the ranges of a group, a block without groups is deleted*/
+    void Release(SBufferArenaAllocation& allocation);
+    
+    /** create a vertex array reading the vertices of the block of allocation with another element buffer
+     * ( the caller deletes it, before the block is released)
+     */
+    GLuint CreateVertexArray(const SBufferArenaAllocation& allocation, CVertexBuffer& indices);
+    
+    /** create a vertex array reading the vertices and the indices of the block of allocation, the caller adds its own attributes
+     * ( it is left bound, the caller deletes it before the block is released)
+     */
+    GLuint CreateVertexArray(const SBufferArenaAllocation& allocation);
+    
+    /** current usage*/
+    SBufferArenaStats GetStats() const;
+
+#ifdef DEBUG
+    /** print the usage and the vertex array binds of the last frame*/
+    void PrintReport() const;
+#endif
+    
+    private :
+    
+    /** allocate the group in block, false if it does not fit*/
+    bool AllocateInBlock(SBufferArenaBlock* block, const std::vector<uchar8>& vertices, const std::vector<uint32>& indices, SBufferArenaAllocation& allocation, INDEX_TYPE& type);
+    
+    /** blocks*/
+    std::vector<SBufferArenaBlock*> m_vBlocks;
+    
+    /** constructor*/
+    CBufferArena() {}
+    
+    /** destructor*/
+    ~CBufferArena();
+    
+    /** not allowed*/
+    CBufferArena(const CBufferArena&);
+    
+    /** not allowed*/
+    CBufferArena& operator=(const CBufferArena&);
+};
+}
+
+#endif
@@ -0,0 +1,208 @@
+/*
+ *  CommandBuffer.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "CommandBuffer.h"
+
+namespace vvision
+{
+    /** command layouts, every command starts with its header and is padded to 8 bytes ( pointers stay aligned)*/
+    struct SCommandUseProgram
+    {
+        SRenderCommandHeader header;
+        CShader* shader;
+    };
+    
+    struct SCommandBindMaterial
+    {
+        SRenderCommandHeader header;
+        CShader* shader;
+        CMaterial* material;
+    };
+    
+    struct SCommandUniformMatrix4
+    {
+        SRenderCommandHeader header;
+        int32 location;
+        CShader* shader;
+        float32 value[16];
+    };
+    
+    struct SCommandBindVertexArray
+    {
+        SRenderCommandHeader header;
+        GLuint vao;
+    };
+    
+    struct SCommandDrawElements
+    {
+        SRenderCommandHeader header;
+        GLenum mode;
+        uint32 count;
+        GLenum type;
+        uint32 offset;
+    };
+    
+    struct SCommandSetEnabled
+    {
+        SRenderCommandHeader header;
+        GLenum cap;
+        uint32 enabled;
+    };
+    
+    struct SCommandDepthMask
+    {
+        SRenderCommandHeader header;
+        uint32 enabled;
+    };
+    
+    /** initial storage, enough for a few hundred draws*/
+    #define VV_COMMAND_BUFFER_INITIAL_SIZE (16 * 1024)
+    
+    CCommandBuffer::CCommandBuffer()
+    : m_uSize(0), m_uCommandCount(0)
+    {
+        m_vData.resize(VV_COMMAND_BUFFER_INITIAL_SIZE);
+    }
+    
+    CCommandBuffer::~CCommandBuffer()
+    {
+        m_vData.clear();
+    }
+    
+    void CCommandBuffer::Reset()
+    {
+        m_uSize = 0;
+        m_uCommandCount = 0;
+    }
+    
+    void* CCommandBuffer::Allocate(RENDER_COMMAND type, uint32 size)
+    {
+        size = (size + 7) & ~7u;
+        
+        if(m_uSize + size > m_vData.size())
+            m_vData.resize((m_uSize + size) * 2);
+        
+        SRenderCommandHeader* header = (SRenderCommandHeader*)&m_vData[m_uSize];
+        header->type = (ushort16)type;
+        header->size = (ushort16)size;
+        
+        m_uSize += size;
+        m_uCommandCount++;
+        return header;
+    }
+    
+    void CCommandBuffer::UseProgram(CShader* shader)
+    {
+        SCommandUseProgram* cmd = (SCommandUseProgram*)Allocate(kRENDER_COMMAND_USE_PROGRAM, sizeof(SCommandUseProgram));
+        cmd->shader = shader;
+    }
+    
+    void CCommandBuffer::BindMaterial(CShader* shader, CMaterial* material)
+    {
+        SCommandBindMaterial* cmd = (SCommandBindMaterial*)Allocate(kRENDER_COMMAND_BIND_MATERIAL, sizeof(SCommandBindMaterial));
+        cmd->shader = shader;
+        cmd->material = material;
+    }
+    
+    void CCommandBuffer::UniformMatrix4(CShader* shader, int32 location, const float32* value)
+    {
+        SCommandUniformMatrix4* cmd = (SCommandUniformMatrix4*)Allocate(kRENDER_COMMAND_UNIFORM_MATRIX4, sizeof(SCommandUniformMatrix4));
+        cmd->location = location;
+        cmd->shader = shader;
+        memcpy(cmd->value, value, sizeof(cmd->value));
+    }
+    
+    void CCommandBuffer::BindVertexArray(GLuint vao)
+    {
+        SCommandBindVertexArray* cmd = (SCommandBindVertexArray*)Allocate(kRENDER_COMMAND_BIND_VERTEX_ARRAY, sizeof(SCommandBindVertexArray));
+        cmd->vao = vao;
+    }
+    
+    void CCommandBuffer::DrawElements(GLenum mode, uint32 count, GLenum type, uint32 offset)
+    {
+        SCommandDrawElements* cmd = (SCommandDrawElements*)Allocate(kRENDER_COMMAND_DRAW_ELEMENTS, sizeof(SCommandDrawElements));
+        cmd->mode = mode;
+        cmd->count = count;
+        cmd->type = type;
+        cmd->offset = offset;
+    }
+    
+    void CCommandBuffer::SetEnabled(GLenum cap, bool enabled)
+    {
+        SCommandSetEnabled* cmd = (SCommandSetEnabled*)Allocate(kRENDER_COMMAND_SET_ENABLED, sizeof(SCommandSetEnabled));
+        cmd->cap = cap;
+        cmd->enabled = enabled ? 1 : 0;
+    }
+    
+    void CCommandBuffer::DepthMask(bool enabled)
+    {
+        SCommandDepthMask* cmd = (SCommandDepthMask*)Allocate(kRENDER_COMMAND_DEPTH_MASK, sizeof(SCommandDepthMask));
+        cmd->enabled = enabled ? 1 : 0;
+    }
+    
+    void CCommandBuffer::Execute(IRenderBackend& backend) const
+    {
+        uint32 position = 0;
+        while(position < m_uSize)
+        {
+            const SRenderCommandHeader* header = (const SRenderCommandHeader*)&m_vData[position];
+            
+            switch (header->type)
+            {
+                case kRENDER_COMMAND_USE_PROGRAM:
+                {
+                    const SCommandUseProgram* cmd = (const SCommandUseProgram*)header;
+                    backend.UseProgram(cmd->shader);
+                    break;
+                }
+                case kRENDER_COMMAND_BIND_MATERIAL:
+                {
+                    const SCommandBindMaterial* cmd = (const SCommandBindMaterial*)header;
+                    backend.BindMaterial(cmd->shader, cmd->material);
+                    break;
+                }
+                case kRENDER_COMMAND_UNIFORM_MATRIX4:
+                {
+                    const SCommandUniformMatrix4* cmd = (const SCommandUniformMatrix4*)header;
+                    backend.UniformMatrix4(cmd->shader, cmd->location, cmd->value);
+                    break;
+                }
+                case kRENDER_COMMAND_BIND_VERTEX_ARRAY:
+                {
+                    const SCommandBindVertexArray* cmd = (const SCommandBindVertexArray*)header;
+                    backend.BindVertexArray(cmd->vao);
+                    break;
+                }
+                case kRENDER_COMMAND_DRAW_ELEMENTS:
+                {
+                    const SCommandDrawElements* cmd = (const SCommandDrawElements*)header;
+                    backend.DrawElements(cmd->mode, cmd->count, cmd->type, cmd->offset);
+                    break;
+                }
+                case kRENDER_COMMAND_SET_ENABLED:
+                {
+                    const SCommandSetEnabled* cmd = (const SCommandSetEnabled*)header;
+                    backend.SetEnabled(cmd->cap, cmd->enabled != 0);
+                    break;
+                }
+                case kRENDER_COMMAND_DEPTH_MASK:
+                {
+                    const SCommandDepthMask* cmd = (const SCommandDepthMask*)header;
+                    backend.DepthMask(cmd->enabled != 0);
+                    break;
+                }
+                default:
+                    std::cerr<<"CCommandBuffer: [ERROR] unknown command "<<header->type<<"\n";
+                    return;
+            }
+            
+            position += header->size;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/* CommandBuffer.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef VVISION_COMMAND_BUFFER_H
+#define VVISION_COMMAND_BUFFER_H
+
+#include "types.h"
+#include "RenderBackend.h"
+
+namespace vvision
+{
+    /** header of a recorded command, the command data follows*/
+    struct SRenderCommandHeader
+    {
+        /** RENDER_COMMAND*/
+        ushort16 type;
+        
+        /** size of the command in bytes, header included*/
+        ushort16 size;
+    };
+    
+    /** linear buffer of render commands.
+     * recording only writes to memory ( no gl call), so a buffer can be recorded on any thread as long as a single thread
+     * records it. the buffer is replayed on a IRenderBackend by the thread that owns the context.
+     * the memory is kept by Reset, a buffer stops allocating once it has recorded its biggest frame.
+     */
+    class CCommandBuffer
+    {
+    public:
+        
+        /** constructor*/
+        CCommandBuffer();
+        
+        /** destructor*/
+        ~CCommandBuffer();
+        
+        /** drop the recorded commands*/
+        void Reset();
+        
+        /** record commands, shader and material must stay valid until the buffer is executed*/
+        void UseProgram(CShader* shader);
+        void BindMaterial(CShader* shader, CMaterial* material);
+        void UniformMatrix4(CShader* shader, int32 location, const float32* value);
+        void BindVertexArray(GLuint vao);
+        void DrawElements(GLenum mode, uint32 count, GLenum type, uint32 offset);
+        void SetEnabled(GLenum cap, bool enabled);
+        void DepthMask(bool enabled);
+        
+        /** replay the recorded commands on backend, the commands are kept ( a buffer can be executed several times)*/
+        void Execute(IRenderBackend& backend) const;
+        
+        /** number of recorded commands*/
+        inline uint32 GetCommandCount() const {return m_uCommandCount;}
+        
+        /** size of the recorded commands in bytes*/
+        inline uint32 GetSize() const {return m_uSize;}
+        
+        /** check if nothing was recorded*/
+        inline bool IsEmpty() const {return m_uCommandCount == 0;}
+        
+    private:
+        
+        /** reserve a command of size bytes ( header included) at the end of the buffer*/
+        void* Allocate(RENDER_COMMAND type, uint32 size);
+        
+        /** storage ( grows, never shrinks)*/
+        std::vector<uchar8> m_vData;
+        
+        /** bytes used in m_vData*/
+        uint32 m_uSize;
+        
+        /** number of recorded commands*/
+        uint32 m_uCommandCount;
+        
+        /** not allowed*/
+        CCommandBuffer(const CCommandBuffer&);
+        
+        /** not allowed*/
+        CCommandBuffer& operator=(const CCommandBuffer&);
+    };
+}
+
+#endif
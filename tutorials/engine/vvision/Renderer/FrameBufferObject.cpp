@@ -8,6 +8,7 @@
  */
 
 #include "FrameBufferObject.h"
+#include "RenderStateCache.h"
 #include <stdio.h>
 
 namespace vvision
@@ -20,6 +21,7 @@ namespace vvision
     
     CFrameBufferObject::~CFrameBufferObject()
     {
+        CRenderStateCache::Instance().OnDeleteFramebuffer(m_uID);
         glDeleteFramebuffers(1, &m_uID);
     }
     
@@ -74,12 +76,12 @@ namespace vvision
     }
     void CFrameBufferObject::Bind()
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, m_uID);
+        CRenderStateCache::Instance().BindFramebuffer(m_uID);
     }
     
     void CFrameBufferObject::Disable()
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        CRenderStateCache::Instance().BindFramebuffer(0);
     }
     
     
@@ -135,12 +137,12 @@ namespace vvision
     
     bool CFrameBufferObject::_GuardedBind()
     {
-        // Only binds if id is different than the currently bound id
-        glGetIntegerv( GL_FRAMEBUFFER_BINDING, &m_uSaveID );
+        // Only binds if id is different than the currently bound id ( served by the state cache, no glGet)
+        m_uSaveID = (GLint)CRenderStateCache::Instance().GetFramebuffer();
         
         if (m_uID != (GLuint)m_uSaveID)
         {
-            glBindFramebuffer(GL_FRAMEBUFFER, m_uID);
+            CRenderStateCache::Instance().BindFramebuffer(m_uID);
             return true;
         }
         
@@ -155,7 +157,7 @@ namespace vvision
         // Returns id binding to the previously enabled fbo
         if (m_uID != (GLuint)m_uSaveID) 
         {
-            glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)m_uSaveID);
+            CRenderStateCache::Instance().BindFramebuffer((GLuint)m_uSaveID);
             return true;
         } 
         
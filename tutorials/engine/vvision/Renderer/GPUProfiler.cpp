@@ -0,0 +1,146 @@
+/*
+ *  GPUProfiler.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "GPUProfiler.h"
+#include <string.h>
+
+namespace vvision
+{
+    CGPUProfileScope::CGPUProfileScope(const char8* name)
+    {
+        CGPUProfiler::Instance().Begin(name);
+    }
+    
+    CGPUProfileScope::~CGPUProfileScope()
+    {
+        CGPUProfiler::Instance().End();
+    }
+    
+    CGPUProfiler::CGPUProfiler()
+    : m_iSupported(-1), m_bActive(false), m_uNested(0)
+    {
+    }
+    
+    bool CGPUProfiler::IsSupported()
+    {
+        if(m_iSupported == -1)
+        {
+#ifdef GL_EXT_disjoint_timer_query
+            const char8* extensions = (const char8*)glGetString(GL_EXTENSIONS);
+            m_iSupported = extensions && strstr(extensions, "GL_EXT_disjoint_timer_query") ? 1 : 0;
+#else
+            m_iSupported = 0;
+#endif
+        }
+        return m_iSupported == 1;
+    }
+    
+    void CGPUProfiler::BeginFrame()
+    {
+#ifdef GL_EXT_disjoint_timer_query
+        if(m_vPending.empty() || !CProfiler::Instance().IsEnabled())
+            return;
+        
+        //results come in issue order, stop at the first one the gpu has not finished
+        uint32 ready = 0;
+        for(; ready < m_vPending.size(); ready++)
+        {
+            GLuint available = GL_FALSE;
+            glGetQueryObjectuivEXT(m_vPending[ready].query, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+            if(!available)
+                break;
+        }
+        
+        if(ready == 0)
+            return;
+        
+        //a disjoint operation makes every result since the last check meaningless
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        
+        CProfiler& profiler = CProfiler::Instance();
+        for(uint32 i = 0; i < ready; i++)
+        {
+            const SGPUQuery& query = m_vPending[i];
+            if(!disjoint)
+            {
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64vEXT(query.query, GL_QUERY_RESULT_EXT, &nanoseconds);
+                profiler.AddGPUEvent(query.name, query.cpuStart, query.cpuStart + (float64)nanoseconds * 1e-9);
+            }
+            m_vFree.push_back(query.query);
+        }
+        m_vPending.erase(m_vPending.begin(), m_vPending.begin() + ready);
+#endif
+    }
+    
+    void CGPUProfiler::Begin(const char8* name)
+    {
+        if(m_bActive)
+        {
+            m_uNested++;
+            return;
+        }
+        
+        if(!IsSupported() || !CProfiler::Instance().IsEnabled() || m_vPending.size() >= kGPU_PROFILER_MAX_QUERIES)
+            return;
+        
+#ifdef GL_EXT_disjoint_timer_query
+        SGPUQuery query;
+        if(m_vFree.empty())
+            glGenQueriesEXT(1, &query.query);
+        else
+        {
+            query.query = m_vFree.back();
+            m_vFree.pop_back();
+        }
+        query.name = name;
+        query.cpuStart = CTimer::Now();
+        
+        glBeginQueryEXT(GL_TIME_ELAPSED_EXT, query.query);
+        m_vPending.push_back(query);
+        m_bActive = true;
+#endif
+    }
+    
+    void CGPUProfiler::End()
+    {
+        if(m_uNested > 0)
+        {
+            m_uNested--;
+            return;
+        }
+        
+        if(!m_bActive)
+            return;
+        
+#ifdef GL_EXT_disjoint_timer_query
+        glEndQueryEXT(GL_TIME_ELAPSED_EXT);
+#endif
+        m_bActive = false;
+    }
+    
+    void CGPUProfiler::Release()
+    {
+#ifdef GL_EXT_disjoint_timer_query
+        if(m_bActive)
+            glEndQueryEXT(GL_TIME_ELAPSED_EXT);
+        
+        for(uint32 i = 0; i < m_vPending.size(); i++)
+            m_vFree.push_back(m_vPending[i].query);
+        
+        if(!m_vFree.empty())
+            glDeleteQueriesEXT(m_vFree.size(), &m_vFree[0]);
+#endif
+        m_vPending.clear();
+        m_vFree.clear();
+        m_bActive = false;
+        m_uNested = 0;
+    }
+}
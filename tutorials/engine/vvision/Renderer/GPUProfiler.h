@@ -0,0 +1,124 @@
+/* GPUProfiler.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_GPU_PROFILER_H
+#define VVISION_GPU_PROFILER_H
+
+#include "types.h"
+#include "Singleton.h"
+#include "Profiler.h"
+
+#ifdef VVISION_PROFILER_ENABLED
+/** time the gl commands of the enclosing block on the gpu ( and on the cpu), name must be a string literal*/
+#define VV_PROFILE_GPU_SCOPE(name) VV_PROFILE_SCOPE(name); vvision::CGPUProfileScope VV_PROFILE_CONCAT(vvGPUProfileScope, __LINE__)(name)
+#else
+#define VV_PROFILE_GPU_SCOPE(name)
+#endif
+
+namespace vvision
+{
+    enum
+    {
+        /** queries in flight, a scope is not timed when they are all waiting for the gpu*/
+        kGPU_PROFILER_MAX_QUERIES = 64
+    };
+    
+    /** times the gl commands of its lifetime, check VV_PROFILE_GPU_SCOPE*/
+    class CGPUProfileScope
+    {
+    public:
+        
+        /** start the scope*/
+        CGPUProfileScope(const char8* name);
+        
+        /** end the scope*/
+        ~CGPUProfileScope();
+        
+    private:
+        
+        /** not allowed*/
+        CGPUProfileScope(const CGPUProfileScope&);
+        
+        /** not allowed*/
+        CGPUProfileScope& operator=(const CGPUProfileScope&);
+    };
+    
+    /** gpu timing with EXT_disjoint_timer_query.
+     * a scope issues a GL_TIME_ELAPSED_EXT query, its result is read back frames later without stalling ( BeginFrame) and given to CProfiler
+     * as a gpu event placed at the cpu time of the scope. the extension has one active query at a time: gpu scopes do not nest, a nested scope is ignored.
+     * results of an interval where the gpu was disjoint ( GL_GPU_DISJOINT_EXT, power state change...) are dropped.
+     * the ios sdk does not declare the extension, the profiler is then unsupported and every call is a no-op.
+     */
+    CREATE_SINGLETON( CGPUProfiler )
+    
+    public :
+    
+    /** check if the extension is available ( needs a current context)*/
+    bool IsSupported();
+    
+    /** read back the results that are available, call once per frame*/
+    void BeginFrame();
+    
+    /** start/end timing the gl commands of a scope*/
+    void Begin(const char8* name);
+    void End();
+    
+    /** delete the queries ( before the context is destroyed)*/
+    void Release();
+    
+private:
+    
+    /** not allowed*/
+    CGPUProfiler();
+    
+    /** not allowed*/
+    ~CGPUProfiler() {}
+    
+    /** not allowed*/
+    CGPUProfiler(const CGPUProfiler&);
+    
+    /** not allowed*/
+    CGPUProfiler& operator=(const CGPUProfiler&);
+    
+    /** an issued query*/
+    struct SGPUQuery
+    {
+        GLuint query;
+        const char8* name;
+        float64 cpuStart;
+    };
+    
+    /** 1 supported, 0 not, -1 unknown*/
+    int32 m_iSupported;
+    
+    /** queries waiting for their result, in issue order*/
+    std::vector<SGPUQuery> m_vPending;
+    
+    /** queries ready to be reused*/
+    std::vector<GLuint> m_vFree;
+    
+    /** a query is active*/
+    bool m_bActive;
+    
+    /** nested scopes ignored inside the active one*/
+    uint32 m_uNested;
+};
+}
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ *  InstancedRenderer.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "InstancedRenderer.h"
+#include "RenderStateCache.h"
+#include "ShaderPermutation.h"
+#include "Profiler.h"
+#include <string.h>
+#include <algorithm>
+
+/** transforms streamed per Render before the stream grows ( 1024 instances)*/
+#define VV_INSTANCED_STREAM_SIZE (1024 * sizeof(mat4f))
+
+namespace vvision
+{
+    /** -1 unknown, 0 not supported, 1 supported*/
+    static int32 s_iInstancingSupported = -1;
+    
+    CInstancedRenderer::CInstancedRenderer()
+    : m_pMesh(NULL), m_cInstanceStream(kGL_BUFFER_TYPE_ARRAY, VV_INSTANCED_STREAM_SIZE)
+    {
+        memset(&m_sStats, 0, sizeof(SInstancedRenderStats));
+    }
+    
+    CInstancedRenderer::~CInstancedRenderer()
+    {
+        //gl unbinds a deleted vao, keep the cache in sync
+        CRenderStateCache::Instance().BindVertexArray(0);
+        for(uint32 g = 0; g < m_vGroups.size(); ++g)
+        {
+            SInstancedGroup& instanced = m_vGroups[g];
+            if(instanced.replicas.block != NULL)
+                CBufferArena::Instance().Release(instanced.replicas);
+            else if(instanced.vao != 0)
+                glDeleteVertexArraysOES(1, &instanced.vao);
+        }
+        m_vGroups.clear();
+    }
+    
+    bool CInstancedRenderer::IsInstancingSupported()
+    {
+#ifdef GL_EXT_instanced_arrays
+        if(s_iInstancingSupported == -1)
+        {
+            const char8* extensions = (const char8*)glGetString(GL_EXTENSIONS);
+            s_iInstancingSupported = extensions && strstr(extensions, "GL_EXT_instanced_arrays") ? 1 : 0;
+        }
+        return s_iInstancingSupported == 1;
+#else
+        return false;
+#endif
+    }
+    
+    uint32 CInstancedRenderer::GetShaderFeature()
+    {
+        return IsInstancingSupported() ? kSHADER_FEATURE_INSTANCING : kSHADER_FEATURE_INSTANCING_UNIFORMS;
+    }
+    
+    bool CInstancedRenderer::Create(CMeshBuffer* mesh)
+    {
+        assert(mesh != NULL && m_vGroups.empty());
+        m_pMesh = mesh;
+        m_cBbox.Reset();
+        
+        bool instancing = IsInstancingSupported();
+        if(instancing && !m_cInstanceStream.Create())
+            return false;
+        
+        for(uint32 g = 0; g < mesh->GroupsCount(); ++g)
+        {
+            CMeshGroup* group = mesh->GroupAtIndex(g);
+            if(group->GetDrawingMode() != kPRIMITIVE_TYPE_TRIANGLE || group->GetAllocation().block == NULL)
+            {
+#ifdef DEBUG
+                std::cerr<<"CInstancedRenderer: [WARNING] group "<<g<<" is not an allocated triangle list, it is not drawn\n";
+#endif
+                continue;
+            }
+            
+            SInstancedGroup instanced;
+            instanced.group = group;
+            instanced.material = group->GetMaterialIndex() >= 0 ? mesh->MaterialForGroup(group) : NULL;
+            instanced.vao = 0;
+            instanced.replicaIndexType = kINDEX_TYPE_UNSIGNED_SHORT;
+            instanced.copies = 1;
+            
+            if(!(instancing ? CreateInstancedGroup(instanced) : CreateReplicatedGroup(instanced)))
+                return false;
+            m_vGroups.push_back(instanced);
+            
+            m_cBbox.Add(group->GetBoundingBox().GetMin());
+            m_cBbox.Add(group->GetBoundingBox().GetMax());
+        }
+        return true;
+    }
+    
+    bool CInstancedRenderer::CreateInstancedGroup(SInstancedGroup& instanced)
+    {
+#ifdef GL_EXT_instanced_arrays
+        instanced.vao = CBufferArena::Instance().CreateVertexArray(instanced.group->GetAllocation());
+        if(instanced.vao == 0)
+            return false;
+        
+        //the columns advance once per instance
+        for(uint32 c = 0; c < 4; c++)
+        {
+            glEnableVertexAttribArray(ATTRIB_INSTANCE_MODEL + c);
+            glVertexAttribDivisorEXT(ATTRIB_INSTANCE_MODEL + c, 1);
+        }
+        PointInstanceAttributes(0);
+        CRenderStateCache::Instance().BindVertexArray(0);
+        return true;
+#else
+        return false;
+#endif
+    }
+    
+    void CInstancedRenderer::PointInstanceAttributes(uint32 offset)
+    {
+        //a mat4 attribute reads one column per location
+        m_cInstanceStream.Bind();
+        for(uint32 c = 0; c < 4; c++)
+            glVertexAttribPointer(ATTRIB_INSTANCE_MODEL + c, 4, GL_FLOAT, GL_FALSE, sizeof(mat4f), (const GLvoid*)(size_t)(offset + c * 4 * sizeof(float32)));
+        m_cInstanceStream.Unbind();
+    }
+    
+    bool CInstancedRenderer::CreateReplicatedGroup(SInstancedGroup& instanced)
+    {
+        const std::vector<CGpuVertex>& vertices = instanced.group->GetVertices();
+        const std::vector<uint32>& indices = instanced.group->GetIndices();
+        if(vertices.empty() || indices.empty())
+            return false;
+        
+        //the copies keep 16 bits indices
+        uint32 copies = kSHADER_INSTANCING_UNIFORM_COUNT;
+        if(vertices.size() * copies > kBUFFER_ARENA_MAX_BLOCK_VERTICES)
+            copies = std::max(1u, (uint32)(kBUFFER_ARENA_MAX_BLOCK_VERTICES / vertices.size()));
+        
+        //the copy index goes in the bones attribute, the group is not skinned ( the copies are in draw order)
+        std::vector<CGpuVertex> replicated;
+        std::vector<uint32> replicatedIndices;
+        replicated.reserve(vertices.size() * copies);
+        replicatedIndices.reserve(indices.size() * copies);
+        for(uint32 c = 0; c < copies; c++)
+        {
+            for(uint32 v = 0; v < vertices.size(); v++)
+            {
+                CGpuVertex vertex = vertices[v];
+                vertex.boneIndices = vec4f((float32)c, 0.f, 0.f, 0.f);
+                vertex.boneWeights = vec4f(0.f, 0.f, 0.f, 0.f);
+                replicated.push_back(vertex);
+            }
+            for(uint32 i = 0; i < indices.size(); i++)
+                replicatedIndices.push_back(c * vertices.size() + indices[i]);
+        }
+        
+        SVertexFormat format = SVertexFormat::Compact(replicated);
+        format.boneIndices = kVERTEX_ATTRIB_FORMAT_UBYTE;
+        CVertexLayout layout(format);
+        
+        std::vector<uchar8> packed;
+        layout.Encode(replicated, packed);
+        if(!CBufferArena::Instance().Allocate(layout, kGL_BUFFER_USAGE_HINT_STATIC, packed, replicatedIndices, instanced.replicas, instanced.replicaIndexType))
+        {
+            std::cerr<<"CInstancedRenderer: [ERROR] cant allocate "<<copies<<" copies of a group of "<<vertices.size()<<" vertices\n";
+            return false;
+        }
+        
+        instanced.vao = instanced.replicas.vao;
+        instanced.copies = copies;
+        return true;
+    }
+    
+    void CInstancedRenderer::Render(CShader* shader, const mat4f& view, const mat4f& projection)
+    {
+        VV_PROFILE_SCOPE("CInstancedRenderer::Render");
+        
+        assert(shader != NULL);
+        
+        memset(&m_sStats, 0, sizeof(SInstancedRenderStats));
+        m_sStats.instances = m_vInstances.size();
+        if(m_vGroups.empty() || m_vInstances.empty())
+            return;
+        
+        //instances out of the frustum
+        mat4f projectionView = projection * view;
+        m_vVisible.clear();
+        for(uint32 i = 0; i < m_vInstances.size(); ++i)
+        {
+            if(!m_cBbox.IsOutsideFrustum(projectionView * m_vInstances[i]))
+                m_vVisible.push_back(m_vInstances[i]);
+        }
+        
+        uint32 visible = m_vVisible.size();
+        m_sStats.culled = m_sStats.instances - visible;
+        if(visible == 0)
+            return;
+        
+        //the model matrix comes from the instance
+        shader->Set(U_MAT_PROJ_VIEW_MODEL, projectionView);
+        CRenderStateCache& cache = CRenderStateCache::Instance();
+        
+        if(IsInstancingSupported())
+        {
+#ifdef GL_EXT_instanced_arrays
+            //the draws of the previous frames still read their own part of the stream
+            uint32 offset = 0;
+            m_cInstanceStream.Begin();
+            if(!m_cInstanceStream.Write(&m_vVisible[0], visible * sizeof(mat4f), sizeof(float32), offset))
+            {
+                m_cInstanceStream.End();
+                return;
+            }
+            m_sStats.uploadedBytes = visible * sizeof(mat4f);
+            
+            for(uint32 g = 0; g < m_vGroups.size(); ++g)
+            {
+                const SInstancedGroup& instanced = m_vGroups[g];
+                m_cBackend.BindMaterial(shader, instanced.material);
+                cache.BindVertexArray(instanced.vao);
+                PointInstanceAttributes(offset);
+                glDrawElementsInstancedEXT(GL_TRIANGLES, instanced.group->GetIndexCount(), instanced.group->GetIndexType(), instanced.group->GetIndexOffset(), visible);
+                m_sStats.draws++;
+            }
+            m_cInstanceStream.End();
+#endif
+        }
+        else
+        {
+            for(uint32 g = 0; g < m_vGroups.size(); ++g)
+            {
+                const SInstancedGroup& instanced = m_vGroups[g];
+                m_cBackend.BindMaterial(shader, instanced.material);
+                cache.BindVertexArray(instanced.vao);
+                
+                //a draw per batch of copies, the last one draws the copies it needs
+                uint32 indexCount = instanced.group->GetIndexCount();
+                for(uint32 first = 0; first < visible; first += instanced.copies)
+                {
+                    uint32 count = std::min(instanced.copies, visible - first);
+                    shader->Set(U_INSTANCE_MODELS, &m_vVisible[first][0], count);
+                    glDrawElements(GL_TRIANGLES, count * indexCount, instanced.replicaIndexType, (const GLvoid*)(size_t)instanced.replicas.indexOffset);
+                    m_sStats.draws++;
+                    m_sStats.uploadedBytes += count * sizeof(mat4f);
+                }
+            }
+        }
+    }
+
+#ifdef DEBUG
+    void CInstancedRenderer::PrintReport() const
+    {
+        std::cerr<<"CInstancedRenderer: [INFO] "<<m_sStats.instances<<" instances ( "<<m_sStats.culled<<" out of the frustum) in "<<m_sStats.draws<<" draws, "
+                 <<(IsInstancingSupported() ? "instanced arrays" : "uniform arrays")<<"\n";
+        std::cerr<<"    transforms: "<<m_sStats.uploadedBytes<<" bytes\n";
+        if(IsInstancingSupported())
+            m_cInstanceStream.PrintReport();
+    }
+#endif
+}
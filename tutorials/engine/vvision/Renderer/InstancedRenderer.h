@@ -0,0 +1,146 @@
+/* InstancedRenderer.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef VVISION_INSTANCED_RENDERER_H
+#define VVISION_INSTANCED_RENDERER_H
+
+#include "MeshBuffer.h"
+#include "StreamBuffer.h"
+#include "RenderBackend.h"
+
+namespace vvision
+{
+    /** draws of the last Render*/
+    struct SInstancedRenderStats
+    {
+        /** instances given, and those out of the frustum*/
+        uint32 instances;
+        uint32 culled;
+        
+        /** draw calls issued*/
+        uint32 draws;
+        
+        /** bytes of transforms uploaded ( instanced arrays) or set as uniforms ( uniform arrays)*/
+        uint32 uploadedBytes;
+    };
+    
+    /** draws many copies of a mesh, each with its own model matrix, in a handful of draw calls.
+     *
+     * with EXT_instanced_arrays the transforms of the visible instances stream in a CStreamBuffer read with a divisor of 1
+     * ( attribute instanceModel, ATTRIB_INSTANCE_MODEL) and every group is drawn once with glDrawElementsInstancedEXT:
+     * the shader permutation is kSHADER_FEATURE_INSTANCING.
+     * without it every group is replicated kSHADER_INSTANCING_UNIFORM_COUNT times in the arena, the copy index stored in the
+     * bones attribute, and the transforms are sent by batches in the uniform array instanceModels:
+     * the shader permutation is kSHADER_FEATURE_INSTANCING_UNIFORMS ( check GetShaderFeature).
+     *
+     * in both paths matProjViewModel holds the projection view matrix, the model matrix comes from the instance.
+     * the instances are culled against the frustum with the bounding box of the mesh. gl thread only.
+     */
+    class CInstancedRenderer
+    {
+    public:
+        
+        /** constructor*/
+        CInstancedRenderer();
+        
+        /** destructor, the mesh must still be allocated*/
+        ~CInstancedRenderer();
+        
+        /** draw the static triangle groups of mesh ( allocated, shared with other users), the mesh must outlive the renderer
+         * @return false if the instance buffer or the replicated groups cant be created
+         */
+        bool Create(CMeshBuffer* mesh);
+        
+        /** the instances, their transforms are copied*/
+        inline void SetInstances(const std::vector<mat4f>& transforms) {m_vInstances = transforms;}
+        inline void AddInstance(const mat4f& transform) {m_vInstances.push_back(transform);}
+        inline void ClearInstances() {m_vInstances.clear();}
+        inline uint32 GetInstanceCount() const {return m_vInstances.size();}
+        
+        /** draw the visible instances with shader ( already begun, the permutation of GetShaderFeature)*/
+        void Render(CShader* shader, const mat4f& view, const mat4f& projection);
+        
+        /** check if EXT_instanced_arrays is supported*/
+        static bool IsInstancingSupported();
+        
+        /** SHADER_FEATURE of the shader permutation Render expects on this device*/
+        static uint32 GetShaderFeature();
+        
+        /** stats of the last Render*/
+        inline const SInstancedRenderStats& GetStats() const {return m_sStats;}
+
+#ifdef DEBUG
+        /** print the stats of the last Render*/
+        void PrintReport() const;
+#endif
+    
+    private:
+        
+        /** a group of the mesh and how it is drawn*/
+        struct SInstancedGroup
+        {
+            CMeshGroup* group;
+            CMaterial* material;
+            
+            /** vertex array: the group with the instance stream ( instanced arrays), or the replicated group ( uniform arrays)*/
+            GLuint vao;
+            
+            /** replicated group, uniform arrays only*/
+            SBufferArenaAllocation replicas;
+            INDEX_TYPE replicaIndexType;
+            uint32 copies;
+        };
+        
+        /** create the vertex array reading the group and the instance stream*/
+        bool CreateInstancedGroup(SInstancedGroup& instanced);
+        
+        /** upload kSHADER_INSTANCING_UNIFORM_COUNT copies of the group*/
+        bool CreateReplicatedGroup(SInstancedGroup& instanced);
+        
+        /** point the instance attributes of the bound vertex array at the transforms written at offset in the stream*/
+        void PointInstanceAttributes(uint32 offset);
+        
+        /** mesh and its groups*/
+        CMeshBuffer* m_pMesh;
+        std::vector<SInstancedGroup> m_vGroups;
+        
+        /** bounding box of the mesh*/
+        CBoundingBox m_cBbox;
+        
+        /** transforms of the instances, and of the visible ones*/
+        std::vector<mat4f> m_vInstances;
+        std::vector<mat4f> m_vVisible;
+        
+        /** transforms of the visible instances ( instanced arrays)*/
+        CStreamBuffer m_cInstanceStream;
+        
+        /** material binding*/
+        CGLRenderBackend m_cBackend;
+        
+        /** stats*/
+        SInstancedRenderStats m_sStats;
+        
+        /** not allowed*/
+        CInstancedRenderer(const CInstancedRenderer&);
+        
+        /** not allowed*/
+        CInstancedRenderer& operator=(const CInstancedRenderer&);
+    };
+}
+
+#endif
@@ -8,15 +8,144 @@
  */
 
 #include "MeshBuffer.h"
+#include <algorithm>
 namespace vvision
 {
+    static SMeshResidencyStats s_sResidencyTotals;
+    
     CMeshGroup::~CMeshGroup()
     {
         m_vVertices.clear();
         m_vIndices.clear();
         m_iMaterialIndex = -1;
-        m_cVboVertices.Destroy();
-        m_cVboIndices.Destroy();
+        CBufferArena::Instance().Release(m_sAllocation);
+    }
+    
+    void CMeshGroup::BuildLods(std::vector<uint32>& indices)
+    {
+        indices = m_vIndices;
+        m_vLods.clear();
+        
+        SMeshLod full = {0, (uint32)m_vIndices.size(), 0.f};
+        m_vLods.push_back(full);
+        
+        if(m_uLodLevels == 0 || m_eDrawingMode != kPRIMITIVE_TYPE_TRIANGLE)
+            return;
+        
+        CBoundingBox bbox;
+        for(uint32 i = 0; i < m_vVertices.size(); i++)
+            bbox.Add(m_vVertices[i].pos);
+        float32 maxError = (bbox.GetMax() - bbox.GetMin()).length() * VV_MESH_LOD_MAX_ERROR;
+        
+        //every level is simplified from the full mesh, so its error is measured against it
+        std::vector<uint32> lod;
+        std::vector<uint32> clusters;
+        float32 reduction = 1.f;
+        for(uint32 l = 0; l < m_uLodLevels; l++)
+        {
+            reduction *= VV_MESH_LOD_REDUCTION;
+            uint32 target = (uint32)(m_vIndices.size() / 3 * reduction) * 3;
+            float32 error = SimplifyMesh(m_vVertices, m_vIndices, target, maxError, lod);
+            
+            //the error limit stopped the simplification before it was worth a level
+            const SMeshLod& previous = m_vLods.back();
+            if(lod.empty() || lod.size() > previous.indexCount * (1.f - VV_MESH_LOD_MIN_REDUCTION))
+                break;
+            
+            OptimizeVertexCache(lod, m_vVertices.size(), clusters);
+            
+            SMeshLod level = {(uint32)indices.size(), (uint32)lod.size(), std::max(error, previous.error)};
+            m_vLods.push_back(level);
+            indices.insert(indices.end(), lod.begin(), lod.end());
+        }
+    }
+    
+    void CMeshGroup::SetResidency(MESH_RESIDENCY residency)
+    {
+        //released copies can not come back, only a policy that keeps less is accepted
+        if(m_bHostReleased && residency != m_eResidency && residency != kMESH_RESIDENCY_DISCARD)
+        {
+            std::cerr<<"CMeshGroup: [ERROR] cant keep host copies that were already released\n";
+            return;
+        }
+        
+        m_eResidency = residency;
+        
+        //already on the gpu
+        if(m_eResidency != kMESH_RESIDENCY_KEEP && m_sAllocation.block != NULL)
+            ReleaseHostCopies();
+    }
+    
+    uint32 CMeshGroup::GetHostBytes() const
+    {
+        return m_vVertices.capacity() * sizeof(CGpuVertex) + m_vIndices.capacity() * sizeof(uint32) + m_vPositions.capacity() * sizeof(vec3f);
+    }
+    
+    void CMeshGroup::ReleaseHostCopies()
+    {
+        uint32 before = GetHostBytes();
+        
+        if(m_eResidency == kMESH_RESIDENCY_POSITIONS && m_vPositions.empty())
+        {
+            m_vPositions.resize(m_vVertices.size());
+            for(uint32 i = 0; i < m_vVertices.size(); i++)
+                m_vPositions[i] = m_vVertices[i].pos;
+        }
+        
+        //clear keeps the capacity, swap with an empty vector to free it
+        std::vector<CGpuVertex>().swap(m_vVertices);
+        if(m_eResidency == kMESH_RESIDENCY_DISCARD)
+        {
+            std::vector<vec3f>().swap(m_vPositions);
+            
+            //the meshlet culler rebuilds the index ranges of the visible meshlets from them every frame
+            if(m_vMeshlets.empty())
+                std::vector<uint32>().swap(m_vIndices);
+        }
+        m_bHostReleased = true;
+        
+        uint32 after = GetHostBytes();
+        if(after >= before)
+            return;
+        
+        s_sResidencyTotals.groups++;
+        s_sResidencyTotals.keptBytes += after;
+        s_sResidencyTotals.releasedBytes += before - after;
+    }
+    
+    const SMeshResidencyStats& GetMeshResidencyTotals()
+    {
+        return s_sResidencyTotals;
+    }
+    
+    uint32 CMeshGroup::SelectLod(float32 projected_size, uint32 current, float32 pixel_error) const
+    {
+        if(m_vLods.size() < 2)
+            return 0;
+        
+        //pixels covered by an object space unit
+        float32 diagonal = (m_cBbox.GetMax() - m_cBbox.GetMin()).length();
+        if(diagonal <= 0)
+            return 0;
+        float32 pixels = projected_size / diagonal;
+        
+        //the errors grow with the level: the coarsest level under the limit, with some margin each way
+        uint32 coarser = 0;
+        uint32 finer = 0;
+        for(uint32 l = 1; l < m_vLods.size(); l++)
+        {
+            float32 error = m_vLods[l].error * pixels;
+            if(error <= pixel_error * (1.f - VV_MESH_LOD_HYSTERESIS))
+                coarser = l;
+            if(error <= pixel_error * (1.f + VV_MESH_LOD_HYSTERESIS))
+                finer = l;
+        }
+        
+        if(current > finer)
+            return finer;
+        if(coarser > current)
+            return coarser;
+        return current;
     }
     
     CMeshBuffer::~CMeshBuffer()
@@ -34,4 +163,18 @@ namespace vvision
         }
         materials.clear();
     }
+    
+    void CMeshBuffer::SetResidency(MESH_RESIDENCY residency)
+    {
+        for(uint32 i = 0; i < groups.size(); i++)
+            groups[i]->SetResidency(residency);
+    }
+    
+    uint32 CMeshBuffer::GetHostBytes() const
+    {
+        uint32 bytes = 0;
+        for(uint32 i = 0; i < groups.size(); i++)
+            bytes += groups[i]->GetHostBytes();
+        return bytes;
+    }
 }
\ No newline at end of file
@@ -21,79 +21,90 @@
 #define CMESH_GROUP_INCLUDED
 
 #include "VertexBuffer.h"
+#include "VertexFormat.h"
+#include "BufferArena.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
 #include "Material.h"
 #include "BoundingBox.h"
 #include "Shader.h"
+#include "RenderStateCache.h"
 #include "types.h"
+#include <iostream>
 
 namespace vvision
 {
-    /** represents a gpu vertex*/
-    struct CGpuVertex {
-        
-        /** vertex pos*/
-        vec3f pos;
+        /** levels built by default for the static groups of imported meshes*/
+        enum
+        {
+            kMESH_LOD_DEFAULT_LEVELS = 3
+        };
         
-        /** vertex tex cooridnate*/
-        vec2f texCoord;
+        /** triangles kept by each level, relative to the full mesh ( 0.5 keeps half, then a quarter...)*/
+        #define VV_MESH_LOD_REDUCTION 0.5f
         
-        /** vertex normal*/
-        vec3f normal;
+        /** a level that removes less than this fraction of the triangles of the previous one is not kept*/
+        #define VV_MESH_LOD_MIN_REDUCTION 0.2f
         
-        /** bone indices that affect this vertex ( for animated mesh only)*/
-        vec4f boneIndices;
+        /** largest error of a level, relative to the diagonal of the group*/
+        #define VV_MESH_LOD_MAX_ERROR 0.05f
         
-        /** bone weights that affect this vertex for animated mes only)*/
-        vec4f boneWeights;
+        /** default screen error of the selected level, in pixels*/
+        #define VV_MESH_LOD_PIXEL_ERROR 1.f
         
-        /** vertex tangent coordinate*/
-        vec3f tangent;
+        /** a level is left once its error is this fraction above the limit, and entered once it is this fraction below it*/
+        #define VV_MESH_LOD_HYSTERESIS 0.25f
         
-        /** constructor*/
-        CGpuVertex() :
-        pos(vec3f()), normal(vec3f()), tangent(vec3f()), texCoord(vec2f()), boneIndices(vec4f(0,0,0,0)), boneWeights(vec4f(0,0,0,0))
-        {}
-        CGpuVertex(const vec3f& pos_, const vec3f& normal_, const vec3f& tangent_, const vec2f& texCoord_, const vec4f& boneIndices_, const vec4f& boneWeights_)
-        :
-        pos(pos_), normal(normal_), tangent(tangent_), texCoord(texCoord_), boneIndices(boneIndices_), boneWeights(boneWeights_)
+        /** what a group keeps in host memory once its vertices and indices are on the gpu*/
+        enum MESH_RESIDENCY
         {
-        }
+            /** vertices and indices, the group can be reallocated, batched or instanced*/
+            kMESH_RESIDENCY_KEEP = 0,
+            
+            /** nothing, the indices of the groups with meshlets are kept for CMeshletCuller*/
+            kMESH_RESIDENCY_DISCARD,
+            
+            /** positions and indices, for picking and collision*/
+            kMESH_RESIDENCY_POSITIONS
+        };
         
-        /** copy constructor*/
-        CGpuVertex(const CGpuVertex& v)
+        /** host memory of the groups that applied a residency policy*/
+        struct SMeshResidencyStats
         {
-            pos = v.pos;
-            normal = v.normal;
-            tangent = v.tangent;
-            texCoord = v.texCoord;
-            boneIndices = v.boneIndices;
-            boneWeights = v.boneWeights;
-        }
+            /** groups that released host copies*/
+            uint32 groups;
+            
+            /** bytes still held by those groups, and bytes released*/
+            uint32 keptBytes;
+            uint32 releasedBytes;
+        };
+        
+        /** totals of every group since the start of the application*/
+        const SMeshResidencyStats& GetMeshResidencyTotals();
         
-        /** = operator*/
-        CGpuVertex& operator=(CGpuVertex const& v)
+        /** a level of detail of a group, its indices follow those of the full mesh in the arena*/
+        struct SMeshLod
         {
-            pos = v.pos;
-            normal = v.normal;
-            tangent = v.tangent;
-            texCoord = v.texCoord;
-            boneIndices = v.boneIndices;
-            boneWeights = v.boneWeights;
-            return *this;
-        }
+            /** first index, relative to the first index of the group*/
+            uint32 firstIndex;
+            uint32 indexCount;
+            
+            /** distance between the level and the full mesh ( object space)*/
+            float32 error;
         };
         
         /** a mesh is represented by a number of MeshGroup, mesh groups can share materials
-         * a mesh group is stored on GPU using vbo + vao
+         * a mesh group is stored on GPU in ranges of the vbo + ibo of a CBufferArena block, drawn with the vao of the block
          */
         class CMeshGroup
         {
-            
+        
         public:
             
             /** constructor*/
             CMeshGroup()
-            : m_iMaterialIndex(-1), m_cBbox(GetBoundingBox()), m_uAttribFlags(0), m_eDrawingMode(kPRIMITIVE_TYPE_TRIANGLE)
+            : m_eDrawingMode(kPRIMITIVE_TYPE_TRIANGLE), m_uAttribFlags(0), m_eResidency(kMESH_RESIDENCY_KEEP), m_bHostReleased(false), m_eIndexType(kINDEX_TYPE_UNSIGNED_SHORT), m_uIndexCount(0), m_uLodLevels(0), m_bVertexFormatSet(false), m_iMaterialIndex(-1)
             {
             }
             
@@ -103,9 +114,26 @@ namespace vvision
             /** get drawing type*/
             inline PRIMITIVE_TYPE GetDrawingMode() {return m_eDrawingMode;}
             
-            /** return a reference to containers */
+            /** return a reference to containers, empty once released by the residency policy*/
             inline vector<CGpuVertex>& GetVertices() {return m_vVertices;}
-            inline vector<ushort16>& GetIndices(){return m_vIndices;}
+            inline vector<uint32>& GetIndices(){return m_vIndices;}
+            
+            /** positions kept by kMESH_RESIDENCY_POSITIONS ( in the order of the vertices the indices refer to)*/
+            inline const vector<vec3f>& GetPositions() const {return m_vPositions;}
+            
+            /** host copies to keep once allocated, applied at once if the group is already on the gpu.
+             * released copies can not come back: the group can not be allocated again, and once released only kMESH_RESIDENCY_DISCARD
+             * is accepted ( an error is logged otherwise)
+             */
+            void SetResidency(MESH_RESIDENCY residency);
+            inline MESH_RESIDENCY GetResidency() const {return m_eResidency;}
+            
+            /** bytes of the vertices, indices and positions held in host memory*/
+            uint32 GetHostBytes() const;
+            
+            /** type and number of the indices of the full mesh on the gpu ( valid once allocated), to draw the group*/
+            inline INDEX_TYPE GetIndexType() const {return m_eIndexType;}
+            inline uint32 GetIndexCount() const {return m_uIndexCount;}
             
             /** getters/setters*/
             inline void SetMaterialIndex(int32 matIndex) {m_iMaterialIndex = matIndex;}
@@ -113,6 +141,28 @@ namespace vvision
             inline CBoundingBox& GetBoundingBox() {return m_cBbox;}
             inline void SetBoundingBox(const CBoundingBox& bbox_) {m_cBbox = bbox_;}
             
+            /** force the gpu storage of the vertices, by default AllocateOnGpuMemory picks SVertexFormat::Compact*/
+            inline void SetVertexFormat(const SVertexFormat& format) {m_sVertexFormat = format; m_bVertexFormatSet = true;}
+            
+            /** layout of the vertices on the gpu ( valid once allocated)*/
+            inline const CVertexLayout& GetVertexLayout() const {return m_cVertexLayout;}
+            
+            /** simplified levels AllocateOnGpuMemory builds after the full mesh ( static triangle lists only, none by default)*/
+            inline void SetLodLevels(uint32 levels) {m_uLodLevels = levels;}
+            
+            /** levels of detail on the gpu, the first one is the full mesh ( valid once allocated)*/
+            inline uint32 GetLodCount() const {return m_vLods.size();}
+            inline const SMeshLod& GetLod(uint32 lod) const {assert(lod < m_vLods.size()); return m_vLods[lod];}
+            
+            /** level to draw for the projected size of the group ( check CBoundingBox::GetProjectedSize)
+             * @param current level drawn last frame, kept unless the error moved past the hysteresis
+             * @param pixel_error largest error on screen, in pixels
+             */
+            uint32 SelectLod(float32 projected_size, uint32 current, float32 pixel_error = VV_MESH_LOD_PIXEL_ERROR) const;
+            
+            /** meshlets of the full mesh, built on allocation for the static triangle lists larger than a meshlet ( not skinned)*/
+            inline const std::vector<SMeshlet>& GetMeshlets() const {return m_vMeshlets;}
+            
             
             /** create bounding box for the mesh*/
             void CreateBoundingBox()
@@ -121,69 +171,128 @@ namespace vvision
                     m_cBbox.Add(m_vVertices[i].pos);
             }
             
-            /** allocate mesh on gpu*/
+            /** allocate mesh on gpu, the vertices are packed in the vertex format of the group and stored with the indices
+             * in the shared buffers of CBufferArena
+             */
             bool AllocateOnGpuMemory( GL_BUFFER_USAGE_HINT usage_)
             {
-                glGenVertexArraysOES(1, &m_uVao);
-                glBindVertexArrayOES(m_uVao);
-                
-                bool res = m_cVboVertices.AllocateStorage(kGL_BUFFER_TYPE_ARRAY, usage_, sizeof(CGpuVertex) * m_vVertices.size(), &m_vVertices[0]);
-                if(!res)
+                if(m_bHostReleased)
+                {
+                    std::cerr<<"CMeshGroup: [ERROR] cant allocate a group whose vertices were released\n";
                     return false;
+                }
+                
+                //static triangle lists are reordered for the vertex cache, overdraw and vertex fetch ( dynamic groups keep
+                //their order, the code updating them relies on it)
+                if(m_eDrawingMode == kPRIMITIVE_TYPE_TRIANGLE && usage_ == kGL_BUFFER_USAGE_HINT_STATIC)
+                    OptimizeMesh(m_vVertices, m_vIndices);
+                
+                if(!m_bVertexFormatSet)
+                    m_sVertexFormat = SVertexFormat::Compact(m_vVertices);
+                m_cVertexLayout = CVertexLayout(m_sVertexFormat);
                 
-                res = m_cVboIndices.AllocateStorage(kGL_BUFFER_TYPE_ELEMENT, usage_, sizeof(ushort16) * m_vIndices.size(), &m_vIndices[0]);
-                if(!res)
+                std::vector<uchar8> packed;
+                m_cVertexLayout.Encode(m_vVertices, packed);
+                
+                //the meshlets follow the triangle order of the full mesh. their bounds and cones are those of the bind pose,
+                //skinned groups have none
+                m_vMeshlets.clear();
+                if(m_eDrawingMode == kPRIMITIVE_TYPE_TRIANGLE && usage_ == kGL_BUFFER_USAGE_HINT_STATIC && m_sVertexFormat.boneWeights == kVERTEX_ATTRIB_FORMAT_NONE && m_vIndices.size() > kMESHLET_MAX_TRIANGLES * 3)
+                    BuildMeshlets(m_vVertices, m_vIndices, m_vMeshlets);
+                
+                //the levels of detail index the same vertices
+                std::vector<uint32> indices;
+                BuildLods(indices);
+                
+                //the arena picks the narrowest indices for the position of the group in its block
+                CBufferArena::Instance().Release(m_sAllocation);
+                if(!CBufferArena::Instance().Allocate(m_cVertexLayout, usage_, packed, indices, m_sAllocation, m_eIndexType))
                     return false;
                 
-                m_cVboVertices.Bind();
-                CVertexBuffer::MapAttribLocation(ATTRIB_VERTEX,         3, kDATA_TYPE_FLOAT, sizeof(CGpuVertex), 0);
-                CVertexBuffer::MapAttribLocation(ATTRIB_TEXTURE0,       2, kDATA_TYPE_FLOAT, sizeof(CGpuVertex), (const GLvoid*)12);
-                CVertexBuffer::MapAttribLocation(ATTRIB_NORMAL,         3, kDATA_TYPE_FLOAT, sizeof(CGpuVertex), (const GLvoid*)20);
-                CVertexBuffer::MapAttribLocation(ATTRIB_BONES_INDICES,  4, kDATA_TYPE_FLOAT, sizeof(CGpuVertex), (const GLvoid*)32);
-                CVertexBuffer::MapAttribLocation(ATTRIB_BONES_WEIGHTS,  4, kDATA_TYPE_FLOAT, sizeof(CGpuVertex), (const GLvoid*)48);
-                CVertexBuffer::MapAttribLocation(ATTRIB_TANGENT,        3, kDATA_TYPE_FLOAT, sizeof(CGpuVertex), (const GLvoid*)64);
+                m_uIndexCount = m_vIndices.size();
                 
-                m_cVboIndices.Bind();
-                m_cVboVertices.Unbind();
-                glBindVertexArrayOES(0);
+                if(m_eResidency != kMESH_RESIDENCY_KEEP)
+                    ReleaseHostCopies();
                 return true;
-                
+            
             }
             
             /** map group to gpu ( prepare for rendering mesh group)
-             * @param flags check e_ATTRIB_PARAM in GL_Enum.h
+             * the attributes are those of the vao of the arena block, the flags of the former per group binding are ignored
              */
-            void MapToGPU(uint32 flags)
+            void MapToGPU(uint32 /*flags*/)
             {
-                glBindVertexArrayOES(m_uVao);
+                CRenderStateCache::Instance().BindVertexArray(m_sAllocation.vao);
             }
             
             /** unmap*/
             void UnmapFromGPU()
             {
-                glBindVertexArrayOES(0);
+                CRenderStateCache::Instance().BindVertexArray(0);
             }
             
+            /** vertex array object of the group, shared with the groups of its arena block*/
+            inline GLuint GetVertexArray() const {return m_sAllocation.vao;}
+            
+            /** vertices and indices of the group in the arena*/
+            inline const SBufferArenaAllocation& GetAllocation() const {return m_sAllocation;}
+            
+            /** first index of the group in the element buffer of its vao*/
+            inline uint32 GetFirstIndex() const {return m_sAllocation.indexOffset / GetIndexTypeSize(m_eIndexType);}
+            
+            /** first index of a level of detail in the element buffer of its vao*/
+            inline uint32 GetFirstIndex(uint32 lod) const {return GetFirstIndex() + GetLod(lod).firstIndex;}
+            
+            /** offset of the first index, the last parameter of glDrawElements*/
+            inline const GLvoid* GetIndexOffset() const {return (const GLvoid*)(size_t)m_sAllocation.indexOffset;}
+        
         private:
             
+            /** fill the levels of detail, indices receives those of every level to upload*/
+            void BuildLods(std::vector<uint32>& indices);
+            
+            /** free the host copies the residency policy does not keep*/
+            void ReleaseHostCopies();
+            
             /** drawing mode*/
             PRIMITIVE_TYPE m_eDrawingMode;
             
             /** attrib flag*/
             uint32 m_uAttribFlags;
             
-            /** vbo*/
-            CVertexBuffer m_cVboVertices;
-            CVertexBuffer m_cVboIndices;
-            
-            /** vao*/
-            GLuint m_uVao;
+            /** vertices and indices in the arena*/
+            SBufferArenaAllocation m_sAllocation;
             
             /** vertices representing this meshGroupd*/
             std::vector<CGpuVertex> m_vVertices;
             
             /** indices of the mesh group*/
-            std::vector<ushort16> m_vIndices;
+            std::vector<uint32> m_vIndices;
+            
+            /** positions kept by kMESH_RESIDENCY_POSITIONS*/
+            std::vector<vec3f> m_vPositions;
+            
+            /** host copies kept once allocated*/
+            MESH_RESIDENCY m_eResidency;
+            bool m_bHostReleased;
+            
+            /** indices on the gpu*/
+            INDEX_TYPE m_eIndexType;
+            uint32 m_uIndexCount;
+            
+            /** levels of detail*/
+            std::vector<SMeshLod> m_vLods;
+            uint32 m_uLodLevels;
+            
+            /** meshlets of the full mesh*/
+            std::vector<SMeshlet> m_vMeshlets;
+            
+            /** vertex format, chosen on allocation unless forced*/
+            SVertexFormat m_sVertexFormat;
+            bool m_bVertexFormatSet;
+            
+            /** layout of the vertex buffer*/
+            CVertexLayout m_cVertexLayout;
             
             /** material index (meshGroup can share  the same material)*/
             int32 m_iMaterialIndex;
@@ -198,6 +307,12 @@ namespace vvision
                 m_vVertices = m.m_vVertices;
                 m_vIndices = m.m_vIndices;
                 m_cBbox = m.m_cBbox;
+                m_sVertexFormat = m.m_sVertexFormat;
+                m_bVertexFormatSet = m.m_bVertexFormatSet;
+                m_uLodLevels = m.m_uLodLevels;
+                m_vPositions = m.m_vPositions;
+                m_eResidency = m.m_eResidency;
+                m_bHostReleased = m.m_bHostReleased;
             }
             
             /** = operator*/
@@ -208,10 +323,16 @@ namespace vvision
                 m_vVertices = m.m_vVertices;
                 m_vIndices = m.m_vIndices;
                 m_cBbox = m.m_cBbox;
+                m_sVertexFormat = m.m_sVertexFormat;
+                m_bVertexFormatSet = m.m_bVertexFormatSet;
+                m_uLodLevels = m.m_uLodLevels;
+                m_vPositions = m.m_vPositions;
+                m_eResidency = m.m_eResidency;
+                m_bHostReleased = m.m_bHostReleased;
                 return *this;
             }
-            
-            
+        
+        
         };
         
         /** conatainer of groups and materials, */
@@ -253,6 +374,12 @@ namespace vvision
             /**reference to groups*/
             std::vector<CMeshGroup*>& GetGroupsContainerRef() {return groups;}
             
+            /** set the residency of every group, check CMeshGroup::SetResidency*/
+            void SetResidency(MESH_RESIDENCY residency);
+            
+            /** bytes held in host memory by the groups*/
+            uint32 GetHostBytes() const;
+        
         private:
             
             /** groups container*/
@@ -268,5 +395,5 @@ namespace vvision
             CMeshBuffer& operator = (CMeshBuffer const& m);
         };
     }
-    
+
 #endif
\ No newline at end of file
@@ -0,0 +1,210 @@
+/*
+ *  MeshletCuller.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "MeshletCuller.h"
+#include "RenderStateCache.h"
+#include <string.h>
+
+namespace vvision
+{
+    /** append count indices rebased on base, in the index type*/
+    static void AppendIndices(const uint32* indices, uint32 count, uint32 base, INDEX_TYPE type, std::vector<uchar8>& data)
+    {
+        uint32 offset = data.size();
+        data.resize(offset + count * GetIndexTypeSize(type));
+        
+        switch(type)
+        {
+            case kINDEX_TYPE_UNSIGNED_BYTE:
+                for(uint32 i = 0; i < count; i++)
+                    data[offset + i] = (uchar8)(indices[i] + base);
+                break;
+            case kINDEX_TYPE_UNSIGNED_SHORT:
+            {
+                ushort16* destination = (ushort16*)&data[offset];
+                for(uint32 i = 0; i < count; i++)
+                    destination[i] = (ushort16)(indices[i] + base);
+                break;
+            }
+            default:
+            {
+                uint32* destination = (uint32*)&data[offset];
+                for(uint32 i = 0; i < count; i++)
+                    destination[i] = indices[i] + base;
+                break;
+            }
+        }
+    }
+    
+    CMeshletCuller::CMeshletCuller()
+    : m_cIndexBuffer(kGL_BUFFER_TYPE_ELEMENT, kGL_BUFFER_USAGE_HINT_STREAM), m_bIndexBufferCreated(false)
+    {
+        memset(&m_sStats, 0, sizeof(SMeshletCullStats));
+    }
+    
+    CMeshletCuller::~CMeshletCuller()
+    {
+        //gl unbinds a deleted vao, keep the cache in sync
+        CRenderStateCache::Instance().BindVertexArray(0);
+        for(std::map<const SBufferArenaBlock*, GLuint>::iterator it = m_mVertexArrays.begin(); it != m_mVertexArrays.end(); ++it)
+            glDeleteVertexArraysOES(1, &it->second);
+        m_mVertexArrays.clear();
+        
+        if(m_bIndexBufferCreated)
+            m_cIndexBuffer.Destroy();
+    }
+    
+    bool CMeshletCuller::AddMesh(CMeshBuffer* mesh)
+    {
+        assert(mesh != NULL);
+        
+        //the vertex arrays reference the element buffer, it is created once and only respecified
+        if(!m_bIndexBufferCreated)
+        {
+            CRenderStateCache::Instance().BindVertexArray(0);
+            if(!m_cIndexBuffer.AllocateStorage(kGL_BUFFER_TYPE_ELEMENT, kGL_BUFFER_USAGE_HINT_STREAM, 0, NULL))
+            {
+                std::cerr<<"CMeshletCuller: [ERROR] cant create the element buffer\n";
+                return false;
+            }
+            m_bIndexBufferCreated = true;
+        }
+        
+        for(uint32 g = 0; g < mesh->GroupsCount(); ++g)
+        {
+            CMeshGroup* group = mesh->GroupAtIndex(g);
+            const SBufferArenaAllocation& allocation = group->GetAllocation();
+            if(group->GetMeshlets().empty() || allocation.block == NULL || m_mVertexArrays.count(allocation.block))
+                continue;
+            
+            m_mVertexArrays[allocation.block] = CBufferArena::Instance().CreateVertexArray(allocation, m_cIndexBuffer);
+        }
+        return true;
+    }
+    
+    void CMeshletCuller::Begin()
+    {
+        m_vIndices.clear();
+        memset(&m_sStats, 0, sizeof(SMeshletCullStats));
+    }
+    
+    bool CMeshletCuller::Cull(CMeshGroup* group, const mat4f& transform, const mat4f& view, const mat4f& projection, SMeshletDraw& draw)
+    {
+        assert(group != NULL);
+        
+        const std::vector<SMeshlet>& meshlets = group->GetMeshlets();
+        const SBufferArenaAllocation& allocation = group->GetAllocation();
+        if(meshlets.empty())
+            return false;
+        
+        std::map<const SBufferArenaBlock*, GLuint>::const_iterator vao = m_mVertexArrays.find(allocation.block);
+        if(vao == m_mVertexArrays.end())
+            return false;
+        
+        //frustum planes in object space ( rows of the model view projection), normalized so they give distances
+        mat4f modelView = view * transform;
+        mat4f modelViewProjection = projection * modelView;
+        const mat4f& m = modelViewProjection;
+        
+        vec4f planes[6];
+        vec4f w(m[3], m[7], m[11], m[15]);
+        for(int32 i = 0; i < 3; i++)
+        {
+            vec4f row(m[i], m[4 + i], m[8 + i], m[12 + i]);
+            planes[i * 2] = w + row;
+            planes[i * 2 + 1] = w - row;
+        }
+        
+        for(int32 i = 0; i < 6; i++)
+        {
+            float32 length = vec3f(planes[i].x, planes[i].y, planes[i].z).length();
+            if(length > 0)
+                planes[i] /= length;
+        }
+        
+        //eye in object space
+        vec4f eye = modelView.inverse() * vec4f(0.f, 0.f, 0.f, 1.f);
+        vec3f eyePosition(eye.x, eye.y, eye.z);
+        
+        INDEX_TYPE type = group->GetIndexType();
+        uint32 size = GetIndexTypeSize(type);
+        const std::vector<uint32>& indices = group->GetIndices();
+        
+        //the draw starts on a multiple of the index size
+        m_vIndices.resize((m_vIndices.size() + size - 1) / size * size, 0);
+        uint32 offset = m_vIndices.size();
+        uint32 kept = 0;
+        
+        for(uint32 i = 0; i < meshlets.size(); i++)
+        {
+            const SMeshlet& meshlet = meshlets[i];
+            
+            bool outside = false;
+            for(int32 p = 0; p < 6 && !outside; p++)
+                outside = planes[p].x * meshlet.center.x + planes[p].y * meshlet.center.y + planes[p].z * meshlet.center.z + planes[p].w < -meshlet.radius;
+            
+            if(outside)
+            {
+                m_sStats.frustumCulled++;
+                continue;
+            }
+            
+            vec3f direction = meshlet.center - eyePosition;
+            if(direction.dotProduct(meshlet.coneAxis) >= meshlet.coneCutoff * direction.length() + meshlet.radius)
+            {
+                m_sStats.coneCulled++;
+                continue;
+            }
+            
+            AppendIndices(&indices[meshlet.firstIndex], meshlet.indexCount, allocation.firstVertex, type, m_vIndices);
+            kept++;
+        }
+        
+        if(kept == meshlets.size())
+        {
+            //nothing culled, the indices of the group are already on the gpu
+            m_vIndices.resize(offset);
+            draw.vao = group->GetVertexArray();
+            draw.firstIndex = group->GetFirstIndex();
+            draw.indexCount = group->GetIndexCount();
+        }
+        else
+        {
+            draw.vao = vao->second;
+            draw.firstIndex = offset / size;
+            draw.indexCount = (m_vIndices.size() - offset) / size;
+        }
+        draw.indexType = type;
+        
+        m_sStats.groups++;
+        m_sStats.meshlets += meshlets.size();
+        m_sStats.trianglesTested += group->GetIndexCount() / 3;
+        m_sStats.trianglesKept += draw.indexCount / 3;
+        return true;
+    }
+    
+    void CMeshletCuller::Upload()
+    {
+        if(m_vIndices.empty() || !m_bIndexBufferCreated)
+            return;
+        
+        //the element buffer binding belongs to the bound vao, upload with none bound. the previous storage is orphaned
+        CRenderStateCache::Instance().BindVertexArray(0);
+        m_cIndexBuffer.Respecify(m_vIndices.size(), &m_vIndices[0]);
+        m_sStats.uploadedBytes = m_vIndices.size();
+    }
+
+#ifdef DEBUG
+    void CMeshletCuller::PrintReport() const
+    {
+        std::cerr<<"CMeshletCuller: [INFO] "<<m_sStats.groups<<" groups, "<<m_sStats.meshlets<<" meshlets ( "<<m_sStats.frustumCulled<<" out of the frustum, "<<m_sStats.coneCulled<<" back facing)\n";
+        std::cerr<<"    triangles: "<<m_sStats.trianglesTested<<" -> "<<m_sStats.trianglesKept<<" ( "<<m_sStats.uploadedBytes<<" bytes of indices uploaded)\n";
+    }
+#endif
+}
@@ -0,0 +1,120 @@
+/* MeshletCuller.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_MESHLET_CULLER_H
+#define VVISION_MESHLET_CULLER_H
+
+#include "MeshBuffer.h"
+#include "VertexBuffer.h"
+
+namespace vvision
+{
+    /** meshlets tested by a culler since its Begin*/
+    struct SMeshletCullStats
+    {
+        /** groups and meshlets tested*/
+        uint32 groups;
+        uint32 meshlets;
+        
+        /** meshlets outside of the frustum, and facing away from the eye*/
+        uint32 frustumCulled;
+        uint32 coneCulled;
+        
+        /** triangles of the tested groups, and of their meshlets that survived*/
+        uint32 trianglesTested;
+        uint32 trianglesKept;
+        
+        /** bytes of indices uploaded*/
+        uint32 uploadedBytes;
+    };
+    
+    /** the meshlets of a group that survived the culling*/
+    struct SMeshletDraw
+    {
+        GLuint vao;
+        INDEX_TYPE indexType;
+        uint32 firstIndex;
+        uint32 indexCount;
+    };
+    
+    /** cpu culling of meshlets ( check MeshletBuilder.h): the meshlets of a group outside of the frustum or facing away from
+     * the eye are dropped, the indices of the others are compacted in a dynamic element buffer and drawn with one draw call.
+     * a pass records with its own culler: Begin and Cull make no gl call and can run on the thread recording the pass,
+     * Upload runs on the thread of the context before the draws are executed.
+     */
+    class CMeshletCuller
+    {
+    public:
+        
+        /** constructor*/
+        CMeshletCuller();
+        
+        /** destructor, the groups added must still be allocated*/
+        ~CMeshletCuller();
+        
+        /** cull the groups of mesh with this culler: creates the vertex arrays drawing their arena blocks with the culled indices
+         * ( gl thread, once the groups are allocated)
+         * @return false if the element buffer cant be created
+         */
+        bool AddMesh(CMeshBuffer* mesh);
+        
+        /** forget the indices and the stats of the previous frame ( no gl call)*/
+        void Begin();
+        
+        /** cull the meshlets of the full mesh of a group ( no gl call)
+         * @param draw the indices to draw, their count is 0 if every meshlet was culled
+         * @return false if the group is not culled by this culler ( no meshlet or not added), it is drawn whole
+         */
+        bool Cull(CMeshGroup* group, const mat4f& transform, const mat4f& view, const mat4f& projection, SMeshletDraw& draw);
+        
+        /** upload the indices culled since Begin ( gl thread, before the draws are executed)*/
+        void Upload();
+        
+        /** stats since Begin*/
+        inline const SMeshletCullStats& GetStats() const {return m_sStats;}
+
+#ifdef DEBUG
+        /** print the stats of the last frame*/
+        void PrintReport() const;
+#endif
+    
+    private:
+        
+        /** culled indices of the frame, packed in the index type of each group*/
+        std::vector<uchar8> m_vIndices;
+        
+        /** element buffer of the culled indices*/
+        CVertexBuffer m_cIndexBuffer;
+        bool m_bIndexBufferCreated;
+        
+        /** vertex array of each arena block with the culled indices*/
+        std::map<const SBufferArenaBlock*, GLuint> m_mVertexArrays;
+        
+        /** stats*/
+        SMeshletCullStats m_sStats;
+        
+        /** not allowed*/
+        CMeshletCuller(const CMeshletCuller&);
+        
+        /** not allowed*/
+        CMeshletCuller& operator=(const CMeshletCuller&);
+    };
+}
+
+#endif
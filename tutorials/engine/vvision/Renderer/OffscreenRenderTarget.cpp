@@ -8,6 +8,7 @@
  */
 
 #include "OffscreenRenderTarget.h"
+#include "RenderStateCache.h"
 
 namespace vvision
 {
@@ -35,6 +36,9 @@ namespace vvision
         m_iContextSize = context_size;
         
         
+        //framebuffer bound by the caller, restored once the target is created
+        GLuint previousFbo = CRenderStateCache::Instance().GetFramebuffer();
+        
         //create the frame buffer object and bind it !
         m_pFbo = new CFrameBufferObject();
         m_pFbo->CreateID();
@@ -66,24 +70,25 @@ namespace vvision
             return false;
         
         //disabel offscreen context
-        m_pFbo->Disable();
+        CRenderStateCache::Instance().BindFramebuffer(previousFbo);
         
         //
         return true;
     }
     void COffscreenRenderTarget::Enable()
     {
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_uCurrentFbo);
-        glGetIntegerv(GL_VIEWPORT, m_vViewport);
+        //the bound framebuffer and the viewport come from the state cache, no pipeline stall
+        CRenderStateCache& cache = CRenderStateCache::Instance();
+        m_uCurrentFbo = (int32)cache.GetFramebuffer();
+        cache.GetViewport(m_vViewport);
         m_pFbo->Bind();
-        glViewport(0, 0, m_iContextSize, m_iContextSize);
+        cache.Viewport(0, 0, m_iContextSize, m_iContextSize);
     }
     
     void COffscreenRenderTarget::Disable()
     {
-        m_pFbo->Disable();
-        glBindFramebuffer(GL_FRAMEBUFFER, m_uCurrentFbo);
-        glViewport(m_vViewport[0], m_vViewport[1], m_vViewport[2], m_vViewport[3]);
-        //glViewport(m_iVpX, m_iVpY, m_iVpW, m_iVpH);
+        CRenderStateCache& cache = CRenderStateCache::Instance();
+        cache.BindFramebuffer((GLuint)m_uCurrentFbo);
+        cache.Viewport(m_vViewport[0], m_vViewport[1], m_vViewport[2], m_vViewport[3]);
     }
 }
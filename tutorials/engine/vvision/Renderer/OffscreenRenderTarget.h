@@ -64,7 +64,7 @@ namespace vvision
         /** activate context ( all drawing commands will be executed into this context*/
         void Enable();
         
-        /** disable context and switch back to default context ( the default context is one bound before Enable was called, this is retrieved via glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_uCurrentFbo); for better performance, it is better to remove the glGet from the rendering loop ( the case when u know the fbo ID )*/
+        /** disable context and switch back to default context ( the default context is one bound before Enable was called, read from the CRenderStateCache shadow state)*/
         void Disable();
     private:
         
@@ -0,0 +1,257 @@
+/*
+ *  ProgramBinaryCache.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "ProgramBinaryCache.h"
+#include "FileSystem.h"
+#include "Helpers.h"
+#include "Timer.h"
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace vvision
+{
+    CProgramBinaryCache::CProgramBinaryCache()
+    : m_bCapsQueried(false), m_bSupported(false), m_uDriverHash(0),
+    m_bEnabled(true), m_bDirectoryCreated(false)
+    {
+        ResetCounters();
+    }
+    
+    void CProgramBinaryCache::QueryCaps()
+    {
+        if(m_bCapsQueried)
+            return;
+        m_bCapsQueried = true;
+        
+        //the driver strings are part of every key, a driver update must not reuse old binaries
+        const GLenum strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+        uint32 hash = 2166136261u;
+        for(uint32 i = 0; i < 3; i++)
+        {
+            const char8* str = (const char8*)glGetString(strings[i]);
+            if(str != NULL)
+                hash = StringManipulator::Hash(str, (uint32)strlen(str), hash);
+        }
+        m_uDriverHash = hash;
+        
+#ifdef GL_OES_get_program_binary
+        const char8* extensions = (const char8*)glGetString(GL_EXTENSIONS);
+        GLint formats = 0;
+        if(extensions != NULL && strstr(extensions, "GL_OES_get_program_binary") != NULL)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+        m_bSupported = formats > 0;
+#endif
+        
+#ifdef DEBUG
+        std::cerr<<"CProgramBinaryCache: [INFO] program binaries "<<(m_bSupported ? "supported" : "not supported")<<"\n";
+#endif
+    }
+    
+    bool CProgramBinaryCache::IsSupported()
+    {
+        QueryCaps();
+        return m_bSupported;
+    }
+    
+    const string& CProgramBinaryCache::GetDirectory()
+    {
+        if(m_sDirectory.empty())
+        {
+            //the caches directory of the application sandbox, the system may purge it, binaries are then rebuilt
+            const char8* home = getenv("HOME");
+            m_sDirectory = home ? home : ".";
+            m_sDirectory += "/Library/Caches/vvshaders";
+        }
+        return m_sDirectory;
+    }
+    
+    void CProgramBinaryCache::HashSources(const char8* vertex_shader, int32 vertex_shader_length, const char8* fragment_shader, int32 fragment_shader_length, uint32& hash, uint32& length)
+    {
+        uint32 vlength = vertex_shader_length < 0 ? (uint32)strlen(vertex_shader) : (uint32)vertex_shader_length;
+        uint32 flength = fragment_shader_length < 0 ? (uint32)strlen(fragment_shader) : (uint32)fragment_shader_length;
+        
+        //separator so moving code from one stage to the other changes the key
+        hash = StringManipulator::Hash(vertex_shader, vlength);
+        hash = StringManipulator::Hash("\0", 1, hash);
+        hash = StringManipulator::Hash(fragment_shader, flength, hash);
+        length = vlength + flength;
+    }
+    
+    string CProgramBinaryCache::GetFilePath(uint32 source_hash, uint32 source_length)
+    {
+        char8 name[64];
+        sprintf(name, "/%08x%08x%08x.vvpb", source_hash, source_length, m_uDriverHash);
+        return GetDirectory() + name;
+    }
+    
+    bool CProgramBinaryCache::Load(GLuint program, const char8* vertex_shader, int32 vertex_shader_length, const char8* fragment_shader, int32 fragment_shader_length)
+    {
+        if(!m_bEnabled || !IsSupported() || program == 0 || vertex_shader == NULL || fragment_shader == NULL)
+            return false;
+        
+#ifdef GL_OES_get_program_binary
+        CTimer timer;
+        uint32 hash, length;
+        HashSources(vertex_shader, vertex_shader_length, fragment_shader, fragment_shader_length, hash, length);
+        string path = GetFilePath(hash, length);
+        
+        CFileBuffer file;
+        if(!file.Open(path.c_str()))
+        {
+            m_uMisses++;
+            return false;
+        }
+        
+        const SProgramBinaryHeader* header = (const SProgramBinaryHeader*)file.GetData();
+        bool valid =
+        file.GetSize() >= sizeof(SProgramBinaryHeader) &&
+        header->magic == VV_PROGRAM_BINARY_MAGIC &&
+        header->version == VV_PROGRAM_BINARY_VERSION &&
+        header->sourceHash == hash &&
+        header->sourceLength == length &&
+        header->driverHash == m_uDriverHash &&
+        header->binaryLength == file.GetSize() - sizeof(SProgramBinaryHeader);
+        
+        GLint status = 0;
+        if(valid)
+        {
+            glProgramBinaryOES(program, header->format, file.GetData() + sizeof(SProgramBinaryHeader), header->binaryLength);
+            glGetProgramiv(program, GL_LINK_STATUS, &status);
+        }
+        file.Close();
+        m_fLoadTimeMs += timer.GetElapsedMs();
+        
+        if(status == 0)
+        {
+            //stale or corrupted, it is replaced once the program is compiled from source
+            std::cerr<<"CProgramBinaryCache: [WARNING] program binary rejected: "<<path<<"\n";
+            remove(path.c_str());
+            m_uRejected++;
+            return false;
+        }
+        
+        m_uHits++;
+        return true;
+#else
+        return false;
+#endif
+    }
+    
+    bool CProgramBinaryCache::Store(GLuint program, const char8* vertex_shader, int32 vertex_shader_length, const char8* fragment_shader, int32 fragment_shader_length)
+    {
+        if(!m_bEnabled || !IsSupported() || program == 0 || vertex_shader == NULL || fragment_shader == NULL)
+            return false;
+        
+#ifdef GL_OES_get_program_binary
+        CTimer timer;
+        GLint size = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &size);
+        if(size <= 0)
+            return false;
+        
+        char8* data = (char8*)malloc(sizeof(SProgramBinaryHeader) + size);
+        if(data == NULL)
+            return false;
+        
+        SProgramBinaryHeader* header = (SProgramBinaryHeader*)data;
+        GLsizei written = 0;
+        GLenum format = 0;
+        glGetProgramBinaryOES(program, size, &written, &format, data + sizeof(SProgramBinaryHeader));
+        
+        if(written <= 0)
+        {
+            free(data);
+            return false;
+        }
+        
+        memset(header, 0, sizeof(SProgramBinaryHeader));
+        header->magic = VV_PROGRAM_BINARY_MAGIC;
+        header->version = VV_PROGRAM_BINARY_VERSION;
+        HashSources(vertex_shader, vertex_shader_length, fragment_shader, fragment_shader_length, header->sourceHash, header->sourceLength);
+        header->driverHash = m_uDriverHash;
+        header->format = format;
+        header->binaryLength = (uint32)written;
+        
+        if(!m_bDirectoryCreated)
+        {
+            mkdir(GetDirectory().c_str(), 0755);
+            m_bDirectoryCreated = true;
+        }
+        
+        //written to a temporary file first, an interrupted write never leaves a truncated binary behind
+        string path = GetFilePath(header->sourceHash, header->sourceLength);
+        string tmp = path + ".tmp";
+        uint32 total = sizeof(SProgramBinaryHeader) + header->binaryLength;
+        
+        FILE* f = fopen(tmp.c_str(), "wb");
+        bool success = f != NULL && fwrite(data, 1, total, f) == total;
+        if(f != NULL)
+            success = fclose(f) == 0 && success;
+        success = success && rename(tmp.c_str(), path.c_str()) == 0;
+        free(data);
+        
+        if(!success)
+        {
+            std::cerr<<"CProgramBinaryCache: [ERROR] failed to save program binary: "<<path<<"\n";
+            remove(tmp.c_str());
+            return false;
+        }
+        
+        m_uStored++;
+        m_fStoreTimeMs += timer.GetElapsedMs();
+        return true;
+#else
+        return false;
+#endif
+    }
+    
+    void CProgramBinaryCache::Clear()
+    {
+        DIR* dir = opendir(GetDirectory().c_str());
+        if(dir == NULL)
+            return;
+        
+        struct dirent* entry;
+        while((entry = readdir(dir)) != NULL)
+        {
+            size_t length = strlen(entry->d_name);
+            if(length > 5 && strcmp(entry->d_name + length - 5, ".vvpb") == 0)
+                remove((GetDirectory() + "/" + entry->d_name).c_str());
+        }
+        closedir(dir);
+    }
+    
+    void CProgramBinaryCache::AddCompileTime(float64 elapsed_ms)
+    {
+        m_uCompiled++;
+        m_fCompileTimeMs += elapsed_ms;
+    }
+    
+    void CProgramBinaryCache::PrintReport() const
+    {
+        std::cerr<<"CProgramBinaryCache: [INFO] shader startup cost: "<<(m_fLoadTimeMs + m_fCompileTimeMs + m_fStoreTimeMs)<<" ms\n";
+        std::cerr<<"    binaries loaded:   "<<m_uHits<<" ( "<<m_uRejected<<" rejected, "<<m_uMisses<<" missing) in "<<m_fLoadTimeMs<<" ms\n";
+        std::cerr<<"    compiled programs: "<<m_uCompiled<<" in "<<m_fCompileTimeMs<<" ms\n";
+        std::cerr<<"    binaries saved:    "<<m_uStored<<" in "<<m_fStoreTimeMs<<" ms\n";
+    }
+    
+    void CProgramBinaryCache::ResetCounters()
+    {
+        m_uHits = 0;
+        m_uMisses = 0;
+        m_uRejected = 0;
+        m_uCompiled = 0;
+        m_uStored = 0;
+        m_fLoadTimeMs = 0.0;
+        m_fCompileTimeMs = 0.0;
+        m_fStoreTimeMs = 0.0;
+    }
+}
@@ -0,0 +1,174 @@
+/* ProgramBinaryCache.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_PROGRAM_BINARY_CACHE_H
+#define VVISION_PROGRAM_BINARY_CACHE_H
+
+#include "types.h"
+#include "Singleton.h"
+
+namespace vvision
+{
+    /** program binary file layout ( one file per program in the cache directory, named after the program key)
+     *
+     * [SProgramBinaryHeader]
+     * [binary]                 binaryLength bytes returned by glGetProgramBinaryOES
+     */
+    
+    /** "VVPB"*/
+    #define VV_PROGRAM_BINARY_MAGIC 0x42505656
+    
+    /** version of the layout described above*/
+    #define VV_PROGRAM_BINARY_VERSION 1
+    
+    /** program binary header*/
+    struct SProgramBinaryHeader
+    {
+        uint32 magic;
+        uint32 version;
+        
+        /** hash and total length of the vertex and fragment sources*/
+        uint32 sourceHash;
+        uint32 sourceLength;
+        
+        /** hash of GL_VENDOR, GL_RENDERER and GL_VERSION, a driver update invalidates the binary*/
+        uint32 driverHash;
+        
+        /** binary format returned by glGetProgramBinaryOES*/
+        uint32 format;
+        
+        /** size of the binary following the header*/
+        uint32 binaryLength;
+        
+        /** padding*/
+        uint32 reserved;
+    };
+    
+    /** persistent cache of linked programs through GL_OES_get_program_binary.
+     * programs are keyed by the hash of their sources and of the driver strings, a miss or a binary rejected by the driver
+     * falls back to compiling from source ( the new binary then replaces the stale one).
+     * the cache is inactive when the extension is not exposed by the device or the sdk, shaders are then always compiled.
+     * the cache also accumulates the time spent loading programs, check PrintReport.
+     */
+    CREATE_SINGLETON( CProgramBinaryCache )
+    
+    public :
+    
+    /** check if the device can save and load program binaries*/
+    bool IsSupported();
+    
+    /** enable/disable the cache ( enabled by default)*/
+    inline void SetEnabled(bool enabled) {m_bEnabled = enabled;}
+    
+    /** check if the cache is enabled*/
+    inline bool IsEnabled() const {return m_bEnabled;}
+    
+    /** set the directory where binaries are saved, default is $HOME/Library/Caches/vvshaders*/
+    inline void SetDirectory(const string& directory) {m_sDirectory = directory;}
+    
+    /** directory where binaries are saved*/
+    const string& GetDirectory();
+    
+    /** load the binary of the program built from the given sources, a negative length means a null terminated source
+     * @return true if a binary was found and the driver linked it, the program is then ready to use
+     */
+    bool Load(GLuint program, const char8* vertex_shader, int32 vertex_shader_length, const char8* fragment_shader, int32 fragment_shader_length);
+    
+    /** save the binary of a program successfully linked from the given sources*/
+    bool Store(GLuint program, const char8* vertex_shader, int32 vertex_shader_length, const char8* fragment_shader, int32 fragment_shader_length);
+    
+    /** delete every binary saved in the cache directory*/
+    void Clear();
+    
+    /** account a program compiled and linked from source in elapsed_ms*/
+    void AddCompileTime(float64 elapsed_ms);
+    
+    /** number of programs loaded from a binary*/
+    inline uint32 GetHitCount() const {return m_uHits;}
+    
+    /** number of programs without binary in the cache*/
+    inline uint32 GetMissCount() const {return m_uMisses;}
+    
+    /** number of binaries rejected ( corrupted, stale or refused by the driver)*/
+    inline uint32 GetRejectedCount() const {return m_uRejected;}
+    
+    /** number of programs compiled from source*/
+    inline uint32 GetCompiledCount() const {return m_uCompiled;}
+    
+    /** time spent loading binaries ( hits and rejected binaries) in ms*/
+    inline float64 GetLoadTime() const {return m_fLoadTimeMs;}
+    
+    /** time spent compiling and linking programs from source in ms*/
+    inline float64 GetCompileTime() const {return m_fCompileTimeMs;}
+    
+    /** time spent saving binaries in ms*/
+    inline float64 GetStoreTime() const {return m_fStoreTimeMs;}
+    
+    /** print the startup shader cost*/
+    void PrintReport() const;
+    
+    /** reset the counters and timings*/
+    void ResetCounters();
+    
+private:
+    
+    /** not allowed*/
+    CProgramBinaryCache();
+    
+    /** not allowed*/
+    ~CProgramBinaryCache() {}
+    
+    /** not allowed*/
+    CProgramBinaryCache(const CProgramBinaryCache&);
+    
+    /** not allowed*/
+    CProgramBinaryCache& operator=(const CProgramBinaryCache&);
+    
+    /** query extension support and driver strings, only the first call reaches gl*/
+    void QueryCaps();
+    
+    /** hash and total length of the sources*/
+    static void HashSources(const char8* vertex_shader, int32 vertex_shader_length, const char8* fragment_shader, int32 fragment_shader_length, uint32& hash, uint32& length);
+    
+    /** path of the binary file for a program*/
+    string GetFilePath(uint32 source_hash, uint32 source_length);
+    
+    /** caps*/
+    bool m_bCapsQueried;
+    bool m_bSupported;
+    uint32 m_uDriverHash;
+    
+    /** settings*/
+    bool m_bEnabled;
+    string m_sDirectory;
+    bool m_bDirectoryCreated;
+    
+    /** counters*/
+    uint32 m_uHits;
+    uint32 m_uMisses;
+    uint32 m_uRejected;
+    uint32 m_uCompiled;
+    uint32 m_uStored;
+    float64 m_fLoadTimeMs;
+    float64 m_fCompileTimeMs;
+    float64 m_fStoreTimeMs;
+};
+}
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ *  RenderBackend.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "RenderBackend.h"
+#include "RenderStateCache.h"
+#include "Shader.h"
+#include "Material.h"
+
+namespace vvision
+{
+    void CGLRenderBackend::UseProgram(CShader* shader)
+    {
+        shader->Begin();
+    }
+    
+    void CGLRenderBackend::BindMaterial(CShader* shader, CMaterial* material)
+    {
+        CRenderStateCache& cache = CRenderStateCache::Instance();
+        
+        if(material == NULL)
+        {
+            cache.Disable(GL_BLEND);
+            cache.DepthMask(GL_TRUE);
+            cache.Enable(GL_CULL_FACE);
+            return;
+        }
+        
+        //fixed function state
+        if(material->isTransparent)
+        {
+            cache.Enable(GL_BLEND);
+            cache.DepthMask(GL_FALSE);
+        }
+        else
+        {
+            cache.Disable(GL_BLEND);
+            cache.DepthMask(GL_TRUE);
+        }
+        
+        if(material->twoSided)
+            cache.Disable(GL_CULL_FACE);
+        else
+            cache.Enable(GL_CULL_FACE);
+        
+        //textures
+        if(material->diffuseTexture != NULL && shader->texture0 != -1)
+        {
+            material->diffuseTexture->ActivateAndBind(GL_TEXTURE0);
+            shader->SetUniform1i("texture0", 0, shader->texture0);
+        }
+        
+        if(material->bumpTexture != NULL && shader->textureBump != -1)
+        {
+            material->bumpTexture->ActivateAndBind(GL_TEXTURE1);
+            shader->SetUniform1i("textureBump", 1, shader->textureBump);
+        }
+        
+        if(material->specularTexture != NULL && shader->textureSpecular != -1)
+        {
+            material->specularTexture->ActivateAndBind(GL_TEXTURE2);
+            shader->SetUniform1i("textureSpecular", 2, shader->textureSpecular);
+        }
+        
+        if(material->detailTexture != NULL && shader->textureDetail != -1)
+        {
+            material->detailTexture->ActivateAndBind(GL_TEXTURE3);
+            shader->SetUniform1i("textureDetail", 3, shader->textureDetail);
+            shader->SetUniform1f("detailFactor", material->detailFactor, shader->detailFactor);
+        }
+        
+        //colors
+        if(shader->matColorAmbient != -1)
+            shader->SetUniform4fv("matColorAmbient", 1, material->ambient, shader->matColorAmbient);
+        
+        if(shader->matColorDiffuse != -1)
+            shader->SetUniform4fv("matColorDiffuse", 1, material->diffuse, shader->matColorDiffuse);
+        
+        if(shader->matColorSpecular != -1)
+            shader->SetUniform4fv("matColorSpecular", 1, material->specular, shader->matColorSpecular);
+        
+        if(shader->matShininess != -1)
+            shader->SetUniform1f("matShininess", material->shininess, shader->matShininess);
+        
+        if(shader->matOpacity != -1)
+            shader->SetUniform1f("matOpacity", material->opacity, shader->matOpacity);
+    }
+    
+    void CGLRenderBackend::UniformMatrix4(CShader* shader, int32 location, const float32* value)
+    {
+        shader->SetUniformMatrix4x4fv(NULL, 1, GL_FALSE, value, location);
+    }
+    
+    void CGLRenderBackend::BindVertexArray(GLuint vao)
+    {
+        CRenderStateCache::Instance().BindVertexArray(vao);
+    }
+    
+    void CGLRenderBackend::DrawElements(GLenum mode, uint32 count, GLenum type, uint32 offset)
+    {
+        glDrawElements(mode, count, type, (const GLvoid*)(size_t)offset);
+    }
+    
+    void CGLRenderBackend::SetEnabled(GLenum cap, bool enabled)
+    {
+        CRenderStateCache::Instance().SetEnabled(cap, enabled);
+    }
+    
+    void CGLRenderBackend::DepthMask(bool enabled)
+    {
+        CRenderStateCache::Instance().DepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
@@ -0,0 +1,167 @@
+/* RenderBackend.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef VVISION_RENDER_BACKEND_H
+#define VVISION_RENDER_BACKEND_H
+
+#include "types.h"
+
+namespace vvision
+{
+    class CShader;
+    class CMaterial;
+    
+    /** commands recorded in a CCommandBuffer*/
+    enum RENDER_COMMAND
+    {
+        /** make a program current*/
+        kRENDER_COMMAND_USE_PROGRAM = 0,
+        
+        /** bind material textures and upload material uniforms*/
+        kRENDER_COMMAND_BIND_MATERIAL,
+        
+        /** upload a 4x4 matrix uniform*/
+        kRENDER_COMMAND_UNIFORM_MATRIX4,
+        
+        /** bind a vertex array object*/
+        kRENDER_COMMAND_BIND_VERTEX_ARRAY,
+        
+        /** indexed draw*/
+        kRENDER_COMMAND_DRAW_ELEMENTS,
+        
+        /** enable/disable a capability*/
+        kRENDER_COMMAND_SET_ENABLED,
+        
+        /** depth writes*/
+        kRENDER_COMMAND_DEPTH_MASK,
+        
+        /** number of commands*/
+        kRENDER_COMMAND_COUNT
+    };
+    
+    /** target of the replay of a command buffer, the only place where recorded commands reach the graphics api*/
+    class IRenderBackend
+    {
+    public:
+        
+        /** destructor*/
+        virtual ~IRenderBackend() {}
+        
+        /** make the program of shader current*/
+        virtual void UseProgram(CShader* shader) = 0;
+        
+        /** bind the material textures and upload its uniforms to shader ( shader is current)*/
+        virtual void BindMaterial(CShader* shader, CMaterial* material) = 0;
+        
+        /** upload a 4x4 matrix to the uniform at location*/
+        virtual void UniformMatrix4(CShader* shader, int32 location, const float32* value) = 0;
+        
+        /** bind a vertex array object*/
+        virtual void BindVertexArray(GLuint vao) = 0;
+        
+        /** draw count indices of type starting at offset bytes in the bound element buffer*/
+        virtual void DrawElements(GLenum mode, uint32 count, GLenum type, uint32 offset) = 0;
+        
+        /** enable/disable a capability*/
+        virtual void SetEnabled(GLenum cap, bool enabled) = 0;
+        
+        /** enable/disable depth writes*/
+        virtual void DepthMask(bool enabled) = 0;
+    };
+    
+    /** replays commands on the current gl context through CRenderStateCache, must be used on the thread that owns the context.
+     *
+     * material binding: diffuse texture on unit 0 ( texture0), bump on unit 1 ( textureBump), specular on unit 2 ( textureSpecular),
+     * detail on unit 3 ( textureDetail, detailFactor), material colors, shininess and opacity when the shader uses them.
+     * twoSided disables face culling and isTransparent enables alpha blending without depth writes.
+     */
+    class CGLRenderBackend: public IRenderBackend
+    {
+    public:
+        
+        /** @inherited from IRenderBackend*/
+        virtual void UseProgram(CShader* shader);
+        
+        /** @inherited from IRenderBackend*/
+        virtual void BindMaterial(CShader* shader, CMaterial* material);
+        
+        /** @inherited from IRenderBackend*/
+        virtual void UniformMatrix4(CShader* shader, int32 location, const float32* value);
+        
+        /** @inherited from IRenderBackend*/
+        virtual void BindVertexArray(GLuint vao);
+        
+        /** @inherited from IRenderBackend*/
+        virtual void DrawElements(GLenum mode, uint32 count, GLenum type, uint32 offset);
+        
+        /** @inherited from IRenderBackend*/
+        virtual void SetEnabled(GLenum cap, bool enabled);
+        
+        /** @inherited from IRenderBackend*/
+        virtual void DepthMask(bool enabled);
+    };
+    
+    /** headless stub: replays commands without a gl context, only counts them.
+     * used to test and benchmark recording and replay on machines without a gpu.
+     */
+    class CNullRenderBackend: public IRenderBackend
+    {
+    public:
+        
+        /** constructor*/
+        CNullRenderBackend() {Reset();}
+        
+        /** @inherited from IRenderBackend*/
+        virtual void UseProgram(CShader* /*shader*/) {m_vCommands[kRENDER_COMMAND_USE_PROGRAM]++;}
+        
+        /** @inherited from IRenderBackend*/
+        virtual void BindMaterial(CShader* /*shader*/, CMaterial* /*material*/) {m_vCommands[kRENDER_COMMAND_BIND_MATERIAL]++;}
+        
+        /** @inherited from IRenderBackend*/
+        virtual void UniformMatrix4(CShader* /*shader*/, int32 /*location*/, const float32* /*value*/) {m_vCommands[kRENDER_COMMAND_UNIFORM_MATRIX4]++;}
+        
+        /** @inherited from IRenderBackend*/
+        virtual void BindVertexArray(GLuint /*vao*/) {m_vCommands[kRENDER_COMMAND_BIND_VERTEX_ARRAY]++;}
+        
+        /** @inherited from IRenderBackend*/
+        virtual void DrawElements(GLenum /*mode*/, uint32 count, GLenum /*type*/, uint32 /*offset*/) {m_vCommands[kRENDER_COMMAND_DRAW_ELEMENTS]++; m_uIndices += count;}
+        
+        /** @inherited from IRenderBackend*/
+        virtual void SetEnabled(GLenum /*cap*/, bool /*enabled*/) {m_vCommands[kRENDER_COMMAND_SET_ENABLED]++;}
+        
+        /** @inherited from IRenderBackend*/
+        virtual void DepthMask(bool /*enabled*/) {m_vCommands[kRENDER_COMMAND_DEPTH_MASK]++;}
+        
+        /** number of commands of a type replayed since the last reset*/
+        inline uint32 GetCommandCount(RENDER_COMMAND command) const {return m_vCommands[command];}
+        
+        /** number of indices drawn since the last reset*/
+        inline uint32 GetIndexCount() const {return m_uIndices;}
+        
+        /** reset the counters*/
+        inline void Reset() {memset(m_vCommands, 0, sizeof(m_vCommands)); m_uIndices = 0;}
+        
+    private:
+        
+        /** counters*/
+        uint32 m_vCommands[kRENDER_COMMAND_COUNT];
+        uint32 m_uIndices;
+    };
+}
+
+#endif
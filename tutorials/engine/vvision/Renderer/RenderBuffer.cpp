@@ -8,6 +8,7 @@
  */
 
 #include "RenderBuffer.h"
+#include "RenderStateCache.h"
 namespace vvision
 {
     
@@ -17,16 +18,17 @@ namespace vvision
     }
     CRenderBuffer::~CRenderBuffer()
     {
+        CRenderStateCache::Instance().OnDeleteRenderbuffer(m_uID);
         glDeleteRenderbuffers(1,&m_uID);
         
     }
     void CRenderBuffer::Bind()
     {
-        glBindRenderbuffer(GL_RENDERBUFFER, m_uID);
+        CRenderStateCache::Instance().BindRenderbuffer(m_uID);
     }
     void CRenderBuffer::UnBind()
     {
-        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        CRenderStateCache::Instance().BindRenderbuffer(0);
     }
     bool CRenderBuffer::SetParameters(GLenum internalFormat, int32  width, int32 height)
     {
@@ -49,7 +51,7 @@ namespace vvision
     bool CRenderBuffer::_GuardedBind()
     {
         // Only binds if m_render buffer id  is different than the currently bound to render buffer
-        glGetIntegerv( GL_RENDERBUFFER_BINDING, &m_iSaveID );
+        m_iSaveID = (GLint)CRenderStateCache::Instance().GetRenderbuffer();
         if (m_uID != (GLuint)m_iSaveID) {
             Bind();
             return true;
@@ -60,7 +62,7 @@ namespace vvision
     {
         
         if (m_uID != (GLuint)m_iSaveID) {
-            glBindRenderbuffer(GL_RENDERBUFFER, (GLuint)m_iSaveID);
+            CRenderStateCache::Instance().BindRenderbuffer((GLuint)m_iSaveID);
             return true;
         } return false;
     }
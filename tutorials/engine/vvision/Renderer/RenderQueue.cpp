@@ -0,0 +1,300 @@
+/*
+ *  RenderQueue.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "RenderQueue.h"
+#include "RenderStateCache.h"
+#include <iostream>
+#include <algorithm>
+
+namespace vvision
+{
+    CRenderQueue::CRenderQueue()
+    {
+        m_mView.identity();
+        m_mProjection.identity();
+        m_mProjectionView.identity();
+        memset(&m_sStats, 0, sizeof(SRenderQueueStats));
+    }
+    
+    CRenderQueue::~CRenderQueue()
+    {
+        m_vPackets.clear();
+        m_vItems.clear();
+        m_vSwap.clear();
+    }
+    
+    void CRenderQueue::Begin(const mat4f& view, const mat4f& projection)
+    {
+        m_mView = view;
+        m_mProjection = projection;
+        m_mProjectionView = projection * view;
+        
+        //capacity is kept, no allocation once the queue has seen its biggest frame
+        m_vPackets.clear();
+        m_vPrograms.clear();
+        m_vMaterials.clear();
+    }
+    
+    uint32 CRenderQueue::GetProgramId(CShader* shader)
+    {
+        //a handful of programs per frame, a linear search beats a map
+        for(uint32 i = 0; i < m_vPrograms.size(); ++i)
+        {
+            if(m_vPrograms[i] == shader)
+                return i;
+        }
+        
+        m_vPrograms.push_back(shader);
+        uint32 id = m_vPrograms.size() - 1;
+
+#ifdef DEBUG
+        if(id >= (1u << kRENDER_QUEUE_PROGRAM_BITS))
+            std::cerr<<"CRenderQueue: [WARNING] more than "<<(1u << kRENDER_QUEUE_PROGRAM_BITS)<<" programs in a frame, programs will not be grouped\n";
+#endif
+        return id & ((1u << kRENDER_QUEUE_PROGRAM_BITS) - 1);
+    }
+    
+    uint32 CRenderQueue::GetMaterialId(CMaterial* material)
+    {
+        if(material == NULL)
+            return 0;
+        
+        //0 is the id of NULL, the ids of the other materials cycle in [1, 2^bits - 1]
+        const uint32 ids = (1u << kRENDER_QUEUE_MATERIAL_BITS) - 1;
+        
+        //materials are usually submitted in runs ( groups of a mesh), check the last ones first
+        for(int32 i = (int32)m_vMaterials.size() - 1; i >= 0; --i)
+        {
+            if(m_vMaterials[i] == material)
+                return i % ids + 1;
+        }
+        
+        m_vMaterials.push_back(material);
+        uint32 index = m_vMaterials.size() - 1;
+
+#ifdef DEBUG
+        if(index == ids)
+            std::cerr<<"CRenderQueue: [WARNING] more than "<<ids<<" materials in a frame, materials will not be grouped\n";
+#endif
+        return index % ids + 1;
+    }
+    
+    uint32 CRenderQueue::QuantizeDepth(float32 depth)
+    {
+        //the bits of a positive float sort like the float, keep the top bits below the sign
+        if(!(depth > 0.f))
+            return 0;
+        
+        uint32 bits;
+        memcpy(&bits, &depth, sizeof(uint32));
+        return bits >> (31 - kRENDER_QUEUE_DEPTH_BITS);
+    }
+    
+    void CRenderQueue::Submit(CShader* shader, CMaterial* material, GLuint vao, GLenum mode, GLenum index_type, uint32 first_index, uint32 index_count, const mat4f& transform, const CBoundingBox& bbox)
+    {
+        assert(shader != NULL);
+        
+        if(index_count == 0)
+            return;
+        
+        //view space distance of the center
+        vec3f center = bbox.GetCenter();
+        vec4f viewPos = m_mView * (transform * vec4f(center.x, center.y, center.z, 1.f));
+        uint32 depth = QuantizeDepth(-viewPos.z);
+        
+        uint64 program = GetProgramId(shader);
+        uint64 materialId = GetMaterialId(material);
+        uint64 key;
+        
+        if(material != NULL && material->isTransparent)
+        {
+            //back to front: farthest first
+            uint64 invDepth = ((1u << kRENDER_QUEUE_DEPTH_BITS) - 1) - depth;
+            key = ((uint64)1 << kRENDER_QUEUE_LAYER_SHIFT)
+                | (invDepth << (kRENDER_QUEUE_PROGRAM_BITS + kRENDER_QUEUE_MATERIAL_BITS + kRENDER_QUEUE_UNUSED_BITS))
+                | (program << (kRENDER_QUEUE_MATERIAL_BITS + kRENDER_QUEUE_UNUSED_BITS))
+                | (materialId << kRENDER_QUEUE_UNUSED_BITS);
+        }
+        else
+        {
+            key = (program << (kRENDER_QUEUE_MATERIAL_BITS + kRENDER_QUEUE_DEPTH_BITS + kRENDER_QUEUE_UNUSED_BITS))
+                | (materialId << (kRENDER_QUEUE_DEPTH_BITS + kRENDER_QUEUE_UNUSED_BITS))
+                | ((uint64)depth << kRENDER_QUEUE_UNUSED_BITS);
+        }
+        
+        SDrawPacket packet;
+        packet.key = key;
+        packet.shader = shader;
+        packet.material = material;
+        packet.vao = vao;
+        packet.mode = mode;
+        packet.indexType = index_type;
+        packet.firstIndex = first_index;
+        packet.indexCount = index_count;
+        packet.transform = &transform;
+        m_vPackets.push_back(packet);
+    }
+    
+    void CRenderQueue::Submit(CShader* shader, CMaterial* material, CMeshGroup* group, const mat4f& transform, uint32 lod)
+    {
+        assert(group != NULL);
+        
+        //a group that is not allocated yet has nothing to draw
+        if(group->GetLodCount() == 0)
+            return;
+        
+        lod = std::min(lod, group->GetLodCount() - 1);
+        Submit(shader, material, group->GetVertexArray(), group->GetDrawingMode(), group->GetIndexType(), group->GetFirstIndex(lod), group->GetLod(lod).indexCount, transform, group->GetBoundingBox());
+    }
+    
+    void CRenderQueue::Sort()
+    {
+        uint32 count = m_vItems.size();
+        m_vSwap.resize(count);
+        
+        SSortItem* src = &m_vItems[0];
+        SSortItem* dst = &m_vSwap[0];
+        
+        for(uint32 shift = 0; shift < 64; shift += 8)
+        {
+            uint32 histogram[256];
+            memset(histogram, 0, sizeof(histogram));
+            
+            for(uint32 i = 0; i < count; ++i)
+                histogram[(src[i].key >> shift) & 0xFF]++;
+            
+            //every key has the same byte, the pass would not move anything ( the unused low bits are always skipped)
+            if(histogram[(src[0].key >> shift) & 0xFF] == count)
+                continue;
+            
+            uint32 offset = 0;
+            for(uint32 b = 0; b < 256; ++b)
+            {
+                uint32 n = histogram[b];
+                histogram[b] = offset;
+                offset += n;
+            }
+            
+            for(uint32 i = 0; i < count; ++i)
+                dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+            
+            SSortItem* tmp = src;
+            src = dst;
+            dst = tmp;
+        }
+        
+        //odd number of passes, the sorted keys are in the swap buffer
+        if(src != &m_vItems[0])
+            m_vItems.swap(m_vSwap);
+    }
+    
+    void CRenderQueue::Record()
+    {
+        memset(&m_sStats, 0, sizeof(SRenderQueueStats));
+        m_cCommands.Reset();
+        
+        uint32 count = m_vPackets.size();
+        if(count == 0)
+            return;
+        
+        //sort
+        m_vItems.resize(count);
+        for(uint32 i = 0; i < count; ++i)
+        {
+            m_vItems[i].key = m_vPackets[i].key;
+            m_vItems[i].index = i;
+        }
+        Sort();
+        
+        //record
+        CShader* currentShader = NULL;
+        CMaterial* currentMaterial = NULL;
+        GLuint currentVao = 0;
+        bool materialBound = false;
+        
+        for(uint32 i = 0; i < count; ++i)
+        {
+            const SDrawPacket& packet = m_vPackets[m_vItems[i].index];
+            CShader* shader = packet.shader;
+            
+            if(shader != currentShader)
+            {
+                m_cCommands.UseProgram(shader);
+                currentShader = shader;
+                materialBound = false;
+                m_sStats.programChanges++;
+            }
+            
+            //material uniforms live in the program, rebind them when the program changes
+            if(!materialBound || packet.material != currentMaterial)
+            {
+                m_cCommands.BindMaterial(shader, packet.material);
+                currentMaterial = packet.material;
+                materialBound = true;
+                m_sStats.materialChanges++;
+            }
+            
+            //per draw uniforms, the matrix product is done here, not on the thread that owns the context
+            if(shader->matprojviewmodel != -1)
+            {
+                mat4f mat = m_mProjectionView * (*packet.transform);
+                m_cCommands.UniformMatrix4(shader, shader->matprojviewmodel, &mat[0]);
+            }
+            
+            if(shader->matmodel != -1)
+                m_cCommands.UniformMatrix4(shader, shader->matmodel, &(*packet.transform)[0]);
+            
+            if(packet.vao != currentVao)
+            {
+                m_cCommands.BindVertexArray(packet.vao);
+                currentVao = packet.vao;
+                m_sStats.vertexArrayChanges++;
+            }
+            
+            m_cCommands.DrawElements(packet.mode, packet.indexCount, packet.indexType, packet.firstIndex * GetIndexTypeSize((INDEX_TYPE)packet.indexType));
+            m_sStats.draws++;
+            if(packet.mode == GL_TRIANGLES)
+                m_sStats.triangles += packet.indexCount / 3;
+            
+            if(packet.material != NULL && packet.material->isTransparent)
+                m_sStats.transparentDraws++;
+        }
+        
+        //leave the default opaque state for the code drawing outside the queue
+        m_cCommands.SetEnabled(GL_BLEND, false);
+        m_cCommands.DepthMask(true);
+        m_cCommands.SetEnabled(GL_CULL_FACE, true);
+    }
+    
+    void CRenderQueue::Execute()
+    {
+        CRenderStateCache& cache = CRenderStateCache::Instance();
+        SRenderStateCounters before = cache.GetCounters();
+        
+        m_cCommands.Execute(m_cBackend);
+        
+        SRenderStateCounters after = cache.GetCounters();
+        m_sStats.stateIssued = (after.issued + after.textureIssued) - (before.issued + before.textureIssued);
+        m_sStats.stateElided = (after.elided + after.textureElided) - (before.elided + before.textureElided);
+    }
+    
+    void CRenderQueue::Execute(IRenderBackend& backend)
+    {
+        m_cCommands.Execute(backend);
+    }
+    
+    void CRenderQueue::PrintReport() const
+    {
+        std::cerr<<"CRenderQueue: [INFO] "<<m_sStats.draws<<" draws ( "<<m_sStats.transparentDraws<<" transparent), "<<m_sStats.triangles<<" triangles, "<<m_cCommands.GetCommandCount()<<" commands ( "<<m_cCommands.GetSize()<<" bytes)\n";
+        std::cerr<<"    program changes:      "<<m_sStats.programChanges<<"\n";
+        std::cerr<<"    material changes:     "<<m_sStats.materialChanges<<"\n";
+        std::cerr<<"    vertex array changes: "<<m_sStats.vertexArrayChanges<<"\n";
+        std::cerr<<"    gl state changes:     "<<m_sStats.stateIssued<<" issued, "<<m_sStats.stateElided<<" elided\n";
+    }
+}
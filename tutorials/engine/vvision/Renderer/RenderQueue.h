@@ -0,0 +1,200 @@
+/* RenderQueue.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef VVISION_RENDER_QUEUE_H
+#define VVISION_RENDER_QUEUE_H
+
+#include "types.h"
+#include "vmath.h"
+#include "Shader.h"
+#include "Material.h"
+#include "MeshBuffer.h"
+#include "CommandBuffer.h"
+
+namespace vvision
+{
+    /** sort key layout ( most significant bits first)
+     *
+     * opaque:      [1 layer = 0][12 program][16 material][24 depth, front to back][11 unused]
+     * transparent: [1 layer = 1][24 depth, back to front][12 program][16 material][11 unused]
+     *
+     * opaque draws are grouped by program then material, and drawn front to back inside a material to help early depth rejection.
+     * transparent draws are drawn back to front after every opaque draw, state grouping only breaks depth ties.
+     */
+    enum
+    {
+        kRENDER_QUEUE_LAYER_SHIFT = 63,
+        kRENDER_QUEUE_PROGRAM_BITS = 12,
+        kRENDER_QUEUE_MATERIAL_BITS = 16,
+        kRENDER_QUEUE_DEPTH_BITS = 24,
+        kRENDER_QUEUE_UNUSED_BITS = 11
+    };
+    
+    /** a draw call submitted by an entity, recorded when the queue is sorted*/
+    struct SDrawPacket
+    {
+        /** sort key*/
+        uint64 key;
+        
+        /** program*/
+        CShader* shader;
+        
+        /** material, can be NULL*/
+        CMaterial* material;
+        
+        /** vertex array object and index range ( in indices, from the start of the element buffer)*/
+        GLuint vao;
+        GLenum mode;
+        GLenum indexType;
+        uint32 firstIndex;
+        uint32 indexCount;
+        
+        /** model transformation, owned by the entity and must stay valid until Record*/
+        const mat4f* transform;
+    };
+    
+    /** draw calls and state changes of a record/execution*/
+    struct SRenderQueueStats
+    {
+        /** draw calls issued*/
+        uint32 draws;
+        
+        /** transparent draw calls among them*/
+        uint32 transparentDraws;
+        
+        /** triangles drawn*/
+        uint32 triangles;
+        
+        /** program, material and vertex array switches*/
+        uint32 programChanges;
+        uint32 materialChanges;
+        uint32 vertexArrayChanges;
+        
+        /** gl state changes issued and elided during the execution on gl, check CRenderStateCache*/
+        uint32 stateIssued;
+        uint32 stateElided;
+    };
+    
+    /** sort based draw submission: entities submit draw packets with a 64 bit key, the queue radix sorts them and records
+     * them in its command buffer with the least program, material and vertex array changes.
+     *
+     * Begin, Submit and Record never call gl: queues of different passes can be recorded in parallel, on worker threads
+     * ( one thread per queue), then executed in order by the thread that owns the context. Flush records and executes.
+     * materials are bound by the backend, check CGLRenderBackend.
+     * uniforms shared by every draw of a program ( lights, camera, clip plane...) must be set on the program before Execute.
+     */
+    class CRenderQueue
+    {
+    public:
+        
+        /** constructor*/
+        CRenderQueue();
+        
+        /** destructor*/
+        ~CRenderQueue();
+        
+        /** start recording draws seen from view/projection, the packets of the previous flush are dropped*/
+        void Begin(const mat4f& view, const mat4f& projection);
+        
+        /** record a draw, the depth is taken at the center of bbox ( in model space)*/
+        void Submit(CShader* shader, CMaterial* material, GLuint vao, GLenum mode, GLenum index_type, uint32 first_index, uint32 index_count, const mat4f& transform, const CBoundingBox& bbox);
+        
+        /** view and projection of the draws recorded since Begin*/
+        inline const mat4f& GetView() const {return m_mView;}
+        inline const mat4f& GetProjection() const {return m_mProjection;}
+        
+        /** record the draw of a level of detail of a mesh group ( check CMeshGroup::SelectLod)*/
+        void Submit(CShader* shader, CMaterial* material, CMeshGroup* group, const mat4f& transform, uint32 lod = 0);
+        
+        /** sort the packets and record them in the command buffer ( no gl call)*/
+        void Record();
+        
+        /** replay the command buffer on gl, must be called by the thread that owns the context*/
+        void Execute();
+        
+        /** replay the command buffer on backend ( a headless backend for example)*/
+        void Execute(IRenderBackend& backend);
+        
+        /** record and execute*/
+        inline void Flush() {Record(); Execute();}
+        
+        /** commands recorded by the last Record*/
+        inline const CCommandBuffer& GetCommands() const {return m_cCommands;}
+        
+        /** number of packets recorded since Begin*/
+        inline uint32 GetPacketCount() const {return m_vPackets.size();}
+        
+        /** stats of the last record/execution*/
+        inline const SRenderQueueStats& GetStats() const {return m_sStats;}
+        
+        /** print the stats of the last record/execution*/
+        void PrintReport() const;
+    
+    private:
+        
+        /** sortable entry, index of the packet in m_vPackets*/
+        struct SSortItem
+        {
+            uint64 key;
+            uint32 index;
+        };
+        
+        /** dense id of the shader/material for this frame ( the key stores ids, not pointers)*/
+        uint32 GetProgramId(CShader* shader);
+        uint32 GetMaterialId(CMaterial* material);
+        
+        /** quantize a view space depth to kRENDER_QUEUE_DEPTH_BITS, order preserving*/
+        static uint32 QuantizeDepth(float32 depth);
+        
+        /** lsd radix sort of m_vItems by key, 8 bits per pass, passes where every key has the same byte are skipped*/
+        void Sort();
+        
+        /** view and projection*/
+        mat4f m_mView;
+        mat4f m_mProjection;
+        mat4f m_mProjectionView;
+        
+        /** recorded packets*/
+        std::vector<SDrawPacket> m_vPackets;
+        
+        /** sort buffers ( kept between frames to avoid allocations)*/
+        std::vector<SSortItem> m_vItems;
+        std::vector<SSortItem> m_vSwap;
+        
+        /** programs and materials seen this frame, the position is the id*/
+        std::vector<CShader*> m_vPrograms;
+        std::vector<CMaterial*> m_vMaterials;
+        
+        /** commands of the sorted packets*/
+        CCommandBuffer m_cCommands;
+        
+        /** gl replay*/
+        CGLRenderBackend m_cBackend;
+        
+        /** stats*/
+        SRenderQueueStats m_sStats;
+        
+        /** not allowed*/
+        CRenderQueue(const CRenderQueue&);
+        
+        /** not allowed*/
+        CRenderQueue& operator=(const CRenderQueue&);
+    };
+}
+
+#endif
@@ -0,0 +1,287 @@
+/*
+ *  RenderStateCache.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "RenderStateCache.h"
+#include <string.h>
+
+namespace vvision
+{
+    /** shadow value meaning "unknown", forces the next call to reach gl*/
+    static const GLuint kRENDER_STATE_UNKNOWN = 0xFFFFFFFF;
+    
+    /** capabilities of es 2.0, in shadow slot order*/
+    static const GLenum s_vCaps[kRENDER_STATE_MAX_CAPS] =
+    {
+        GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_DITHER, GL_POLYGON_OFFSET_FILL,
+        GL_SAMPLE_ALPHA_TO_COVERAGE, GL_SAMPLE_COVERAGE, GL_SCISSOR_TEST, GL_STENCIL_TEST
+    };
+    
+    CRenderStateCache::CRenderStateCache()
+    : m_uIssued(0), m_uElided(0), m_uQueries(0), m_uVertexArrayIssued(0), m_uVertexArrayElided(0)
+    {
+        memset(&m_sFrameCounters, 0, sizeof(m_sFrameCounters));
+        Invalidate();
+    }
+    
+    void CRenderStateCache::Invalidate()
+    {
+        for(uint32 i = 0; i < kRENDER_STATE_MAX_CAPS; i++)
+            m_vCaps[i] = kRENDER_STATE_UNKNOWN;
+        
+        m_uBlendSrc = kRENDER_STATE_UNKNOWN;
+        m_uBlendDst = kRENDER_STATE_UNKNOWN;
+        m_uDepthMask = kRENDER_STATE_UNKNOWN;
+        m_uDepthFunc = kRENDER_STATE_UNKNOWN;
+        m_uCullFace = kRENDER_STATE_UNKNOWN;
+        m_bViewportKnown = false;
+        
+        m_uFramebuffer = kRENDER_STATE_UNKNOWN;
+        m_uRenderbuffer = kRENDER_STATE_UNKNOWN;
+        m_uProgram = kRENDER_STATE_UNKNOWN;
+        m_uVertexArray = kRENDER_STATE_UNKNOWN;
+        
+        CTextureStateTracker::Instance().Invalidate();
+    }
+    
+    void CRenderStateCache::BeginFrame(GLuint framebuffer, GLsizei width, GLsizei height)
+    {
+        m_sFrameCounters = GetCounters();
+        ResetCounters();
+        
+        //the view binds its framebuffer and sets the viewport with gl directly, the renderbuffer is bound to present the frame
+        m_uFramebuffer = framebuffer;
+        m_uRenderbuffer = kRENDER_STATE_UNKNOWN;
+        m_vViewport[0] = 0;
+        m_vViewport[1] = 0;
+        m_vViewport[2] = width;
+        m_vViewport[3] = height;
+        m_bViewportKnown = true;
+    }
+    
+    int32 CRenderStateCache::CapSlot(GLenum cap)
+    {
+        for(int32 i = 0; i < kRENDER_STATE_MAX_CAPS; i++)
+        {
+            if(s_vCaps[i] == cap)
+                return i;
+        }
+        return -1;
+    }
+    
+    bool CRenderStateCache::Change(GLuint& shadow, GLuint value)
+    {
+        if(shadow == value)
+        {
+            m_uElided++;
+            return false;
+        }
+        
+        shadow = value;
+        m_uIssued++;
+        return true;
+    }
+    
+    GLuint CRenderStateCache::Query(GLuint& shadow, GLenum pname)
+    {
+        if(shadow == kRENDER_STATE_UNKNOWN)
+        {
+            GLint value = 0;
+            glGetIntegerv(pname, &value);
+            shadow = (GLuint)value;
+            m_uQueries++;
+        }
+        return shadow;
+    }
+    
+    void CRenderStateCache::SetEnabled(GLenum cap, bool enabled)
+    {
+        int32 slot = CapSlot(cap);
+        if(slot >= 0 && !Change(m_vCaps[slot], enabled ? 1 : 0))
+            return;
+        
+        if(enabled)
+            glEnable(cap);
+        else
+            glDisable(cap);
+    }
+    
+    bool CRenderStateCache::IsEnabled(GLenum cap)
+    {
+        int32 slot = CapSlot(cap);
+        if(slot < 0)
+            return glIsEnabled(cap) == GL_TRUE;
+        
+        if(m_vCaps[slot] == kRENDER_STATE_UNKNOWN)
+        {
+            m_vCaps[slot] = glIsEnabled(cap) == GL_TRUE ? 1 : 0;
+            m_uQueries++;
+        }
+        return m_vCaps[slot] == 1;
+    }
+    
+    void CRenderStateCache::BlendFunc(GLenum sfactor, GLenum dfactor)
+    {
+        if(m_uBlendSrc == sfactor && m_uBlendDst == dfactor)
+        {
+            m_uElided++;
+            return;
+        }
+        
+        m_uBlendSrc = sfactor;
+        m_uBlendDst = dfactor;
+        m_uIssued++;
+        glBlendFunc(sfactor, dfactor);
+    }
+    
+    void CRenderStateCache::DepthMask(GLboolean flag)
+    {
+        if(Change(m_uDepthMask, flag ? GL_TRUE : GL_FALSE))
+            glDepthMask(flag);
+    }
+    
+    void CRenderStateCache::DepthFunc(GLenum func)
+    {
+        if(Change(m_uDepthFunc, func))
+            glDepthFunc(func);
+    }
+    
+    void CRenderStateCache::CullFace(GLenum mode)
+    {
+        if(Change(m_uCullFace, mode))
+            glCullFace(mode);
+    }
+    
+    void CRenderStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        if(m_bViewportKnown && m_vViewport[0] == x && m_vViewport[1] == y && m_vViewport[2] == width && m_vViewport[3] == height)
+        {
+            m_uElided++;
+            return;
+        }
+        
+        m_vViewport[0] = x;
+        m_vViewport[1] = y;
+        m_vViewport[2] = width;
+        m_vViewport[3] = height;
+        m_bViewportKnown = true;
+        m_uIssued++;
+        glViewport(x, y, width, height);
+    }
+    
+    void CRenderStateCache::GetViewport(GLint viewport[4])
+    {
+        if(!m_bViewportKnown)
+        {
+            glGetIntegerv(GL_VIEWPORT, m_vViewport);
+            m_bViewportKnown = true;
+            m_uQueries++;
+        }
+        memcpy(viewport, m_vViewport, sizeof(m_vViewport));
+    }
+    
+    void CRenderStateCache::BindFramebuffer(GLuint framebuffer)
+    {
+        if(Change(m_uFramebuffer, framebuffer))
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+    
+    GLuint CRenderStateCache::GetFramebuffer()
+    {
+        return Query(m_uFramebuffer, GL_FRAMEBUFFER_BINDING);
+    }
+    
+    void CRenderStateCache::BindRenderbuffer(GLuint renderbuffer)
+    {
+        if(Change(m_uRenderbuffer, renderbuffer))
+            glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    }
+    
+    GLuint CRenderStateCache::GetRenderbuffer()
+    {
+        return Query(m_uRenderbuffer, GL_RENDERBUFFER_BINDING);
+    }
+    
+    void CRenderStateCache::UseProgram(GLuint program)
+    {
+        if(Change(m_uProgram, program))
+            glUseProgram(program);
+    }
+    
+    GLuint CRenderStateCache::GetProgram()
+    {
+        return Query(m_uProgram, GL_CURRENT_PROGRAM);
+    }
+    
+    void CRenderStateCache::BindVertexArray(GLuint vao)
+    {
+        if(Change(m_uVertexArray, vao))
+        {
+            glBindVertexArrayOES(vao);
+            m_uVertexArrayIssued++;
+        }
+        else
+            m_uVertexArrayElided++;
+    }
+    
+    GLuint CRenderStateCache::GetVertexArray()
+    {
+        return Query(m_uVertexArray, GL_VERTEX_ARRAY_BINDING_OES);
+    }
+    
+    void CRenderStateCache::OnDeleteFramebuffer(GLuint framebuffer)
+    {
+        //gl binds 0 when the bound framebuffer is deleted
+        if(m_uFramebuffer == framebuffer)
+            m_uFramebuffer = 0;
+    }
+    
+    void CRenderStateCache::OnDeleteRenderbuffer(GLuint renderbuffer)
+    {
+        if(m_uRenderbuffer == renderbuffer)
+            m_uRenderbuffer = 0;
+    }
+    
+    void CRenderStateCache::OnDeleteProgram(GLuint program)
+    {
+        //the program in use is only flagged for deletion, the next UseProgram must reach gl even if the name is recycled
+        if(m_uProgram == program)
+            m_uProgram = kRENDER_STATE_UNKNOWN;
+    }
+    
+    void CRenderStateCache::OnDeleteVertexArray(GLuint vao)
+    {
+        if(m_uVertexArray == vao)
+            m_uVertexArray = 0;
+    }
+    
+    SRenderStateCounters CRenderStateCache::GetCounters() const
+    {
+        CTextureStateTracker& textures = CTextureStateTracker::Instance();
+        
+        SRenderStateCounters counters;
+        counters.issued = m_uIssued;
+        counters.elided = m_uElided;
+        counters.queries = m_uQueries;
+        counters.textureIssued = textures.GetBindsIssued() + textures.GetActiveUnitChanges();
+        counters.textureElided = textures.GetBindsSkipped();
+        counters.vertexArrayIssued = m_uVertexArrayIssued;
+        counters.vertexArrayElided = m_uVertexArrayElided;
+        return counters;
+    }
+    
+    void CRenderStateCache::ResetCounters()
+    {
+        m_uIssued = 0;
+        m_uElided = 0;
+        m_uQueries = 0;
+        m_uVertexArrayIssued = 0;
+        m_uVertexArrayElided = 0;
+        CTextureStateTracker::Instance().ResetCounters();
+    }
+}
@@ -0,0 +1,192 @@
+/* RenderStateCache.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_RENDER_STATE_CACHE_H
+#define VVISION_RENDER_STATE_CACHE_H
+
+#include "types.h"
+#include "Singleton.h"
+#include "TextureStateTracker.h"
+
+namespace vvision
+{
+    enum
+    {
+        /** number of capabilities shadowed by the cache ( every glEnable cap of es 2.0)*/
+        kRENDER_STATE_MAX_CAPS = 9
+    };
+    
+    /** state changes of a frame*/
+    struct SRenderStateCounters
+    {
+        /** state changes forwarded to gl*/
+        uint32 issued;
+        
+        /** state changes skipped because the state was already set*/
+        uint32 elided;
+        
+        /** glGet issued to fill an unknown shadow value*/
+        uint32 queries;
+        
+        /** texture binds ( and active unit changes) issued and skipped, check CTextureStateTracker*/
+        uint32 textureIssued;
+        uint32 textureElided;
+        
+        /** vertex array binds issued and skipped ( the buffer binds of the draws, check CBufferArena)*/
+        uint32 vertexArrayIssued;
+        uint32 vertexArrayElided;
+    };
+    
+    /** shadows the gl pipeline state ( capabilities, blend, depth, cull, viewport, framebuffer, renderbuffer, program and vertex array)
+     * so only real changes reach gl and state queries never stall the pipeline. textures are forwarded to CTextureStateTracker.
+     * every state change of the engine goes through the cache, code that changes state directly with gl must call Invalidate afterwards.
+     * an unknown shadow value ( after Invalidate) is read back with glGet once, on first use.
+     */
+    CREATE_SINGLETON( CRenderStateCache )
+    
+    public :
+    
+    /** start a new frame: framebuffer and viewport were set by the view ( outside the cache), the counters of the previous frame are saved and reset*/
+    void BeginFrame(GLuint framebuffer, GLsizei width, GLsizei height);
+    
+    /** forget the shadowed state ( after state was changed outside the cache or the context changed)*/
+    void Invalidate();
+    
+    /** glEnable/glDisable*/
+    void SetEnabled(GLenum cap, bool enabled);
+    inline void Enable(GLenum cap) {SetEnabled(cap, true);}
+    inline void Disable(GLenum cap) {SetEnabled(cap, false);}
+    
+    /** glIsEnabled served from the shadow state*/
+    bool IsEnabled(GLenum cap);
+    
+    /** glBlendFunc*/
+    void BlendFunc(GLenum sfactor, GLenum dfactor);
+    
+    /** glDepthMask*/
+    void DepthMask(GLboolean flag);
+    
+    /** glDepthFunc*/
+    void DepthFunc(GLenum func);
+    
+    /** glCullFace*/
+    void CullFace(GLenum mode);
+    
+    /** glViewport*/
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    
+    /** current viewport ( x, y, width, height)*/
+    void GetViewport(GLint viewport[4]);
+    
+    /** glBindFramebuffer ( GL_FRAMEBUFFER)*/
+    void BindFramebuffer(GLuint framebuffer);
+    
+    /** framebuffer currently bound*/
+    GLuint GetFramebuffer();
+    
+    /** glBindRenderbuffer ( GL_RENDERBUFFER)*/
+    void BindRenderbuffer(GLuint renderbuffer);
+    
+    /** renderbuffer currently bound*/
+    GLuint GetRenderbuffer();
+    
+    /** glUseProgram*/
+    void UseProgram(GLuint program);
+    
+    /** program currently in use*/
+    GLuint GetProgram();
+    
+    /** glBindVertexArrayOES*/
+    void BindVertexArray(GLuint vao);
+    
+    /** vertex array currently bound*/
+    GLuint GetVertexArray();
+    
+    /** bind texture to target on the given unit, check CTextureStateTracker*/
+    inline void BindTexture(GLenum texture_unit, GLenum target, GLuint texture) {CTextureStateTracker::Instance().Bind(texture_unit, target, texture);}
+    
+    /** objects about to be deleted, a recycled name must not be mistaken for the bound one*/
+    void OnDeleteFramebuffer(GLuint framebuffer);
+    void OnDeleteRenderbuffer(GLuint renderbuffer);
+    void OnDeleteProgram(GLuint program);
+    void OnDeleteVertexArray(GLuint vao);
+    
+    /** counters of the current frame*/
+    SRenderStateCounters GetCounters() const;
+    
+    /** counters of the last complete frame ( saved by BeginFrame)*/
+    inline const SRenderStateCounters& GetFrameCounters() const {return m_sFrameCounters;}
+    
+    /** reset the counters of the current frame*/
+    void ResetCounters();
+
+private:
+    
+    /** not allowed*/
+    CRenderStateCache();
+    
+    /** not allowed*/
+    ~CRenderStateCache() {}
+    
+    /** not allowed*/
+    CRenderStateCache(const CRenderStateCache&);
+    
+    /** not allowed*/
+    CRenderStateCache& operator=(const CRenderStateCache&);
+    
+    /** shadow slot of a capability, -1 if the capability is not tracked*/
+    static int32 CapSlot(GLenum cap);
+    
+    /** compare value with the shadow and store it, returns true if gl must be called*/
+    bool Change(GLuint& shadow, GLuint value);
+    
+    /** shadow of a binding, read back from gl if unknown*/
+    GLuint Query(GLuint& shadow, GLenum pname);
+    
+    /** capabilities ( 0, 1 or unknown)*/
+    GLuint m_vCaps[kRENDER_STATE_MAX_CAPS];
+    
+    /** blend, depth and cull state*/
+    GLuint m_uBlendSrc;
+    GLuint m_uBlendDst;
+    GLuint m_uDepthMask;
+    GLuint m_uDepthFunc;
+    GLuint m_uCullFace;
+    
+    /** viewport*/
+    GLint m_vViewport[4];
+    bool m_bViewportKnown;
+    
+    /** bindings*/
+    GLuint m_uFramebuffer;
+    GLuint m_uRenderbuffer;
+    GLuint m_uProgram;
+    GLuint m_uVertexArray;
+    
+    /** counters*/
+    uint32 m_uIssued;
+    uint32 m_uElided;
+    uint32 m_uQueries;
+    uint32 m_uVertexArrayIssued;
+    uint32 m_uVertexArrayElided;
+    SRenderStateCounters m_sFrameCounters;
+};
+}
+
+#endif
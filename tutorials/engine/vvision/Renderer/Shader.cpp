@@ -11,14 +11,21 @@
 #include <stdio.h>
 #include <fstream>
 #include <iostream>
+#include "Helpers.h"
+#include "ProgramBinaryCache.h"
+#include "Timer.h"
+#include "RenderStateCache.h"
 namespace vvision
 {
+    uint32 CShader::s_uTotalUploadsIssued = 0;
+    uint32 CShader::s_uTotalUploadsSkipped = 0;
     
     CShader::CShader()
+    : m_uUploadsIssued(0), m_uUploadsSkipped(0), m_uVertShader(0), m_uFragShader(0), m_bLoadedFromBinary(false)
     {
         
         m_uShadersProgram = glCreateProgram();
-        
+    
     }
     CShader::~CShader()
     {
@@ -30,20 +37,38 @@ namespace vvision
         
         if (m_uShadersProgram)
         {
+            CRenderStateCache::Instance().OnDeleteProgram(m_uShadersProgram);
             glDeleteProgram(m_uShadersProgram);
             CShader::m_uShadersProgram = 0;
         }
     }
     
     bool CShader::LoadShadersFromMemory(const char8 *vertex_shader, const char8* fragment_shader)
+    {
+        return LoadShadersFromMemory(vertex_shader, -1, fragment_shader, -1);
+    }
+    
+    bool CShader::LoadShadersFromMemory(const char8 *vertex_shader, int32 vertex_shader_length, const char8* fragment_shader, int32 fragment_shader_length)
     {
         if(!m_uShadersProgram)
             m_uShadersProgram = glCreateProgram();
         
-        if ( !CompileShader(&m_uVertShader, GL_VERTEX_SHADER, vertex_shader) )
+        //a binary linked by a previous launch skips compilation, attribute locations are part of the binary
+        CProgramBinaryCache& binaryCache = CProgramBinaryCache::Instance();
+        m_bLoadedFromBinary = binaryCache.Load(m_uShadersProgram, vertex_shader, vertex_shader_length, fragment_shader, fragment_shader_length);
+        if(m_bLoadedFromBinary)
+        {
+            BuildUniformTable();
+            BuildAttributeTable();
+            LoadShaderUniforms();
+            return true;
+        }
+        
+        CTimer timer;
+        if ( !CompileShader(&m_uVertShader, GL_VERTEX_SHADER, vertex_shader, vertex_shader_length) )
             return false;
         
-        if ( !CompileShader(&m_uFragShader, GL_FRAGMENT_SHADER, fragment_shader) )
+        if ( !CompileShader(&m_uFragShader, GL_FRAGMENT_SHADER, fragment_shader, fragment_shader_length) )
             return false;
         
         // Attach vertex shader to ShadersProgram.
@@ -62,11 +87,10 @@ namespace vvision
         
         glBindAttribLocation(m_uShadersProgram, ATTRIB_BONES_INDICES, "bones");
         glBindAttribLocation(m_uShadersProgram, ATTRIB_BONES_WEIGHTS, "weights");
+        glBindAttribLocation(m_uShadersProgram, ATTRIB_INSTANCE_MODEL, "instanceModel");
         
         if (!LinkProgram())
         {
-            //print log here
-            
             if (m_uVertShader)
             {
                 glDeleteShader(m_uVertShader);
@@ -82,76 +106,86 @@ namespace vvision
             return false;
         }
         
+        binaryCache.AddCompileTime(timer.GetElapsedMs());
+        binaryCache.Store(m_uShadersProgram, vertex_shader, vertex_shader_length, fragment_shader, fragment_shader_length);
+        
+        BuildUniformTable();
+        BuildAttributeTable();
         LoadShaderUniforms();
         return true;
     }
-    bool CShader::CompileShader(GLuint *shader, GLenum type, const char8* file )
+    bool CShader::CompileShader(GLuint *shader, GLenum type, const char8* file, int32 length)
     {
         GLint status;
         const GLchar *source = (GLchar*) file;
         
-        if (!source || !strlen(source))
+        if (!source || length == 0 || (length < 0 && !strlen(source)))
             return false;
         
         *shader = glCreateShader(type);
-        glShaderSource(*shader, 1, &source, NULL);
+        GLint sourceLength = length;
+        glShaderSource(*shader, 1, &source, length < 0 ? NULL : &sourceLength);
         glCompileShader(*shader);
         
+        glGetShaderiv(*shader, GL_COMPILE_STATUS, &status);
         
+        //compile errors are always reported, warnings only in debug
         GLint logLength;
         glGetShaderiv(*shader, GL_INFO_LOG_LENGTH, &logLength);
-        
-#ifdef DEBUG
-        if (logLength > 0)
+#ifndef DEBUG
+        if (status == 0)
+#endif
         {
-            GLchar *log = (GLchar *)malloc(logLength);
-            glGetShaderInfoLog(*shader, logLength, &logLength, log);
-            
-            // print log  here
-            cerr<<"CShader: [INFO] shader compile log: "<<log<<endl;
-            
-            free(log);
+            if (logLength > 1)
+            {
+                GLchar *log = (GLchar *)malloc(logLength);
+                glGetShaderInfoLog(*shader, logLength, &logLength, log);
+                cerr<<"CShader: "<<(status == 0 ? "[ERROR]" : "[INFO]")<<" "<<(type == GL_VERTEX_SHADER ? "vertex" : "fragment")<<" shader compile log: "<<log<<endl;
+                free(log);
+            }
         }
-#endif
-        
-        glGetShaderiv(*shader, GL_COMPILE_STATUS, &status);
         
         if (status == 0)
         {
-#ifdef DEBUG
-            cerr<<"CShader: [ERROR] failed to compile shader."<<endl;
-#endif
+            cerr<<"CShader: [ERROR] failed to compile "<<(type == GL_VERTEX_SHADER ? "vertex" : "fragment")<<" shader."<<endl;
             glDeleteShader(*shader);
+            *shader = 0;
             return false;
         }
         
         return true;
-        
+    
     }
     bool CShader::LinkProgram()
     {
         GLint status;
         glLinkProgram(m_uShadersProgram);
+        glGetProgramiv(m_uShadersProgram, GL_LINK_STATUS, &status);
         
-#ifdef DEBUG_SHADER_LINK_OUTPUT
-        GLint logLength;
-        glGetProgramiv(m_uShadersProgram, GL_INFO_LOG_LENGTH, &logLength);
-        if (logLength > 0)
+        //link errors are always reported, the link output of valid programs with DEBUG_SHADER_LINK_OUTPUT
+#ifndef DEBUG_SHADER_LINK_OUTPUT
+        if (status == 0)
+#endif
         {
-            GLchar *log = (GLchar *)malloc(logLength);
-            glGetProgramInfoLog(m_uShadersProgram, logLength, &logLength, log);
-            // print log  here
-            cerr<<"CShader: [INFO] link output:\n"<< log<<endl;
-            free(log);
+            GLint logLength;
+            glGetProgramiv(m_uShadersProgram, GL_INFO_LOG_LENGTH, &logLength);
+            if (logLength > 1)
+            {
+                GLchar *log = (GLchar *)malloc(logLength);
+                glGetProgramInfoLog(m_uShadersProgram, logLength, &logLength, log);
+                cerr<<"CShader: "<<(status == 0 ? "[ERROR]" : "[INFO]")<<" link output:\n"<< log<<endl;
+                free(log);
+            }
         }
-#endif
         
-        glGetProgramiv(m_uShadersProgram, GL_LINK_STATUS, &status);
-        if (m_uShadersProgram == 0)
+        if (status == 0)
+        {
+            cerr<<"CShader: [ERROR] failed to link program."<<endl;
             return false;
+        }
         
         return true;
-        
+    
     }
     bool CShader::ValidateProgram()
     {
@@ -172,214 +206,458 @@ namespace vvision
             return false;
         
         return true;
-        
+    
     }
     bool CShader::SetUniform1f(const GLchar* uniformName, GLfloat value,GLint location)
     {
-        if (location == -1) {
-            int loc =glGetUniformLocation(m_uShadersProgram, uniformName);
-            if (loc != -1)
-            {
-                glUniform1f(loc, value);
+        switch (PrepareUpload(uniformName, location, &value, 1))
+        {
+            case kUNIFORM_UPLOAD_ISSUE:
+                glUniform1f(location, value);
                 return true;
-            }
-            else
+            case kUNIFORM_UPLOAD_SKIP:
+                return true;
+            default:
                 return false;
-            
-        }
-        else {
-            //if u are here that mean that u have already  verified  that the location alread exist using getuniformlocation, so be careful
-            glUniform1f(location, value);
-            return true;
         }
-        
     }
     bool CShader::SetUniform1i(const GLchar* uniformName, GLint value, GLint location )
     {
-        if (location == -1) {
-            int loc =glGetUniformLocation(m_uShadersProgram, uniformName);
-            
-            if (loc != -1)
-            {
-                glUniform1i(loc, value);
+        switch (PrepareUpload(uniformName, location, &value, 1))
+        {
+            case kUNIFORM_UPLOAD_ISSUE:
+                glUniform1i(location, value);
                 return true;
-            }
-            else
+            case kUNIFORM_UPLOAD_SKIP:
+                return true;
+            default:
                 return false;
-            
-        }
-        else {
-            //if u are here that mean that u have already  verified  that the location alread exist using getuniformlocation, so be careful
-            glUniform1i(location, value);
-            
-            return true;
         }
     }
     bool CShader::SetUniform2fv(const GLchar* uniformName, GLsizei count, const GLfloat* value, GLint location)
     {
-        if (location == -1) {
-            int loc =glGetUniformLocation(m_uShadersProgram, uniformName);
-            if (loc != -1)
-            {
-                glUniform2fv(loc, count, value);
+        switch (PrepareUpload(uniformName, location, value, 2 * count))
+        {
+            case kUNIFORM_UPLOAD_ISSUE:
+                glUniform2fv(location, count, value);
                 return true;
-            }
-            else
+            case kUNIFORM_UPLOAD_SKIP:
+                return true;
+            default:
                 return false;
-            
-        }
-        else {
-            //if u are here that mean that u have already  verified  that the location alread exist using getuniformlocation, so be careful
-            glUniform2fv(location, count, value);
-            return true;
         }
     }
     bool CShader::SetUniform3fv(const GLchar* uniformName, GLsizei count, const GLfloat* value, GLint location)
     {
-        if (location == -1) {
-            int loc =glGetUniformLocation(m_uShadersProgram, uniformName);
-            if (loc != -1)
-            {
-                glUniform3fv(loc, count, value);
+        switch (PrepareUpload(uniformName, location, value, 3 * count))
+        {
+            case kUNIFORM_UPLOAD_ISSUE:
+                glUniform3fv(location, count, value);
                 return true;
-            }
-            else
+            case kUNIFORM_UPLOAD_SKIP:
+                return true;
+            default:
                 return false;
-            
-        }
-        else {
-            //if u are here that mean that u have already  verified  that the location alread exist using getuniformlocation, so be careful
-            glUniform3fv(location, count, value);
-            return true;
         }
     }
     
     bool CShader::SetUniform4fv(const GLchar* uniformName, GLsizei count, const GLfloat* value, GLint location)
     {
-        if (location == -1) {
-            int loc =glGetUniformLocation(m_uShadersProgram, uniformName);
-            if (loc != -1)
-            {
-                glUniform4fv(loc, count, value);
+        switch (PrepareUpload(uniformName, location, value, 4 * count))
+        {
+            case kUNIFORM_UPLOAD_ISSUE:
+                glUniform4fv(location, count, value);
                 return true;
-            }
-            else
+            case kUNIFORM_UPLOAD_SKIP:
+                return true;
+            default:
                 return false;
-            
-        }
-        else {
-            //if u are here that mean that u have already  verified  that the location alread exist using getuniformlocation, so be careful
-            glUniform4fv(location, count, value);
-            return true;
         }
     }
     
     bool CShader::SetUniformMatrix4x4fv(const GLchar* uniformName, GLsizei count, GLboolean transpose, const GLfloat* value,int location)
     {
-        if (location == -1) {
-            int loc =glGetUniformLocation(m_uShadersProgram, uniformName);
-            if (loc != -1)
-            {
-                glUniformMatrix4fv(loc, count, transpose, value);
+        switch (PrepareUpload(uniformName, location, value, 16 * count))
+        {
+            case kUNIFORM_UPLOAD_ISSUE:
+                glUniformMatrix4fv(location, count, transpose, value);
                 return true;
+            case kUNIFORM_UPLOAD_SKIP:
+                return true;
+            default:
+                return false;
+        }
+    }
+    bool CShader::SetUniformMatrix3x3fv(const GLchar* uniformName, GLsizei count, GLboolean transpose, const GLfloat* value, int location)
+    {
+        switch (PrepareUpload(uniformName, location, value, 9 * count))
+        {
+            case kUNIFORM_UPLOAD_ISSUE:
+                glUniformMatrix3fv(location, count, transpose, value);
+                return true;
+            case kUNIFORM_UPLOAD_SKIP:
+                return true;
+            default:
+                return false;
+        }
+    }
+    GLint CShader::GetUnifomLocation(const GLchar* uniformName)
+    {
+        int32 index = FindUniform(uniformName);
+        if(index >= 0)
+            return m_vUniforms[index].location;
+        
+        //array elements ( "bones[3]") are not in the table
+        return glGetUniformLocation(m_uShadersProgram, uniformName);
+    }
+    CShader::UNIFORM_UPLOAD CShader::PrepareUpload(const GLchar* uniformName, GLint& location, const void* value, uint32 words)
+    {
+        int32 index;
+        if (location == -1)
+        {
+            //name lookup in the table, no gl call
+            index = uniformName ? FindUniform(uniformName) : -1;
+            if(index < 0)
+            {
+                //array elements are not in the table, ask gl
+                location = uniformName ? glGetUniformLocation(m_uShadersProgram, uniformName) : -1;
+                if(location == -1)
+                    return kUNIFORM_UPLOAD_NOT_FOUND;
             }
             else
-                return false;
+                location = m_vUniforms[index].location;
         }
-        else {
-            glUniformMatrix4fv(location, count, transpose, value);
-            return true;
+        else
+        {
+            //if u are here that mean that u have already  verified  that the location alread exist using getuniformlocation, so be careful
+            index = FindUniform(location);
         }
+        
+        return CompareAndStore(index, value, words);
     }
-    bool CShader::SetUniformMatrix3x3fv(const GLchar* uniformName, GLsizei count, GLboolean transpose, const GLfloat* value, int location)
+    CShader::UNIFORM_UPLOAD CShader::CompareAndStore(int32 index, const void* value, uint32 words)
     {
-        if (location == -1) {
-            int loc =glGetUniformLocation(m_uShadersProgram, uniformName);
-            if (loc != -1)
+        //values that cant be shadowed ( array elements, count above the array size) are always uploaded
+        if(index >= 0)
+        {
+            SShaderUniform& uniform = m_vUniforms[index];
+            uint32* shadow = &m_vUniformValues[uniform.offset];
+            
+            if(words <= uniform.words)
             {
-                glUniformMatrix3fv(loc, count, transpose, value);
-                return true;
+                if(uniform.initialized && memcmp(shadow, value, words * sizeof(uint32)) == 0)
+                {
+                    m_uUploadsSkipped++;
+                    s_uTotalUploadsSkipped++;
+                    return kUNIFORM_UPLOAD_SKIP;
+                }
+                
+                memcpy(shadow, value, words * sizeof(uint32));
+                
+                //a partial upload of an array leaves the remaining elements unknown
+                uniform.initialized = words == uniform.words;
             }
             else
-                return false;
+                uniform.initialized = false;
+        }
+        
+        m_uUploadsIssued++;
+        s_uTotalUploadsIssued++;
+        return kUNIFORM_UPLOAD_ISSUE;
+    }
+    int32 CShader::FindUniform(const GLchar* uniformName) const
+    {
+        std::map<uint32, int32>::const_iterator it = m_mUniformsByHash.find(StringManipulator::Hash(uniformName));
+        if(it != m_mUniformsByHash.end() && m_vUniforms[it->second].name == uniformName)
+            return it->second;
+        
+        //hash collision, should never happen with the handful of uniforms of a program
+        if(it != m_mUniformsByHash.end())
+        {
+            for(uint32 i = 0; i < m_vUniforms.size(); i++)
+            {
+                if(m_vUniforms[i].name == uniformName)
+                    return i;
+            }
         }
-        else {
-            glUniformMatrix3fv(location, count, transpose, value);
+        return -1;
+    }
+    int32 CShader::FindUniform(GLint location) const
+    {
+        std::map<GLint, int32>::const_iterator it = m_mUniformsByLocation.find(location);
+        return it != m_mUniformsByLocation.end() ? it->second : -1;
+    }
+    void CShader::BuildUniformTable()
+    {
+        m_vUniforms.clear();
+        m_vUniformsByID.clear();
+        m_mUniformsByHash.clear();
+        m_mUniformsByLocation.clear();
+        m_vUniformValues.clear();
+        
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(m_uShadersProgram, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(m_uShadersProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        
+        std::vector<GLchar> name(maxLength + 1);
+        uint32 offset = 0;
+        
+        for(GLint i = 0; i < count; i++)
+        {
+            SShaderUniform uniform;
+            GLsizei length = 0;
+            glGetActiveUniform(m_uShadersProgram, i, maxLength + 1, &length, &uniform.size, &uniform.type, &name[0]);
+            
+            uniform.name.assign(&name[0], length);
+            size_t bracket = uniform.name.find('[');
+            if(bracket != string::npos)
+                uniform.name.erase(bracket);
+            
+            uniform.location = glGetUniformLocation(m_uShadersProgram, uniform.name.c_str());
+            if(uniform.location == -1)
+                continue;
+            
+            uint32 components;
+            switch (uniform.type)
+            {
+                case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_BOOL_VEC2:    components = 2; break;
+                case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_BOOL_VEC3:    components = 3; break;
+                case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_BOOL_VEC4:
+                case GL_FLOAT_MAT2:                                         components = 4; break;
+                case GL_FLOAT_MAT3:                                         components = 9; break;
+                case GL_FLOAT_MAT4:                                         components = 16; break;
+                default:                                                    components = 1; break;
+            }
+            
+            uniform.hash = StringManipulator::Hash(uniform.name.c_str());
+            uniform.components = components;
+            uniform.offset = offset;
+            uniform.words = components * uniform.size;
+            uniform.initialized = false;
+            offset += uniform.words;
+            
+            m_mUniformsByHash.insert(std::make_pair(uniform.hash, (int32)m_vUniforms.size()));
+            m_mUniformsByLocation[uniform.location] = (int32)m_vUniforms.size();
+            m_vUniforms.push_back(uniform);
+        }
+        
+        m_vUniformValues.resize(offset);
+    }
+    void CShader::BuildAttributeTable()
+    {
+        m_vAttributes.clear();
+        
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(m_uShadersProgram, GL_ACTIVE_ATTRIBUTES, &count);
+        glGetProgramiv(m_uShadersProgram, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+        
+        std::vector<GLchar> name(maxLength + 1);
+        for(GLint i = 0; i < count; i++)
+        {
+            SShaderAttribute attribute;
+            GLsizei length = 0;
+            glGetActiveAttrib(m_uShadersProgram, i, maxLength + 1, &length, &attribute.size, &attribute.type, &name[0]);
+            attribute.name.assign(&name[0], length);
+            attribute.location = glGetAttribLocation(m_uShadersProgram, attribute.name.c_str());
+            m_vAttributes.push_back(attribute);
+        }
+    }
+    GLint CShader::GetAttributeLocation(const GLchar* attributeName) const
+    {
+        for(uint32 i = 0; i < m_vAttributes.size(); i++)
+        {
+            if(m_vAttributes[i].name == attributeName)
+                return m_vAttributes[i].location;
+        }
+        return -1;
+    }
+    void CShader::ResolveUniformIDs()
+    {
+        uint32 registered = CShaderUniformID::GetRegisteredCount();
+        for(uint32 i = (uint32)m_vUniformsByID.size(); i < registered; i++)
+            m_vUniformsByID.push_back(FindUniform(CShaderUniformID::GetRegisteredName(i).c_str()));
+    }
+    bool CShader::Upload(const CShaderUniformID& id, const void* values, GLsizei count, uint32 components, bool isFloat)
+    {
+        int32 index = ResolveUniform(id);
+        if(index < 0 || count <= 0)
+            return false;
+        
+        const SShaderUniform& uniform = m_vUniforms[index];
+        
+        bool floatUniform;
+        switch (uniform.type)
+        {
+            case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+            case GL_BOOL: case GL_BOOL_VEC2: case GL_BOOL_VEC3: case GL_BOOL_VEC4:
+            case GL_SAMPLER_2D: case GL_SAMPLER_CUBE:
+                floatUniform = false;
+                break;
+            default:
+                floatUniform = true;
+                break;
+        }
+        
+        //a single value may carry more components than the uniform ( vec4f to a vec3), never less
+        if(floatUniform != isFloat || (components != 0 && components < uniform.components) || (components > uniform.components && count > 1))
+        {
+#ifdef DEBUG
+            cerr<<"CShader: [ERROR] type mismatch for uniform: "<<uniform.name<<endl;
+#endif
+            return false;
+        }
+        
+        if(count > uniform.size)
+            count = uniform.size;
+        
+        //the shadow copy holds packed elements, an oversized single value is compared on the used components only
+        if(CompareAndStore(index, values, uniform.components * count) == kUNIFORM_UPLOAD_SKIP)
             return true;
+        
+        const GLfloat* f = (const GLfloat*)values;
+        const GLint* i = (const GLint*)values;
+        GLint location = uniform.location;
+        
+        switch (uniform.type)
+        {
+            case GL_FLOAT:          glUniform1fv(location, count, f); break;
+            case GL_FLOAT_VEC2:     glUniform2fv(location, count, f); break;
+            case GL_FLOAT_VEC3:     glUniform3fv(location, count, f); break;
+            case GL_FLOAT_VEC4:     glUniform4fv(location, count, f); break;
+            case GL_FLOAT_MAT2:     glUniformMatrix2fv(location, count, GL_FALSE, f); break;
+            case GL_FLOAT_MAT3:     glUniformMatrix3fv(location, count, GL_FALSE, f); break;
+            case GL_FLOAT_MAT4:     glUniformMatrix4fv(location, count, GL_FALSE, f); break;
+            case GL_INT_VEC2:
+            case GL_BOOL_VEC2:      glUniform2iv(location, count, i); break;
+            case GL_INT_VEC3:
+            case GL_BOOL_VEC3:      glUniform3iv(location, count, i); break;
+            case GL_INT_VEC4:
+            case GL_BOOL_VEC4:      glUniform4iv(location, count, i); break;
+            default:                glUniform1iv(location, count, i); break;
         }
+        return true;
     }
-    GLint CShader::GetUnifomLocation(const GLchar* uniformName)
+    bool CShader::Set(const CShaderUniformID& id, GLint value)
     {
-        return glGetUniformLocation(m_uShadersProgram, uniformName);
+        return Upload(id, &value, 1, 1, false);
+    }
+    bool CShader::Set(const CShaderUniformID& id, GLfloat value)
+    {
+        return Upload(id, &value, 1, 1, true);
+    }
+    bool CShader::Set(const CShaderUniformID& id, const vec2f& value)
+    {
+        return Upload(id, &value.x, 1, 2, true);
+    }
+    bool CShader::Set(const CShaderUniformID& id, const vec3f& value)
+    {
+        return Upload(id, &value.x, 1, 3, true);
+    }
+    bool CShader::Set(const CShaderUniformID& id, const vec4f& value)
+    {
+        return Upload(id, &value.x, 1, 4, true);
+    }
+    bool CShader::Set(const CShaderUniformID& id, const mat3f& value)
+    {
+        return Upload(id, &value[0], 1, 9, true);
+    }
+    bool CShader::Set(const CShaderUniformID& id, const mat4f& value)
+    {
+        return Upload(id, &value[0], 1, 16, true);
+    }
+    bool CShader::Set(const CShaderUniformID& id, const GLfloat* values, GLsizei count)
+    {
+        return Upload(id, values, count, 0, true);
+    }
+    bool CShader::Set(const CShaderUniformID& id, const GLint* values, GLsizei count)
+    {
+        return Upload(id, values, count, 0, false);
+    }
+    void CShader::InvalidateUniforms()
+    {
+        for(uint32 i = 0; i < m_vUniforms.size(); i++)
+            m_vUniforms[i].initialized = false;
+    }
+    void CShader::ResetCounters()
+    {
+        m_uUploadsIssued = 0;
+        m_uUploadsSkipped = 0;
+    }
+    void CShader::ResetTotalCounters()
+    {
+        s_uTotalUploadsIssued = 0;
+        s_uTotalUploadsSkipped = 0;
     }
     void CShader::Begin()
     {
         if (m_uShadersProgram <= 0)
             return;
         
-        glUseProgram(m_uShadersProgram);
+        CRenderStateCache::Instance().UseProgram(m_uShadersProgram);
     }
     void CShader::End()
     {
-        glUseProgram(0);
+        //the program stays in use until another shader begins, unbinding it between passes is a wasted state change
     }
     void CShader::LoadShaderUniforms()
     {
+        //the legacy fields are read from the reflected tables, no gl call
+        
         //matrices
-        matproj = glGetUniformLocation(m_uShadersProgram,               "matProj");
-        matview = glGetUniformLocation(m_uShadersProgram,               "matView");
-        matmodel = glGetUniformLocation(m_uShadersProgram,              "matModel");
-        matViewModel  = glGetUniformLocation(m_uShadersProgram,          "matViewModel");
-        matprojviewmodel = glGetUniformLocation(m_uShadersProgram,      "matProjViewModel");
-        matnormal = glGetUniformLocation(m_uShadersProgram,             "matNormal");
+        matproj = FindUniformLocation("matProj");
+        matview = FindUniformLocation("matView");
+        matmodel = FindUniformLocation("matModel");
+        matViewModel  = FindUniformLocation("matViewModel");
+        matprojviewmodel = FindUniformLocation("matProjViewModel");
+        matnormal = FindUniformLocation("matNormal");
         
         //attribute
-        position = glGetAttribLocation(m_uShadersProgram,   "position");
-        normal = glGetAttribLocation(m_uShadersProgram,     "normal");
-        texcoord0 = glGetAttribLocation(m_uShadersProgram,  "texCoord0");
-        color = glGetAttribLocation(m_uShadersProgram,      "color");
-        tangent = glGetAttribLocation(m_uShadersProgram,    "tangent");
+        position = GetAttributeLocation("position");
+        normal = GetAttributeLocation("normal");
+        texcoord0 = GetAttributeLocation("texCoord0");
+        color = GetAttributeLocation("color");
+        tangent = GetAttributeLocation("tangent");
         
         ///diffuse
-        texture0 = glGetUniformLocation(m_uShadersProgram, "texture0");
+        texture0 = FindUniformLocation("texture0");
         
         //cube map
-        textureCubeMap = glGetUniformLocation(m_uShadersProgram, "textureCubeMap");
+        textureCubeMap = FindUniformLocation("textureCubeMap");
         
         //bump
-        textureBump = glGetUniformLocation(m_uShadersProgram, "textureBump");
+        textureBump = FindUniformLocation("textureBump");
         
         //specular
-        textureSpecular = glGetUniformLocation(m_uShadersProgram, "textureSpecular");
+        textureSpecular = FindUniformLocation("textureSpecular");
         //detail
-        textureDetail = glGetUniformLocation(m_uShadersProgram,     "textureDetail");
-        useDetailTexture = glGetUniformLocation(m_uShadersProgram,  "useDetailTexture");
-        detailFactor = glGetUniformLocation(m_uShadersProgram,      "detailFactor");
+        textureDetail = FindUniformLocation("textureDetail");
+        useDetailTexture = FindUniformLocation("useDetailTexture");
+        detailFactor = FindUniformLocation("detailFactor");
         
         //material
-        matColorAmbient = glGetUniformLocation(m_uShadersProgram,   "matColorAmbient");
-        matColorDiffuse = glGetUniformLocation(m_uShadersProgram,   "matColorDiffuse");
-        matColorSpecular = glGetUniformLocation(m_uShadersProgram,  "matColorSpecular");
-        matShininess = glGetUniformLocation(m_uShadersProgram,      "matShininess");
-        matOpacity  = glGetUniformLocation(m_uShadersProgram,       "matOpacity");
-        matColorEmissive = glGetUniformLocation(m_uShadersProgram,  "matColorEmissive");
+        matColorAmbient = FindUniformLocation("matColorAmbient");
+        matColorDiffuse = FindUniformLocation("matColorDiffuse");
+        matColorSpecular = FindUniformLocation("matColorSpecular");
+        matShininess = FindUniformLocation("matShininess");
+        matOpacity  = FindUniformLocation("matOpacity");
+        matColorEmissive = FindUniformLocation("matColorEmissive");
         
         //fog
-        fcolor = glGetUniformLocation(m_uShadersProgram,    "fColor");
-        fstartend = glGetUniformLocation(m_uShadersProgram, "fStartEnd");
+        fcolor = FindUniformLocation("fColor");
+        fstartend = FindUniformLocation("fStartEnd");
         
         //light
-        lightColorAmbient = glGetUniformLocation(m_uShadersProgram,     "lightColorAmbient");
-        lightColorDiffuse = glGetUniformLocation(m_uShadersProgram,     "lightColorDiffuse");
-        lightColorSpecular = glGetUniformLocation(m_uShadersProgram,    "lightColorSpecular");
-        lightPosition = glGetUniformLocation(m_uShadersProgram,         "lightPosition");
-        lightAttenuation = glGetUniformLocation(m_uShadersProgram,      "lightAttenuation");
+        lightColorAmbient = FindUniformLocation("lightColorAmbient");
+        lightColorDiffuse = FindUniformLocation("lightColorDiffuse");
+        lightColorSpecular = FindUniformLocation("lightColorSpecular");
+        lightPosition = FindUniformLocation("lightPosition");
+        lightAttenuation = FindUniformLocation("lightAttenuation");
         
         //time
-        time = glGetUniformLocation(m_uShadersProgram, "Time");
+        time = FindUniformLocation("Time");
         
         //position
-        cameraPosition = glGetUniformLocation(m_uShadersProgram, "cameraPosition");
-        
+        cameraPosition = FindUniformLocation("cameraPosition");
+    
     }
 }
@@ -21,9 +21,55 @@
 #define GL_SHADER_H
 
 #include "types.h"
+#include "ShaderUniforms.h"
 
 namespace vvision
 {
+    /** an active uniform of a linked program, built with glGetActiveUniform*/
+    struct SShaderUniform
+    {
+        /** name, without the "[0]" suffix of arrays*/
+        string name;
+        
+        /** StringManipulator::Hash of the name*/
+        uint32 hash;
+        
+        /** location of the first element*/
+        GLint location;
+        
+        /** gl type ( GL_FLOAT_VEC4, GL_SAMPLER_2D ...)*/
+        GLenum type;
+        
+        /** array length, 1 for non array uniforms*/
+        GLint size;
+        
+        /** number of 32 bits components of one element ( 16 for a mat4)*/
+        uint32 components;
+        
+        /** offset and size in 32 bits words of the last uploaded value in the shadow storage*/
+        uint32 offset;
+        uint32 words;
+        
+        /** false until a value is uploaded through the shader*/
+        bool initialized;
+    };
+    
+    /** an active attribute of a linked program, built with glGetActiveAttrib*/
+    struct SShaderAttribute
+    {
+        /** name*/
+        string name;
+        
+        /** location ( bound before linking for the engine attributes, check ATTRIB_VERTEX ...)*/
+        GLint location;
+        
+        /** gl type ( GL_FLOAT_VEC4 ...)*/
+        GLenum type;
+        
+        /** array length*/
+        GLint size;
+    };
+    
     class CShader
     {
         
@@ -41,6 +87,11 @@ namespace vvision
          */
         bool LoadShadersFromMemory(const char8 *vertex_shader, const char8* fragment_shader);
         
+        /** load compile and link shader from sources that are not necessarily null terminated ( mapped files), return true if success
+         * @param vertex_shader_length/fragment_shader_length size in bytes of each source
+         */
+        bool LoadShadersFromMemory(const char8 *vertex_shader, int32 vertex_shader_length, const char8* fragment_shader, int32 fragment_shader_length);
+        
         /** send float unifrom to shader
          * set location = -1 if you dont know the location of the uniform
          * @return true if success
@@ -69,6 +120,56 @@ namespace vvision
         /** get the uniform location given unifrom name*/
         GLint GetUnifomLocation(const GLchar* uniformName);
         
+        /** set uniform by id ( check ShaderUniforms.h), the shader must be active. the value must match the type declared in the shader
+         * ( a vec4f can be sent to a vec3 uniform, the extra component is ignored). unchanged values are skipped.
+         * @return false if the uniform is not used by the shader or the type doesnt match
+         */
+        bool Set(const CShaderUniformID& id, GLint value);
+        bool Set(const CShaderUniformID& id, GLfloat value);
+        bool Set(const CShaderUniformID& id, const vec2f& value);
+        bool Set(const CShaderUniformID& id, const vec3f& value);
+        bool Set(const CShaderUniformID& id, const vec4f& value);
+        bool Set(const CShaderUniformID& id, const mat3f& value);
+        bool Set(const CShaderUniformID& id, const mat4f& value);
+        
+        /** set count elements of a uniform ( arrays), the gl call is chosen from the type declared in the shader.
+         * values must hold count elements of that type ( count * 16 floats for a mat4 array)
+         */
+        bool Set(const CShaderUniformID& id, const GLfloat* values, GLsizei count);
+        bool Set(const CShaderUniformID& id, const GLint* values, GLsizei count);
+        
+        /** check if the shader uses the uniform*/
+        inline bool HasUniform(const CShaderUniformID& id) {return ResolveUniform(id) >= 0;}
+        
+        /** active uniforms of the program*/
+        inline const std::vector<SShaderUniform>& GetUniforms() const {return m_vUniforms;}
+        
+        /** active attributes of the program*/
+        inline const std::vector<SShaderAttribute>& GetAttributes() const {return m_vAttributes;}
+        
+        /** location of an active attribute, -1 if not used by the shader*/
+        GLint GetAttributeLocation(const GLchar* attributeName) const;
+        
+        /** check if the program was loaded from a binary saved by a previous launch ( check CProgramBinaryCache)*/
+        inline bool IsLoadedFromBinary() const {return m_bLoadedFromBinary;}
+        
+        /** uniform uploads issued/skipped ( value unchanged) by this shader since the last reset*/
+        inline uint32 GetUploadsIssued() const {return m_uUploadsIssued;}
+        inline uint32 GetUploadsSkipped() const {return m_uUploadsSkipped;}
+        
+        /** uniform uploads issued/skipped by all shaders since the last reset*/
+        static inline uint32 GetTotalUploadsIssued() {return s_uTotalUploadsIssued;}
+        static inline uint32 GetTotalUploadsSkipped() {return s_uTotalUploadsSkipped;}
+        
+        /** reset the counters of this shader*/
+        void ResetCounters();
+        
+        /** reset the counters of all shaders, call it once per frame to get per frame numbers*/
+        static void ResetTotalCounters();
+        
+        /** forget the uploaded values, the next upload of every uniform reaches gl ( call it after setting uniforms with gl directly)*/
+        void InvalidateUniforms();
+        
         /** validate shader ( used in debug mode)
          * check if shader is setup correctly
          */
@@ -77,9 +178,13 @@ namespace vvision
         /** activate shader*/
         void Begin();
         
-        /** desactivate shader*/
+        /** desactivate shader ( the program stays in use until another shader begins)*/
         void End();
         
+        /** deprecated, locations of the former fixed uniforms and attributes ( -1 if not active), filled from the reflected tables
+         * after each link for the code that still reads them. use the CShaderUniformID setters, HasUniform and GetAttributeLocation
+         */
+        
         /** unifroms*/
         int32 matproj;
         int32 matview;
@@ -147,15 +252,86 @@ namespace vvision
         CShader(const CShader& shader);
         CShader& operator=(const CShader& shader);
         
-        /** compile shader*/
-        bool CompileShader(GLuint *shader, GLenum type, const char8* file );
+        /** compile shader ( length = -1 if the source is null terminated)*/
+        bool CompileShader(GLuint *shader, GLenum type, const char8* file, int32 length = -1);
         
-        /** link*/
+        /** link, returns false if the link status is not set*/
         bool LinkProgram();
         
-        /** uniform locations*/
+        /** fill the deprecated location fields from the uniform and attribute tables*/
         void LoadShaderUniforms();
         
+        /** build the uniform and attribute tables after linking*/
+        void BuildUniformTable();
+        void BuildAttributeTable();
+        
+        /** index in m_vUniforms of a uniform id, -1 if not active*/
+        inline int32 ResolveUniform(const CShaderUniformID& id)
+        {
+            if(id.GetIndex() >= m_vUniformsByID.size())
+                ResolveUniformIDs();
+            return m_vUniformsByID[id.GetIndex()];
+        }
+        
+        /** resolve the ids registered since the last call*/
+        void ResolveUniformIDs();
+        
+        /** upload count elements to a uniform by id
+         * @param components number of 32 bits components of one element of values
+         * @param isFloat true if values are floats
+         */
+        bool Upload(const CShaderUniformID& id, const void* values, GLsizei count, uint32 components, bool isFloat);
+        
+        /** index in m_vUniforms of the uniform, -1 if not active*/
+        int32 FindUniform(const GLchar* uniformName) const;
+        int32 FindUniform(GLint location) const;
+        
+        /** location of an active uniform from the table, -1 if not active ( no gl call)*/
+        inline GLint FindUniformLocation(const GLchar* uniformName) const {int32 index = FindUniform(uniformName); return index >= 0 ? m_vUniforms[index].location : -1;}
+        
+        /** result of PrepareUpload*/
+        enum UNIFORM_UPLOAD
+        {
+            /** uniform not active*/
+            kUNIFORM_UPLOAD_NOT_FOUND,
+            
+            /** same value already uploaded*/
+            kUNIFORM_UPLOAD_SKIP,
+            
+            /** value must be sent to gl*/
+            kUNIFORM_UPLOAD_ISSUE
+        };
+        
+        /** resolve the location and compare value with the shadow copy ( updated if different)
+         * @param words size of the value in 32 bits words
+         */
+        UNIFORM_UPLOAD PrepareUpload(const GLchar* uniformName, GLint& location, const void* value, uint32 words);
+        
+        /** compare value with the shadow copy of the uniform ( updated if different)*/
+        UNIFORM_UPLOAD CompareAndStore(int32 index, const void* value, uint32 words);
+        
+        /** active uniforms*/
+        std::vector<SShaderUniform> m_vUniforms;
+        
+        /** active attributes*/
+        std::vector<SShaderAttribute> m_vAttributes;
+        
+        /** uniform index by id ( CShaderUniformID::GetIndex), -1 for uniforms not used by the program*/
+        std::vector<int32> m_vUniformsByID;
+        
+        /** uniform index by name hash and by location*/
+        std::map<uint32, int32> m_mUniformsByHash;
+        std::map<GLint, int32> m_mUniformsByLocation;
+        
+        /** shadow copy of the uploaded values*/
+        std::vector<uint32> m_vUniformValues;
+        
+        /** counters*/
+        uint32 m_uUploadsIssued;
+        uint32 m_uUploadsSkipped;
+        static uint32 s_uTotalUploadsIssued;
+        static uint32 s_uTotalUploadsSkipped;
+        
         /** shader program*/
         GLuint m_uShadersProgram;
         
@@ -165,6 +341,9 @@ namespace vvision
         /** fragment shader*/
         GLuint m_uFragShader;
         
+        /** program loaded from a binary*/
+        bool m_bLoadedFromBinary;
+    
     };
 }
 #endif
\ No newline at end of file
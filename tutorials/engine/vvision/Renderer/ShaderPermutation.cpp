@@ -0,0 +1,109 @@
+/*
+ *  ShaderPermutation.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "ShaderPermutation.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace vvision
+{
+    /** define name of every feature bit*/
+    static const struct {SHADER_FEATURE feature; const char8* define;} s_vFeatureDefines[] =
+    {
+        {kSHADER_FEATURE_BUMP, "VV_BUMP"},
+        {kSHADER_FEATURE_DETAIL, "VV_DETAIL"},
+        {kSHADER_FEATURE_FOG, "VV_FOG"},
+        {kSHADER_FEATURE_SKINNING, "VV_SKINNING"},
+        {kSHADER_FEATURE_CLIP_PLANE, "VV_CLIP_PLANE"},
+        {kSHADER_FEATURE_INSTANCING, "VV_INSTANCING"},
+        {kSHADER_FEATURE_INSTANCING_UNIFORMS, "VV_INSTANCING_UNIFORMS"}
+    };
+    
+    string GetShaderPermutationName(const string& name, const SShaderPermutation& permutation)
+    {
+        if(permutation.GetKey() == 0)
+            return name;
+        
+        char8 key[16];
+        sprintf(key, "#%08x", permutation.GetKey());
+        return name + key;
+    }
+    
+    /** check if the line starting at str is a directive that must stay before the injected defines*/
+    static bool IsLeadingDirective(const char8* str, const char8* end)
+    {
+        while(str < end && (*str == ' ' || *str == '\t'))
+            str++;
+        
+        if(str == end || *str != '#')
+            return false;
+        
+        str++;
+        while(str < end && (*str == ' ' || *str == '\t'))
+            str++;
+        
+        return (end - str >= 7 && strncmp(str, "version", 7) == 0) || (end - str >= 9 && strncmp(str, "extension", 9) == 0);
+    }
+    
+    void BuildShaderPermutation(const SShaderPermutation& permutation, const char8* source, int32 length, string& output)
+    {
+        output.clear();
+        if(source == NULL)
+            return;
+        
+        const char8* end = source + (length < 0 ? strlen(source) : (size_t)length);
+        
+        //find the end of the last #version/#extension line
+        const char8* insert = source;
+        uint32 line = 1, insertLine = 1;
+        for(const char8* str = source; str < end; line++)
+        {
+            const char8* eol = (const char8*)memchr(str, '\n', end - str);
+            const char8* next = eol ? eol + 1 : end;
+            if(IsLeadingDirective(str, eol ? eol : end))
+            {
+                insert = next;
+                insertLine = line + 1;
+            }
+            str = next;
+        }
+        
+        output.reserve((end - source) + 256);
+        output.append(source, insert);
+        if(insert > source && insert[-1] != '\n')
+            output += '\n';
+        
+        char8 define[64];
+        for(uint32 i = 0; i < sizeof(s_vFeatureDefines) / sizeof(s_vFeatureDefines[0]); i++)
+        {
+            if(!permutation.Has(s_vFeatureDefines[i].feature))
+                continue;
+            
+            sprintf(define, "#define %s 1\n", s_vFeatureDefines[i].define);
+            output += define;
+        }
+        
+        if(permutation.Has(kSHADER_FEATURE_SKINNING))
+        {
+            sprintf(define, "#define VV_BONES %u\n", permutation.bones);
+            output += define;
+        }
+        
+        if(permutation.Has(kSHADER_FEATURE_INSTANCING_UNIFORMS))
+        {
+            sprintf(define, "#define VV_INSTANCES %u\n", (uint32)kSHADER_INSTANCING_UNIFORM_COUNT);
+            output += define;
+        }
+        
+        //glsl es 1.0: the line following "#line n" is line n + 1
+        sprintf(define, "#line %u\n", insertLine - 1);
+        output += define;
+        output.append(insert, end);
+    }
+}
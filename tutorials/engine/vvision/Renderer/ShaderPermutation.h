@@ -0,0 +1,96 @@
+/* ShaderPermutation.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_SHADER_PERMUTATION_H
+#define VVISION_SHADER_PERMUTATION_H
+
+#include "types.h"
+
+namespace vvision
+{
+    /** optional features of a shader, each feature enabled in a permutation is injected as a #define in both stages,
+     * so one base .vsh/.fsh replaces hand copied variants and runtime branches become static code
+     */
+    enum SHADER_FEATURE
+    {
+        /** #define VV_BUMP, per pixel normal from textureBump*/
+        kSHADER_FEATURE_BUMP = 1 << 0,
+        
+        /** #define VV_DETAIL, detail texture modulation*/
+        kSHADER_FEATURE_DETAIL = 1 << 1,
+        
+        /** #define VV_FOG, linear fog*/
+        kSHADER_FEATURE_FOG = 1 << 2,
+        
+        /** #define VV_SKINNING and VV_BONES ( bone count of the permutation)*/
+        kSHADER_FEATURE_SKINNING = 1 << 3,
+        
+        /** #define VV_CLIP_PLANE, fragments on the wrong side of the clip plane are discarded*/
+        kSHADER_FEATURE_CLIP_PLANE = 1 << 4,
+        
+        /** #define VV_INSTANCING, the model matrix is the per instance attribute instanceModel ( EXT_instanced_arrays)*/
+        kSHADER_FEATURE_INSTANCING = 1 << 5,
+        
+        /** #define VV_INSTANCING_UNIFORMS and VV_INSTANCES, the model matrix is instanceModels[int(bones.x)]*/
+        kSHADER_FEATURE_INSTANCING_UNIFORMS = 1 << 6
+    };
+    
+    /** model matrices of a draw of kSHADER_FEATURE_INSTANCING_UNIFORMS, 96 of the 128 vertex uniform vectors es 2.0 guarantees*/
+    enum
+    {
+        kSHADER_INSTANCING_UNIFORM_COUNT = 24
+    };
+    
+    /** a set of features enabled for a base shader*/
+    struct SShaderPermutation
+    {
+        /** constructor, no features ( the base shader as is)*/
+        SShaderPermutation() : features(0), bones(0) {}
+        
+        /** constructor
+         * @param f SHADER_FEATURE bits
+         * @param b bone count, only used with kSHADER_FEATURE_SKINNING
+         */
+        SShaderPermutation(uint32 f, uint32 b = 0) : features(f), bones((f & kSHADER_FEATURE_SKINNING) ? b : 0) {}
+        
+        /** check if a feature is enabled*/
+        inline bool Has(SHADER_FEATURE feature) const {return (features & feature) != 0;}
+        
+        /** key identifying the permutation, the bone count lives in the high bits*/
+        inline uint32 GetKey() const {return (features & 0xFFFF) | (bones << 16);}
+        
+        /** SHADER_FEATURE bits*/
+        uint32 features;
+        
+        /** bone count*/
+        uint32 bones;
+    };
+    
+    /** name a permutation of a base shader is cached under ( base name when no feature is enabled)*/
+    string GetShaderPermutationName(const string& name, const SShaderPermutation& permutation);
+    
+    /** write the source of a permutation: the #define block of the enabled features is inserted after the #version/#extension
+     * directives ( they must come first in glsl es) and followed by a #line so compile errors point to the base file lines
+     * @param source base shader source, a negative length means a null terminated source
+     * @param output the specialized source
+     */
+    void BuildShaderPermutation(const SShaderPermutation& permutation, const char8* source, int32 length, string& output);
+}
+
+#endif
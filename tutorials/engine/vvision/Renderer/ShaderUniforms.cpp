@@ -0,0 +1,96 @@
+/*
+ *  ShaderUniforms.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "ShaderUniforms.h"
+#include "Helpers.h"
+
+namespace vvision
+{
+    /** registered names, built during static initialization ( function statics so the order of the translation units doesnt matter)*/
+    static std::vector<string>& GetRegistryNames()
+    {
+        static std::vector<string> names;
+        return names;
+    }
+    
+    static std::map<string, uint32>& GetRegistryIndices()
+    {
+        static std::map<string, uint32> indices;
+        return indices;
+    }
+    
+    CShaderUniformID::CShaderUniformID(const char8* name)
+    {
+        std::map<string, uint32>& indices = GetRegistryIndices();
+        std::map<string, uint32>::iterator it = indices.find(name);
+        if(it != indices.end())
+        {
+            m_uIndex = it->second;
+        }
+        else
+        {
+            m_uIndex = (uint32)GetRegistryNames().size();
+            GetRegistryNames().push_back(name);
+            indices[name] = m_uIndex;
+        }
+        m_uHash = StringManipulator::Hash(name);
+    }
+    
+    const string& CShaderUniformID::GetName() const
+    {
+        return GetRegistryNames()[m_uIndex];
+    }
+    
+    uint32 CShaderUniformID::GetRegisteredCount()
+    {
+        return (uint32)GetRegistryNames().size();
+    }
+    
+    const string& CShaderUniformID::GetRegisteredName(uint32 index)
+    {
+        return GetRegistryNames()[index];
+    }
+    
+    const CShaderUniformID U_MAT_PROJ("matProj");
+    const CShaderUniformID U_MAT_VIEW("matView");
+    const CShaderUniformID U_MAT_MODEL("matModel");
+    const CShaderUniformID U_MAT_VIEW_MODEL("matViewModel");
+    const CShaderUniformID U_MAT_NORMAL("matNormal");
+    const CShaderUniformID U_MAT_PROJ_VIEW_MODEL("matProjViewModel");
+    
+    const CShaderUniformID U_TEXTURE0("texture0");
+    const CShaderUniformID U_TEXTURE_CUBE_MAP("textureCubeMap");
+    const CShaderUniformID U_TEXTURE_BUMP("textureBump");
+    const CShaderUniformID U_TEXTURE_SPECULAR("textureSpecular");
+    const CShaderUniformID U_TEXTURE_DETAIL("textureDetail");
+    const CShaderUniformID U_USE_DETAIL_TEXTURE("useDetailTexture");
+    const CShaderUniformID U_DETAIL_FACTOR("detailFactor");
+    
+    const CShaderUniformID U_MAT_SHININESS("matShininess");
+    const CShaderUniformID U_MAT_OPACITY("matOpacity");
+    const CShaderUniformID U_MAT_COLOR_SPECULAR("matColorSpecular");
+    const CShaderUniformID U_MAT_COLOR_DIFFUSE("matColorDiffuse");
+    const CShaderUniformID U_MAT_COLOR_AMBIENT("matColorAmbient");
+    const CShaderUniformID U_MAT_COLOR_EMISSIVE("matColorEmissive");
+    
+    const CShaderUniformID U_FOG_COLOR("fColor");
+    const CShaderUniformID U_FOG_START_END("fStartEnd");
+    
+    const CShaderUniformID U_LIGHT_COLOR_AMBIENT("lightColorAmbient");
+    const CShaderUniformID U_LIGHT_COLOR_DIFFUSE("lightColorDiffuse");
+    const CShaderUniformID U_LIGHT_COLOR_SPECULAR("lightColorSpecular");
+    const CShaderUniformID U_LIGHT_POSITION("lightPosition");
+    const CShaderUniformID U_LIGHT_ATTENUATION("lightAttenuation");
+    
+    const CShaderUniformID U_TIME("Time");
+    const CShaderUniformID U_CAMERA_POSITION("cameraPosition");
+    
+    const CShaderUniformID U_SKINNING_MATRIX("skinningMatrix");
+    const CShaderUniformID U_INSTANCE_MODELS("instanceModels");
+}
@@ -0,0 +1,114 @@
+/* ShaderUniforms.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_SHADER_UNIFORMS_H
+#define VVISION_SHADER_UNIFORMS_H
+
+#include "types.h"
+
+namespace vvision
+{
+    /** identifier of a uniform by name, used with CShader::Set.
+     * ids are interned: every id created with the same name gets the same index, and the index is resolved once per shader,
+     * so Set(id, ...) is a table lookup. ids are meant to be created once ( global or static), never per frame.
+     */
+    class CShaderUniformID
+    {
+    public:
+        
+        /** register name ( or find it if already registered)*/
+        explicit CShaderUniformID(const char8* name);
+        
+        /** index in the registry*/
+        inline uint32 GetIndex() const {return m_uIndex;}
+        
+        /** StringManipulator::Hash of the name*/
+        inline uint32 GetHash() const {return m_uHash;}
+        
+        /** uniform name*/
+        const string& GetName() const;
+        
+        /** number of names registered so far*/
+        static uint32 GetRegisteredCount();
+        
+        /** name of a registered index*/
+        static const string& GetRegisteredName(uint32 index);
+    
+    private:
+        
+        /** registry index*/
+        uint32 m_uIndex;
+        
+        /** name hash*/
+        uint32 m_uHash;
+    };
+    
+    /** declare a uniform id for a uniform the engine doesnt know about, in a .cpp file:
+     * VV_DECLARE_UNIFORM(U_REPEAT_TEXTURE, "repeatTexture") then shader->Set(U_REPEAT_TEXTURE, 4.f)
+     */
+    #define VV_DECLARE_UNIFORM(id, name) static const vvision::CShaderUniformID id(name);
+    
+    /** matrices*/
+    extern const CShaderUniformID U_MAT_PROJ;
+    extern const CShaderUniformID U_MAT_VIEW;
+    extern const CShaderUniformID U_MAT_MODEL;
+    extern const CShaderUniformID U_MAT_VIEW_MODEL;
+    extern const CShaderUniformID U_MAT_NORMAL;
+    extern const CShaderUniformID U_MAT_PROJ_VIEW_MODEL;
+    
+    /** textures*/
+    extern const CShaderUniformID U_TEXTURE0;
+    extern const CShaderUniformID U_TEXTURE_CUBE_MAP;
+    extern const CShaderUniformID U_TEXTURE_BUMP;
+    extern const CShaderUniformID U_TEXTURE_SPECULAR;
+    extern const CShaderUniformID U_TEXTURE_DETAIL;
+    extern const CShaderUniformID U_USE_DETAIL_TEXTURE;
+    extern const CShaderUniformID U_DETAIL_FACTOR;
+    
+    /** material*/
+    extern const CShaderUniformID U_MAT_SHININESS;
+    extern const CShaderUniformID U_MAT_OPACITY;
+    extern const CShaderUniformID U_MAT_COLOR_SPECULAR;
+    extern const CShaderUniformID U_MAT_COLOR_DIFFUSE;
+    extern const CShaderUniformID U_MAT_COLOR_AMBIENT;
+    extern const CShaderUniformID U_MAT_COLOR_EMISSIVE;
+    
+    /** fog*/
+    extern const CShaderUniformID U_FOG_COLOR;
+    extern const CShaderUniformID U_FOG_START_END;
+    
+    /** light*/
+    extern const CShaderUniformID U_LIGHT_COLOR_AMBIENT;
+    extern const CShaderUniformID U_LIGHT_COLOR_DIFFUSE;
+    extern const CShaderUniformID U_LIGHT_COLOR_SPECULAR;
+    extern const CShaderUniformID U_LIGHT_POSITION;
+    extern const CShaderUniformID U_LIGHT_ATTENUATION;
+    
+    /** misc*/
+    extern const CShaderUniformID U_TIME;
+    extern const CShaderUniformID U_CAMERA_POSITION;
+    
+    /** skinning matrices array*/
+    extern const CShaderUniformID U_SKINNING_MATRIX;
+    
+    /** model matrices array of the instances, check CInstancedRenderer*/
+    extern const CShaderUniformID U_INSTANCE_MODELS;
+}
+
+#endif
@@ -0,0 +1,251 @@
+/*
+ *  StaticBatcher.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "StaticBatcher.h"
+#include "Profiler.h"
+#include <string.h>
+
+namespace vvision
+{
+    /** true if two materials draw the same ( name and index aside)*/
+    static bool IsSameMaterial(const CMaterial& a, const CMaterial& b)
+    {
+        return a.diffuseTexture == b.diffuseTexture && a.bumpTexture == b.bumpTexture && a.specularTexture == b.specularTexture &&
+               a.detailTexture == b.detailTexture && a.cubeMapTexture == b.cubeMapTexture &&
+               a.ambient == b.ambient && a.diffuse == b.diffuse && a.specular == b.specular && a.emissive == b.emissive &&
+               a.shininess == b.shininess && a.opacity == b.opacity && a.detailFactor == b.detailFactor &&
+               a.twoSided == b.twoSided && a.isTransparent == b.isTransparent;
+    }
+    
+    /** a material of the batches, the textures are shared with the source*/
+    static CMaterial* CloneMaterial(const CMaterial& source)
+    {
+        CMaterial* material = new CMaterial();
+        material->Name = source.Name;
+        material->ambient = source.ambient;
+        material->diffuse = source.diffuse;
+        material->specular = source.specular;
+        material->emissive = source.emissive;
+        material->shininess = source.shininess;
+        material->opacity = source.opacity;
+        material->twoSided = source.twoSided;
+        material->isTransparent = source.isTransparent;
+        material->diffuseTexture = source.diffuseTexture;
+        material->bumpTexture = source.bumpTexture;
+        material->specularTexture = source.specularTexture;
+        material->detailTexture = source.detailTexture;
+        material->detailFactor = source.detailFactor;
+        material->cubeMapTexture = source.cubeMapTexture;
+        return material;
+    }
+    
+    /** direction d transformed by the 3x3 part of m, normalized*/
+    static vec3f TransformDirection(const mat4f& m, const vec3f& d)
+    {
+        vec4f t = m * vec4f(d.x, d.y, d.z, 0.f);
+        vec3f direction(t.x, t.y, t.z);
+        float32 length = direction.length();
+        return length > 0 ? direction / length : direction;
+    }
+    
+    /** true if a group can be merged: a triangle list that is not skinned*/
+    static bool CanBatch(CMeshGroup* group)
+    {
+        if(group->GetDrawingMode() != kPRIMITIVE_TYPE_TRIANGLE || group->GetMaterialIndex() < 0 || group->GetIndices().empty())
+            return false;
+        
+        const std::vector<CGpuVertex>& vertices = group->GetVertices();
+        for(uint32 i = 0; i < vertices.size(); i++)
+        {
+            const vec4f& w = vertices[i].boneWeights;
+            if(w.x != 0 || w.y != 0 || w.z != 0 || w.w != 0)
+                return false;
+        }
+        return true;
+    }
+    
+    CStaticBatcher::CStaticBatcher()
+    : m_pBatches(NULL)
+    {
+        memset(&m_sStats, 0, sizeof(SStaticBatchStats));
+    }
+    
+    CStaticBatcher::~CStaticBatcher()
+    {
+        SAFE_DELETE(m_pBatches);
+    }
+    
+    bool CStaticBatcher::AddMesh(CMeshBuffer* mesh, const mat4f& transform)
+    {
+        assert(mesh != NULL);
+        m_sStats.groups += mesh->GroupsCount();
+        
+        //the whole mesh or nothing, the entity would otherwise have to draw the groups left out
+        for(uint32 g = 0; g < mesh->GroupsCount(); ++g)
+        {
+            if(!CanBatch(mesh->GroupAtIndex(g)))
+            {
+                m_sStats.skippedGroups += mesh->GroupsCount();
+                return false;
+            }
+        }
+        
+        for(uint32 g = 0; g < mesh->GroupsCount(); ++g)
+        {
+            SSource source;
+            source.group = mesh->GroupAtIndex(g);
+            source.material = mesh->MaterialForGroup(source.group);
+            source.transform = transform;
+            m_vSources.push_back(source);
+        }
+        m_sStats.meshes++;
+        return true;
+    }
+    
+    bool CStaticBatcher::Build()
+    {
+        SAFE_DELETE(m_pBatches);
+        m_pBatches = new CMeshBuffer();
+        m_sStats.batches = 0;
+        m_sStats.vertices = 0;
+        m_sStats.indices = 0;
+        
+        //batch being filled for each material of the batches
+        std::vector<CMeshGroup*> filling;
+        
+        for(uint32 s = 0; s < m_vSources.size(); s++)
+        {
+            const SSource& source = m_vSources[s];
+            
+            uint32 material = 0;
+            for(; material < m_pBatches->MaterialsCount(); material++)
+            {
+                if(IsSameMaterial(*m_pBatches->MaterialAtindex(material), *source.material))
+                    break;
+            }
+            
+            if(material == m_pBatches->MaterialsCount())
+            {
+                m_pBatches->AddMaterial(CloneMaterial(*source.material));
+                filling.push_back(NULL);
+            }
+            
+            //a new batch once the current one would need 32 bits indices
+            const std::vector<CGpuVertex>& vertices = source.group->GetVertices();
+            const std::vector<uint32>& indices = source.group->GetIndices();
+            CMeshGroup* batch = filling[material];
+            if(batch != NULL && batch->GetVertices().size() + vertices.size() > kBUFFER_ARENA_MAX_BLOCK_VERTICES)
+                batch = NULL;
+            
+            if(batch == NULL)
+            {
+                batch = new CMeshGroup();
+                batch->SetMaterialIndex(material);
+                batch->SetLodLevels(kMESH_LOD_DEFAULT_LEVELS);
+                m_pBatches->AddGroup(batch);
+                filling[material] = batch;
+            }
+            
+            //positions to world space, normals by the inverse transpose
+            mat4f normalMatrix = source.transform;
+            normalMatrix = normalMatrix.inverse().transpose();
+            
+            std::vector<CGpuVertex>& batchVertices = batch->GetVertices();
+            uint32 base = batchVertices.size();
+            for(uint32 i = 0; i < vertices.size(); i++)
+            {
+                CGpuVertex v = vertices[i];
+                vec4f p = source.transform * vec4f(v.pos.x, v.pos.y, v.pos.z, 1.f);
+                v.pos = vec3f(p.x, p.y, p.z);
+                v.normal = TransformDirection(normalMatrix, v.normal);
+                v.tangent = TransformDirection(source.transform, v.tangent);
+                batchVertices.push_back(v);
+            }
+            
+            //a mirroring transform turns the triangles around
+            const mat4f& m = source.transform;
+            vec3f x(m[0], m[1], m[2]);
+            vec3f y(m[4], m[5], m[6]);
+            vec3f z(m[8], m[9], m[10]);
+            bool mirrored = x.dotProduct(y.crossProduct(z)) < 0;
+            
+            std::vector<uint32>& batchIndices = batch->GetIndices();
+            for(uint32 i = 0; i + 2 < indices.size(); i += 3)
+            {
+                batchIndices.push_back(base + indices[i]);
+                batchIndices.push_back(base + indices[i + (mirrored ? 2 : 1)]);
+                batchIndices.push_back(base + indices[i + (mirrored ? 1 : 2)]);
+            }
+        }
+        
+        for(uint32 b = 0; b < m_pBatches->GroupsCount(); ++b)
+        {
+            CMeshGroup* batch = m_pBatches->GroupAtIndex(b);
+            if(!batch->AllocateOnGpuMemory(kGL_BUFFER_USAGE_HINT_STATIC))
+            {
+                std::cerr<<"CStaticBatcher: [ERROR] cant allocate a batch of "<<batch->GetVertices().size()<<" vertices\n";
+                return false;
+            }
+            batch->CreateBoundingBox();
+            
+            m_sStats.batches++;
+            m_sStats.vertices += batch->GetVertices().size();
+            m_sStats.indices += batch->GetIndexCount();
+        }
+        
+        m_vLods.assign(m_pBatches->GroupsCount(), 0);
+        return true;
+    }
+    
+    void CStaticBatcher::SelectLods(const mat4f& view, const mat4f& projection, float32 viewport_height)
+    {
+        if(m_pBatches == NULL)
+            return;
+        
+        for(uint32 b = 0; b < m_pBatches->GroupsCount(); ++b)
+        {
+            CMeshGroup* batch = m_pBatches->GroupAtIndex(b);
+            float32 size = batch->GetBoundingBox().GetProjectedSize(view, projection, viewport_height);
+            m_vLods[b] = batch->SelectLod(size, m_vLods[b]);
+        }
+    }
+    
+    void CStaticBatcher::Submit(CRenderQueue& queue, CShader* shader, CMeshletCuller* culler)
+    {
+        VV_PROFILE_SCOPE("CStaticBatcher::Submit");
+        
+        if(m_pBatches == NULL)
+            return;
+        
+        mat4f viewProjection = queue.GetProjection() * queue.GetView();
+        for(uint32 b = 0; b < m_pBatches->GroupsCount(); ++b)
+        {
+            CMeshGroup* batch = m_pBatches->GroupAtIndex(b);
+            if(batch->GetBoundingBox().IsOutsideFrustum(viewProjection))
+                continue;
+            
+            //the simplified levels are drawn whole
+            CMaterial* material = m_pBatches->MaterialForGroup(batch);
+            SMeshletDraw draw;
+            if(culler != NULL && m_vLods[b] == 0 && culler->Cull(batch, m_mIdentity, queue.GetView(), queue.GetProjection(), draw))
+                queue.Submit(shader, material, draw.vao, batch->GetDrawingMode(), draw.indexType, draw.firstIndex, draw.indexCount, m_mIdentity, batch->GetBoundingBox());
+            else
+                queue.Submit(shader, material, batch, m_mIdentity, m_vLods[b]);
+        }
+    }
+
+#ifdef DEBUG
+    void CStaticBatcher::PrintReport() const
+    {
+        std::cerr<<"CStaticBatcher: [INFO] "<<m_sStats.meshes<<" meshes, "<<m_sStats.groups<<" groups in "<<m_sStats.batches<<" batches ( "<<m_sStats.skippedGroups<<" groups skipped)\n";
+        std::cerr<<"    draw calls per pass: "<<m_sStats.groups - m_sStats.skippedGroups<<" -> "<<m_sStats.batches<<"\n";
+        std::cerr<<"    batches: "<<m_sStats.vertices<<" vertices, "<<m_sStats.indices<<" indices\n";
+    }
+#endif
+}
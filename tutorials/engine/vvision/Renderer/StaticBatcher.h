@@ -0,0 +1,123 @@
+/* StaticBatcher.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_STATIC_BATCHER_H
+#define VVISION_STATIC_BATCHER_H
+
+#include "MeshBuffer.h"
+#include "RenderQueue.h"
+#include "MeshletCuller.h"
+
+namespace vvision
+{
+    /** what the batcher merged*/
+    struct SStaticBatchStats
+    {
+        /** meshes merged, groups of every mesh given*/
+        uint32 meshes;
+        uint32 groups;
+        
+        /** groups of the meshes that could not be merged ( a group is not a triangle list, or is skinned)*/
+        uint32 skippedGroups;
+        
+        /** batches built, one draw call each*/
+        uint32 batches;
+        
+        /** vertices and indices of the batches*/
+        uint32 vertices;
+        uint32 indices;
+    };
+    
+    /** static batching: the groups of static meshes are pre-transformed to world space and the groups sharing a material are
+     * merged in one group ( a batch), drawn with one draw call and an identity transform. a batch is split when it would need
+     * 32 bits indices. the batches are regular groups: they get the mesh optimizer, levels of detail and meshlets on
+     * allocation, and their bounding box ( world space) culls them against the frustum.
+     * the meshes added must outlive the batcher ( their materials textures are shared)
+     */
+    class CStaticBatcher
+    {
+    public:
+        
+        /** constructor*/
+        CStaticBatcher();
+        
+        /** destructor*/
+        ~CStaticBatcher();
+        
+        /** add the groups of a static mesh, transform moves them to world space ( before Build)
+         * @return false if a group of the mesh cant be merged, the mesh is not added and must be drawn on its own
+         */
+        bool AddMesh(CMeshBuffer* mesh, const mat4f& transform);
+        
+        /** merge the groups added in batches and allocate them ( gl thread)
+         * @return false if a batch cant be allocated
+         */
+        bool Build();
+        
+        /** pick the level of detail of each batch ( check CMeshGroup::SelectLod)*/
+        void SelectLods(const mat4f& view, const mat4f& projection, float32 viewport_height);
+        
+        /** submit the batches in the frustum of the queue, the full meshes are culled per meshlet when a culler is given*/
+        void Submit(CRenderQueue& queue, CShader* shader, CMeshletCuller* culler = NULL);
+        
+        /** the batches and their materials ( to add them to a CMeshletCuller)*/
+        inline CMeshBuffer* GetMeshBuffer() {return m_pBatches;}
+        
+        /** what Build merged*/
+        inline const SStaticBatchStats& GetStats() const {return m_sStats;}
+
+#ifdef DEBUG
+        /** print the draw calls saved*/
+        void PrintReport() const;
+#endif
+    
+    private:
+        
+        /** a group added, with the transform of its mesh*/
+        struct SSource
+        {
+            CMeshGroup* group;
+            CMaterial* material;
+            mat4f transform;
+        };
+        
+        /** groups added*/
+        std::vector<SSource> m_vSources;
+        
+        /** the batches*/
+        CMeshBuffer* m_pBatches;
+        
+        /** level of detail of each batch*/
+        std::vector<uint32> m_vLods;
+        
+        /** transform of the batches*/
+        mat4f m_mIdentity;
+        
+        /** stats*/
+        SStaticBatchStats m_sStats;
+        
+        /** not allowed*/
+        CStaticBatcher(const CStaticBatcher&);
+        
+        /** not allowed*/
+        CStaticBatcher& operator=(const CStaticBatcher&);
+    };
+}
+
+#endif
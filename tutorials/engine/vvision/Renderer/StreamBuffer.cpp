@@ -0,0 +1,198 @@
+/*
+ *  StreamBuffer.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "StreamBuffer.h"
+#include "RenderStateCache.h"
+#include <string.h>
+
+#if defined(GL_EXT_map_buffer_range) && defined(GL_OES_mapbuffer) && defined(GL_APPLE_sync)
+#define VV_STREAM_BUFFER_RING
+#endif
+
+namespace vvision
+{
+    /** -1 unknown, 0 not supported, 1 supported*/
+    static int32 s_iRingSupported = -1;
+    
+    CStreamBuffer::CStreamBuffer(GL_BUFFER_TYPE type, uint32 region_size)
+    : m_cBuffer(type, kGL_BUFFER_USAGE_HINT_STREAM), m_eType(type), m_bCreated(false), m_eMode(kSTREAM_BUFFER_MODE_ORPHAN),
+    m_uRegionSize(region_size), m_uRegion(0), m_uUsed(0)
+    {
+        memset(m_vFences, 0, sizeof(m_vFences));
+        memset(&m_sStats, 0, sizeof(SStreamBufferStats));
+    }
+    
+    CStreamBuffer::~CStreamBuffer()
+    {
+        for(uint32 r = 0; r < kSTREAM_BUFFER_REGIONS; r++)
+            DeleteFence(r);
+        
+        if(m_bCreated)
+            m_cBuffer.Destroy();
+    }
+    
+    bool CStreamBuffer::IsRingSupported()
+    {
+#ifdef VV_STREAM_BUFFER_RING
+        if(s_iRingSupported == -1)
+        {
+            const char8* extensions = (const char8*)glGetString(GL_EXTENSIONS);
+            s_iRingSupported = extensions && strstr(extensions, "GL_EXT_map_buffer_range") && strstr(extensions, "GL_OES_mapbuffer") &&
+                               strstr(extensions, "GL_APPLE_sync") ? 1 : 0;
+        }
+        return s_iRingSupported == 1;
+#else
+        return false;
+#endif
+    }
+    
+    bool CStreamBuffer::Create()
+    {
+        if(m_bCreated)
+            return true;
+        
+        //an element buffer binding would change the vao bound
+        if(m_eType == kGL_BUFFER_TYPE_ELEMENT)
+            CRenderStateCache::Instance().BindVertexArray(0);
+        
+        m_eMode = IsRingSupported() ? kSTREAM_BUFFER_MODE_RING : kSTREAM_BUFFER_MODE_ORPHAN;
+        uint32 regions = m_eMode == kSTREAM_BUFFER_MODE_RING ? kSTREAM_BUFFER_REGIONS : 1;
+        if(!m_cBuffer.AllocateStorage(m_eType, kGL_BUFFER_USAGE_HINT_STREAM, m_uRegionSize * regions, NULL))
+        {
+            std::cerr<<"CStreamBuffer: [ERROR] cant create the buffer\n";
+            return false;
+        }
+        
+        m_bCreated = true;
+        m_uRegion = 0;
+        m_uUsed = 0;
+        return true;
+    }
+    
+    void CStreamBuffer::DeleteFence(uint32 region)
+    {
+#ifdef VV_STREAM_BUFFER_RING
+        if(m_vFences[region] != NULL)
+            glDeleteSyncAPPLE((GLsync)m_vFences[region]);
+#endif
+        m_vFences[region] = NULL;
+    }
+    
+    void CStreamBuffer::Allocate(uint32 region_size)
+    {
+        //the new storage is not read by any draw
+        for(uint32 r = 0; r < kSTREAM_BUFFER_REGIONS; r++)
+            DeleteFence(r);
+        
+        if(m_eType == kGL_BUFFER_TYPE_ELEMENT)
+            CRenderStateCache::Instance().BindVertexArray(0);
+        
+        m_uRegionSize = region_size;
+        uint32 regions = m_eMode == kSTREAM_BUFFER_MODE_RING ? kSTREAM_BUFFER_REGIONS : 1;
+        m_cBuffer.Orphan(m_uRegionSize * regions);
+    }
+    
+    void CStreamBuffer::Begin()
+    {
+        assert(m_bCreated);
+        m_uUsed = 0;
+        m_sStats.frames++;
+        
+        if(m_eMode == kSTREAM_BUFFER_MODE_ORPHAN)
+        {
+            if(m_eType == kGL_BUFFER_TYPE_ELEMENT)
+                CRenderStateCache::Instance().BindVertexArray(0);
+            m_cBuffer.Orphan(m_uRegionSize);
+            return;
+        }
+
+#ifdef VV_STREAM_BUFFER_RING
+        //the fence of the region was set kSTREAM_BUFFER_REGIONS frames ago, the gpu is usually done with it
+        m_uRegion = (m_uRegion + 1) % kSTREAM_BUFFER_REGIONS;
+        if(m_vFences[m_uRegion] != NULL)
+        {
+            GLenum result = glClientWaitSyncAPPLE((GLsync)m_vFences[m_uRegion], GL_SYNC_FLUSH_COMMANDS_BIT_APPLE, GL_TIMEOUT_IGNORED_APPLE);
+            if(result != GL_ALREADY_SIGNALED_APPLE)
+                m_sStats.waits++;
+            DeleteFence(m_uRegion);
+        }
+#endif
+    }
+    
+    bool CStreamBuffer::Write(const void* data, uint32 size, uint32 alignment, uint32& offset)
+    {
+        assert(m_bCreated && data != NULL);
+        
+        uint32 start = (m_uUsed + alignment - 1) & ~(alignment - 1);
+        if(start + size > m_uRegionSize)
+        {
+            //growing drops the writes of the frame, only the first one can grow the regions
+            if(m_uUsed != 0)
+                return false;
+            
+            uint32 regionSize = m_uRegionSize * 2;
+            while(regionSize < size)
+                regionSize *= 2;
+            Allocate(regionSize);
+            m_sStats.grows++;
+            start = 0;
+        }
+        
+        if(m_eType == kGL_BUFFER_TYPE_ELEMENT)
+            CRenderStateCache::Instance().BindVertexArray(0);
+        
+        offset = (m_eMode == kSTREAM_BUFFER_MODE_RING ? m_uRegion * m_uRegionSize : 0) + start;
+        m_cBuffer.Bind();
+
+#ifdef VV_STREAM_BUFFER_RING
+        if(m_eMode == kSTREAM_BUFFER_MODE_RING)
+        {
+            //no gl synchronization, the fence of the region guarantees the gpu is not reading it
+            void* mapped = glMapBufferRangeEXT(m_eType, offset, size, GL_MAP_WRITE_BIT_EXT | GL_MAP_INVALIDATE_RANGE_BIT_EXT | GL_MAP_UNSYNCHRONIZED_BIT_EXT);
+            if(mapped == NULL)
+            {
+                m_cBuffer.Unbind();
+                return false;
+            }
+            memcpy(mapped, data, size);
+            glUnmapBufferOES(m_eType);
+        }
+        else
+#endif
+        {
+            //the storage was orphaned by Begin, no draw reads it yet
+            glBufferSubData(m_eType, offset, size, data);
+        }
+        m_cBuffer.Unbind();
+        
+        m_uUsed = start + size;
+        m_sStats.writes++;
+        m_sStats.bytes += size;
+        return true;
+    }
+    
+    void CStreamBuffer::End()
+    {
+#ifdef VV_STREAM_BUFFER_RING
+        if(m_eMode == kSTREAM_BUFFER_MODE_RING && m_uUsed != 0)
+        {
+            DeleteFence(m_uRegion);
+            m_vFences[m_uRegion] = (void*)glFenceSyncAPPLE(GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE, 0);
+        }
+#endif
+    }
+
+#ifdef DEBUG
+    void CStreamBuffer::PrintReport() const
+    {
+        std::cerr<<"CStreamBuffer: [INFO] "<<(m_eMode == kSTREAM_BUFFER_MODE_RING ? "ring" : "orphaning")<<", "<<m_sStats.frames<<" frames, "<<m_sStats.writes<<" writes, "<<m_sStats.bytes<<" bytes\n";
+        std::cerr<<"    region size: "<<m_uRegionSize<<" bytes ( grown "<<m_sStats.grows<<" times), fence waits: "<<m_sStats.waits<<"\n";
+    }
+#endif
+}
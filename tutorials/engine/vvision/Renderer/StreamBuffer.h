@@ -0,0 +1,157 @@
+/* StreamBuffer.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef VVISION_STREAM_BUFFER_H
+#define VVISION_STREAM_BUFFER_H
+
+#include "types.h"
+#include "VertexBuffer.h"
+
+namespace vvision
+{
+    /** regions of the ring, a region is written again once the gpu is done with the draws of kSTREAM_BUFFER_REGIONS - 1 frames*/
+    enum
+    {
+        kSTREAM_BUFFER_REGIONS = 3
+    };
+    
+    /** how the writes reach the buffer*/
+    enum STREAM_BUFFER_MODE
+    {
+        /** ring of regions written with unsynchronized glMapBufferRangeEXT, a fence per region ( EXT_map_buffer_range and APPLE_sync)*/
+        kSTREAM_BUFFER_MODE_RING,
+        
+        /** one region orphaned by Begin and written with glBufferSubData*/
+        kSTREAM_BUFFER_MODE_ORPHAN
+    };
+    
+    /** writes since the creation of a stream buffer*/
+    struct SStreamBufferStats
+    {
+        /** frames ( Begin/End) and writes*/
+        uint32 frames;
+        uint32 writes;
+        
+        /** bytes written*/
+        uint32 bytes;
+        
+        /** frames that waited for the fence of their region*/
+        uint32 waits;
+        
+        /** times the regions were grown*/
+        uint32 grows;
+    };
+    
+    /** gl buffer written every frame ( particles, cpu skinned vertices, debug lines, instance data...) without waiting for the
+     * draws still reading the previous frames.
+     *
+     * the writes between Begin and End form a frame of the buffer. in ring mode the buffer holds kSTREAM_BUFFER_REGIONS regions
+     * and a frame writes the next region, mapped without synchronization: the fence set by End on the region is waited for
+     * ( it is usually signaled already) before the region is written again. without the extensions the buffer falls back to
+     * orphaning: Begin gets a new storage and the writes use glBufferSubData.
+     *
+     * Write returns the offset of the data in the buffer, draws and attribute pointers use it. gl thread only.
+     */
+    class CStreamBuffer
+    {
+    public:
+        
+        /** constructor
+         * @param type array or element buffer
+         * @param region_size bytes a frame can write, grown when a frame needs more
+         */
+        CStreamBuffer(GL_BUFFER_TYPE type, uint32 region_size);
+        
+        /** destructor*/
+        ~CStreamBuffer();
+        
+        /** create the buffer and pick the mode
+         * @return false if the buffer cant be created
+         */
+        bool Create();
+        
+        /** start a frame: move to the next region and wait for the gpu to be done with it*/
+        void Begin();
+        
+        /** copy size bytes at the end of the region of the frame
+         * @param alignment of the offset, a power of two ( the size of an index, 4 for floats)
+         * @param offset of the data in the buffer
+         * @return false if the region is full, a region is only grown by the first write of a frame
+         */
+        bool Write(const void* data, uint32 size, uint32 alignment, uint32& offset);
+        
+        /** end the frame, the draws reading it must be issued before*/
+        void End();
+        
+        /** bind/unbind the buffer ( to set attribute pointers or an element buffer)*/
+        inline void Bind() {m_cBuffer.Bind();}
+        inline void Unbind() {m_cBuffer.Unbind();}
+        
+        /** buffer id*/
+        inline GLuint GetID() const {return m_cBuffer.GetID();}
+        
+        /** how the writes reach the buffer ( valid once created)*/
+        inline STREAM_BUFFER_MODE GetMode() const {return m_eMode;}
+        
+        /** check if EXT_map_buffer_range, OES_mapbuffer and APPLE_sync are supported*/
+        static bool IsRingSupported();
+        
+        /** stats*/
+        inline const SStreamBufferStats& GetStats() const {return m_sStats;}
+
+#ifdef DEBUG
+        /** print the stats*/
+        void PrintReport() const;
+#endif
+    
+    private:
+        
+        /** (re)allocate the storage of every region, the fences of the previous storage are dropped*/
+        void Allocate(uint32 region_size);
+        
+        /** delete the fence of a region*/
+        void DeleteFence(uint32 region);
+        
+        /** the buffer*/
+        CVertexBuffer m_cBuffer;
+        GL_BUFFER_TYPE m_eType;
+        bool m_bCreated;
+        
+        /** mode*/
+        STREAM_BUFFER_MODE m_eMode;
+        
+        /** size of a region, region of the frame and bytes written in it*/
+        uint32 m_uRegionSize;
+        uint32 m_uRegion;
+        uint32 m_uUsed;
+        
+        /** fence set at the end of the last frame of each region, NULL if none*/
+        void* m_vFences[kSTREAM_BUFFER_REGIONS];
+        
+        /** stats*/
+        SStreamBufferStats m_sStats;
+        
+        /** not allowed*/
+        CStreamBuffer(const CStreamBuffer&);
+        
+        /** not allowed*/
+        CStreamBuffer& operator=(const CStreamBuffer&);
+    };
+}
+
+#endif
@@ -9,6 +9,8 @@
 
 
 #include "Texture.h"
+#include "TextureUploadQueue.h"
+#include "TextureStateTracker.h"
 
 namespace vvision
 {
@@ -50,18 +52,16 @@ namespace vvision
         
         {
             // Allocate and bind an OpenGL texture
-            glBindTexture (m_eTarget, m_uID);
+            CTextureStateTracker::Instance().Bind(m_eTarget, m_uID);
             
             // Set desired wrapping type
             glTexParameteri(m_eTarget, GL_TEXTURE_WRAP_S, m_iSWrapMode);
             glTexParameteri(m_eTarget, GL_TEXTURE_WRAP_T, m_iTWrapMode);
             
-            if(enableAnistorpicFiltering)
-            {
-                GLfloat maxAnisotrpoicfiltering;
-                glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotrpoicfiltering);
-                glTexParameterf(m_eTarget, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAnisotrpoicfiltering);
-            }
+            //the device max anisotropy is queried once by the tracker
+            CTextureStateTracker& tracker = CTextureStateTracker::Instance();
+            if(enableAnistorpicFiltering && tracker.IsAnisotropySupported())
+                glTexParameterf(m_eTarget, GL_TEXTURE_MAX_ANISOTROPY_EXT, tracker.GetMaxAnisotropy());
             
             // Set interpolation function t	o nearest-neighbor
             glTexParameteri(m_eTarget, GL_TEXTURE_MIN_FILTER, m_iMinFilter);
@@ -84,6 +84,8 @@ namespace vvision
     }
     void CTexture::Release()
     {
+        CTextureUploadQueue::Instance().Discard(m_uID);
+        CTextureStateTracker::Instance().OnDelete(m_uID);
         if(IsValid())
             glDeleteTextures(1, &m_uID);
         
@@ -95,13 +97,28 @@ namespace vvision
     }
     void CTexture::ActivateAndBind(GLenum texture_unit)
     {
-        glActiveTexture(texture_unit);
-        glBindTexture(m_eTarget, m_uID);
+        //queued refreshes land before the texture is sampled
+        CTextureUploadQueue& uploads = CTextureUploadQueue::Instance();
+        if(uploads.HasPendingUploads())
+            uploads.Flush();
+        
+        //skipped if the texture is already bound to the unit
+        CTextureStateTracker::Instance().Bind(texture_unit, m_eTarget, m_uID);
     }
     void CTexture::ActivateAndRefresh(void * data, GLsizei width, GLsizei height, GLint xoffset , GLint yoffset , GLint level , GLenum host_format , GLenum host_type)
     {
-        glBindTexture(m_eTarget, m_uID);
+        //older queued refreshes must not overwrite this one
+        CTextureUploadQueue& uploads = CTextureUploadQueue::Instance();
+        if(uploads.HasPendingUploads())
+            uploads.Flush();
+        
+        CTextureStateTracker::Instance().Bind(m_eTarget, m_uID);
         glTexSubImage2D(m_eTarget, level, xoffset, yoffset, width, height, host_format, host_type, data);
         
     }
+    void CTexture::QueueRefresh(const void * data, GLsizei width, GLsizei height, GLint xoffset , GLint yoffset , GLint level , GLenum host_format , GLenum host_type)
+    {
+        if(!CTextureUploadQueue::Instance().Enqueue(m_uID, m_eTarget, m_eTarget, data, width, height, xoffset, yoffset, level, host_format, host_type))
+            ActivateAndRefresh((void*)data, width, height, xoffset, yoffset, level, host_format, host_type);
+    }
 }
\ No newline at end of file
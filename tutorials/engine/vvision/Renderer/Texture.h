@@ -59,6 +59,9 @@ namespace vvision
         /** activate and refresh texture*/
         void ActivateAndRefresh(void * data, GLsizei width, GLsizei height, GLint xoffset = 0, GLint yoffset = 0,GLint level = 0, GLenum host_format = GL_BGRA, GLenum host_type = GL_UNSIGNED_BYTE);
         
+        /** queue a refresh in the CTextureUploadQueue, the data is copied and submitted with the other updates before the next bind ( uploaded right away if it doesnt fit in the queue)*/
+        void QueueRefresh(const void * data, GLsizei width, GLsizei height, GLint xoffset = 0, GLint yoffset = 0,GLint level = 0, GLenum host_format = GL_BGRA, GLenum host_type = GL_UNSIGNED_BYTE);
+        
         /** release texture*/
         void Release();
         
@@ -8,6 +8,8 @@
  */
 
 #include "TextureCubeMap.h"
+#include "TextureUploadQueue.h"
+#include "TextureStateTracker.h"
 
 namespace vvision
 {
@@ -53,7 +55,7 @@ namespace vvision
         glGenTextures(1, &m_uID);
         {
             // Allocate and bind an OpenGL texture
-            glBindTexture (m_eTarget, m_uID);
+            CTextureStateTracker::Instance().Bind(m_eTarget, m_uID);
             
             // Set interpolation function t	o nearest-neighbor
             glTexParameteri(m_eTarget, GL_TEXTURE_MIN_FILTER, m_iMinFilter);
@@ -124,14 +126,17 @@ namespace vvision
                           host_data_type,
                           host_data_zn);
             
-            glBindTexture (m_eTarget, 0);
-            
+            //mipmaps are generated for the bound cube map, before unbinding it
             if(buildMipMap)
-                glGenerateMipmap(GL_TEXTURE_2D);//GL_LINEAR_MIPMAP_LINEAR
+                glGenerateMipmap(m_eTarget);//GL_LINEAR_MIPMAP_LINEAR
+            
+            CTextureStateTracker::Instance().Bind(m_eTarget, 0);
         }
     }
     void CTextureCubeMap::Release()
     {
+        CTextureUploadQueue::Instance().Discard(m_uID);
+        CTextureStateTracker::Instance().OnDelete(m_uID);
         if(IsValid())
             glDeleteTextures(1, &m_uID);
         
@@ -143,13 +148,25 @@ namespace vvision
     }
     void CTextureCubeMap::ActivateAndBind(GLenum texture_unit)
     {
-        glActiveTexture(texture_unit);
-        glBindTexture(m_eTarget, m_uID);
+        CTextureUploadQueue& uploads = CTextureUploadQueue::Instance();
+        if(uploads.HasPendingUploads())
+            uploads.Flush();
+        
+        CTextureStateTracker::Instance().Bind(texture_unit, m_eTarget, m_uID);
     }
     void CTextureCubeMap::ActivateAndRefresh(GLenum target,void * data, GLsizei width, GLsizei height, GLint xoffset , GLint yoffset , GLint level , GLenum host_format , GLenum host_type)
     {
-        glBindTexture(m_eTarget, m_uID);
+        CTextureUploadQueue& uploads = CTextureUploadQueue::Instance();
+        if(uploads.HasPendingUploads())
+            uploads.Flush();
+        
+        CTextureStateTracker::Instance().Bind(m_eTarget, m_uID);
         glTexSubImage2D(target, level, xoffset, yoffset, width, height, host_format, host_type, data);
         
     }
+    void CTextureCubeMap::QueueRefresh(GLenum target, const void * data, GLsizei width, GLsizei height, GLint xoffset , GLint yoffset , GLint level , GLenum host_format , GLenum host_type)
+    {
+        if(!CTextureUploadQueue::Instance().Enqueue(m_uID, m_eTarget, target, data, width, height, xoffset, yoffset, level, host_format, host_type))
+            ActivateAndRefresh(target, (void*)data, width, height, xoffset, yoffset, level, host_format, host_type);
+    }
 }
@@ -24,6 +24,24 @@
 
 namespace vvision
 {
+    /** "VVCM"*/
+    #define VV_CUBE_MAP_MAGIC 0x4D435656
+    
+    /** version of the cube map container*/
+    #define VV_CUBE_MAP_VERSION 1
+    
+    /** pre-packed cube map container ( .vvcube, written by tools/vvcube.py), all values are little endian.
+     * the header is followed by six RGBA8 faces of size * size pixels in gl order (+x, -x, +y, -y, +z, -z), each face starts faceStride bytes after the previous one.
+     * the faces are uploaded straight from the mapped file ( or the asset pack) without decoding.
+     */
+    struct SCubeMapHeader
+    {
+        uint32 magic;
+        uint32 version;
+        uint32 size;
+        uint32 faceStride;
+    };
+    
     class CTextureCubeMap
     {
         public :
@@ -65,6 +83,9 @@ namespace vvision
         /** activate and refresh texture*/
         void ActivateAndRefresh(GLenum target, void * data, GLsizei width, GLsizei height, GLint xoffset = 0, GLint yoffset = 0,GLint level = 0, GLenum host_format = GL_BGRA, GLenum host_type = GL_UNSIGNED_BYTE);
         
+        /** queue a refresh of a face in the CTextureUploadQueue, check CTexture::QueueRefresh*/
+        void QueueRefresh(GLenum target, const void * data, GLsizei width, GLsizei height, GLint xoffset = 0, GLint yoffset = 0,GLint level = 0, GLenum host_format = GL_BGRA, GLenum host_type = GL_UNSIGNED_BYTE);
+        
         /** release texture*/
         void Release();
         
@@ -0,0 +1,127 @@
+/*
+ *  TextureStateTracker.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "TextureStateTracker.h"
+#include <string.h>
+
+namespace vvision
+{
+    /** shadow value meaning "unknown", forces the next call to reach gl*/
+    static const GLuint kTEXTURE_STATE_UNKNOWN = 0xFFFFFFFF;
+    
+    CTextureStateTracker::CTextureStateTracker()
+    : m_bCapsQueried(false), m_bAnisotropySupported(false), m_fMaxAnisotropy(1.0f),
+    m_iMaxTextureUnits(8), m_iMaxTextureSize(2048),
+    m_uBindsIssued(0), m_uBindsSkipped(0), m_uActiveUnitChanges(0)
+    {
+        Invalidate();
+    }
+    
+    void CTextureStateTracker::QueryCaps()
+    {
+        if(m_bCapsQueried)
+            return;
+        m_bCapsQueried = true;
+        
+        glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &m_iMaxTextureUnits);
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_iMaxTextureSize);
+        
+        const char8* extensions = (const char8*)glGetString(GL_EXTENSIONS);
+        m_bAnisotropySupported = extensions != NULL && strstr(extensions, "GL_EXT_texture_filter_anisotropic") != NULL;
+        if(m_bAnisotropySupported)
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &m_fMaxAnisotropy);
+        
+#ifdef DEBUG
+        std::cerr<<"CTextureStateTracker: [INFO] texture units: "<<m_iMaxTextureUnits<<", max size: "<<m_iMaxTextureSize<<", max anisotropy: "<<m_fMaxAnisotropy<<"\n";
+#endif
+    }
+    
+    int32 CTextureStateTracker::TargetSlot(GLenum target)
+    {
+        switch (target)
+        {
+            case GL_TEXTURE_2D:
+                return 0;
+            case GL_TEXTURE_CUBE_MAP:
+                return 1;
+            default:
+                return -1;
+        }
+    }
+    
+    void CTextureStateTracker::SetActiveUnit(GLenum texture_unit)
+    {
+        uint32 unit = texture_unit - GL_TEXTURE0;
+        if(unit == m_uActiveUnit)
+            return;
+        
+        glActiveTexture(texture_unit);
+        m_uActiveUnitChanges++;
+        
+        //units above the shadowed range are never considered active, the next call reaches gl
+        m_uActiveUnit = unit < kTEXTURE_STATE_MAX_UNITS ? unit : kTEXTURE_STATE_UNKNOWN;
+    }
+    
+    void CTextureStateTracker::Bind(GLenum texture_unit, GLenum target, GLuint texture)
+    {
+        SetActiveUnit(texture_unit);
+        Bind(target, texture);
+    }
+    
+    void CTextureStateTracker::Bind(GLenum target, GLuint texture)
+    {
+        //the unit is never changed here: when the active unit is unknown or above the shadowed range the bind reaches gl
+        //without being shadowed
+        int32 slot = TargetSlot(target);
+        if(slot >= 0 && m_uActiveUnit < kTEXTURE_STATE_MAX_UNITS)
+        {
+            if(m_vBound[m_uActiveUnit][slot] == texture)
+            {
+                m_uBindsSkipped++;
+                return;
+            }
+            m_vBound[m_uActiveUnit][slot] = texture;
+        }
+        
+        glBindTexture(target, texture);
+        m_uBindsIssued++;
+    }
+    
+    void CTextureStateTracker::OnDelete(GLuint texture)
+    {
+        if(texture == 0)
+            return;
+        
+        for(uint32 i = 0; i < kTEXTURE_STATE_MAX_UNITS; i++)
+        {
+            for(uint32 j = 0; j < 2; j++)
+            {
+                if(m_vBound[i][j] == texture)
+                    m_vBound[i][j] = 0;
+            }
+        }
+    }
+    
+    void CTextureStateTracker::Invalidate()
+    {
+        for(uint32 i = 0; i < kTEXTURE_STATE_MAX_UNITS; i++)
+        {
+            m_vBound[i][0] = kTEXTURE_STATE_UNKNOWN;
+            m_vBound[i][1] = kTEXTURE_STATE_UNKNOWN;
+        }
+        m_uActiveUnit = kTEXTURE_STATE_UNKNOWN;
+    }
+    
+    void CTextureStateTracker::ResetCounters()
+    {
+        m_uBindsIssued = 0;
+        m_uBindsSkipped = 0;
+        m_uActiveUnitChanges = 0;
+    }
+}
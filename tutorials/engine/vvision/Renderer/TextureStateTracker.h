@@ -0,0 +1,121 @@
+/* TextureStateTracker.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_TEXTURE_STATE_TRACKER_H
+#define VVISION_TEXTURE_STATE_TRACKER_H
+
+#include "types.h"
+#include "Singleton.h"
+
+namespace vvision
+{
+    enum
+    {
+        /** number of texture units shadowed by the tracker, units above are bound without tracking*/
+        kTEXTURE_STATE_MAX_UNITS = 16
+    };
+    
+    /** shadows the active texture unit and the texture bound to every unit, so redundant glActiveTexture/glBindTexture calls are skipped.
+     * every texture bind of the engine goes through the tracker, code that binds textures directly with gl must call Invalidate afterwards.
+     * device caps related to textures are queried once, on first use.
+     */
+    CREATE_SINGLETON( CTextureStateTracker )
+    
+    public :
+    
+    /** bind texture to target on the given unit ( GL_TEXTURE0 ...), nothing is issued if it is already bound*/
+    void Bind(GLenum texture_unit, GLenum target, GLuint texture);
+    
+    /** bind texture to target on the active unit ( used to create/update textures), not shadowed when the active unit is unknown*/
+    void Bind(GLenum target, GLuint texture);
+    
+    /** make texture_unit the active unit*/
+    void SetActiveUnit(GLenum texture_unit);
+    
+    /** a texture is about to be deleted, gl unbinds it from every unit*/
+    void OnDelete(GLuint texture);
+    
+    /** forget the shadowed state ( after texture state was changed outside the tracker or the context changed)*/
+    void Invalidate();
+    
+    /** max anisotropy supported by the device, 1 if EXT_texture_filter_anisotropic is not available*/
+    inline GLfloat GetMaxAnisotropy() {QueryCaps(); return m_fMaxAnisotropy;}
+    
+    /** check if EXT_texture_filter_anisotropic is available*/
+    inline bool IsAnisotropySupported() {QueryCaps(); return m_bAnisotropySupported;}
+    
+    /** GL_MAX_TEXTURE_IMAGE_UNITS*/
+    inline GLint GetMaxTextureUnits() {QueryCaps(); return m_iMaxTextureUnits;}
+    
+    /** GL_MAX_TEXTURE_SIZE*/
+    inline GLint GetMaxTextureSize() {QueryCaps(); return m_iMaxTextureSize;}
+    
+    /** number of glBindTexture issued since the last reset*/
+    inline uint32 GetBindsIssued() const {return m_uBindsIssued;}
+    
+    /** number of binds skipped because the texture was already bound*/
+    inline uint32 GetBindsSkipped() const {return m_uBindsSkipped;}
+    
+    /** number of glActiveTexture issued since the last reset*/
+    inline uint32 GetActiveUnitChanges() const {return m_uActiveUnitChanges;}
+    
+    /** reset the counters, call it once per frame to get per frame numbers*/
+    void ResetCounters();
+    
+private:
+    
+    /** not allowed*/
+    CTextureStateTracker();
+    
+    /** not allowed*/
+    ~CTextureStateTracker() {}
+    
+    /** not allowed*/
+    CTextureStateTracker(const CTextureStateTracker&);
+    
+    /** not allowed*/
+    CTextureStateTracker& operator=(const CTextureStateTracker&);
+    
+    /** query device caps, only the first call reaches gl*/
+    void QueryCaps();
+    
+    /** shadow slot of a target, -1 if the target is not tracked*/
+    static int32 TargetSlot(GLenum target);
+    
+    /** texture bound per unit, for GL_TEXTURE_2D and GL_TEXTURE_CUBE_MAP ( a unit holds both)*/
+    GLuint m_vBound[kTEXTURE_STATE_MAX_UNITS][2];
+    
+    /** active unit index ( unit - GL_TEXTURE0)*/
+    uint32 m_uActiveUnit;
+    
+    /** caps*/
+    bool m_bCapsQueried;
+    bool m_bAnisotropySupported;
+    GLfloat m_fMaxAnisotropy;
+    GLint m_iMaxTextureUnits;
+    GLint m_iMaxTextureSize;
+    
+    /** counters*/
+    uint32 m_uBindsIssued;
+    uint32 m_uBindsSkipped;
+    uint32 m_uActiveUnitChanges;
+};
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ *  TextureUploadQueue.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "TextureUploadQueue.h"
+#include "TextureStateTracker.h"
+
+namespace vvision
+{
+    /** staging regions alignment in bytes*/
+    static const uint32 kTEXTURE_UPLOAD_ALIGNMENT = 16;
+    
+    /** GL_UNPACK_ALIGNMENT, the engine never changes it*/
+    static const uint32 kTEXTURE_UNPACK_ALIGNMENT = 4;
+    
+    CTextureUploadQueue::CTextureUploadQueue()
+    : m_pStaging(NULL), m_uCapacity(VV_TEXTURE_UPLOAD_BUFFER_SIZE), m_uHead(0),
+    m_uUploadCount(0), m_uDroppedCount(0), m_uFallbackCount(0), m_uUploadedBytes(0)
+    {
+    }
+    
+    CTextureUploadQueue::~CTextureUploadQueue()
+    {
+        //the context may already be gone, pending updates are discarded
+        free(m_pStaging);
+    }
+    
+    uint32 CTextureUploadQueue::GetImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+    {
+        uint32 bytesPerPixel;
+        switch (type)
+        {
+            case GL_UNSIGNED_SHORT_5_6_5:
+            case GL_UNSIGNED_SHORT_4_4_4_4:
+            case GL_UNSIGNED_SHORT_5_5_5_1:
+                bytesPerPixel = 2;
+                break;
+                
+            default:
+                switch (format)
+                {
+                    case GL_ALPHA:
+                    case GL_LUMINANCE:
+                        bytesPerPixel = 1;
+                        break;
+                    case GL_LUMINANCE_ALPHA:
+                        bytesPerPixel = 2;
+                        break;
+                    case GL_RGB:
+                        bytesPerPixel = 3;
+                        break;
+                    default:
+                        bytesPerPixel = 4;
+                        break;
+                }
+                break;
+        }
+        
+        if(width <= 0 || height <= 0)
+            return 0;
+        
+        //every row but the last one is padded to the unpack alignment
+        uint32 rowBytes = (uint32)width * bytesPerPixel;
+        uint32 pitch = (rowBytes + kTEXTURE_UNPACK_ALIGNMENT - 1) & ~(kTEXTURE_UNPACK_ALIGNMENT - 1);
+        return pitch * (uint32)(height - 1) + rowBytes;
+    }
+    
+    bool CTextureUploadQueue::Enqueue(GLuint texture, GLenum bindTarget, GLenum target, const void* data,
+                                      GLsizei width, GLsizei height, GLint xoffset, GLint yoffset, GLint level,
+                                      GLenum format, GLenum type)
+    {
+        uint32 size = GetImageSize(width, height, format, type);
+        if(data == NULL || size == 0 || size > m_uCapacity)
+        {
+            m_uFallbackCount++;
+            return false;
+        }
+        
+        if(m_pStaging == NULL)
+        {
+            m_pStaging = (char8*)malloc(m_uCapacity);
+            if(m_pStaging == NULL)
+            {
+                m_uFallbackCount++;
+                return false;
+            }
+        }
+        
+        //staging full, submit what is queued and start over
+        if(m_uHead + size > m_uCapacity)
+            Flush();
+        
+        //an update covering a queued one of the same image makes it useless
+        for(std::vector<STextureUpload>::iterator it = m_vUploads.begin(); it != m_vUploads.end(); ++it)
+        {
+            if(!it->dropped && it->texture == texture && it->target == target && it->level == level &&
+               it->xoffset >= xoffset && it->yoffset >= yoffset &&
+               it->xoffset + it->width <= xoffset + width && it->yoffset + it->height <= yoffset + height)
+            {
+                it->dropped = true;
+                m_uDroppedCount++;
+            }
+        }
+        
+        STextureUpload upload;
+        upload.texture = texture;
+        upload.bindTarget = bindTarget;
+        upload.target = target;
+        upload.level = level;
+        upload.xoffset = xoffset;
+        upload.yoffset = yoffset;
+        upload.width = width;
+        upload.height = height;
+        upload.format = format;
+        upload.type = type;
+        upload.offset = m_uHead;
+        upload.dropped = false;
+        
+        memcpy(m_pStaging + m_uHead, data, size);
+        m_uHead = (m_uHead + size + kTEXTURE_UPLOAD_ALIGNMENT - 1) & ~(kTEXTURE_UPLOAD_ALIGNMENT - 1);
+        
+        m_vUploads.push_back(upload);
+        return true;
+    }
+    
+    void CTextureUploadQueue::Flush()
+    {
+        CTextureStateTracker& tracker = CTextureStateTracker::Instance();
+        
+        for(std::vector<STextureUpload>::iterator it = m_vUploads.begin(); it != m_vUploads.end(); ++it)
+        {
+            if(it->dropped)
+                continue;
+            
+            //consecutive updates of the same texture are submitted with a single bind
+            tracker.Bind(it->bindTarget, it->texture);
+            
+            glTexSubImage2D(it->target, it->level, it->xoffset, it->yoffset, it->width, it->height, it->format, it->type, m_pStaging + it->offset);
+            
+            m_uUploadCount++;
+            m_uUploadedBytes += GetImageSize(it->width, it->height, it->format, it->type);
+        }
+        
+        //the driver copied the pixels, every region can be reused
+        m_vUploads.clear();
+        m_uHead = 0;
+    }
+    
+    void CTextureUploadQueue::Discard(GLuint texture)
+    {
+        for(std::vector<STextureUpload>::iterator it = m_vUploads.begin(); it != m_vUploads.end(); ++it)
+        {
+            if(it->texture == texture)
+                it->dropped = true;
+        }
+    }
+    
+    void CTextureUploadQueue::SetBufferSize(uint32 size)
+    {
+        Flush();
+        free(m_pStaging);
+        m_pStaging = NULL;
+        m_uCapacity = size;
+    }
+    
+    void CTextureUploadQueue::Release()
+    {
+        Flush();
+        free(m_pStaging);
+        m_pStaging = NULL;
+    }
+    
+    void CTextureUploadQueue::ResetCounters()
+    {
+        m_uUploadCount = 0;
+        m_uDroppedCount = 0;
+        m_uFallbackCount = 0;
+        m_uUploadedBytes = 0;
+    }
+}
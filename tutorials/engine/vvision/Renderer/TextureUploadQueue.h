@@ -0,0 +1,143 @@
+/* TextureUploadQueue.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_TEXTURE_UPLOAD_QUEUE_H
+#define VVISION_TEXTURE_UPLOAD_QUEUE_H
+
+#include "types.h"
+#include "Singleton.h"
+
+/** default size of the staging buffer in bytes*/
+#define VV_TEXTURE_UPLOAD_BUFFER_SIZE (4 * 1024 * 1024)
+
+namespace vvision
+{
+    /** a sub image update waiting in the staging buffer*/
+    struct STextureUpload
+    {
+        /** texture id and the target it is bound to ( GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP)*/
+        GLuint texture;
+        GLenum bindTarget;
+        
+        /** target of the update ( the texture target or a cube map face)*/
+        GLenum target;
+        
+        /** region*/
+        GLint level;
+        GLint xoffset;
+        GLint yoffset;
+        GLsizei width;
+        GLsizei height;
+        
+        /** host data format and type*/
+        GLenum format;
+        GLenum type;
+        
+        /** offset of the pixels in the staging buffer*/
+        uint32 offset;
+        
+        /** true if a later update of the same texture covers this one*/
+        bool dropped;
+    };
+    
+    /** batches texture sub image updates ( video frames, procedural textures ...) and submits them at once.
+     * updates are copied into a staging buffer that is handed out in aligned regions, so the caller can reuse its memory right away.
+     * es 2.0 has no pixel buffer objects: the pixels are sourced from client memory and copied by the driver on submission,
+     * the staging regions are therefore recycled as soon as the queue is flushed ( no fence needed).
+     * updates that dont fit in the staging buffer are refused and the caller uploads them directly.
+     */
+    CREATE_SINGLETON( CTextureUploadQueue )
+    
+    public :
+    
+    /** queue a sub image update, the pixels are copied
+     * @return false if the update doesnt fit in the staging buffer
+     */
+    bool Enqueue(GLuint texture, GLenum bindTarget, GLenum target, const void* data,
+                 GLsizei width, GLsizei height, GLint xoffset, GLint yoffset, GLint level,
+                 GLenum format, GLenum type);
+    
+    /** submit all queued updates, the textures are bound on the active texture unit. called by the textures before they are bound for drawing*/
+    void Flush();
+    
+    /** drop the queued updates of a texture that is about to be deleted*/
+    void Discard(GLuint texture);
+    
+    /** check if some updates are waiting*/
+    inline bool HasPendingUploads() const {return !m_vUploads.empty();}
+    
+    /** resize the staging buffer ( pending updates are flushed first)*/
+    void SetBufferSize(uint32 size);
+    
+    /** flush and free the staging buffer*/
+    void Release();
+    
+    /** size in bytes of an image in client memory, with respect to GL_UNPACK_ALIGNMENT ( 4)*/
+    static uint32 GetImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type);
+    
+    /** number of glTexSubImage2D issued by Flush*/
+    inline uint32 GetUploadCount() const {return m_uUploadCount;}
+    
+    /** number of updates dropped because a later update covered them*/
+    inline uint32 GetDroppedCount() const {return m_uDroppedCount;}
+    
+    /** number of updates refused ( uploaded directly by the caller)*/
+    inline uint32 GetFallbackCount() const {return m_uFallbackCount;}
+    
+    /** bytes submitted by Flush*/
+    inline uint32 GetUploadedBytes() const {return m_uUploadedBytes;}
+    
+    /** reset the counters ( usually every frame)*/
+    void ResetCounters();
+    
+private:
+    
+    /** not allowed*/
+    CTextureUploadQueue();
+    
+    /** not allowed*/
+    ~CTextureUploadQueue();
+    
+    /** not allowed*/
+    CTextureUploadQueue(const CTextureUploadQueue&);
+    
+    /** not allowed*/
+    CTextureUploadQueue& operator=(const CTextureUploadQueue&);
+    
+    /** staging memory, allocated on first use*/
+    char8* m_pStaging;
+    
+    /** staging size in bytes*/
+    uint32 m_uCapacity;
+    
+    /** next free byte in the staging buffer*/
+    uint32 m_uHead;
+    
+    /** queued updates in submission order*/
+    std::vector<STextureUpload> m_vUploads;
+    
+    /** counters*/
+    uint32 m_uUploadCount;
+    uint32 m_uDroppedCount;
+    uint32 m_uFallbackCount;
+    uint32 m_uUploadedBytes;
+};
+}
+
+#endif
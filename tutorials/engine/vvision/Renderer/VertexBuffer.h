@@ -32,15 +32,15 @@ namespace vvision
         
         /** constructor*/
         CVertexBuffer()
-        : m_eBufferType(kGL_BUFFER_TYPE_ARRAY), m_eBufferUsage(kGL_BUFFER_USAGE_HINT_STATIC)
+        : m_uVboID(0), m_eBufferUsage(kGL_BUFFER_USAGE_HINT_STATIC), m_eBufferType(kGL_BUFFER_TYPE_ARRAY)
         {
         }
         
         /** construct with given buffer type and usage*/
         CVertexBuffer(GL_BUFFER_TYPE bufferType_, GL_BUFFER_USAGE_HINT usage_)
-        : m_eBufferType(bufferType_), m_eBufferUsage(usage_)
+        : m_uVboID(0), m_eBufferUsage(usage_), m_eBufferType(bufferType_)
         {
-            
+        
         }
         
         /** destructor*/
@@ -75,7 +75,7 @@ namespace vvision
             return true;
         }
         
-        /** update buffer content*/
+        /** update buffer content, waits for the draws still reading the buffer ( use Respecify or a CStreamBuffer for per frame data)*/
         inline void UpdateContent(int32 offset, int32 sizeByte, void* data)
         {
             glBindBuffer(m_eBufferType, m_uVboID);
@@ -83,6 +83,25 @@ namespace vvision
             glBindBuffer(m_eBufferType, 0);
         }
         
+        /** replace the storage of the buffer, the name is kept ( vertex array objects referencing it stay valid).
+         * the previous storage is orphaned: the draws still reading it keep it alive, the cpu doesnt wait for them
+         */
+        inline void Respecify(int32 storageSizeByte, void* data)
+        {
+            glBindBuffer(m_eBufferType, m_uVboID);
+            glBufferData(m_eBufferType, storageSizeByte, data, m_eBufferUsage);
+            glBindBuffer(m_eBufferType, 0);
+        }
+        
+        /** orphan the storage and get a new undefined one of the same size, UpdateContent can then write it without waiting*/
+        inline void Orphan(int32 storageSizeByte)
+        {
+            Respecify(storageSizeByte, NULL);
+        }
+        
+        /** buffer id*/
+        inline GLuint GetID() const {return m_uVboID;}
+        
         /** bind buffer*/
         inline void Bind()
         {
@@ -95,18 +114,20 @@ namespace vvision
             glBindBuffer(m_eBufferType, 0);
         }
         
-        /** send attrib to shader */
-        static void MapAttribLocation(int32 index, int32 componentsPerElement, DATA_TYPE type, int32 stride, const void* ptr)
+        /** send attrib to shader
+         * @param normalized integer types are mapped to [0, 1] ( unsigned) or [-1, 1] ( signed) instead of read as is
+         */
+        static void MapAttribLocation(int32 index, int32 componentsPerElement, DATA_TYPE type, int32 stride, const void* ptr, bool normalized = false)
         {
             glEnableVertexAttribArray(index);
-            glVertexAttribPointer(index, componentsPerElement, type, GL_FALSE, stride, ptr);
+            glVertexAttribPointer(index, componentsPerElement, type, normalized ? GL_TRUE : GL_FALSE, stride, ptr);
         }
         /** desactivate the given attrib*/
         static void UnmapAttribLocation(int32 index)
         {
             glDisableVertexAttribArray(index);
         }
-        
+    
     private:
         /** copy constructor no allowed, doenst make sense to copy a mesh buffer ?*/
         CVertexBuffer(const CVertexBuffer& c);
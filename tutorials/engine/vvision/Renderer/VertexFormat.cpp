@@ -0,0 +1,405 @@
+/*
+ *  VertexFormat.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "VertexFormat.h"
+#include "VertexBuffer.h"
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+namespace vvision
+{
+    /** largest half float position error accepted, relative to the mesh diagonal*/
+    static const float32 s_fPositionTolerance = 1.f / 2048.f;
+    
+    /** largest half float tex coord error accepted ( half a texel of a 1024 texture)*/
+    static const float32 s_fTexCoordTolerance = 1.f / 2048.f;
+    
+    /** -1 unknown, 0 not supported, 1 supported*/
+    static int32 s_iHalfFloatSupported = -1;
+    static int32 s_iIndexUintSupported = -1;
+    
+    /** float to half float, round to nearest, overflow gives infinity*/
+    static ushort16 FloatToHalf(float32 value)
+    {
+        union { float32 f; uint32 u; } bits;
+        bits.f = value;
+        
+        uint32 sign = (bits.u >> 16) & 0x8000;
+        int32 exponent = (int32)((bits.u >> 23) & 0xFF) - 127 + 15;
+        uint32 mantissa = bits.u & 0x007FFFFF;
+        
+        if(exponent >= 31)
+            return (ushort16)(sign | 0x7C00);
+        
+        //subnormal half
+        if(exponent <= 0)
+        {
+            if(exponent < -10)
+                return (ushort16)sign;
+            
+            mantissa |= 0x00800000;
+            uint32 shift = 14 - exponent;
+            uint32 half = mantissa >> shift;
+            if((mantissa >> (shift - 1)) & 1)
+                half++;
+            return (ushort16)(sign | half);
+        }
+        
+        //a rounding carry moves to the exponent, which is still the right result
+        uint32 half = sign | ((uint32)exponent << 10) | (mantissa >> 13);
+        if(mantissa & 0x1000)
+            half++;
+        return (ushort16)half;
+    }
+    
+    /** half float to float*/
+    static float32 HalfToFloat(ushort16 half)
+    {
+        int32 exponent = (half >> 10) & 0x1F;
+        int32 mantissa = half & 0x3FF;
+        
+        float32 value;
+        if(exponent == 0)
+            value = ldexpf((float32)mantissa, -24);
+        else if(exponent == 31)
+            value = FLT_MAX;
+        else
+            value = ldexpf((float32)(mantissa | 0x400), exponent - 25);
+        
+        return (half & 0x8000) ? -value : value;
+    }
+    
+    /** error of a value stored as half float*/
+    static inline float32 HalfError(float32 value)
+    {
+        return fabsf(HalfToFloat(FloatToHalf(value)) - value);
+    }
+    
+    SVertexFormat SVertexFormat::Compact(const std::vector<CGpuVertex>& vertices)
+    {
+        SVertexFormat format;
+        if(vertices.empty())
+            return format;
+        
+        vec3f minimum = vertices[0].pos;
+        vec3f maximum = vertices[0].pos;
+        float32 positionError = 0.f;
+        float32 texCoordError = 0.f;
+        bool hasTexCoord = false, unitTexCoord = true, hasNormal = false, hasTangent = false, hasBones = false, byteIndices = true;
+        
+        for(uint32 i = 0; i < vertices.size(); i++)
+        {
+            const CGpuVertex& v = vertices[i];
+            for(int32 c = 0; c < 3; c++)
+            {
+                minimum[c] = std::min(minimum[c], v.pos[c]);
+                maximum[c] = std::max(maximum[c], v.pos[c]);
+                positionError = std::max(positionError, HalfError(v.pos[c]));
+                hasNormal = hasNormal || v.normal[c] != 0.f;
+                hasTangent = hasTangent || v.tangent[c] != 0.f;
+            }
+            
+            for(int32 c = 0; c < 2; c++)
+            {
+                hasTexCoord = hasTexCoord || v.texCoord[c] != 0.f;
+                unitTexCoord = unitTexCoord && v.texCoord[c] >= 0.f && v.texCoord[c] <= 1.f;
+                texCoordError = std::max(texCoordError, HalfError(v.texCoord[c]));
+            }
+            
+            for(int32 c = 0; c < 4; c++)
+            {
+                hasBones = hasBones || v.boneWeights[c] != 0.f;
+                float32 index = v.boneIndices[c];
+                byteIndices = byteIndices && index >= 0.f && index <= 255.f && index == floorf(index);
+            }
+        }
+        
+        bool half = CVertexLayout::IsHalfFloatSupported();
+        float32 diagonal = (maximum - minimum).length();
+        
+        format.position = half && positionError <= diagonal * s_fPositionTolerance ? kVERTEX_ATTRIB_FORMAT_HALF : kVERTEX_ATTRIB_FORMAT_FLOAT;
+        
+        if(!hasTexCoord)
+            format.texCoord = kVERTEX_ATTRIB_FORMAT_NONE;
+        else if(unitTexCoord)
+            format.texCoord = kVERTEX_ATTRIB_FORMAT_UNORM16;
+        else if(half && texCoordError <= s_fTexCoordTolerance)
+            format.texCoord = kVERTEX_ATTRIB_FORMAT_HALF;
+        
+        format.normal = hasNormal ? kVERTEX_ATTRIB_FORMAT_SNORM8 : kVERTEX_ATTRIB_FORMAT_NONE;
+        format.tangent = hasTangent ? kVERTEX_ATTRIB_FORMAT_SNORM8 : kVERTEX_ATTRIB_FORMAT_NONE;
+        
+        if(!hasBones)
+        {
+            format.boneIndices = kVERTEX_ATTRIB_FORMAT_NONE;
+            format.boneWeights = kVERTEX_ATTRIB_FORMAT_NONE;
+        }
+        else
+        {
+            format.boneIndices = byteIndices ? kVERTEX_ATTRIB_FORMAT_UBYTE : kVERTEX_ATTRIB_FORMAT_FLOAT;
+            format.boneWeights = kVERTEX_ATTRIB_FORMAT_UNORM8;
+        }
+        
+        return format;
+    }
+    
+    /** bytes of a component*/
+    static uint32 ComponentSize(VERTEX_ATTRIB_FORMAT format)
+    {
+        switch(format)
+        {
+            case kVERTEX_ATTRIB_FORMAT_FLOAT:
+                return 4;
+            case kVERTEX_ATTRIB_FORMAT_HALF:
+            case kVERTEX_ATTRIB_FORMAT_UNORM16:
+                return 2;
+            case kVERTEX_ATTRIB_FORMAT_SNORM8:
+            case kVERTEX_ATTRIB_FORMAT_UBYTE:
+            case kVERTEX_ATTRIB_FORMAT_UNORM8:
+                return 1;
+            default:
+                return 0;
+        }
+    }
+    
+    CVertexLayout::CVertexLayout()
+    : m_uStride(0)
+    {
+        AddAttribute(ATTRIB_VERTEX,        3, m_sFormat.position);
+        AddAttribute(ATTRIB_TEXTURE0,      2, m_sFormat.texCoord);
+        AddAttribute(ATTRIB_NORMAL,        3, m_sFormat.normal);
+        AddAttribute(ATTRIB_BONES_INDICES, 4, m_sFormat.boneIndices);
+        AddAttribute(ATTRIB_BONES_WEIGHTS, 4, m_sFormat.boneWeights);
+        AddAttribute(ATTRIB_TANGENT,       3, m_sFormat.tangent);
+    }
+    
+    CVertexLayout::CVertexLayout(const SVertexFormat& format)
+    : m_sFormat(format), m_uStride(0)
+    {
+        AddAttribute(ATTRIB_VERTEX,        3, m_sFormat.position);
+        AddAttribute(ATTRIB_TEXTURE0,      2, m_sFormat.texCoord);
+        AddAttribute(ATTRIB_NORMAL,        3, m_sFormat.normal);
+        AddAttribute(ATTRIB_BONES_INDICES, 4, m_sFormat.boneIndices);
+        AddAttribute(ATTRIB_BONES_WEIGHTS, 4, m_sFormat.boneWeights);
+        AddAttribute(ATTRIB_TANGENT,       3, m_sFormat.tangent);
+    }
+    
+    void CVertexLayout::AddAttribute(int32 index, int32 components, VERTEX_ATTRIB_FORMAT format)
+    {
+        if(format == kVERTEX_ATTRIB_FORMAT_NONE)
+            return;
+        
+        SVertexAttrib attrib = {index, components, format, m_uStride};
+        m_vAttributes.push_back(attrib);
+        
+        //keep the next attribute 4 bytes aligned
+        m_uStride += (components * ComponentSize(format) + 3) & ~3;
+    }
+    
+    /** source components of an attribute*/
+    static const float32* AttributeSource(const CGpuVertex& v, int32 index)
+    {
+        switch(index)
+        {
+            case ATTRIB_VERTEX:
+                return &v.pos.x;
+            case ATTRIB_TEXTURE0:
+                return &v.texCoord.x;
+            case ATTRIB_NORMAL:
+                return &v.normal.x;
+            case ATTRIB_BONES_INDICES:
+                return &v.boneIndices.x;
+            case ATTRIB_BONES_WEIGHTS:
+                return &v.boneWeights.x;
+            default:
+                return &v.tangent.x;
+        }
+    }
+    
+    /** clamp and round to the nearest integer*/
+    static inline int32 Quantize(float32 value, float32 minimum, float32 maximum)
+    {
+        return (int32)floorf(std::min(std::max(value, minimum), maximum) + 0.5f);
+    }
+    
+    void CVertexLayout::Encode(const std::vector<CGpuVertex>& vertices, std::vector<uchar8>& data) const
+    {
+        data.assign(vertices.size() * m_uStride, 0);
+        
+        for(uint32 i = 0; i < vertices.size(); i++)
+        {
+            uchar8* vertex = &data[i * m_uStride];
+            for(uint32 a = 0; a < m_vAttributes.size(); a++)
+            {
+                const SVertexAttrib& attrib = m_vAttributes[a];
+                const float32* source = AttributeSource(vertices[i], attrib.index);
+                uchar8* destination = vertex + attrib.offset;
+                
+                for(int32 c = 0; c < attrib.components; c++)
+                {
+                    float32 value = source[c];
+                    switch(attrib.format)
+                    {
+                        case kVERTEX_ATTRIB_FORMAT_FLOAT:
+                            memcpy(destination + c * 4, &value, 4);
+                            break;
+                        case kVERTEX_ATTRIB_FORMAT_HALF:
+                        {
+                            ushort16 half = FloatToHalf(value);
+                            memcpy(destination + c * 2, &half, 2);
+                            break;
+                        }
+                        case kVERTEX_ATTRIB_FORMAT_UNORM16:
+                        {
+                            ushort16 unorm = (ushort16)Quantize(value * 65535.f, 0.f, 65535.f);
+                            memcpy(destination + c * 2, &unorm, 2);
+                            break;
+                        }
+                        case kVERTEX_ATTRIB_FORMAT_SNORM8:
+                            //gl es 2 maps the byte c to ( 2c + 1) / 255
+                            destination[c] = (uchar8)(char8)Quantize((value * 255.f - 1.f) * 0.5f, -128.f, 127.f);
+                            break;
+                        case kVERTEX_ATTRIB_FORMAT_UBYTE:
+                            destination[c] = (uchar8)Quantize(value, 0.f, 255.f);
+                            break;
+                        case kVERTEX_ATTRIB_FORMAT_UNORM8:
+                            destination[c] = (uchar8)Quantize(value * 255.f, 0.f, 255.f);
+                            break;
+                        default:
+                            break;
+                    }
+                }
+                
+                //quantized weights that summed to one still sum to one, the rounding error goes to the largest weight
+                if(attrib.format == kVERTEX_ATTRIB_FORMAT_UNORM8 && attrib.index == ATTRIB_BONES_WEIGHTS)
+                {
+                    float32 total = source[0] + source[1] + source[2] + source[3];
+                    if(fabsf(total - 1.f) < 0.01f)
+                    {
+                        int32 sum = 0, largest = 0;
+                        for(int32 c = 0; c < 4; c++)
+                        {
+                            sum += destination[c];
+                            if(destination[c] > destination[largest])
+                                largest = c;
+                        }
+                        destination[largest] = (uchar8)(destination[largest] + 255 - sum);
+                    }
+                }
+            }
+        }
+    }
+    
+    void CVertexLayout::MapAttributes() const
+    {
+        for(uint32 a = 0; a < m_vAttributes.size(); a++)
+        {
+            const SVertexAttrib& attrib = m_vAttributes[a];
+            const GLvoid* offset = (const GLvoid*)(size_t)attrib.offset;
+            
+            switch(attrib.format)
+            {
+                case kVERTEX_ATTRIB_FORMAT_FLOAT:
+                    CVertexBuffer::MapAttribLocation(attrib.index, attrib.components, kDATA_TYPE_FLOAT, m_uStride, offset);
+                    break;
+                case kVERTEX_ATTRIB_FORMAT_HALF:
+                    CVertexBuffer::MapAttribLocation(attrib.index, attrib.components, kDATA_TYPE_HALF_FLOAT, m_uStride, offset);
+                    break;
+                case kVERTEX_ATTRIB_FORMAT_UNORM16:
+                    CVertexBuffer::MapAttribLocation(attrib.index, attrib.components, kDATA_TYPE_UNSIGNED_SHORT, m_uStride, offset, true);
+                    break;
+                case kVERTEX_ATTRIB_FORMAT_SNORM8:
+                    CVertexBuffer::MapAttribLocation(attrib.index, attrib.components, kDATA_TYPE_BYTE, m_uStride, offset, true);
+                    break;
+                case kVERTEX_ATTRIB_FORMAT_UBYTE:
+                    CVertexBuffer::MapAttribLocation(attrib.index, attrib.components, kDATA_TYPE_UNSIGNED_BYTE, m_uStride, offset);
+                    break;
+                case kVERTEX_ATTRIB_FORMAT_UNORM8:
+                    CVertexBuffer::MapAttribLocation(attrib.index, attrib.components, kDATA_TYPE_UNSIGNED_BYTE, m_uStride, offset, true);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    
+    bool CVertexLayout::IsHalfFloatSupported()
+    {
+        if(s_iHalfFloatSupported == -1)
+        {
+            const char8* extensions = (const char8*)glGetString(GL_EXTENSIONS);
+            s_iHalfFloatSupported = extensions && strstr(extensions, "GL_OES_vertex_half_float") ? 1 : 0;
+        }
+        return s_iHalfFloatSupported == 1;
+    }
+    
+    uint32 GetIndexTypeSize(INDEX_TYPE type)
+    {
+        switch(type)
+        {
+            case kINDEX_TYPE_UNSIGNED_BYTE:
+                return 1;
+            case kINDEX_TYPE_UNSIGNED_SHORT:
+                return 2;
+            default:
+                return 4;
+        }
+    }
+    
+    bool SelectIndexType(uint32 vertex_count, INDEX_TYPE& type)
+    {
+        if(vertex_count <= 0x100)
+            type = kINDEX_TYPE_UNSIGNED_BYTE;
+        else if(vertex_count <= 0x10000)
+            type = kINDEX_TYPE_UNSIGNED_SHORT;
+        else
+        {
+            type = kINDEX_TYPE_UNSIGNED_INT;
+            return IsIndexUintSupported();
+        }
+        return true;
+    }
+    
+    void EncodeIndices(const std::vector<uint32>& indices, INDEX_TYPE type, std::vector<uchar8>& data)
+    {
+        uint32 size = GetIndexTypeSize(type);
+        data.resize(indices.size() * size);
+        if(indices.empty())
+            return;
+        
+        switch(type)
+        {
+            case kINDEX_TYPE_UNSIGNED_BYTE:
+                for(uint32 i = 0; i < indices.size(); i++)
+                    data[i] = (uchar8)indices[i];
+                break;
+            case kINDEX_TYPE_UNSIGNED_SHORT:
+            {
+                ushort16* destination = (ushort16*)&data[0];
+                for(uint32 i = 0; i < indices.size(); i++)
+                    destination[i] = (ushort16)indices[i];
+                break;
+            }
+            default:
+                memcpy(&data[0], &indices[0], data.size());
+                break;
+        }
+    }
+    
+    bool IsIndexUintSupported()
+    {
+        if(s_iIndexUintSupported == -1)
+        {
+            const char8* extensions = (const char8*)glGetString(GL_EXTENSIONS);
+            s_iIndexUintSupported = extensions && strstr(extensions, "GL_OES_element_index_uint") ? 1 : 0;
+        }
+        return s_iIndexUintSupported == 1;
+    }
+}
@@ -0,0 +1,209 @@
+/* VertexFormat.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_VERTEX_FORMAT_H
+#define VVISION_VERTEX_FORMAT_H
+
+#include "types.h"
+
+namespace vvision
+{
+    /** represents a gpu vertex*/
+    struct CGpuVertex {
+        
+        /** vertex pos*/
+        vec3f pos;
+        
+        /** vertex tex cooridnate*/
+        vec2f texCoord;
+        
+        /** vertex normal*/
+        vec3f normal;
+        
+        /** bone indices that affect this vertex ( for animated mesh only)*/
+        vec4f boneIndices;
+        
+        /** bone weights that affect this vertex for animated mes only)*/
+        vec4f boneWeights;
+        
+        /** vertex tangent coordinate*/
+        vec3f tangent;
+        
+        /** constructor*/
+        CGpuVertex() :
+        pos(vec3f()), texCoord(vec2f()), normal(vec3f()), boneIndices(vec4f(0,0,0,0)), boneWeights(vec4f(0,0,0,0)), tangent(vec3f())
+        {}
+        CGpuVertex(const vec3f& pos_, const vec3f& normal_, const vec3f& tangent_, const vec2f& texCoord_, const vec4f& boneIndices_, const vec4f& boneWeights_)
+        :
+        pos(pos_), texCoord(texCoord_), normal(normal_), boneIndices(boneIndices_), boneWeights(boneWeights_), tangent(tangent_)
+        {
+        }
+        
+        /** copy constructor*/
+        CGpuVertex(const CGpuVertex& v)
+        {
+            pos = v.pos;
+            normal = v.normal;
+            tangent = v.tangent;
+            texCoord = v.texCoord;
+            boneIndices = v.boneIndices;
+            boneWeights = v.boneWeights;
+        }
+        
+        /** = operator*/
+        CGpuVertex& operator=(CGpuVertex const& v)
+        {
+            pos = v.pos;
+            normal = v.normal;
+            tangent = v.tangent;
+            texCoord = v.texCoord;
+            boneIndices = v.boneIndices;
+            boneWeights = v.boneWeights;
+            return *this;
+        }
+    };
+    
+    /** storage of a vertex attribute on the gpu, every attribute starts on a 4 bytes boundary*/
+    enum VERTEX_ATTRIB_FORMAT
+    {
+        /** not stored, the shader reads the current generic attribute ( 0, 0, 0, 1)*/
+        kVERTEX_ATTRIB_FORMAT_NONE,
+        
+        /** 32 bits float per component*/
+        kVERTEX_ATTRIB_FORMAT_FLOAT,
+        
+        /** 16 bits float per component ( OES_vertex_half_float)*/
+        kVERTEX_ATTRIB_FORMAT_HALF,
+        
+        /** normalized unsigned short per component, [0, 1]*/
+        kVERTEX_ATTRIB_FORMAT_UNORM16,
+        
+        /** normalized signed byte per component, [-1, 1]*/
+        kVERTEX_ATTRIB_FORMAT_SNORM8,
+        
+        /** unsigned byte per component read as is, [0, 255] ( bone indices)*/
+        kVERTEX_ATTRIB_FORMAT_UBYTE,
+        
+        /** normalized unsigned byte per component, [0, 1] ( bone weights)*/
+        kVERTEX_ATTRIB_FORMAT_UNORM8
+    };
+    
+    /** storage of each attribute of CGpuVertex for a mesh, the shaders read floats whatever the storage is*/
+    struct SVertexFormat
+    {
+        /** constructor, the float layout of CGpuVertex*/
+        SVertexFormat()
+        : position(kVERTEX_ATTRIB_FORMAT_FLOAT), texCoord(kVERTEX_ATTRIB_FORMAT_FLOAT), normal(kVERTEX_ATTRIB_FORMAT_FLOAT),
+        tangent(kVERTEX_ATTRIB_FORMAT_FLOAT), boneIndices(kVERTEX_ATTRIB_FORMAT_FLOAT), boneWeights(kVERTEX_ATTRIB_FORMAT_FLOAT)
+        {}
+        
+        /** the smallest format that represents the given vertices within the engine tolerances:
+         * attributes never set are dropped, positions and tex coords are half floats ( or unorm16 for tex coords in [0, 1])
+         * when the round trip error is small enough, normals and tangents are snorm8, bone indices ubyte and weights unorm8
+         */
+        static SVertexFormat Compact(const std::vector<CGpuVertex>& vertices);
+        
+        /** key identifying the format, 4 bits per attribute*/
+        inline uint32 GetKey() const {return position | (texCoord << 4) | (normal << 8) | (tangent << 12) | (boneIndices << 16) | (boneWeights << 20);}
+        
+        /** storage of each attribute*/
+        VERTEX_ATTRIB_FORMAT position;
+        VERTEX_ATTRIB_FORMAT texCoord;
+        VERTEX_ATTRIB_FORMAT normal;
+        VERTEX_ATTRIB_FORMAT tangent;
+        VERTEX_ATTRIB_FORMAT boneIndices;
+        VERTEX_ATTRIB_FORMAT boneWeights;
+    };
+    
+    /** an attribute of a vertex layout*/
+    struct SVertexAttrib
+    {
+        /** attribute location ( ATTRIB_VERTEX ...)*/
+        int32 index;
+        
+        /** components read by the shader*/
+        int32 components;
+        
+        /** storage*/
+        VERTEX_ATTRIB_FORMAT format;
+        
+        /** offset in the vertex, in bytes*/
+        uint32 offset;
+    };
+    
+    /** interleaved layout of a vertex format: attribute offsets, stride, packing of CGpuVertex and the attrib pointers*/
+    class CVertexLayout
+    {
+    public:
+        
+        /** constructor, the float layout of CGpuVertex*/
+        CVertexLayout();
+        
+        /** constructor*/
+        explicit CVertexLayout(const SVertexFormat& format);
+        
+        /** format of the layout*/
+        inline const SVertexFormat& GetFormat() const {return m_sFormat;}
+        
+        /** size of a vertex in bytes*/
+        inline uint32 GetStride() const {return m_uStride;}
+        
+        /** stored attributes*/
+        inline const std::vector<SVertexAttrib>& GetAttributes() const {return m_vAttributes;}
+        
+        /** pack vertices in the layout*/
+        void Encode(const std::vector<CGpuVertex>& vertices, std::vector<uchar8>& data) const;
+        
+        /** enable and point the stored attributes at the bound array buffer ( call with the vao of the mesh bound)*/
+        void MapAttributes() const;
+        
+        /** check if the device reads half float attributes ( OES_vertex_half_float), requires a current context*/
+        static bool IsHalfFloatSupported();
+    
+    private:
+        
+        /** add an attribute, no op for kVERTEX_ATTRIB_FORMAT_NONE*/
+        void AddAttribute(int32 index, int32 components, VERTEX_ATTRIB_FORMAT format);
+        
+        /** format*/
+        SVertexFormat m_sFormat;
+        
+        /** stored attributes*/
+        std::vector<SVertexAttrib> m_vAttributes;
+        
+        /** vertex size*/
+        uint32 m_uStride;
+    };
+    
+    /** size in bytes of an index*/
+    uint32 GetIndexTypeSize(INDEX_TYPE type);
+    
+    /** smallest index type that addresses vertex_count vertices, 32 bits indices require OES_element_index_uint
+     * @return false if the device cant address that many vertices in one draw
+     */
+    bool SelectIndexType(uint32 vertex_count, INDEX_TYPE& type);
+    
+    /** pack indices in the given type*/
+    void EncodeIndices(const std::vector<uint32>& indices, INDEX_TYPE type, std::vector<uchar8>& data);
+    
+    /** check if the device draws 32 bits indices ( OES_element_index_uint), requires a current context*/
+    bool IsIndexUintSupported();
+}
+
+#endif
@@ -24,12 +24,28 @@
 #include "Material.h"
 #include "MeshBuffer.h"
 #include "Shader.h"
+#include "ShaderUniforms.h"
 #include "Texture.h"
 #include "TextureCubeMap.h"
+#include "TextureUploadQueue.h"
+#include "TextureStateTracker.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderPermutation.h"
+#include "RenderStateCache.h"
+#include "RenderBackend.h"
+#include "CommandBuffer.h"
+#include "RenderQueue.h"
 #include "VertexBuffer.h"
+#include "VertexFormat.h"
+#include "BufferArena.h"
+#include "MeshletCuller.h"
+#include "StaticBatcher.h"
+#include "StreamBuffer.h"
+#include "InstancedRenderer.h"
 #include "types.h"
 #include "RenderBuffer.h"
 #include "OffscreenRenderTarget.h"
+#include "GPUProfiler.h"
 
 using namespace vvision;
 
@@ -0,0 +1,116 @@
+/*
+ *  AssimpIOSystem.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "AssimpIOSystem.h"
+#include <unistd.h>
+
+namespace vvision
+{
+    CAssimpIOStream::CAssimpIOStream()
+    : m_uCursor(0)
+    {
+    }
+
+    CAssimpIOStream::~CAssimpIOStream()
+    {
+    }
+
+    size_t CAssimpIOStream::Read(void* pvBuffer, size_t pSize, size_t pCount)
+    {
+        if(pSize == 0)
+            return 0;
+
+        size_t available = (m_cBuffer.GetSize() - m_uCursor) / pSize;
+        size_t count = pCount < available ? pCount : available;
+        memcpy(pvBuffer, m_cBuffer.GetData() + m_uCursor, count * pSize);
+        m_uCursor += count * pSize;
+        return count;
+    }
+
+    size_t CAssimpIOStream::Write(const void* /*pvBuffer*/, size_t /*pSize*/, size_t /*pCount*/)
+    {
+        //read only
+        return 0;
+    }
+
+    aiReturn CAssimpIOStream::Seek(size_t pOffset, aiOrigin pOrigin)
+    {
+        size_t size = m_cBuffer.GetSize();
+        size_t target;
+
+        switch (pOrigin)
+        {
+            case aiOrigin_SET:
+                target = pOffset;
+                break;
+
+            case aiOrigin_CUR:
+                target = m_uCursor + pOffset;
+                break;
+
+            case aiOrigin_END:
+                //the offset is negative for aiOrigin_END ( see IOStream::Seek)
+                target = size + pOffset;
+                break;
+
+            default:
+                return aiReturn_FAILURE;
+        }
+
+        if(target > size)
+            return aiReturn_FAILURE;
+
+        m_uCursor = target;
+        return aiReturn_SUCCESS;
+    }
+
+    size_t CAssimpIOStream::Tell() const
+    {
+        return m_uCursor;
+    }
+
+    size_t CAssimpIOStream::FileSize() const
+    {
+        return m_cBuffer.GetSize();
+    }
+
+    void CAssimpIOStream::Flush()
+    {
+    }
+
+    bool CAssimpIOSystem::Exists(const char* pFile) const
+    {
+        return CFileSystem::Instance().IsArchived(pFile) || access(pFile, R_OK) == 0;
+    }
+
+    char CAssimpIOSystem::getOsSeparator() const
+    {
+        return '/';
+    }
+
+    Assimp::IOStream* CAssimpIOSystem::Open(const char* pFile, const char* pMode)
+    {
+        //meshes are only read
+        if(strchr(pMode, 'w') != NULL)
+            return NULL;
+
+        CAssimpIOStream* stream = new CAssimpIOStream();
+        if(!CFileSystem::Instance().ReadFile(pFile, stream->GetBuffer()))
+        {
+            delete stream;
+            return NULL;
+        }
+        return stream;
+    }
+
+    void CAssimpIOSystem::Close(Assimp::IOStream* pFile)
+    {
+        delete pFile;
+    }
+}
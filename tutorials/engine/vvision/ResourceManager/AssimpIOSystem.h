@@ -0,0 +1,77 @@
+/* AssimpIOSystem.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_ASSIMP_IO_SYSTEM_H
+#define VVISION_ASSIMP_IO_SYSTEM_H
+
+#include "IOSystem.h"
+#include "IOStream.h"
+#include "FileSystem.h"
+
+namespace vvision
+{
+    /** read only assimp stream over a file buffer ( mapped file or archive entry)*/
+    class CAssimpIOStream: public Assimp::IOStream
+    {
+    public:
+
+        /** constructor*/
+        CAssimpIOStream();
+
+        /** destructor*/
+        ~CAssimpIOStream();
+
+        /** the file content*/
+        inline CFileBuffer& GetBuffer() {return m_cBuffer;}
+
+        /** @inherited from IOStream*/
+        size_t Read(void* pvBuffer, size_t pSize, size_t pCount);
+        size_t Write(const void* pvBuffer, size_t pSize, size_t pCount);
+        aiReturn Seek(size_t pOffset, aiOrigin pOrigin);
+        size_t Tell() const;
+        size_t FileSize() const;
+        void Flush();
+
+    private:
+
+        /** not allowed*/
+        CAssimpIOStream(const CAssimpIOStream&);
+        CAssimpIOStream& operator=(const CAssimpIOStream&);
+
+        /** file content*/
+        CFileBuffer m_cBuffer;
+
+        /** read cursor*/
+        size_t m_uCursor;
+    };
+
+    /** assimp file system routed through CFileSystem, so meshes and the files they reference ( materials, ...) are found in mounted asset packs*/
+    class CAssimpIOSystem: public Assimp::IOSystem
+    {
+    public:
+
+        /** @inherited from IOSystem*/
+        bool Exists(const char* pFile) const;
+        char getOsSeparator() const;
+        Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb");
+        void Close(Assimp::IOStream* pFile);
+    };
+}
+
+#endif
@@ -10,8 +10,277 @@
 #include "CacheResourceManager.h"
 #include "Helpers.h"
 #include "FilePath.h"
+#include "Timer.h"
+#include "AssimpIOSystem.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "VertexFormat.h"
+#include "aiConfig.h"
 namespace vvision
 {
+    /** suffixes of the six files layout, in gl order*/
+    static const char8* s_pCubeFaceSuffix[6] = {"_xp", "_xn", "_yp", "_yn", "_zp", "_zn"};
+    
+    /** one face of a cube map decoded by a worker thread*/
+    struct SCubeFaceJob
+    {
+        string filename;
+        CImageSource source;
+        char8* destination;
+        bool success;
+    };
+    
+    static void OpenCubeFace(void* context, size_t index)
+    {
+        VV_PROFILE_SCOPE("OpenCubeFace");
+        SCubeFaceJob* job = (SCubeFaceJob*)context + index;
+        job->success = job->source.Open(job->filename);
+    }
+    
+    static void DecodeCubeFace(void* context, size_t index)
+    {
+        VV_PROFILE_SCOPE("DecodeCubeFace");
+        SCubeFaceJob* job = (SCubeFaceJob*)context + index;
+        job->success = job->source.Decode(job->destination);
+    }
+    
+    /** six files layout ( base_xp.ext ... base_zn.ext), the faces are decoded in parallel into one allocation*/
+    static char8* LoadCubeFaces(const string& name, uint32& size)
+    {
+        string extension, base;
+        StringManipulator::GetExtensitonType(name, extension);
+        StringManipulator::GetBaseName(name, base);
+        
+        SCubeFaceJob jobs[6];
+        for(uint32 i = 0; i < 6; i++)
+            jobs[i].filename = base + s_pCubeFaceSuffix[i] + "." + extension;
+        
+        ParallelFor(6, jobs, OpenCubeFace);
+        
+        for(uint32 i = 0; i < 6; i++)
+        {
+            if(!jobs[i].success)
+            {
+                std::cerr<<"CCacheResourceManager: [ERROR] could not open cube map face: "<<jobs[i].filename<<"\n";
+                return NULL;
+            }
+            if(jobs[i].source.GetWidth() != jobs[i].source.GetHeight() || jobs[i].source.GetWidth() != jobs[0].source.GetWidth())
+            {
+                std::cerr<<"CCacheResourceManager: [ERROR] cube map faces must be square and share the same size: "<<jobs[i].filename<<"\n";
+                return NULL;
+            }
+        }
+        
+        size = jobs[0].source.GetWidth();
+        uint32 faceBytes = size * size * 4;
+        char8* staging = (char8*)malloc(faceBytes * 6);
+        if(staging == NULL)
+            return NULL;
+        
+        for(uint32 i = 0; i < 6; i++)
+            jobs[i].destination = staging + faceBytes * i;
+        
+        ParallelFor(6, jobs, DecodeCubeFace);
+        
+        for(uint32 i = 0; i < 6; i++)
+        {
+            if(!jobs[i].success)
+            {
+                std::cerr<<"CCacheResourceManager: [ERROR] could not decode cube map face: "<<jobs[i].filename<<"\n";
+                free(staging);
+                return NULL;
+            }
+        }
+        return staging;
+    }
+    
+    /** single image layout, the layout is deduced from the aspect ratio:
+     * 1:6 vertical strip and 6:1 horizontal strip in gl order,
+     * 4:3 horizontal cross ( -x +z +x -z on the middle row) and 3:4 vertical cross ( -z upside down on the last row).
+     */
+    static char8* LoadCubeLayout(const string& name, uint32& size)
+    {
+        CImageSource source;
+        if(!source.Open(name))
+        {
+            std::cerr<<"CCacheResourceManager: [ERROR] could not open cube map: "<<name<<"\n";
+            return NULL;
+        }
+        
+        uint32 width = source.GetWidth();
+        uint32 height = source.GetHeight();
+        
+        //face cells ( column, row) in gl order
+        static const uint32 hcross[6][2] = {{2, 1}, {0, 1}, {1, 0}, {1, 2}, {1, 1}, {3, 1}};
+        static const uint32 vcross[6][2] = {{2, 1}, {0, 1}, {1, 0}, {1, 2}, {1, 1}, {1, 3}};
+        uint32 cells[6][2];
+        bool flipNegativeZ = false;
+        
+        if(width * 6 == height)
+        {
+            //faces are already contiguous, decode in place
+            size = width;
+            char8* staging = (char8*)malloc(size * size * 4 * 6);
+            if(staging != NULL && !source.Decode(staging))
+            {
+                free(staging);
+                staging = NULL;
+            }
+            return staging;
+        }
+        else if(width == height * 6)
+        {
+            size = height;
+            for(uint32 i = 0; i < 6; i++)
+            {
+                cells[i][0] = i;
+                cells[i][1] = 0;
+            }
+        }
+        else if(width * 3 == height * 4)
+        {
+            size = width / 4;
+            memcpy(cells, hcross, sizeof(cells));
+        }
+        else if(width * 4 == height * 3)
+        {
+            size = width / 3;
+            memcpy(cells, vcross, sizeof(cells));
+            flipNegativeZ = true;
+        }
+        else
+        {
+            std::cerr<<"CCacheResourceManager: [ERROR] unknown cube map layout ( "<<width<<"x"<<height<<"): "<<name<<"\n";
+            return NULL;
+        }
+        
+        char8* image = (char8*)malloc(width * height * 4);
+        if(image == NULL || !source.Decode(image))
+        {
+            free(image);
+            return NULL;
+        }
+        
+        uint32 rowBytes = size * 4;
+        char8* staging = (char8*)malloc(rowBytes * size * 6);
+        if(staging == NULL)
+        {
+            free(image);
+            return NULL;
+        }
+        
+        for(uint32 i = 0; i < 6; i++)
+        {
+            const char8* src = image + (cells[i][1] * size * width + cells[i][0] * size) * 4;
+            char8* dst = staging + rowBytes * size * i;
+            
+            if(flipNegativeZ && i == 5)
+            {
+                //rotate by 180 degrees
+                for(uint32 y = 0; y < size; y++)
+                {
+                    const uint32* srcRow = (const uint32*)(src + (size - 1 - y) * width * 4);
+                    uint32* dstRow = (uint32*)(dst + y * rowBytes);
+                    for(uint32 x = 0; x < size; x++)
+                        dstRow[x] = srcRow[size - 1 - x];
+                }
+            }
+            else
+            {
+                for(uint32 y = 0; y < size; y++)
+                    memcpy(dst + y * rowBytes, src + y * width * 4, rowBytes);
+            }
+        }
+        
+        free(image);
+        return staging;
+    }
+    
+    /** pre-packed container, the faces are used directly from the file content
+     * @return pointer to the first face, valid as long as buffer is open
+     */
+    static const char8* LoadCubeContainer(const string& name, CFileBuffer& buffer, uint32& size, uint32& faceStride)
+    {
+        if(!getContentFromPath(getPath(name), buffer))
+        {
+            std::cerr<<"CCacheResourceManager: [ERROR] could not open cube map: "<<name<<"\n";
+            return NULL;
+        }
+        
+        const SCubeMapHeader* header = (const SCubeMapHeader*)buffer.GetData();
+        bool valid =
+        buffer.GetSize() >= sizeof(SCubeMapHeader) &&
+        header->magic == VV_CUBE_MAP_MAGIC &&
+        header->version == VV_CUBE_MAP_VERSION &&
+        header->size > 0 &&
+        header->faceStride / 4 / header->size >= header->size &&
+        header->faceStride <= (buffer.GetSize() - sizeof(SCubeMapHeader)) / 6;
+        
+        if(!valid)
+        {
+            std::cerr<<"CCacheResourceManager: [ERROR] invalid cube map container: "<<name<<"\n";
+            return NULL;
+        }
+        
+        size = header->size;
+        faceStride = header->faceStride;
+        return buffer.GetData() + sizeof(SCubeMapHeader);
+    }
+    
+    CCacheResourceManager::CCacheResourceManager()
+    : m_pAssetPack(NULL), m_pShaderPack(NULL), m_fLoadingTimeMs(0.0)
+    {
+        //meshes ( and the files they reference) are read through the engine file system, the importer owns the io handler
+        Importer.SetIOHandler(new CAssimpIOSystem());
+        
+        //the pack is optional, loose files are used when it is not bundled
+        MountAssetPack(VV_DEFAULT_ASSET_PACK);
+        
+        //mounted last, the shader pack takes precedence over the shaders of the asset pack
+        MountShaderPack(VV_DEFAULT_SHADER_PACK);
+    }
+    
+    CCacheResourceManager::~CCacheResourceManager()
+    {
+        Destroy();
+        UnmountPack(m_pShaderPack);
+        UnmountPack(m_pAssetPack);
+    }
+    
+    bool CCacheResourceManager::MountPack(const std::string& name, CAssetPack*& pack)
+    {
+        CAssetPack* loaded = new CAssetPack();
+        if(!loaded->Load(getPath(name).c_str()))
+        {
+            delete loaded;
+            return false;
+        }
+        
+        UnmountPack(pack);
+        pack = loaded;
+        CFileSystem::Instance().MountArchive(pack);
+        return true;
+    }
+    
+    void CCacheResourceManager::UnmountPack(CAssetPack*& pack)
+    {
+        if(pack != NULL)
+        {
+            CFileSystem::Instance().UnmountArchive(pack);
+            SAFE_DELETE(pack);
+        }
+    }
+    
+    bool CCacheResourceManager::MountAssetPack(const std::string& name)
+    {
+        return MountPack(name, m_pAssetPack);
+    }
+    
+    bool CCacheResourceManager::MountShaderPack(const std::string& name)
+    {
+        return MountPack(name, m_pShaderPack);
+    }
+    
     void CCacheResourceManager::Destroy()
     {
         //texture cleanup
@@ -64,6 +333,7 @@ namespace vvision
                                                    GLint min_filter
                                                    )
     {
+        VV_PROFILE_SCOPE("CCacheResourceManager::LoadTexture2D");
         
         if(tex2dResources.find(name) != tex2dResources.end())
         {
@@ -73,8 +343,9 @@ namespace vvision
             return tex2dResources.find(name)->second;
         }
         
+        CTimer timer;
         int32 width,height;
-        char8 * data = LoadImage(getPath(name.c_str()), &width, &height);
+        char8 * data = LoadImage(name, &width, &height);
         
         if(data == NULL)
         {
@@ -93,8 +364,9 @@ namespace vvision
                            );
         free(data);
         tex2dResources[name] = ptr;
+        m_fLoadingTimeMs += timer.GetElapsedMs();
 #ifdef DEBUG
-        std::cerr<< "CCacheResourceManager: [SUCCESS] "<<name <<" texture loaded...\n";
+        std::cerr<< "CCacheResourceManager: [SUCCESS] "<<name <<" texture loaded in "<<timer.GetElapsedMs()<<" ms...\n";
 #endif
         return ptr;
         
@@ -109,6 +381,7 @@ namespace vvision
                                                             GLint min_filter
                                                             )
     {
+        VV_PROFILE_SCOPE("CCacheResourceManager::LoadTextureCube");
         
         //resource already loaded !
         if(texCubeResources.find(name) != texCubeResources.end())
@@ -119,120 +392,62 @@ namespace vvision
             return texCubeResources.find(name)->second;
         }
         
-#define CCRM_CUBE_MAP_NOT_FOUND \
-std::cerr<< "CCacheResourceManager: [ERROR] could not load texture cube map: "<< name << "...<\n";
-        
-        int32 width,height;
-        string extension, base;
+        CTimer timer;
+        string extension;
         StringManipulator::GetExtensitonType(name, extension);
-        StringManipulator::GetBaseName(name, base);
-        ostringstream os;
+        StringManipulator::ToLowerCase(extension);
         
-        //xp
-        os.str("");
-        os<<base<<"_xp."<<extension;
-        char8 * data_xp = LoadImage(getPath(os.str()), &width, &height);
+        uint32 size = 0;
+        uint32 faceStride = 0;
+        const char8* faces = NULL;
+        char8* staging = NULL;
+        CFileBuffer container;
         
-        if(data_xp == NULL)
+        if(StringManipulator::IsEqual(extension, "vvcube") == 0)
         {
-            CCRM_CUBE_MAP_NOT_FOUND
-            return NULL;
-        }
-        
-        //xn
-        os.str("");
-        os<<base<<"_xn."<<extension;
-        char8 * data_xn = LoadImage(getPath(os.str()), &width, &height);
-        
-        if(data_xn == NULL)
-        {
-            CCRM_CUBE_MAP_NOT_FOUND
-            free(data_xp);
-            return NULL;
+            faces = LoadCubeContainer(name, container, size, faceStride);
         }
-        
-        //yp
-        os.str("");
-        os<<base<<"_yp."<<extension;
-        char8 * data_yp = LoadImage(getPath(os.str()), &width, &height);
-        
-        if(data_yp == NULL)
+        else
         {
-            CCRM_CUBE_MAP_NOT_FOUND
-            free(data_xp);
-            free(data_xn);
-            return NULL;
-        }
-        
-        //yn
-        os.str("");
-        os<<base<<"_yn."<<extension;
-        char8 * data_yn = LoadImage(getPath(os.str()), &width, &height);
-        
-        if(data_yn == NULL)
-        {
-            CCRM_CUBE_MAP_NOT_FOUND
-            free(data_xp);
-            free(data_xn);
-            free(data_yp);
-            return NULL;
-        }
-        
-        //zp
-        os.str("");
-        os<<base<<"_zp."<<extension;
-        char8 * data_zp = LoadImage(getPath(os.str()), &width, &height);
-        
-        if(data_zp == NULL)
-        {
-            CCRM_CUBE_MAP_NOT_FOUND
-            free(data_xp);
-            free(data_xn);
-            free(data_yp);
-            free(data_yn);
-            return NULL;
+            //a file with the cube map name is a single image layout, else the six faces are loaded from base_xp.ext ... base_zn.ext
+            if(CFileSystem::Instance().Exists(getPath(name)))
+                staging = LoadCubeLayout(name, size);
+            else
+                staging = LoadCubeFaces(name, size);
+            
+            faces = staging;
+            faceStride = size * size * 4;
         }
         
-        //yn
-        os.str("");
-        os<<base<<"_zn."<<extension;
-        char8 * data_zn = LoadImage(getPath(os.str()), &width, &height);
-        
-        if(data_zn == NULL)
+        if(faces == NULL)
         {
-            CCRM_CUBE_MAP_NOT_FOUND
-            free(data_xp);
-            free(data_xn);
-            free(data_yp);
-            free(data_yn);
-            free(data_zp);
+            std::cerr<< "CCacheResourceManager: [ERROR] could not load texture cube map: "<< name << "...<\n";
             return NULL;
         }
         
         CTextureCubeMap* ptr=new CTextureCubeMap();
         ptr->CreateTexture(GL_TEXTURE_CUBE_MAP,
-                           width, height, GL_RGBA,
+                           size, size, GL_RGBA,
                            GL_UNSIGNED_BYTE, GL_RGBA,
-                           (uchar8*)data_xp,
-                           (uchar8*)data_xn,
+                           (void*)(faces),
+                           (void*)(faces + faceStride),
                            
-                           (uchar8*)data_yp,
-                           (uchar8*)data_yn,
+                           (void*)(faces + faceStride * 2),
+                           (void*)(faces + faceStride * 3),
                            
-                           (uchar8*)data_zp,
-                           (uchar8*)data_zn,
+                           (void*)(faces + faceStride * 4),
+                           (void*)(faces + faceStride * 5),
                            
                            wrap_s, wrap_t,
-                           mag_filter, min_filter, buildMipMapTexture
+                           min_filter, mag_filter, buildMipMapTexture
                            );
-        free(data_xp);free(data_xn);
-        free(data_yp);free(data_yn);
-        free(data_zp);free(data_zn);
+        free(staging);
         
         //cache resource
         texCubeResources[name] = ptr;
+        m_fLoadingTimeMs += timer.GetElapsedMs();
 #ifdef DEBUG
-        std::cerr<< "CCacheResourceManager: [SUCCESS] "<<name<<" texture cube map loaded...\n";
+        std::cerr<< "CCacheResourceManager: [SUCCESS] "<<name<<" texture cube map loaded in "<<timer.GetElapsedMs()<<" ms...\n";
 #endif
         return ptr;
         
@@ -240,34 +455,73 @@ std::cerr<< "CCacheResourceManager: [ERROR] could not load texture cube map: "<<
     
     CShader* CCacheResourceManager::LoadShader(const std::string& name)
     {
+        return LoadShader(name, SShaderPermutation());
+    }
+    
+    CShader* CCacheResourceManager::LoadShader(const std::string& name, const SShaderPermutation& permutation)
+    {
+        VV_PROFILE_SCOPE("CCacheResourceManager::LoadShader");
         
-        if(shaderResources.find(name) != shaderResources.end())
+        string key = GetShaderPermutationName(name, permutation);
+        if(shaderResources.find(key) != shaderResources.end())
         {
 #ifdef DEBUG
-            std::cerr<<"CCacheResourceManager: [INFO] "<< name<<" loaded from cache.\n";
+            std::cerr<<"CCacheResourceManager: [INFO] "<< key<<" loaded from cache.\n";
 #endif
-            return shaderResources.find(name)->second;
+            return shaderResources.find(key)->second;
         }
         
+        //the offline validation already rejected this program, dont hand it to the driver
+        CFileBuffer invalid;
+        if(m_pShaderPack != NULL && m_pShaderPack->Open(name + VV_SHADER_INVALID_EXTENSION, invalid))
+        {
+            std::cerr<< "CCacheResourceManager: [ERROR] shader "<< name << " failed the offline validation:\n";
+            std::cerr.write(invalid.GetData(), invalid.GetSize());
+            std::cerr<< "\n";
+            return NULL;
+        }
         
+        
+        CTimer timer;
         CShader* ptr = new CShader();
         string vshader = name;
         string pshader = name;
         StringManipulator::AddCharArrayToString(vshader, ".vsh");
         StringManipulator::AddCharArrayToString(pshader, ".fsh");
         
-        if(!ptr->LoadShadersFromMemory(getContentFromPath(getPath(vshader)).c_str(),
-                                       getContentFromPath(getPath(pshader)).c_str()))
+        //shader sources are mapped and handed to the driver without any copy
+        CFileBuffer vsource, psource;
+        getContentFromPath(getPath(vshader), vsource);
+        getContentFromPath(getPath(pshader), psource);
+        
+        bool loaded;
+        if(permutation.GetKey() == 0)
         {
-            std::cerr<< "CCacheResourceManager: [ERROR] failed to load shader: "<< name << "...<\n";
+            loaded = ptr->LoadShadersFromMemory(vsource.GetData(), vsource.GetSize(),
+                                                psource.GetData(), psource.GetSize());
+        }
+        else
+        {
+            //the specialized sources differ from the files only by the injected #define block
+            string vpermutation, ppermutation;
+            BuildShaderPermutation(permutation, vsource.GetData(), vsource.GetSize(), vpermutation);
+            BuildShaderPermutation(permutation, psource.GetData(), psource.GetSize(), ppermutation);
+            loaded = ptr->LoadShadersFromMemory(vpermutation.c_str(), (int32)vpermutation.length(),
+                                                ppermutation.c_str(), (int32)ppermutation.length());
+        }
+        
+        if(!loaded)
+        {
+            std::cerr<< "CCacheResourceManager: [ERROR] failed to load shader: "<< key << "...<\n";
             delete ptr;
             return NULL;
         }
         
-        shaderResources[name] = ptr;
+        shaderResources[key] = ptr;
+        m_fLoadingTimeMs += timer.GetElapsedMs();
         
 #ifdef DEBUG
-        std::cerr<< "CCacheResourceManager: [SUCCESS] "<<name <<" shader loaded...\n";
+        std::cerr<< "CCacheResourceManager: [SUCCESS] "<<key <<" shader "<<(ptr->IsLoadedFromBinary() ? "loaded from program binary" : "compiled")<<" in "<<timer.GetElapsedMs()<<" ms...\n";
 #endif
         
         return ptr;
@@ -275,6 +529,7 @@ std::cerr<< "CCacheResourceManager: [ERROR] could not load texture cube map: "<<
     
     const aiScene* CCacheResourceManager::LoadMesh(const std::string& name)
     {
+        VV_PROFILE_SCOPE("CCacheResourceManager::LoadMesh");
         
         if(meshResources.find(name) != meshResources.end())
         {
@@ -284,13 +539,15 @@ std::cerr<< "CCacheResourceManager: [ERROR] could not load texture cube map: "<<
             return meshResources.find(name)->second;
         }
         
+        CTimer timer;
+        
         // todo: we must be able to customize this
         uint32 ppsteps =
         //xaiProcess_CalcTangentSpace      | // calculate tangents and bitangents if possible
         aiProcess_CalcTangentSpace         | //calculate tangents if possible
         aiProcess_JoinIdenticalVertices    | // join identical vertices/ optimize indexing
         aiProcess_ValidateDataStructure    | // perform a full validation of the loader's output
-        aiProcess_ImproveCacheLocality     | // improve the cache locality of the output vertices
+        //aiProcess_ImproveCacheLocality   | // done by the engine when the groups are allocated, check MeshOptimizer.h
         aiProcess_RemoveRedundantMaterials | // remove redundant materials
         aiProcess_FindDegenerates          | // remove degenerated polygons from the import
         aiProcess_FindInvalidData          | // detect invalid model data, such as invalid normal vectors
@@ -308,6 +565,9 @@ std::cerr<< "CCacheResourceManager: [ERROR] could not load texture cube map: "<<
         aiProcess_SortByPType              | // make 'clean' meshes which consist of a single typ of primitives
         aiProcess_OptimizeGraph            |
         0;
+        
+        //large meshes are only split when the device cant draw them with 32 bits indices
+        Importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT, IsIndexUintSupported() ? AI_SLM_DEFAULT_MAX_VERTICES : 0x10000);
         Importer.ReadFile(getPath(name).c_str(), ppsteps );
         
         aiScene* ptr = Importer.GetOrphanedScene();
@@ -318,9 +578,10 @@ std::cerr<< "CCacheResourceManager: [ERROR] could not load texture cube map: "<<
             return NULL;
         }
         meshResources[name] = ptr;
+        m_fLoadingTimeMs += timer.GetElapsedMs();
         
 #ifdef DEBUG
-        std::cerr<< "CCacheResourceManager: [SUCCESS] "<<name <<" mesh loaded...\n";
+        std::cerr<< "CCacheResourceManager: [SUCCESS] "<<name <<" mesh loaded in "<<timer.GetElapsedMs()<<" ms...\n";
 #endif
         
         return ptr;
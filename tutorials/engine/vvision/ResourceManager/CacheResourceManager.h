@@ -26,10 +26,21 @@
 #include "Texture.h"
 #include "TextureCubeMap.h"
 #include "Shader.h"
+#include "ShaderPermutation.h"
 #include "assimp.hpp"      // C++ importer interface
 #include "aiScene.h"       // Output data structure
 #include "aiPostProcess.h" // Post processing flags
 #include "types.h"
+#include "AssetPack.h"
+
+/** asset pack mounted automatically when present in the application bundle ( built with tools/vvpack.py)*/
+#define VV_DEFAULT_ASSET_PACK "resources.vvpack"
+
+/** shader pack mounted automatically when present in the application bundle ( validated and stripped shaders built with tools/vvshader.py)*/
+#define VV_DEFAULT_SHADER_PACK "shaders.vvpack"
+
+/** entry of the shader pack marking a program that failed the offline validation ( holds the validation log)*/
+#define VV_SHADER_INVALID_EXTENSION ".invalid"
 
 namespace vvision
 {
@@ -76,6 +87,11 @@ namespace vvision
     /** load shader, first it search the cache for any exisiting resource with the same name if not found it loads and cache it  , returns NULL if not found */
     CShader* LoadShader(const std::string& name);
     
+    /** load a permutation of the shader name.vsh/name.fsh, the enabled features are injected as #define in both sources.
+     * each permutation is cached separately, under the name returned by GetShaderPermutationName ( use it with DeleteResource)
+     */
+    CShader* LoadShader(const std::string& name, const SShaderPermutation& permutation);
+    
     /** load mesh, first it search the cache for any exisiting resource with the same name if not found it loads and cache it , returns NULL if not found */
     const aiScene* LoadMesh(const std::string& name);
     
@@ -88,18 +104,28 @@ namespace vvision
     /** empty cache, this will delete all cached resources that has been already loaded by the resource manager*/
     void Destroy();
     
+    /** mount an asset pack, all resources found in the pack are loaded from it instead of the loose files, returns false if the pack is not found or invalid*/
+    bool MountAssetPack(const std::string& name);
+    
+    /** true if an asset pack is mounted*/
+    inline bool HasAssetPack() {return m_pAssetPack != NULL;}
+    
+    /** mount a shader pack, its shaders replace the loose .vsh/.fsh files and programs marked invalid are never compiled, returns false if the pack is not found or invalid*/
+    bool MountShaderPack(const std::string& name);
+    
+    /** true if a shader pack is mounted*/
+    inline bool HasShaderPack() {return m_pShaderPack != NULL;}
+    
+    /** total time spent loading resources ( cache misses only) in milliseconds*/
+    inline float64 GetLoadingTime() {return m_fLoadingTimeMs;}
+    
 private:
     
     /** not allowed*/
-    ~CCacheResourceManager()
-    {
-        Destroy();
-    }
+    ~CCacheResourceManager();
     
     /** not allowed*/
-    CCacheResourceManager()
-    {
-    }
+    CCacheResourceManager();
     
     /** not allowed*/
     CCacheResourceManager(const CCacheResourceManager& r);
@@ -107,6 +133,12 @@ private:
     /** not allowed*/
     CCacheResourceManager& operator=(const CCacheResourceManager& r);
     
+    /** load the pack name and mount it in place of pack*/
+    static bool MountPack(const std::string& name, CAssetPack*& pack);
+    
+    /** unmount and delete pack*/
+    static void UnmountPack(CAssetPack*& pack);
+    
     /** assimp mesh importer*/
     Assimp::Importer Importer;
     
@@ -122,6 +154,15 @@ private:
     /** array of chaced shaders*/
     std::map<std::string, CShader*> shaderResources;
     
+    /** mounted asset pack ( NULL if resources are loaded from loose files)*/
+    CAssetPack* m_pAssetPack;
+    
+    /** mounted shader pack ( NULL if shaders are loaded from loose files)*/
+    CAssetPack* m_pShaderPack;
+    
+    /** time spent loading resources*/
+    float64 m_fLoadingTimeMs;
+    
 };
 }
 #endif
@@ -0,0 +1,166 @@
+/*
+ *  AssetPack.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "AssetPack.h"
+#include <zlib.h>
+
+namespace vvision
+{
+    CAssetPack::CAssetPack()
+    : m_pHeader(NULL), m_pEntries(NULL), m_pBuckets(NULL), m_pNames(NULL)
+    {
+    }
+
+    CAssetPack::~CAssetPack()
+    {
+        Release();
+    }
+
+    void CAssetPack::Release()
+    {
+        m_cFile.Close();
+        m_pHeader = NULL;
+        m_pEntries = NULL;
+        m_pBuckets = NULL;
+        m_pNames = NULL;
+    }
+
+    bool CAssetPack::Load(const char8* filepath)
+    {
+        Release();
+
+        //the pack is always read from disk ( never from another archive)
+        if(!m_cFile.Open(filepath))
+            return false;
+
+        const char8* base = m_cFile.GetData();
+        uint32 size = m_cFile.GetSize();
+
+        if(size < sizeof(SAssetPackHeader))
+        {
+            Release();
+            return false;
+        }
+
+        const SAssetPackHeader* header = (const SAssetPackHeader*)base;
+
+        //validate the table of content once, lookups dont check bounds again
+        bool valid =
+        header->magic == VV_ASSET_PACK_MAGIC &&
+        header->version == VV_ASSET_PACK_VERSION &&
+        header->bucketCount > header->entryCount &&
+        (header->bucketCount & (header->bucketCount - 1)) == 0 &&
+        header->entriesOffset + header->entryCount * sizeof(SAssetPackEntry) <= size &&
+        header->bucketsOffset + header->bucketCount * sizeof(uint32) <= size &&
+        header->namesOffset <= size;
+
+        if(!valid)
+        {
+            std::cerr<<"CAssetPack: [ERROR] invalid asset pack: "<<filepath<<"\n";
+            Release();
+            return false;
+        }
+
+        const SAssetPackEntry* entries = (const SAssetPackEntry*)(base + header->entriesOffset);
+        for(uint32 i = 0; i < header->entryCount; i++)
+        {
+            const SAssetPackEntry& e = entries[i];
+            if(header->namesOffset + e.nameOffset + e.nameLength > size || e.offset + e.storedSize > size)
+            {
+                std::cerr<<"CAssetPack: [ERROR] corrupted entry in asset pack: "<<filepath<<"\n";
+                Release();
+                return false;
+            }
+        }
+
+        m_pHeader = header;
+        m_pEntries = entries;
+        m_pBuckets = (const uint32*)(base + header->bucketsOffset);
+        m_pNames = base + header->namesOffset;
+
+#ifdef DEBUG
+        std::cerr<<"CAssetPack: [SUCCESS] "<<filepath<<" mounted ( "<<header->entryCount<<" files)...\n";
+#endif
+        return true;
+    }
+
+    uint32 CAssetPack::HashName(const char8* name, uint32 length)
+    {
+        uint32 hash = 2166136261u;
+        for(uint32 i = 0; i < length; i++)
+        {
+            hash ^= (uchar8)name[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    const SAssetPackEntry* CAssetPack::FindEntry(const string& filename) const
+    {
+        if(m_pHeader == NULL)
+            return NULL;
+
+        uint32 length = (uint32)filename.length();
+        uint32 hash = HashName(filename.c_str(), length);
+        uint32 mask = m_pHeader->bucketCount - 1;
+
+        for(uint32 probe = 0; probe <= mask; probe++)
+        {
+            uint32 index = m_pBuckets[(hash + probe) & mask];
+            if(index == kASSET_PACK_EMPTY_BUCKET || index >= m_pHeader->entryCount)
+                return NULL;
+
+            const SAssetPackEntry* e = &m_pEntries[index];
+            if(e->hash == hash && e->nameLength == length && memcmp(m_pNames + e->nameOffset, filename.c_str(), length) == 0)
+                return e;
+        }
+        return NULL;
+    }
+
+    bool CAssetPack::Contains(const string& filename) const
+    {
+        return FindEntry(filename) != NULL;
+    }
+
+    bool CAssetPack::Open(const string& filename, CFileBuffer& buffer)
+    {
+        const SAssetPackEntry* e = FindEntry(filename);
+        if(e == NULL)
+            return false;
+
+        const char8* payload = m_cFile.GetData() + e->offset;
+
+        switch (e->compression)
+        {
+            case kASSET_PACK_COMPRESSION_NONE:
+                buffer.Reference(payload, e->storedSize);
+                return true;
+
+            case kASSET_PACK_COMPRESSION_ZLIB:
+            {
+                //one extra byte so inflated text can be used as a c string
+                char8* data = (char8*)malloc(e->size + 1);
+                uLongf size = e->size;
+                if(data == NULL || uncompress((Bytef*)data, &size, (const Bytef*)payload, e->storedSize) != Z_OK || size != e->size)
+                {
+                    std::cerr<<"CAssetPack: [ERROR] failed to inflate: "<<filename<<"\n";
+                    free(data);
+                    return false;
+                }
+                data[e->size] = '\0';
+                buffer.Adopt(data, e->size);
+                return true;
+            }
+
+            default:
+                std::cerr<<"CAssetPack: [ERROR] unsupported compression for: "<<filename<<"\n";
+                return false;
+        }
+    }
+}
@@ -0,0 +1,153 @@
+/* AssetPack.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_ASSET_PACK_H
+#define VVISION_ASSET_PACK_H
+
+#include "FileSystem.h"
+
+namespace vvision
+{
+    /** asset pack file layout ( all values are little endian, written by tools/vvpack.py)
+     *
+     * [SAssetPackHeader]
+     * [SAssetPackEntry * entryCount]
+     * [uint32 * bucketCount]           hash table, entry index or kASSET_PACK_EMPTY_BUCKET, linear probing
+     * [names]                          file names, not null terminated
+     * [payloads]                       each payload starts on a kASSET_PACK_ALIGNMENT boundary
+     */
+
+    /** "VVPK"*/
+    #define VV_ASSET_PACK_MAGIC 0x4B505656
+
+    /** version of the layout described above*/
+    #define VV_ASSET_PACK_VERSION 1
+
+    enum
+    {
+        /** payload alignment in bytes*/
+        kASSET_PACK_ALIGNMENT = 16,
+
+        /** unused slot in the hash table*/
+        kASSET_PACK_EMPTY_BUCKET = 0xFFFFFFFF
+    };
+
+    /** how an entry is stored in the pack*/
+    enum ASSET_PACK_COMPRESSION
+    {
+        /** stored as is, can be referenced directly from the mapped pack*/
+        kASSET_PACK_COMPRESSION_NONE = 0,
+
+        /** zlib stream, inflated on open*/
+        kASSET_PACK_COMPRESSION_ZLIB = 1
+    };
+
+    /** pack header*/
+    struct SAssetPackHeader
+    {
+        uint32 magic;
+        uint32 version;
+        uint32 entryCount;
+        uint32 bucketCount;
+        uint32 entriesOffset;
+        uint32 bucketsOffset;
+        uint32 namesOffset;
+        uint32 reserved;
+    };
+
+    /** table of content entry*/
+    struct SAssetPackEntry
+    {
+        /** hash of the file name, check HashName*/
+        uint32 hash;
+
+        /** file name offset and length in the names block*/
+        uint32 nameOffset;
+        uint32 nameLength;
+
+        /** ASSET_PACK_COMPRESSION*/
+        uint32 compression;
+
+        /** payload offset from the beginning of the pack*/
+        uint32 offset;
+
+        /** size of the payload in the pack*/
+        uint32 storedSize;
+
+        /** size of the file once decompressed*/
+        uint32 size;
+
+        /** padding*/
+        uint32 reserved;
+    };
+
+    /** single file archive of resources, the pack is mapped once and uncompressed entries are returned without copy*/
+    class CAssetPack: public IFileArchive
+    {
+    public:
+
+        /** constructor*/
+        CAssetPack();
+
+        /** destructor*/
+        ~CAssetPack();
+
+        /** open pack at the given path ( obtained from getPath)
+         * @return true if the pack exists and its table of content is valid
+         */
+        bool Load(const char8* filepath);
+
+        /** release the pack*/
+        void Release();
+
+        /** @inherited from IFileArchive*/
+        virtual bool Contains(const string& filename) const;
+
+        /** @inherited from IFileArchive*/
+        virtual bool Open(const string& filename, CFileBuffer& buffer);
+
+        /** number of files in the pack*/
+        inline uint32 GetEntryCount() const {return m_pHeader ? m_pHeader->entryCount : 0;}
+
+        /** 32 bit FNV-1a hash used for the table of content*/
+        static uint32 HashName(const char8* name, uint32 length);
+
+    private:
+
+        /** not allowed*/
+        CAssetPack(const CAssetPack&);
+
+        /** not allowed*/
+        CAssetPack& operator=(const CAssetPack&);
+
+        /** find entry for name, NULL if not found*/
+        const SAssetPackEntry* FindEntry(const string& filename) const;
+
+        /** mapped pack*/
+        CFileBuffer m_cFile;
+
+        /** pointers into the mapped pack*/
+        const SAssetPackHeader* m_pHeader;
+        const SAssetPackEntry* m_pEntries;
+        const uint32* m_pBuckets;
+        const char8* m_pNames;
+    };
+}
+
+#endif
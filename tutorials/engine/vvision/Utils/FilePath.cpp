@@ -10,50 +10,107 @@
 #include "FilePath.h"
 #include <fstream>
 #include <iostream>
+#ifdef VVISION_PLATFORM_IOS
 #include <CoreFoundation/CoreFoundation.h>
 #import <QuartzCore/QuartzCore.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
 #include "Helpers.h"
 
 namespace vvision
 {
     
-    string getPath(const char8 *filename)
+#ifdef VVISION_PLATFORM_IOS
+    /** the bundle directory is resolved through CFBundle only once*/
+    static const string& getBundlePath()
     {
-        char8 *ptr;
-        std::string fnm(filename);
-        if(fnm.find("/") == fnm.npos)
+        static string bundlePath;
+        if(bundlePath.empty())
         {
             CFBundleRef mainBundle = CFBundleGetMainBundle();
             CFURLRef resourcesURL = CFBundleCopyBundleURL(mainBundle);
             CFStringRef str = CFURLCopyFileSystemPath(resourcesURL,
                                                       kCFURLPOSIXPathStyle);
             CFRelease(resourcesURL);
-            ptr = new char8[CFStringGetLength(str)+1];
-            CFStringGetCString(str,
-                               ptr,
-                               FILENAME_MAX,
-                               kCFStringEncodingASCII);
+            char8 ptr[FILENAME_MAX];
+            if(CFStringGetCString(str,
+                                  ptr,
+                                  FILENAME_MAX,
+                                  kCFStringEncodingASCII))
+                bundlePath = ptr;
             CFRelease(str);
+            bundlePath += std::string("/");
+        }
+        return bundlePath;
+    }
+    
+    string getPath(const char8 *filename)
+    {
+        std::string fnm(filename);
+        if(fnm.find("/") == fnm.npos)
+            return getBundlePath() + fnm;
+        
+        return fnm;
+    }
+#else
+    /** files of the resource directory by name, the bundle resources are flattened the same way*/
+    static std::map<string, string> s_mResources;
+    static bool s_bResourcesScanned = false;
+    
+    /** walk a directory recursively, the first file found with a given name wins*/
+    static void scanResourceDirectory(const string& directory)
+    {
+        DIR* dir = opendir(directory.c_str());
+        if(!dir)
+            return;
+        
+        struct dirent* entry;
+        while((entry = readdir(dir)) != NULL)
+        {
+            string name(entry->d_name);
+            if(name.empty() || name[0] == '.')
+                continue;
             
-            std::string res(ptr);
-            res += std::string("/");
-            res += std::string(filename);
+            string path = directory + "/" + name;
+            struct stat info;
+            if(stat(path.c_str(), &info) != 0)
+                continue;
             
-            delete[] ptr;
-            ptr = new char8[res.length()+1];
-            strcpy(ptr, res.c_str());
+            if(S_ISDIR(info.st_mode))
+                scanResourceDirectory(path);
+            else if(s_mResources.find(name) == s_mResources.end())
+                s_mResources[name] = path;
         }
+        closedir(dir);
+    }
+    
+    void setResourceDirectory(const string& directory)
+    {
+        s_mResources.clear();
+        scanResourceDirectory(directory);
+        s_bResourcesScanned = true;
+    }
+    
+    string getPath(const char8 *filename)
+    {
+        std::string fnm(filename);
+        if(fnm.find("/") != fnm.npos)
+            return fnm;
         
-        else
+        if(!s_bResourcesScanned)
         {
-            ptr = new char8[fnm.length()+1];
-            strcpy(ptr, fnm.c_str());
+            const char8* directory = getenv("VVISION_RESOURCE_DIR");
+            setResourceDirectory(directory ? directory : ".");
         }
         
-        string s(ptr);
-        delete[] ptr;
-        return s;
+        std::map<string, string>::const_iterator it = s_mResources.find(fnm);
+        if(it == s_mResources.end())
+            return fnm;
+        return it->second;
     }
+#endif
     
     string getPath(const string& filename)
     {
@@ -62,40 +119,47 @@ namespace vvision
     
     string getContentFromPath(const char8 *filepath)
     {
-        std::string buf("");
-        std::string line("");
-        std::ifstream in(filepath);
-        
-        if(in.fail())
+        CFileBuffer buffer;
+        if(!getContentFromPath(string(filepath), buffer))
             return "";
-        while(std::getline(in,line))
-        {
-            line += std::string("\n");
-            buf += line;
-        }
         
-        char8 *ptr = new char8[buf.length()];
-        strcpy(ptr, buf.c_str());
-        string s(ptr);
-        delete[] ptr;
-        return s;
-        //printf("%s\n", ptr);
-        return (const char8*)ptr;
+        return buffer.GetView().ToString();
     }
     string getContentFromPath(const string& filepath)
     {
         return getContentFromPath(filepath.c_str());
     }
     
-    char8* LoadImage(const char8* filename, int32 *width, int32 *height)
+    bool getContentFromPath(const string& filepath, CFileBuffer& buffer)
     {
-        const char8 *filepath = getPath(filename).c_str();
-        CGDataProviderRef texturefiledata = CGDataProviderCreateWithFilename(filepath);
-        
-        if(!texturefiledata)
-        {
-            return NULL;
-        }
+        return CFileSystem::Instance().ReadFile(filepath, buffer);
+    }
+    
+    CImageSource::CImageSource()
+    : m_pImage(NULL), m_iWidth(0), m_iHeight(0)
+    {
+    }
+    
+    CImageSource::~CImageSource()
+    {
+        Close();
+    }
+    
+    void CImageSource::Close()
+    {
+#ifdef VVISION_PLATFORM_IOS
+        //the image references the file content, release it first
+        if(m_pImage)
+            CGImageRelease((CGImageRef)m_pImage);
+#endif
+        m_pImage = NULL;
+        m_cFile.Close();
+        m_iWidth = m_iHeight = 0;
+    }
+    
+    bool CImageSource::Open(const string& filename)
+    {
+        Close();
         
         string extension;
         StringManipulator::GetExtensitonType(filename,extension);
@@ -103,53 +167,165 @@ namespace vvision
         bool Ispng = StringManipulator::IsEqual(extension,"png") == 0;
         bool IsJpg = StringManipulator::IsEqual(extension,"jpg") == 0;
         
+        if(!Ispng && !IsJpg)
+        {
+            cerr<<"LoadPng: unsupported image type:"<<extension<<"\n";
+            return false;
+        }
+        
+        //decode from memory, the file is mapped ( or read from a mounted archive) once and handed to core graphics without copy
+        if(!getContentFromPath(getPath(filename), m_cFile))
+        {
+            return false;
+        }
+        
+#ifdef VVISION_PLATFORM_IOS
+        CGDataProviderRef texturefiledata = CGDataProviderCreateWithData(NULL, m_cFile.GetData(), m_cFile.GetSize(), NULL);
+        
+        if(!texturefiledata)
+        {
+            Close();
+            return false;
+        }
+        
         CGImageRef textureImage;
         if(IsJpg)
             textureImage = CGImageCreateWithJPEGDataProvider(texturefiledata,
                                                              NULL,
                                                              true,
                                                              kCGRenderingIntentDefault);
-        else if (Ispng)
+        else
             textureImage = CGImageCreateWithPNGDataProvider(texturefiledata,
                                                             NULL,
                                                             true,
                                                             kCGRenderingIntentDefault);
-        else {
-            cerr<<"LoadPng: unsupported image type:"<<extension<<"\n";
-            return NULL;
-        }
         
         CGDataProviderRelease(texturefiledata);
-        *width = CGImageGetWidth(textureImage);
-        *height = CGImageGetHeight(textureImage);
-        void *imageData = malloc( *height * *width * 4 );
+        
+        if(!textureImage)
+        {
+            Close();
+            return false;
+        }
+        
+        m_pImage = (void*)textureImage;
+        m_iWidth = (int32)CGImageGetWidth(textureImage);
+        m_iHeight = (int32)CGImageGetHeight(textureImage);
+        return true;
+#else
+        //no image codec off device, only the header is read: the texture keeps its real size ( and upload cost)
+        const uchar8* data = (const uchar8*)m_cFile.GetData();
+        uint32 size = m_cFile.GetSize();
+        
+        if(Ispng)
+        {
+            //signature then IHDR: width and height big endian
+            if(size >= 24 && memcmp(data + 12, "IHDR", 4) == 0)
+            {
+                m_iWidth = (data[16] << 24) | (data[17] << 16) | (data[18] << 8) | data[19];
+                m_iHeight = (data[20] << 24) | (data[21] << 16) | (data[22] << 8) | data[23];
+            }
+        }
+        else
+        {
+            //walk the segments up to the start of frame
+            uint32 i = 2;
+            while(i + 9 < size && data[i] == 0xFF)
+            {
+                uchar8 marker = data[i + 1];
+                if(marker == 0xFF)
+                {
+                    i++;
+                    continue;
+                }
+                if(marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+                {
+                    m_iHeight = (data[i + 5] << 8) | data[i + 6];
+                    m_iWidth = (data[i + 7] << 8) | data[i + 8];
+                    break;
+                }
+                i += 2 + ((data[i + 2] << 8) | data[i + 3]);
+            }
+        }
+        
+        if(m_iWidth <= 0 || m_iHeight <= 0)
+        {
+            cerr<<"CImageSource: [ERROR] corrupted image:"<<filename<<"\n";
+            Close();
+            return false;
+        }
+        
+        m_pImage = (void*)m_cFile.GetData();
+        return true;
+#endif
+    }
+    
+    bool CImageSource::Decode(char8* destination) const
+    {
+        if(!m_pImage || !destination)
+            return false;
+        
+#ifdef VVISION_PLATFORM_IOS
         CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
-        CGContextRef textureContext = CGBitmapContextCreate( imageData,
-                                                            *width,
-                                                            *height,
-                                                            8, 4 * *width,
+        CGContextRef textureContext = CGBitmapContextCreate( destination,
+                                                            m_iWidth,
+                                                            m_iHeight,
+                                                            8, 4 * m_iWidth,
                                                             colorSpace,
                                                             kCGImageAlphaPremultipliedLast |
                                                             kCGBitmapByteOrder32Big );
+        CGColorSpaceRelease(colorSpace);
+        
+        if(!textureContext)
+            return false;
         
         CGContextDrawImage( textureContext,
                            CGRectMake( 0,
                                       0,
-                                      *width, 
-                                      *height ), 
-                           textureImage );
+                                      m_iWidth, 
+                                      m_iHeight ), 
+                           (CGImageRef)m_pImage );
         
         CFRelease(textureContext);
-        CGImageRelease(textureImage);
+        return true;
+#else
+        //opaque mid grey
+        uint32 pixels = m_iWidth * m_iHeight;
+        for(uint32 i = 0; i < pixels; ++i)
+        {
+            destination[i * 4 + 0] = destination[i * 4 + 1] = destination[i * 4 + 2] = (char8)0x80;
+            destination[i * 4 + 3] = (char8)0xFF;
+        }
+        return true;
+#endif
+    }
+    
+    char8* LoadImage(const char8* filename, int32 *width, int32 *height)
+    {
+        CImageSource source;
+        if(!source.Open(filename))
+        {
+            return NULL;
+        }
+        
+        *width = source.GetWidth();
+        *height = source.GetHeight();
+        char8 *imageData = (char8*)malloc( *height * *width * 4 );
+        
+        if(!source.Decode(imageData))
+        {
+            free(imageData);
+            return NULL;
+        }
         
-        return (char8*)imageData;
+        return imageData;
     }
     char8* LoadImage(const string& filename, int32 *width, int32 *height)
     {
         return LoadImage(filename.c_str(), width, height);
     }
     
-    char8* LoadImageFromTga(const char8* filename, int32 *width, int32 *height)
+    char8* LoadImageFromTga(const char8* /*filename*/, int32* /*width*/, int32* /*height*/)
     {
         return NULL;
     }
@@ -21,6 +21,7 @@
 #define FILE_PATH_INCLUDED
 
 #include "types.h"
+#include "FileSystem.h"
 
 namespace vvision
 {
@@ -32,13 +33,83 @@ namespace vvision
     string getPath(const char8 *filename);
     string getPath(const string& filename);
     
+#ifdef VVISION_PLATFORM_HEADLESS
+    /** set the directory that replaces the application bundle on the headless platform.
+     * the directory is walked recursively and its files are found by name, like the flattened resources of the bundle.
+     * if not set, the VVISION_RESOURCE_DIR environment variable ( or the working directory) is used.
+     */
+    void setResourceDirectory(const string& directory);
+#endif
+    
     /** Reads every byte from the file specified by a given path.
      * @param filepath the path obtained from getPath, check getPath
-     * @return the files content, u should delete the path from outside
+     * @return the files content
      */
     string getContentFromPath(const char8 *filepath);
     string getContentFromPath(const string& filepath);
     
+    /** Maps ( or reads at once) the file specified by a given path without any intermediate copy.
+     * @param filepath the path obtained from getPath, check getPath
+     * @param buffer receives the file content, the content stays valid as long as the buffer is open
+     * @return true if success
+     */
+    bool getContentFromPath(const string& filepath, CFileBuffer& buffer);
+    
+    /** an encoded png/jpg image, the header is parsed on Open so the size is known before decoding.
+     * this allows to decode several images into one allocation, and to decode them from different threads ( one source per thread).
+     */
+    class CImageSource
+    {
+    public:
+        
+        /** constructor*/
+        CImageSource();
+        
+        /** destructor*/
+        ~CImageSource();
+        
+        /** open the image, this function calls getPath implicitly
+         * @return false if the file is missing, not a png/jpg or corrupted
+         */
+        bool Open(const string& filename);
+        
+        /** decode the image as RGBA8
+         * @param destination GetWidth() * GetHeight() * 4 bytes
+         * @return true if success
+         */
+        bool Decode(char8* destination) const;
+        
+        /** release the encoded image and the file content*/
+        void Close();
+        
+        /** check if an image is opened*/
+        inline bool IsValid() const {return m_pImage != NULL;}
+        
+        /** get width*/
+        inline int32 GetWidth() const {return m_iWidth;}
+        
+        /** get height*/
+        inline int32 GetHeight() const {return m_iHeight;}
+        
+    private:
+        
+        /** not allowed*/
+        CImageSource(const CImageSource&);
+        
+        /** not allowed*/
+        CImageSource& operator=(const CImageSource&);
+        
+        /** encoded file content*/
+        CFileBuffer m_cFile;
+        
+        /** CGImageRef, kept opaque so core graphics is not exposed to every engine file ( the file content on the headless platform)*/
+        void* m_pImage;
+        
+        /** image size*/
+        int32 m_iWidth;
+        int32 m_iHeight;
+    };
+    
     /**
      * load a png/jpg image
      * @param filename the image file name, this function calls getPath implicitly ..
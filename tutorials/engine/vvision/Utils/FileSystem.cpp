@@ -0,0 +1,176 @@
+/*
+ *  FileSystem.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "FileSystem.h"
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+namespace vvision
+{
+    CFileBuffer::CFileBuffer()
+    : m_pData(NULL), m_uSize(0), m_eStorage(kSTORAGE_NONE)
+    {
+    }
+
+    CFileBuffer::~CFileBuffer()
+    {
+        Close();
+    }
+
+    bool CFileBuffer::Open(const char8* filepath, bool mapFile)
+    {
+        Close();
+
+        int fd = open(filepath, O_RDONLY);
+        if(fd < 0)
+            return false;
+
+        struct stat st;
+        if(fstat(fd, &st) != 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        m_uSize = (uint32)st.st_size;
+
+        //mmap of an empty file fails, empty files are read into a (null terminated) buffer
+        if(mapFile && m_uSize > 0)
+        {
+            void* ptr = mmap(NULL, m_uSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(ptr != MAP_FAILED)
+            {
+                close(fd);
+                m_pData = (char8*)ptr;
+                m_eStorage = kSTORAGE_MAPPED;
+                return true;
+            }
+        }
+
+        //read the whole file at once, one extra byte for the null terminator
+        m_pData = (char8*)malloc(m_uSize + 1);
+        uint32 total = 0;
+        while(m_pData != NULL && total < m_uSize)
+        {
+            ssize_t n = read(fd, m_pData + total, m_uSize - total);
+            if(n <= 0)
+                break;
+            total += (uint32)n;
+        }
+        close(fd);
+
+        if(m_pData == NULL || total != m_uSize)
+        {
+#ifdef DEBUG
+            cerr<<"CFileBuffer: [ERROR] failed to read: "<<filepath<<endl;
+#endif
+            free(m_pData);
+            m_pData = NULL;
+            m_uSize = 0;
+            return false;
+        }
+
+        m_pData[m_uSize] = '\0';
+        m_eStorage = kSTORAGE_HEAP;
+        return true;
+    }
+
+    void CFileBuffer::Adopt(char8* data, uint32 size)
+    {
+        Close();
+        m_pData = data;
+        m_uSize = size;
+        m_eStorage = kSTORAGE_HEAP;
+    }
+
+    void CFileBuffer::Reference(const char8* data, uint32 size)
+    {
+        Close();
+        m_pData = (char8*)data;
+        m_uSize = size;
+        m_eStorage = kSTORAGE_REFERENCE;
+    }
+
+    void CFileBuffer::Close()
+    {
+        switch (m_eStorage)
+        {
+            case kSTORAGE_MAPPED:
+                munmap(m_pData, m_uSize);
+                break;
+
+            case kSTORAGE_HEAP:
+                free(m_pData);
+                break;
+
+            default:
+                break;
+        }
+
+        m_pData = NULL;
+        m_uSize = 0;
+        m_eStorage = kSTORAGE_NONE;
+    }
+
+    void CFileSystem::MountArchive(IFileArchive* archive)
+    {
+        if(archive == NULL)
+            return;
+
+        if(std::find(m_vArchives.begin(), m_vArchives.end(), archive) == m_vArchives.end())
+            m_vArchives.push_back(archive);
+    }
+
+    void CFileSystem::UnmountArchive(IFileArchive* archive)
+    {
+        std::vector<IFileArchive*>::iterator it = std::find(m_vArchives.begin(), m_vArchives.end(), archive);
+        if(it != m_vArchives.end())
+            m_vArchives.erase(it);
+    }
+
+    bool CFileSystem::ReadFile(const string& filepath, CFileBuffer& buffer)
+    {
+        if(!m_vArchives.empty())
+        {
+            //resources are stored flat in archives ( like in the application bundle)
+            size_t found = filepath.find_last_of("/\\");
+            string filename = found == string::npos ? filepath : filepath.substr(found + 1);
+
+            for(std::vector<IFileArchive*>::reverse_iterator it = m_vArchives.rbegin(); it != m_vArchives.rend(); ++it)
+            {
+                if((*it)->Open(filename, buffer))
+                    return true;
+            }
+        }
+
+        return buffer.Open(filepath.c_str());
+    }
+
+    bool CFileSystem::IsArchived(const string& filepath) const
+    {
+        size_t found = filepath.find_last_of("/\\");
+        string filename = found == string::npos ? filepath : filepath.substr(found + 1);
+
+        for(std::vector<IFileArchive*>::const_iterator it = m_vArchives.begin(); it != m_vArchives.end(); ++it)
+        {
+            if((*it)->Contains(filename))
+                return true;
+        }
+        return false;
+    }
+
+    bool CFileSystem::Exists(const string& filepath) const
+    {
+        return IsArchived(filepath) || access(filepath.c_str(), R_OK) == 0;
+    }
+}
@@ -0,0 +1,207 @@
+/* FileSystem.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_FILE_SYSTEM_H
+#define VVISION_FILE_SYSTEM_H
+
+#include "types.h"
+#include "Singleton.h"
+
+namespace vvision
+{
+    /** read only view on a range of bytes, the view doesnt own the memory ( the bytes are not guaranteed to be null terminated, always use GetSize)*/
+    class CByteView
+    {
+    public:
+
+        /** empty view*/
+        CByteView() : m_pData(NULL), m_uSize(0) {}
+
+        /** view on size bytes starting at data*/
+        CByteView(const char8* data, uint32 size) : m_pData(data), m_uSize(size) {}
+
+        /** get data pointer*/
+        inline const char8* GetData() const {return m_pData;}
+
+        /** get size in bytes*/
+        inline uint32 GetSize() const {return m_uSize;}
+
+        /** true if the view doesnt reference any byte*/
+        inline bool IsEmpty() const {return m_uSize == 0;}
+
+        /** view on a part of this view*/
+        inline CByteView SubView(uint32 offset, uint32 size) const
+        {
+            if(offset > m_uSize)
+                return CByteView();
+            if(size > m_uSize - offset)
+                size = m_uSize - offset;
+            return CByteView(m_pData + offset, size);
+        }
+
+        /** copy the bytes into a string ( use only when a string is really needed)*/
+        inline string ToString() const {return m_uSize ? string(m_pData, m_uSize) : string();}
+
+    private:
+
+        /** first byte*/
+        const char8* m_pData;
+
+        /** number of bytes*/
+        uint32 m_uSize;
+    };
+
+    /** the content of a file, the file is either mapped read only in memory (mmap) or read at once in a single buffer.
+     * the content is valid until Close is called or the buffer is destroyed.
+     */
+    class CFileBuffer
+    {
+    public:
+
+        /** constructor*/
+        CFileBuffer();
+
+        /** destructor*/
+        ~CFileBuffer();
+
+        /** open the file at the given path ( the path obtained from getPath)
+         * @param filepath full path of the file
+         * @param mapFile if true the file is mapped in memory, else ( or if mapping fails) it is read into a single buffer
+         * @return true if success
+         */
+        bool Open(const char8* filepath, bool mapFile = true);
+
+        /** take ownership of a malloc'ed buffer ( used by archives that decompress their content)*/
+        void Adopt(char8* data, uint32 size);
+
+        /** reference memory owned by someone else ( used by archives that are already mapped), the memory must outlive the buffer*/
+        void Reference(const char8* data, uint32 size);
+
+        /** unmap/free the content*/
+        void Close();
+
+        /** check if the buffer holds some content*/
+        inline bool IsValid() const {return m_pData != NULL;}
+
+        /** true if the content is a memory mapping of the file*/
+        inline bool IsMapped() const {return m_eStorage == kSTORAGE_MAPPED;}
+
+        /** get data pointer*/
+        inline const char8* GetData() const {return m_pData;}
+
+        /** get size in bytes*/
+        inline uint32 GetSize() const {return m_uSize;}
+
+        /** get a view on the whole content*/
+        inline CByteView GetView() const {return CByteView(m_pData, m_uSize);}
+
+    private:
+
+        /** not allowed*/
+        CFileBuffer(const CFileBuffer&);
+
+        /** not allowed*/
+        CFileBuffer& operator=(const CFileBuffer&);
+
+        /** where the bytes come from*/
+        enum STORAGE
+        {
+            /** nothing loaded*/
+            kSTORAGE_NONE,
+
+            /** mmap'ed file*/
+            kSTORAGE_MAPPED,
+
+            /** malloc'ed buffer ( null terminated)*/
+            kSTORAGE_HEAP,
+
+            /** memory not owned by the buffer*/
+            kSTORAGE_REFERENCE
+        };
+
+        /** content*/
+        char8* m_pData;
+
+        /** content size*/
+        uint32 m_uSize;
+
+        /** storage type*/
+        STORAGE m_eStorage;
+    };
+
+    /** an archive of files ( packed resources) that can be mounted in the file system*/
+    class IFileArchive
+    {
+    public:
+
+        /** destructor*/
+        virtual ~IFileArchive() {}
+
+        /** check if the archive contains the given file name*/
+        virtual bool Contains(const string& filename) const = 0;
+
+        /** open file from archive
+         * @return true if the file exists in the archive and was loaded into buffer
+         */
+        virtual bool Open(const string& filename, CFileBuffer& buffer) = 0;
+    };
+
+    /** entry point for reading resource files, first it search mounted archives for the file name, if not found it falls back to the file on disk*/
+    CREATE_SINGLETON( CFileSystem )
+
+    public :
+
+    /** mount an archive, the file system doesnt take ownership of the archive. archives mounted last are searched first*/
+    void MountArchive(IFileArchive* archive);
+
+    /** unmount archive*/
+    void UnmountArchive(IFileArchive* archive);
+
+    /** load file content into buffer
+     * @param filepath a file name or a full path obtained from getPath. mounted archives are searched by file name
+     * @return true if success
+     */
+    bool ReadFile(const string& filepath, CFileBuffer& buffer);
+
+    /** check if a file with the given name is available in one of the mounted archives*/
+    bool IsArchived(const string& filepath) const;
+
+    /** check if a file can be read, either from a mounted archive or from disk ( the file is not opened)*/
+    bool Exists(const string& filepath) const;
+
+private:
+
+    /** not allowed*/
+    CFileSystem() {}
+
+    /** not allowed*/
+    ~CFileSystem() {}
+
+    /** not allowed*/
+    CFileSystem(const CFileSystem&);
+
+    /** not allowed*/
+    CFileSystem& operator=(const CFileSystem&);
+
+    /** mounted archives*/
+    std::vector<IFileArchive*> m_vArchives;
+};
+}
+
+#endif
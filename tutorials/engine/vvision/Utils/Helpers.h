@@ -68,6 +68,28 @@ namespace vvision
         {
             return str1.compare(str2);
         }
+        /** 32 bit FNV-1a hash of a null terminated string*/
+        static uint32 Hash(const char* str)
+        {
+            uint32 hash = 2166136261u;
+            while(*str)
+            {
+                hash ^= (unsigned char)*str++;
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+        /** 32 bit FNV-1a hash of length bytes, pass the previous hash as seed to hash several blocks*/
+        static uint32 Hash(const char* data, uint32 length, uint32 seed = 2166136261u)
+        {
+            uint32 hash = seed;
+            for(uint32 i = 0; i < length; i++)
+            {
+                hash ^= (unsigned char)data[i];
+                hash *= 16777619u;
+            }
+            return hash;
+        }
         static void AddCharArrayToString(string &str,const char* array)
         {
             int32 i=0;
@@ -0,0 +1,48 @@
+/* Parallel.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_PARALLEL_H
+#define VVISION_PARALLEL_H
+
+#include "types.h"
+
+#ifdef __APPLE__
+#include <dispatch/dispatch.h>
+#endif
+
+namespace vvision
+{
+    /** task called by ParallelFor, index goes from 0 to count - 1*/
+    typedef void (*ParallelTask)(void* context, size_t index);
+
+    /** run task for every index on the global concurrent queue and wait for all of them to finish.
+     * tasks must not touch any gl state, they run outside the thread that owns the context.
+     */
+    inline void ParallelFor(size_t count, void* context, ParallelTask task)
+    {
+#ifdef __APPLE__
+        dispatch_apply_f(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), context, task);
+#else
+        for(size_t i = 0; i < count; i++)
+            task(context, i);
+#endif
+    }
+}
+
+#endif
@@ -0,0 +1,42 @@
+/* Platform.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+#ifndef VVISION_PLATFORM_H
+#define VVISION_PLATFORM_H
+
+/** platform selection, the only place where the engine includes the gl headers.
+ *
+ * VVISION_PLATFORM_IOS       ( default) OpenGL ES 2.0 of the iOS sdk, resources are read from the application bundle
+ * VVISION_PLATFORM_HEADLESS  ( build with -DVVISION_HEADLESS) gl calls are served by the headless backend in Platform/HeadlessGL.cpp:
+ *                            no gpu is needed, calls are recorded, counted and validated, check CHeadlessDevice.
+ *                            resources are read from the directory given to setResourceDirectory ( FilePath.h)
+ */
+#ifdef VVISION_HEADLESS
+
+#define VVISION_PLATFORM_HEADLESS
+#include "HeadlessGL.h"
+
+#else
+
+#define VVISION_PLATFORM_IOS
+#include <OpenGLES/ES2/gl.h>
+#include <OpenGLES/ES2/glext.h>
+
+#endif
+
+#endif
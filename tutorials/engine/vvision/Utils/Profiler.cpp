@@ -0,0 +1,273 @@
+/*
+ *  Profiler.cpp
+ *  Virtual Vision
+ *
+ *  Created by Abdallah Dib Abdallah.dib@virtual-vison.net
+ *  Copyright 2011 Virtual Vision. All rights reserved.
+ *
+ */
+
+#include "Profiler.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+namespace vvision
+{
+    /** name of the event that spans a whole frame*/
+    static const char8* s_pFrameEventName = "Frame";
+    
+    /** thread id of the gpu in the chrome trace*/
+    #define VV_PROFILER_TRACE_GPU_TID 1000
+    
+    CProfileThreadBuffer::CProfileThreadBuffer(uint32 thread)
+    : m_uDepth(0), m_uHead(0), m_uTail(0), m_uThread(thread)
+    {
+    }
+    
+    void CProfileThreadBuffer::Push(const char8* name, float64 start, float64 end, uint32 depth)
+    {
+        SProfileEvent& event = m_vEvents[m_uHead % kPROFILER_THREAD_EVENTS];
+        event.name = name;
+        event.start = start;
+        event.end = end;
+        event.depth = depth;
+        event.thread = m_uThread;
+        
+        //the event must be visible before it is published
+        __sync_synchronize();
+        m_uHead = m_uHead + 1;
+    }
+    
+    uint32 CProfileThreadBuffer::Read(std::vector<SProfileEvent>& events)
+    {
+        uint32 head = m_uHead;
+        __sync_synchronize();
+        
+        //the ring wrapped since the last read, the oldest events are gone
+        uint32 lost = 0;
+        if(head - m_uTail > kPROFILER_THREAD_EVENTS)
+        {
+            lost = head - m_uTail - kPROFILER_THREAD_EVENTS;
+            m_uTail = head - kPROFILER_THREAD_EVENTS;
+        }
+        
+        for(; m_uTail != head; m_uTail++)
+            events.push_back(m_vEvents[m_uTail % kPROFILER_THREAD_EVENTS]);
+        
+        return lost;
+    }
+    
+    CProfileScope::CProfileScope(const char8* name)
+    : m_pName(name), m_pBuffer(NULL), m_uDepth(0), m_fStart(0)
+    {
+        CProfiler& profiler = CProfiler::Instance();
+        if(!profiler.IsEnabled())
+            return;
+        
+        m_pBuffer = profiler.GetThreadBuffer();
+        m_uDepth = m_pBuffer->Enter();
+        m_fStart = CTimer::Now();
+    }
+    
+    CProfileScope::~CProfileScope()
+    {
+        if(!m_pBuffer)
+            return;
+        
+        float64 end = CTimer::Now();
+        m_pBuffer->Leave();
+        m_pBuffer->Push(m_pName, m_fStart, end, m_uDepth);
+    }
+    
+    CProfiler::CProfiler()
+    : m_bEnabled(true), m_fFrameStart(0), m_uFrameThread(0), m_fFrameMs(0), m_uFrameLost(0), m_uCaptureFrames(0)
+    {
+        pthread_key_create(&m_cThreadKey, NULL);
+        pthread_mutex_init(&m_cThreadBuffersLock, NULL);
+        m_fFrameStart = CTimer::Now();
+    }
+    
+    CProfiler::~CProfiler()
+    {
+        for(uint32 i = 0; i < m_vThreadBuffers.size(); i++)
+            delete m_vThreadBuffers[i];
+        
+        pthread_key_delete(m_cThreadKey);
+        pthread_mutex_destroy(&m_cThreadBuffersLock);
+    }
+    
+    CProfileThreadBuffer* CProfiler::GetThreadBuffer()
+    {
+        CProfileThreadBuffer* buffer = (CProfileThreadBuffer*)pthread_getspecific(m_cThreadKey);
+        if(buffer)
+            return buffer;
+        
+        //first scope of this thread, the buffer outlives the thread and is released with the profiler
+        pthread_mutex_lock(&m_cThreadBuffersLock);
+        buffer = new CProfileThreadBuffer(m_vThreadBuffers.size());
+        m_vThreadBuffers.push_back(buffer);
+        pthread_mutex_unlock(&m_cThreadBuffersLock);
+        
+        pthread_setspecific(m_cThreadKey, buffer);
+        return buffer;
+    }
+    
+    void CProfiler::BeginFrame()
+    {
+        m_uFrameThread = GetThreadBuffer()->GetThread();
+        m_fFrameStart = CTimer::Now();
+    }
+    
+    void CProfiler::EndFrame()
+    {
+        float64 end = CTimer::Now();
+        m_fFrameMs = (end - m_fFrameStart) * 1000.0;
+        m_vFrameEvents.clear();
+        m_uFrameLost = 0;
+        
+        //workers are idle between frames, the lock only protects the buffer list
+        pthread_mutex_lock(&m_cThreadBuffersLock);
+        for(uint32 i = 0; i < m_vThreadBuffers.size(); i++)
+            m_uFrameLost += m_vThreadBuffers[i]->Read(m_vFrameEvents);
+        pthread_mutex_unlock(&m_cThreadBuffersLock);
+        
+        m_vFrameEvents.insert(m_vFrameEvents.end(), m_vGPUEvents.begin(), m_vGPUEvents.end());
+        m_vGPUEvents.clear();
+        
+        //the frame itself, root of the hierarchy of the frame thread
+        SProfileEvent frame = {s_pFrameEventName, m_fFrameStart, end, 0, m_uFrameThread};
+        m_vFrameEvents.push_back(frame);
+        
+        //totals per scope name
+        m_vFrameStats.clear();
+        std::map<const char8*, uint32> slots;
+        for(uint32 i = 0; i < m_vFrameEvents.size(); i++)
+        {
+            const SProfileEvent& event = m_vFrameEvents[i];
+            float64 ms = (event.end - event.start) * 1000.0;
+            
+            std::map<const char8*, uint32>::iterator it = slots.find(event.name);
+            if(it == slots.end())
+            {
+                SProfileScopeStats stats = {event.name, 0, 0, 0};
+                it = slots.insert(std::make_pair(event.name, (uint32)m_vFrameStats.size())).first;
+                m_vFrameStats.push_back(stats);
+            }
+            
+            SProfileScopeStats& stats = m_vFrameStats[it->second];
+            stats.calls++;
+            stats.totalMs += ms;
+            stats.maxMs = std::max(stats.maxMs, ms);
+        }
+        
+        if(m_uCaptureFrames > 0)
+        {
+            m_vCapture.insert(m_vCapture.end(), m_vFrameEvents.begin(), m_vFrameEvents.end());
+            m_uCaptureFrames--;
+        }
+    }
+    
+    const SProfileScopeStats* CProfiler::GetScopeStats(const char8* name) const
+    {
+        for(uint32 i = 0; i < m_vFrameStats.size(); i++)
+        {
+            if(m_vFrameStats[i].name == name || strcmp(m_vFrameStats[i].name, name) == 0)
+                return &m_vFrameStats[i];
+        }
+        return NULL;
+    }
+    
+    void CProfiler::StartCapture(uint32 frames)
+    {
+        m_vCapture.clear();
+        m_uCaptureFrames = std::min(frames, (uint32)kPROFILER_MAX_CAPTURE_FRAMES);
+    }
+    
+    void CProfiler::AddGPUEvent(const char8* name, float64 start, float64 end)
+    {
+        SProfileEvent event = {name, start, end, 0, kPROFILER_GPU_THREAD};
+        m_vGPUEvents.push_back(event);
+    }
+    
+    /** write a string as a json string*/
+    static void WriteJsonString(FILE* file, const char8* text)
+    {
+        fputc('"', file);
+        for(; *text; text++)
+        {
+            if(*text == '"' || *text == '\\')
+                fputc('\\', file);
+            fputc(*text, file);
+        }
+        fputc('"', file);
+    }
+    
+    bool CProfiler::SaveChromeTrace(const string& path)
+    {
+        if(m_vCapture.empty())
+        {
+            std::cerr<<"CProfiler: [ERROR] nothing captured, call StartCapture first\n";
+            return false;
+        }
+        
+        FILE* file = fopen(path.c_str(), "w");
+        if(!file)
+        {
+            std::cerr<<"CProfiler: [ERROR] cant write trace "<<path<<"\n";
+            return false;
+        }
+        
+        //timestamps in microseconds from the first event
+        float64 origin = m_vCapture[0].start;
+        for(uint32 i = 1; i < m_vCapture.size(); i++)
+            origin = std::min(origin, m_vCapture[i].start);
+        
+        fprintf(file, "{\"traceEvents\":[\n");
+        
+        //thread names
+        uint32 threads = m_vThreadBuffers.size();
+        for(uint32 i = 0; i < threads; i++)
+            fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}},\n", i, i == m_uFrameThread ? "frame thread" : "worker", i);
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"gpu\"}}", VV_PROFILER_TRACE_GPU_TID);
+        
+        for(uint32 i = 0; i < m_vCapture.size(); i++)
+        {
+            const SProfileEvent& event = m_vCapture[i];
+            int32 tid = event.thread == kPROFILER_GPU_THREAD ? VV_PROFILER_TRACE_GPU_TID : (int32)event.thread;
+            
+            fprintf(file, ",\n{\"name\":");
+            WriteJsonString(file, event.name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", tid, (event.start - origin) * 1e6, (event.end - event.start) * 1e6);
+        }
+        
+        fprintf(file, "\n]}\n");
+        fclose(file);
+        
+        m_vCapture.clear();
+        m_uCaptureFrames = 0;
+        return true;
+    }
+
+#ifdef DEBUG
+    /** sort scopes by total time*/
+    static bool SortByTotal(const SProfileScopeStats& a, const SProfileScopeStats& b)
+    {
+        return a.totalMs > b.totalMs;
+    }
+    
+    void CProfiler::PrintReport() const
+    {
+        std::vector<SProfileScopeStats> sorted(m_vFrameStats);
+        std::sort(sorted.begin(), sorted.end(), SortByTotal);
+        
+        std::cerr<<"CProfiler: [INFO] frame "<<m_fFrameMs<<" ms";
+        if(m_uFrameLost)
+            std::cerr<<" ( "<<m_uFrameLost<<" events lost)";
+        std::cerr<<"\n";
+        
+        for(uint32 i = 0; i < sorted.size(); i++)
+            std::cerr<<"    "<<sorted[i].name<<": "<<sorted[i].calls<<" calls, "<<sorted[i].totalMs<<" ms ( max "<<sorted[i].maxMs<<" ms)\n";
+    }
+#endif
+}
@@ -0,0 +1,247 @@
+/* Profiler.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_PROFILER_H
+#define VVISION_PROFILER_H
+
+#include "types.h"
+#include "Singleton.h"
+#include "Timer.h"
+#include <pthread.h>
+
+/** scopes are compiled in debug builds, or in any build with -DVVISION_PROFILE*/
+#if defined(DEBUG) || defined(VVISION_PROFILE)
+#define VVISION_PROFILER_ENABLED
+#endif
+
+#define VV_PROFILE_CONCAT_(a, b) a##b
+#define VV_PROFILE_CONCAT(a, b) VV_PROFILE_CONCAT_(a, b)
+
+#ifdef VVISION_PROFILER_ENABLED
+/** time the enclosing block on the cpu, name must be a string literal ( it is stored by address)*/
+#define VV_PROFILE_SCOPE(name) vvision::CProfileScope VV_PROFILE_CONCAT(vvProfileScope, __LINE__)(name)
+#else
+#define VV_PROFILE_SCOPE(name)
+#endif
+
+namespace vvision
+{
+    enum
+    {
+        /** events kept per thread between two EndFrame, older ones are overwritten*/
+        kPROFILER_THREAD_EVENTS = 4096,
+        
+        /** frames kept by a capture*/
+        kPROFILER_MAX_CAPTURE_FRAMES = 600
+    };
+    
+    /** a timed scope*/
+    struct SProfileEvent
+    {
+        /** scope name ( string literal)*/
+        const char8* name;
+        
+        /** start and end in seconds ( CTimer::Now)*/
+        float64 start;
+        float64 end;
+        
+        /** nesting depth in its thread*/
+        uint32 depth;
+        
+        /** thread index ( registration order), kPROFILER_GPU_THREAD for the gpu*/
+        uint32 thread;
+    };
+    
+    /** thread index of gpu events*/
+    static const uint32 kPROFILER_GPU_THREAD = 0xFFFFFFFF;
+    
+    /** per frame totals of a scope name*/
+    struct SProfileScopeStats
+    {
+        const char8* name;
+        uint32 calls;
+        float64 totalMs;
+        float64 maxMs;
+    };
+    
+    /** events of one thread. only the owner thread writes: an event is stored then published by moving the head,
+     * the reader ( EndFrame, on the frame thread while the workers are idle) consumes up to the head. no lock is taken.
+     */
+    class CProfileThreadBuffer
+    {
+    public:
+        
+        /** constructor*/
+        CProfileThreadBuffer(uint32 thread);
+        
+        /** store an event ( owner thread)*/
+        void Push(const char8* name, float64 start, float64 end, uint32 depth);
+        
+        /** copy the events published since the last read, returns the number of events lost because the ring wrapped*/
+        uint32 Read(std::vector<SProfileEvent>& events);
+        
+        /** enter a scope, returns its depth ( owner thread)*/
+        inline uint32 Enter() {return m_uDepth++;}
+        
+        /** leave a scope ( owner thread)*/
+        inline void Leave() {m_uDepth--;}
+        
+        /** thread index*/
+        inline uint32 GetThread() const {return m_uThread;}
+        
+    private:
+        
+        /** nesting depth of the owner thread*/
+        uint32 m_uDepth;
+        
+        /** ring*/
+        SProfileEvent m_vEvents[kPROFILER_THREAD_EVENTS];
+        
+        /** events published ( written by the owner)*/
+        volatile uint32 m_uHead;
+        
+        /** events read ( read by the reader)*/
+        uint32 m_uTail;
+        
+        /** thread index*/
+        uint32 m_uThread;
+    };
+    
+    /** times its lifetime, check VV_PROFILE_SCOPE*/
+    class CProfileScope
+    {
+    public:
+        
+        /** start the scope*/
+        CProfileScope(const char8* name);
+        
+        /** end the scope*/
+        ~CProfileScope();
+        
+    private:
+        
+        /** not allowed*/
+        CProfileScope(const CProfileScope&);
+        
+        /** not allowed*/
+        CProfileScope& operator=(const CProfileScope&);
+        
+        /** scope name*/
+        const char8* m_pName;
+        
+        /** buffer of the thread, NULL when the profiler is disabled*/
+        CProfileThreadBuffer* m_pBuffer;
+        
+        /** depth and start time*/
+        uint32 m_uDepth;
+        float64 m_fStart;
+    };
+    
+    /** hierarchical frame profiler.
+     * cpu scopes ( VV_PROFILE_SCOPE) are written to a lock free ring per thread, EndFrame gathers them in the frame.
+     * gpu scopes come from CGPUProfiler. the totals of the last frame are available at any time, a capture keeps every event
+     * of several frames and is exported as a chrome trace ( chrome://tracing, perfetto).
+     */
+    CREATE_SINGLETON( CProfiler )
+    
+    public :
+    
+    /** enable/disable the recording at runtime ( enabled by default when the profiler is compiled)*/
+    inline void SetEnabled(bool enabled) {m_bEnabled = enabled;}
+    inline bool IsEnabled() const {return m_bEnabled;}
+    
+    /** start a frame ( on the thread that runs the frame)*/
+    void BeginFrame();
+    
+    /** end the frame: gather the events of every thread, compute the totals and add the frame to the capture*/
+    void EndFrame();
+    
+    /** events of the last ended frame*/
+    inline const std::vector<SProfileEvent>& GetFrameEvents() const {return m_vFrameEvents;}
+    
+    /** cpu time of the last ended frame in ms*/
+    inline float64 GetFrameMs() const {return m_fFrameMs;}
+    
+    /** totals of a scope during the last ended frame, NULL if the scope did not run*/
+    const SProfileScopeStats* GetScopeStats(const char8* name) const;
+    
+    /** keep the events of the next frames ( up to kPROFILER_MAX_CAPTURE_FRAMES)*/
+    void StartCapture(uint32 frames);
+    
+    /** check if a capture is running*/
+    inline bool IsCapturing() const {return m_uCaptureFrames > 0;}
+    
+    /** write the captured events as chrome trace json and clear the capture
+     * @return true if success
+     */
+    bool SaveChromeTrace(const string& path);
+    
+    /** add an event measured by the gpu ( CGPUProfiler), start is on the cpu clock*/
+    void AddGPUEvent(const char8* name, float64 start, float64 end);
+    
+    /** buffer of the calling thread, created on first use*/
+    CProfileThreadBuffer* GetThreadBuffer();
+    
+#ifdef DEBUG
+    /** print the totals of the last frame*/
+    void PrintReport() const;
+#endif
+    
+private:
+    
+    /** not allowed*/
+    CProfiler();
+    
+    /** not allowed*/
+    ~CProfiler();
+    
+    /** not allowed*/
+    CProfiler(const CProfiler&);
+    
+    /** not allowed*/
+    CProfiler& operator=(const CProfiler&);
+    
+    /** thread local buffer*/
+    pthread_key_t m_cThreadKey;
+    
+    /** every thread buffer ( the mutex is only taken when a thread profiles for the first time)*/
+    std::vector<CProfileThreadBuffer*> m_vThreadBuffers;
+    pthread_mutex_t m_cThreadBuffersLock;
+    
+    /** current frame*/
+    bool m_bEnabled;
+    float64 m_fFrameStart;
+    uint32 m_uFrameThread;
+    
+    /** last ended frame*/
+    std::vector<SProfileEvent> m_vFrameEvents;
+    std::vector<SProfileScopeStats> m_vFrameStats;
+    float64 m_fFrameMs;
+    uint32 m_uFrameLost;
+    
+    /** gpu events of the frame*/
+    std::vector<SProfileEvent> m_vGPUEvents;
+    
+    /** capture*/
+    std::vector<SProfileEvent> m_vCapture;
+    uint32 m_uCaptureFrames;
+};
+}
+
+#endif
@@ -0,0 +1,57 @@
+/* Timer.h
+ *
+ * Virtual Vision Engine . Copyright (C) 2012 Abdallah DIB.
+ * All rights reserved. Email: Abdallah.dib@virtual-vison.net
+ * Web: <http://www.virutal-vision.net/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*/
+
+#ifndef VVISION_TIMER_H
+#define VVISION_TIMER_H
+
+#include "types.h"
+#include <sys/time.h>
+
+namespace vvision
+{
+    /** simple wall clock timer, used to measure loading times*/
+    class CTimer
+    {
+    public:
+
+        /** constructor, starts the timer*/
+        CTimer() {Reset();}
+
+        /** restart the timer*/
+        inline void Reset() {m_fStart = Now();}
+
+        /** elapsed time since the last reset in milliseconds*/
+        inline float64 GetElapsedMs() const {return (Now() - m_fStart) * 1000.0;}
+
+        /** current time in seconds*/
+        static inline float64 Now()
+        {
+            timeval tv;
+            gettimeofday(&tv, NULL);
+            return (float64)tv.tv_sec + (float64)tv.tv_usec * 1e-6;
+        }
+
+    private:
+
+        /** start time in seconds*/
+        float64 m_fStart;
+    };
+}
+
+#endif
@@ -11,6 +11,7 @@
 
 #include "Singleton.h"
 #include "FilePath.h"
+#include "FileSystem.h"
 
 
 #endif
@@ -21,9 +21,8 @@
 #define VVISION_base_h
 
 #include "vmath.h"
-#import <stdlib.h>
-#import <OpenGLES/ES2/gl.h>
-#import <OpenGLES/ES2/glext.h>
+#include <stdlib.h>
+#include "Platform.h"
 #include <vector>
 #include <string>
 #include <iostream>
@@ -58,6 +57,19 @@ namespace vvision
         kPRIMITIVE_TYPE_POINTS = GL_POINTS
     };
     
+    /** element index types*/
+    enum INDEX_TYPE
+    {
+        /** 8 bits indices*/
+        kINDEX_TYPE_UNSIGNED_BYTE = GL_UNSIGNED_BYTE,
+        
+        /** 16 bits indices*/
+        kINDEX_TYPE_UNSIGNED_SHORT = GL_UNSIGNED_SHORT,
+        
+        /** 32 bits indices ( OES_element_index_uint)*/
+        kINDEX_TYPE_UNSIGNED_INT = GL_UNSIGNED_INT
+    };
+
 #ifdef ZERO____
     /** determines which attribs will be mapped to the current shadrer ( the attribs used for shadow mapping generator are less than attribs required for rendering)*/
     enum SHADER_VERTEX_ATTRIBUTE
@@ -85,6 +97,15 @@ namespace vvision
         /** unsigned byte */
         kDATA_TYPE_UNSIGNED_BYTE = GL_UNSIGNED_BYTE,
         
+        /** short*/
+        kDATA_TYPE_SHORT = GL_SHORT,
+        
+        /** unsigned short*/
+        kDATA_TYPE_UNSIGNED_SHORT = GL_UNSIGNED_SHORT,
+        
+        /** float 16 bits ( OES_vertex_half_float)*/
+        kDATA_TYPE_HALF_FLOAT = GL_HALF_FLOAT_OES,
+        
         /** float 32 bits*/
         kDATA_TYPE_FLOAT = GL_FLOAT
     };
@@ -108,6 +129,9 @@ namespace vvision
         /** dynamic*/
         kGL_BUFFER_USAGE_HINT_DYNAMIC = GL_DYNAMIC_DRAW,
         
+        /** written every frame and drawn a few times ( check CStreamBuffer)*/
+        kGL_BUFFER_USAGE_HINT_STREAM = GL_STREAM_DRAW,
+    
     };
     
     
@@ -138,8 +162,11 @@ namespace vvision
         /** bone weight attrib*/
         ATTRIB_BONES_WEIGHTS,
         
+        /** model matrix of an instance, a mat4 attribute takes 4 locations ( check CInstancedRenderer)*/
+        ATTRIB_INSTANCE_MODEL,
+        
         /** attrib number*/
-        NUM_ATTRIBUTES
+        NUM_ATTRIBUTES = ATTRIB_INSTANCE_MODEL + 4
     };
     
     /* 8 bit unsigned variable.*/
@@ -172,6 +199,9 @@ namespace vvision
     /** 64 bit floating point variable.*/
     typedef double				float64;
     
+    /** 64 bit unsigned variable.*/
+    typedef unsigned long long	uint64;
+
 #define SAFE_DELETE(ptr) \
 if(ptr != NULL) \
 {delete ptr; ptr = NULL;}
@@ -64,6 +64,8 @@
 @property GLint framebufferWidth;
 @property GLint framebufferHeight;
 - (void)setFramebuffer;
+/** the framebuffer bound by setFramebuffer ( the msaa framebuffer when multisampling is enabled)*/
+- (GLuint)framebuffer;
 - (BOOL)presentFramebuffer;
 
 @end
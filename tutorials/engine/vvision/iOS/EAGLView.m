@@ -223,6 +223,15 @@
     }
 }
 
+- (GLuint)framebuffer
+{
+#ifdef VVISION_ENABLE_MSAA
+    return msaaFramebuffer;
+#else
+    return defaultFramebuffer;
+#endif
+}
+
 - (BOOL)presentFramebuffer
 {
     BOOL success = FALSE;
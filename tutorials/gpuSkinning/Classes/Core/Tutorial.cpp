@@ -31,8 +31,8 @@ void Tutorial::Cleanup()
 }
 bool Tutorial::LoadShaders()
 {
-    //load gpu skinning shader
-    m_pShaderAnimatedMesh = crm.LoadShader("GpuSkinnig");
+    //load gpu skinning shader, specialized for the 60 bones palette of the animated model
+    m_pShaderAnimatedMesh = crm.LoadShader("GpuSkinnig", SShaderPermutation(kSHADER_FEATURE_SKINNING, 60));
     return (m_pShaderAnimatedMesh != NULL);
 }
 
@@ -63,8 +63,9 @@ bool Tutorial::Deploy()
     
     glClearColor(0.2, 0.2, 0.2, 1.f);
     //enable depth test and back face culling
-    glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
+    CRenderStateCache::Instance().Enable(GL_DEPTH_TEST);
+    CRenderStateCache::Instance().Enable(GL_CULL_FACE);
+    CRenderStateCache::Instance().CullFace(GL_BACK);
 
     return true;
 }
@@ -46,7 +46,7 @@ void CAnimatedMeshEntity::RenderNode(aiNode* piNode)
                 matRef[i].Transpose();
             
             //send the bones transformations at time t to he shader to pefrom the skinning
-            m_pShader->SetUniformMatrix4x4fv("skinningMatrix", matRef.size(), GL_FALSE, &matRef[0].a1);
+            m_pShader->Set(U_SKINNING_MATRIX, &matRef[0].a1, matRef.size());
             
             //our importer presever the same grp order
             CMeshGroup* grp = meshBuffer->GroupAtIndex(i);
@@ -66,7 +66,7 @@ void CAnimatedMeshEntity::RenderNode(aiNode* piNode)
             grp->MapToGPU(0);
             
             //render grp
-            glDrawElements(grp->GetDrawingMode(), grp->GetIndices().size(), GL_UNSIGNED_SHORT, 0);
+            glDrawElements(grp->GetDrawingMode(), grp->GetIndexCount(), grp->GetIndexType(), grp->GetIndexOffset());
             
         }
     }
@@ -78,12 +78,14 @@ void CAnimatedMeshEntity::RenderNode(aiNode* piNode)
 }
 void CAnimatedMeshEntity::Render(CShader* shader,  const mat4f &view, const mat4f &projection)
 {
+    VV_PROFILE_SCOPE("CAnimatedMeshEntity::Render");
+    
     assert ( shader != NULL  && m_pMesh != NULL);
     m_pShader = shader;
     m_mProjViewModelMatrix = projection * view * m_mTransformationMatrix;
     
     if(m_pShader->matprojviewmodel != -1 )
-        glUniformMatrix4fv(m_pShader->matprojviewmodel, 1, GL_FALSE, &m_mProjViewModelMatrix[0]);
+        m_pShader->SetUniformMatrix4x4fv("matProjViewModel", 1, GL_FALSE, &m_mProjViewModelMatrix[0], m_pShader->matprojviewmodel);
     
     //recursive
     RenderNode(m_pAnimator->mScene->mRootNode);
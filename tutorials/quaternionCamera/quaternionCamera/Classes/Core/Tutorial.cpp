@@ -92,9 +92,9 @@ bool Tutorial::Deploy()
     
     glClearColor(0.8, 0.8, 0.8, 1.f);
     //enable depth test an back face culling
-    glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    CRenderStateCache::Instance().Enable(GL_DEPTH_TEST);
+	CRenderStateCache::Instance().Enable(GL_CULL_FACE);
+    CRenderStateCache::Instance().CullFace(GL_BACK);
     
     return true;
 }
@@ -25,17 +25,19 @@ void CMeshEntity::Update(float32 dt)
 }
 void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projection)
 {
+    VV_PROFILE_SCOPE("CMeshEntity::Render");
+    
     assert ( shader != NULL );
     
     if(shader->matprojviewmodel != -1 )
     {
         mat4f mat = projection * view * m_mTransformationMatrix;
-        glUniformMatrix4fv(shader->matprojviewmodel, 1, GL_FALSE, &mat[0]);
+        shader->SetUniformMatrix4x4fv("matProjViewModel", 1, GL_FALSE, &mat[0], shader->matprojviewmodel);
     }
     
     if(shader->matmodel != -1 )
     {
-        glUniformMatrix4fv(shader->matmodel, 1, GL_FALSE, &m_mTransformationMatrix[0]);
+        shader->SetUniformMatrix4x4fv("matModel", 1, GL_FALSE, &m_mTransformationMatrix[0], shader->matmodel);
     }
     
     CMeshBuffer* buffer = m_pMesh->GetMeshBuffer();
@@ -58,9 +60,9 @@ void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projec
             if(material->detailTexture !=0)
             {
                 material->detailTexture->ActivateAndBind(GL_TEXTURE2);
-                glUniform1i(shader->textureDetail, 2);
-                glUniform1i(shader->useDetailTexture, 1);
-                glUniform1f(shader->detailFactor, material->detailFactor);
+                shader->SetUniform1i("textureDetail", 2, shader->textureDetail);
+                shader->SetUniform1i("useDetailTexture", 1, shader->useDetailTexture);
+                shader->SetUniform1f("detailFactor", material->detailFactor, shader->detailFactor);
             }
         }
         
@@ -68,7 +70,7 @@ void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projec
         grp->MapToGPU(0);
         
         //draw command
-        glDrawElements(grp->GetDrawingMode(), grp->GetIndices().size(), GL_UNSIGNED_SHORT, 0);
+        glDrawElements(grp->GetDrawingMode(), grp->GetIndexCount(), grp->GetIndexType(), grp->GetIndexOffset());
     }
 
 }
\ No newline at end of file
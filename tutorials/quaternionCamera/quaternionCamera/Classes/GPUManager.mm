@@ -9,6 +9,8 @@
 
 #import "GPUManager.h"
 #import "CacheResourceManager.h"
+#import "RenderStateCache.h"
+#import "GPUProfiler.h"
 @implementation GPUManager
 
 @synthesize  context = _context;
@@ -78,7 +80,11 @@ CCacheResourceManager& crm_ = CCacheResourceManager::Instance();
 {
     // Tear down context.
     if ([EAGLContext currentContext] == self.context)
-        [EAGLContext setCurrentContext:nil];	
+    {
+        //the timer queries belong to the context
+        CGPUProfiler::Instance().Release();
+        [EAGLContext setCurrentContext:nil];
+    }
 	
 }
 
@@ -88,13 +94,18 @@ CCacheResourceManager& crm_ = CCacheResourceManager::Instance();
 	{
         [EAGLContext setCurrentContext:self.context];
         [_glview setFramebuffer];
+        //the view binds its framebuffer and viewport natively, resync the state cache with them
+        CRenderStateCache::Instance().BeginFrame([_glview framebuffer], _glview.framebufferWidth, _glview.framebufferHeight);
         
         _tutorial->SetWindowSize(_glview.framebufferWidth,  _glview.framebufferHeight);
     }
     
-    //draw frame
+    //draw frame, the gpu timings of previous frames are read back first
+    CProfiler::Instance().BeginFrame();
+    CGPUProfiler::Instance().BeginFrame();
     _tutorial->Frame();
     [_glview presentFramebuffer];
+    CProfiler::Instance().EndFrame();
     
     
 }
@@ -102,9 +102,9 @@ bool Tutorial::Deploy()
     
     glClearColor(0.2, 0.2, 0.2, 1.f);
     //enable depth test an back face culling
-    glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    CRenderStateCache::Instance().Enable(GL_DEPTH_TEST);
+	CRenderStateCache::Instance().Enable(GL_CULL_FACE);
+    CRenderStateCache::Instance().CullFace(GL_BACK);
     
     return true;
 }
@@ -170,11 +170,11 @@ void Tutorial::RenderFromPosition(const mat4f& view, const mat4f& projection)
     
     //draw all objects of the scene
     m_pShaderSkybox->Begin();
-    glDepthMask(GL_FALSE);//this can be added as a material property so a scene manager can set th GL state accordingly
-    glDisable(GL_CULL_FACE); // this is a material property (CMaterial has an attribute named twoSided) 
+    CRenderStateCache::Instance().DepthMask(GL_FALSE);//this can be added as a material property so a scene manager can set th GL state accordingly
+    CRenderStateCache::Instance().Disable(GL_CULL_FACE); // this is a material property (CMaterial has an attribute named twoSided) 
     m_pSkybox->Render(m_pShaderSkybox, view, projection);
-    glDepthMask(GL_TRUE);
-    glEnable(GL_CULL_FACE);
+    CRenderStateCache::Instance().DepthMask(GL_TRUE);
+    CRenderStateCache::Instance().Enable(GL_CULL_FACE);
     m_pShaderSkybox->End();
 
 }
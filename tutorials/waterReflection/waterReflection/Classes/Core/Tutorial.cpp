@@ -8,14 +8,18 @@
  */
 
 #include "Tutorial.h"
+#include "Parallel.h"
 
 #define REPLACE_DIFFUSE_TEXTURE
 
+//draw a village of instanced houses around the house ( main pass only)
+//#define INSTANCED_HOUSES
+
 //cache resource manager
 CCacheResourceManager& crm = CCacheResourceManager::Instance();
 
 Tutorial::Tutorial()
-: m_pCamera(NULL), m_pMesh(NULL), m_pWater(NULL), m_pSkybox(NULL), m_pHouse(NULL)
+: m_pCamera(NULL), m_pMesh(NULL), m_pWater(NULL), m_pSkybox(NULL), m_pHouse(NULL), m_pRenderQueue(NULL), m_pReflectionQueue(NULL), m_pCuller(NULL), m_pReflectionCuller(NULL), m_pStaticBatcher(NULL), m_pInstancedHouses(NULL), m_pShaderInstanced(NULL), m_uFrameCount(0)
 {
 }
 
@@ -33,14 +37,25 @@ void Tutorial::Cleanup()
     SAFE_DELETE(m_pWater);
     SAFE_DELETE(m_pSkybox);
     SAFE_DELETE(m_pHouse);
+    SAFE_DELETE(m_pRenderQueue);
+    SAFE_DELETE(m_pReflectionQueue);
+    SAFE_DELETE(m_pCuller);
+    SAFE_DELETE(m_pReflectionCuller);
+    SAFE_DELETE(m_pStaticBatcher);
+    SAFE_DELETE(m_pInstancedHouses);
 }
 bool Tutorial::LoadShaders()
 {
     //load shader
-    m_pShaderMesh = crm.LoadShader("Terrain");
+    m_pShaderMesh = crm.LoadShader("Terrain", SShaderPermutation(kSHADER_FEATURE_DETAIL));
     if(!m_pShaderMesh)
         return false;
     
+    //same shader for the reflection pass, the clip plane permutation discards the scene under the water
+    m_pShaderMeshReflection = crm.LoadShader("Terrain", SShaderPermutation(kSHADER_FEATURE_DETAIL | kSHADER_FEATURE_CLIP_PLANE));
+    if(!m_pShaderMeshReflection)
+        return false;
+    
     //sky vox shader
     m_pShaderSkybox = crm.LoadShader("SkyBox");
     if(!m_pShaderSkybox)
@@ -50,6 +65,18 @@ bool Tutorial::LoadShaders()
     m_pShaderWaterSurface = crm.LoadShader("WaterSurface");
     if(!m_pShaderWaterSurface)
         return false;
+
+#ifdef INSTANCED_HOUSES
+    //instanced arrays or uniform arrays, whichever the device supports
+    m_pShaderInstanced = crm.LoadShader("Terrain", SShaderPermutation(kSHADER_FEATURE_DETAIL | CInstancedRenderer::GetShaderFeature()));
+    if(!m_pShaderInstanced)
+        return false;
+#endif
+
+#ifdef DEBUG
+    //time spent compiling shaders or loading their binaries
+    CProgramBinaryCache::Instance().PrintReport();
+#endif
     
     return true;
 }
@@ -58,7 +85,7 @@ bool Tutorial::LoadEntities()
 {
     //static mesh
     IMesh* assimpMesh = IMesh::LoadMeshFromFile(("terrain2.ms3d"));
-
+    
     if(assimpMesh == NULL)
         return false;
     
@@ -88,6 +115,71 @@ bool Tutorial::LoadEntities()
     m_pHouse = new CMeshEntity(bumpedAssimpMesh);
     m_pHouse->GetMeshBuffer().MaterialAtindex(1)->detailTexture = crm.LoadTexture2D("detail.jpg");//add detail to house
     m_pHouse->GetMeshBuffer().MaterialAtindex(1)->detailFactor = 6.f;
+    mat4f &modelHouse = m_pHouse->GetTransfromationMatrix();
+    mat4f s;
+    s.identity();
+    //scale the model ( this can be done within a modeling package ) scaling can affect light calculation
+    s[0] *= 0.03f;
+    s[5] *= 0.03f;
+    s[10] *= 0.03f;
+    modelHouse = s;
+    //position the model on the terrain
+    modelHouse[12] = 117.f;
+    modelHouse[13] = -113.4579f;
+    modelHouse[14] = -28.0493;
+    
+    //render queues of the passes, recorded in parallel
+    m_pRenderQueue = new CRenderQueue();
+    m_pReflectionQueue = new CRenderQueue();
+    
+    //the terrain and the house never move, they are merged by material in world space
+    m_pStaticBatcher = new CStaticBatcher();
+    m_pMesh->SetStatic(m_pStaticBatcher->AddMesh(&m_pMesh->GetMeshBuffer(), m_pMesh->GetTransfromationMatrix()));
+    m_pHouse->SetStatic(m_pStaticBatcher->AddMesh(&m_pHouse->GetMeshBuffer(), m_pHouse->GetTransfromationMatrix()));
+    if(!m_pStaticBatcher->Build())
+        return false;
+    
+    //the batches and the meshes that could not be merged are culled per meshlet in both passes
+    m_pCuller = new CMeshletCuller();
+    m_pReflectionCuller = new CMeshletCuller();
+    if(!m_pCuller->AddMesh(m_pStaticBatcher->GetMeshBuffer()) || !m_pReflectionCuller->AddMesh(m_pStaticBatcher->GetMeshBuffer()))
+        return false;
+    
+    CMeshEntity* meshes[2] = {m_pMesh, m_pHouse};
+    for(uint32 e = 0; e < 2; ++e)
+    {
+        if(!meshes[e]->IsStatic() && (!m_pCuller->AddMesh(&meshes[e]->GetMeshBuffer()) || !m_pReflectionCuller->AddMesh(&meshes[e]->GetMeshBuffer())))
+            return false;
+    }
+
+#ifdef INSTANCED_HOUSES
+    //100 x 100 houses sharing the mesh of the house, a handful of draw calls
+    m_pInstancedHouses = new CInstancedRenderer();
+    if(!m_pInstancedHouses->Create(&m_pHouse->GetMeshBuffer()))
+        return false;
+    
+    for(int32 y = 0; y < 100; ++y)
+    {
+        for(int32 x = 0; x < 100; ++x)
+        {
+            mat4f instance = modelHouse;
+            instance[12] += (x - 50) * 12.f;
+            instance[13] += (y - 50) * 12.f;
+            m_pInstancedHouses->AddInstance(instance);
+        }
+    }
+#endif
+    
+    //the batcher and the instanced renderer copied what they needed, the meshes are drawn from the gpu only.
+    //the batches keep their world space positions for picking and collision
+    for(uint32 e = 0; e < 2; ++e)
+        meshes[e]->GetMeshBuffer().SetResidency(kMESH_RESIDENCY_DISCARD);
+    m_pStaticBatcher->GetMeshBuffer()->SetResidency(kMESH_RESIDENCY_POSITIONS);
+
+#ifdef DEBUG
+    const SMeshResidencyStats& residency = GetMeshResidencyTotals();
+    std::cerr<<"Tutorial: [INFO] mesh host memory, "<<residency.releasedBytes<<" bytes released, "<<residency.keptBytes<<" bytes kept\n";
+#endif
     
     //water
     CTexture* normal = crm.LoadTexture2D("normal.jpg");
@@ -109,7 +201,7 @@ bool Tutorial::LoadEntities()
     m_pCamera = new CCameraEntity(vec3f(-5.72926, -170.729, -15.5698), vec3f(-4.99851, -170.047, -15.6047), 40.f);
     
     return true;
-    
+
 }
 
 bool Tutorial::Deploy()
@@ -122,10 +214,10 @@ bool Tutorial::Deploy()
     
     glClearColor(0.2, 0.2, 0.2, 1.f);
     //enable depth test and face culling
-    glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
+    CRenderStateCache::Instance().Enable(GL_DEPTH_TEST);
+	CRenderStateCache::Instance().Enable(GL_CULL_FACE);
     //setup alpha blending function
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    CRenderStateCache::Instance().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
     return true;
 }
@@ -135,7 +227,7 @@ void Tutorial::UpdateControls(const CControlPad& pad)
     
     //m_pCamera based quaternion
     const Quatf& q = m_pCamera->GetQuaternionRepresentation();//this will not call the copy construtor
-
+    
     if(pad.keyUp)
     {
         Quatf rot = Quatf::fromAxisRot(vec3i(1, 0, 0), -step);
@@ -170,7 +262,7 @@ void Tutorial::UpdateControls(const CControlPad& pad)
         vec3f right = m_pCamera->GetForwardVector();
         pos += right * 2.f;
         m_pCamera->SetPosition(pos);
-        
+    
     }
     
     else if(pad.keyMoveDown)
@@ -180,64 +272,130 @@ void Tutorial::UpdateControls(const CControlPad& pad)
         pos -= right * 2.f;
         m_pCamera->SetPosition(pos);
     }
-    
+
 
 }
-void Tutorial::RenderFromPosition(const mat4f& view, const mat4f& projection)
+void Tutorial::RenderFromPosition(const mat4f& view, const mat4f& projection, CRenderQueue* queue)
 {
     //draw all objects of the scene
     m_pShaderSkybox->Begin();
-    glDepthMask(GL_FALSE);
-    glDisable(GL_CULL_FACE);
+    CRenderStateCache::Instance().DepthMask(GL_FALSE);
+    CRenderStateCache::Instance().Disable(GL_CULL_FACE);
     m_pSkybox->Render(m_pShaderSkybox, view, projection);
-    glDepthMask(GL_TRUE);
-    glEnable(GL_CULL_FACE);
+    CRenderStateCache::Instance().DepthMask(GL_TRUE);
+    CRenderStateCache::Instance().Enable(GL_CULL_FACE);
     m_pShaderSkybox->End();
     
-    m_pShaderMesh->Begin();
-    m_pMesh->Render(m_pShaderMesh, view, projection);
-    mat4f &modelHouse = m_pHouse->GetTransfromationMatrix();
-    mat4f s;
-    s.identity();
-    //scale the model ( this can be done within a modeling package ) scaling can affect light calculation
-    s[0] *= 0.03f;
-    s[5] *= 0.03f;
-    s[10] *= 0.03f;
-    modelHouse = s;
-    //position the model on the terrain
-    modelHouse[12] = 117.f;
-    modelHouse[13] = -113.4579f;
-    modelHouse[14] = -28.0493;
-    m_pHouse->Render(m_pShaderMesh, view, projection);
-    m_pShaderMesh->End();
-    
-    
+    //replay the recorded meshes
+    queue->Execute();
 }
+
+/** meshes of a pass to record*/
+struct SPassRecording
+{
+    CRenderQueue* queue;
+    CMeshletCuller* culler;
+    CStaticBatcher* batcher;
+    CShader* shader;
+    const mat4f* view;
+    const mat4f* projection;
+    CMeshEntity* entities[2];
+};
+
+/** record a pass, runs on a worker thread ( no gl call)*/
+static void RecordPass(void* context, size_t index)
+{
+    VV_PROFILE_SCOPE("RecordPass");
+    SPassRecording& pass = ((SPassRecording*)context)[index];
+    pass.queue->Begin(*pass.view, *pass.projection);
+    pass.culler->Begin();
+    pass.batcher->Submit(*pass.queue, pass.shader, pass.culler);
+    for(uint32 e = 0; e < 2; ++e)
+    {
+        if(!pass.entities[e]->IsStatic())
+            pass.entities[e]->Submit(*pass.queue, pass.shader, pass.culler);
+    }
+    pass.queue->Record();
+}
+
 void Tutorial::Frame()
 {
     //clear depth/color buffer bit
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-    //Set Main shader
-    m_pShaderMesh->Begin();
+    //levels of detail seen from the camera, the reflection pass draws the same ones
+    GLint viewport[4];
+    CRenderStateCache::Instance().GetViewport(viewport);
+    m_pStaticBatcher->SelectLods(m_pCamera->GetViewMatrix(), m_pCamera->GetProjectionMatrix(), (float32)viewport[3]);
+    if(!m_pMesh->IsStatic())
+        m_pMesh->SelectLods(m_pCamera->GetViewMatrix(), m_pCamera->GetProjectionMatrix(), (float32)viewport[3]);
+    if(!m_pHouse->IsStatic())
+        m_pHouse->SelectLods(m_pCamera->GetViewMatrix(), m_pCamera->GetProjectionMatrix(), (float32)viewport[3]);
+    
+    //0- record the meshes of both passes in parallel, each pass in its own queue
+    m_pWater->UpdateReflectionCamera(m_pCamera);
+    SPassRecording passes[2] =
+    {
+        {m_pReflectionQueue, m_pReflectionCuller, m_pStaticBatcher, m_pShaderMeshReflection, &m_pWater->GetViewMatrix(), &m_pCamera->GetProjectionMatrix(), {m_pMesh, m_pHouse}},
+        {m_pRenderQueue, m_pCuller, m_pStaticBatcher, m_pShaderMesh, &m_pCamera->GetViewMatrix(), &m_pCamera->GetProjectionMatrix(), {m_pMesh, m_pHouse}}
+    };
+    ParallelFor(2, passes, RecordPass);
+    
+    //indices of the meshlets that survived the culling of each pass
+    m_pReflectionCuller->Upload();
+    m_pCuller->Upload();
     
     //1- FIRST PASS: from mirrored camera position ( this will capture the reflected scene)
-    //cull front faces
-    glCullFace(GL_FRONT);
-    //this will enable the framebuffer object for offscreen rendering where the mirrored scene in rendered to the attached texture
-    m_pWater->PrepareReflectionPass(m_pShaderMesh, m_pCamera);
-    RenderFromPosition(m_pWater->GetViewMatrix(), m_pCamera->GetProjectionMatrix());
-    //this will end the reflection pass and switch back to default frame buffer
-    m_pWater->EndReflectionPass(m_pShaderMesh);
-    glCullFace(GL_BACK);
+    {
+        VV_PROFILE_GPU_SCOPE("Reflection pass");
+        
+        //Set reflection pass shader
+        m_pShaderMeshReflection->Begin();
+        
+        //cull front faces
+        CRenderStateCache::Instance().CullFace(GL_FRONT);
+        //this will enable the framebuffer object for offscreen rendering where the mirrored scene in rendered to the attached texture
+        m_pWater->PrepareReflectionPass(m_pShaderMeshReflection);
+        RenderFromPosition(m_pWater->GetViewMatrix(), m_pCamera->GetProjectionMatrix(), m_pReflectionQueue);
+        //this will end the reflection pass and switch back to default frame buffer
+        m_pWater->EndReflectionPass(m_pShaderMeshReflection);
+        CRenderStateCache::Instance().CullFace(GL_BACK);
+    }
     
     //2- SECOND PASS: draw the scene from camera position
-    RenderFromPosition(m_pCamera->GetViewMatrix(), m_pCamera->GetProjectionMatrix());
+    {
+        VV_PROFILE_GPU_SCOPE("Main pass");
+        RenderFromPosition(m_pCamera->GetViewMatrix(), m_pCamera->GetProjectionMatrix(), m_pRenderQueue);
+
+#ifdef INSTANCED_HOUSES
+        m_pShaderInstanced->Begin();
+        m_pInstancedHouses->Render(m_pShaderInstanced, m_pCamera->GetViewMatrix(), m_pCamera->GetProjectionMatrix());
+        m_pShaderInstanced->End();
+#endif
+    }
     
     //3- Draw water surface using the mirrored texture rendered in the first pass
-    m_pShaderWaterSurface->Begin();
-    m_pWater->Render(m_pShaderWaterSurface, m_pCamera->GetViewMatrix(), m_pCamera->GetProjectionMatrix());
-    m_pShaderWaterSurface->End();
+    {
+        VV_PROFILE_GPU_SCOPE("Water surface");
+        m_pShaderWaterSurface->Begin();
+        m_pWater->Render(m_pShaderWaterSurface, m_pCamera->GetViewMatrix(), m_pCamera->GetProjectionMatrix());
+        m_pShaderWaterSurface->End();
+    }
+
+#ifdef DEBUG
+    //draws and state changes of the main pass, mesh memory, timings of the previous frame
+    if((++m_uFrameCount % 300) == 0)
+    {
+        m_pRenderQueue->PrintReport();
+        m_pCuller->PrintReport();
+        m_pStaticBatcher->PrintReport();
+#ifdef INSTANCED_HOUSES
+        m_pInstancedHouses->PrintReport();
+#endif
+        CBufferArena::Instance().PrintReport();
+        CProfiler::Instance().PrintReport();
+    }
+#endif
 
 }
 void Tutorial::SetWindowSize(float32 width, float32 height)
@@ -45,7 +45,7 @@ struct CControlPad
     
     /** key move backward is pressed*/
     bool keyMoveDown;
-    
+
 };
 
 class Tutorial
@@ -82,11 +82,12 @@ private:
     /** load entities*/
     bool LoadEntities();
     
-    /**render the scene from different position*/
-    void RenderFromPosition(const mat4f& view, const mat4f& projection);
+    /**render the scene from different position, the meshes of the pass are already recorded in queue*/
+    void RenderFromPosition(const mat4f& view, const mat4f& projection, CRenderQueue* queue);
     
     /** shaders*/
     CShader *m_pShaderMesh;
+    CShader *m_pShaderMeshReflection;
     CShader* m_pShaderWaterSurface;
     CShader* m_pShaderSkybox;
     
@@ -104,6 +105,24 @@ private:
     
     /** skybox entity*/
     CSkyBoxEntity* m_pSkybox;
+    
+    /** sort and record the meshes of the main and the reflection pass*/
+    CRenderQueue* m_pRenderQueue;
+    CRenderQueue* m_pReflectionQueue;
+    
+    /** meshlet culling of the main and the reflection pass*/
+    CMeshletCuller* m_pCuller;
+    CMeshletCuller* m_pReflectionCuller;
+    
+    /** the static meshes merged by material*/
+    CStaticBatcher* m_pStaticBatcher;
+    
+    /** copies of the house drawn with instancing, and their shader*/
+    CInstancedRenderer* m_pInstancedHouses;
+    CShader* m_pShaderInstanced;
+    
+    /** frames drawn ( render queue stats are printed periodically in debug)*/
+    uint32 m_uFrameCount;
 
 };
 
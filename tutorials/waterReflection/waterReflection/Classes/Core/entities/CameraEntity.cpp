@@ -68,10 +68,10 @@ void CCameraEntity::SetProjectionMatrix(const mat4f& projection)
 void CCameraEntity::Render(CShader* shader)
 {
     if(shader->matview != -1 )
-        glUniformMatrix4fv(shader->matview, 1, GL_FALSE, &GetViewMatrix()[0]);
+        shader->SetUniformMatrix4x4fv("matView", 1, GL_FALSE, &GetViewMatrix()[0], shader->matview);
     
     if(shader->matproj != -1)
-       glUniformMatrix4fv(shader->matview, 1, GL_FALSE, &m_mProjection[0]);
+       shader->SetUniformMatrix4x4fv("matProj", 1, GL_FALSE, &m_mProjection[0], shader->matproj);
 }
 vec3f CCameraEntity::GetPosition()
 {
@@ -10,7 +10,7 @@
 #include "MeshEntity.h"
 
 CMeshEntity::CMeshEntity(IMesh* mesh)
-: m_pMesh(mesh)
+: m_pMesh(mesh), m_bStatic(false)
 {
     //m_pMesh = mesh->GetMesh();
 }
@@ -23,59 +23,38 @@ CMeshEntity::~CMeshEntity()
 void CMeshEntity::Update(float32 dt)
 {
 }
-void CMeshEntity::Render(CShader* shader, const mat4f &view, const mat4f &projection)
+void CMeshEntity::SelectLods(const mat4f& view, const mat4f& projection, float32 viewport_height)
 {
-    assert ( shader != NULL );
+    CMeshBuffer* buffer = m_pMesh->GetMeshBuffer();
+    m_vLods.resize(buffer->GroupsCount(), 0);
     
-    if(shader->matprojviewmodel != -1 )
+    mat4f modelView = view * m_mTransformationMatrix;
+    for(uint32 g = 0; g < buffer->GroupsCount(); ++g)
     {
-        mat4f mat = projection * view * m_mTransformationMatrix;
-        glUniformMatrix4fv(shader->matprojviewmodel, 1, GL_FALSE, &mat[0]);
+        CMeshGroup* grp = buffer->GroupAtIndex(g);
+        float32 size = grp->GetBoundingBox().GetProjectedSize(modelView, projection, viewport_height);
+        m_vLods[g] = grp->SelectLod(size, m_vLods[g]);
     }
+}
+
+void CMeshEntity::Submit(CRenderQueue& queue, CShader* shader, CMeshletCuller* culler)
+{
+    VV_PROFILE_SCOPE("CMeshEntity::Submit");
     
-    if(shader->matmodel != -1 )
-    {
-        glUniformMatrix4fv(shader->matmodel, 1, GL_FALSE, &m_mTransformationMatrix[0]);
-    }
+    assert ( shader != NULL );
     
+    //the queue binds materials, vaos and transforms once the draws of every entity are sorted
     CMeshBuffer* buffer = m_pMesh->GetMeshBuffer();
-    
-    //this part can be merged in a renderer class
-    //go through all groups in the buffer and draw them one by one
     for(uint32 g = 0; g < buffer->GroupsCount(); ++g)
 	{
 		CMeshGroup* grp = buffer->GroupAtIndex(g);
-        //get the material for current material
-        CMaterial* material = buffer->MaterialForGroup(grp);
+        uint32 lod = g < m_vLods.size() ? m_vLods[g] : 0;
         
-        if(material != NULL )
-        {
-            if( material->diffuseTexture != NULL && shader->texture0 != -1)
-            {
-                //Enable(TEXTURING_2D);
-                material->diffuseTexture->ActivateAndBind(GL_TEXTURE0);
-                glUniform1i(shader->texture0, 0);
-            }
-            
-            /*
-             //no bump in this tutorial
-            if(shader->textureBump != -1 && material->bumpTexture != NULL)
-            {
-                material->bumpTexture->ActivateAndBind(GL_TEXTURE1);
-                shader->SetUniform1i("textureBump", 1, shader->textureBump);
-            }*/
-            
-            if(material->detailTexture !=0 && material->detailTexture != NULL)
-            {
-                material->detailTexture->ActivateAndBind(GL_TEXTURE2);
-                glUniform1i(shader->textureDetail, 2);
-                glUniform1f(shader->detailFactor, material->detailFactor);
-            }
-                
-        }
-        
-        grp->MapToGPU(0);
-        glDrawElements(grp->GetDrawingMode(), grp->GetIndices().size(), GL_UNSIGNED_SHORT, 0);
+        //the simplified levels are drawn whole
+        SMeshletDraw draw;
+        if(culler != NULL && lod == 0 && culler->Cull(grp, m_mTransformationMatrix, queue.GetView(), queue.GetProjection(), draw))
+            queue.Submit(shader, buffer->MaterialForGroup(grp), draw.vao, grp->GetDrawingMode(), draw.indexType, draw.firstIndex, draw.indexCount, m_mTransformationMatrix, grp->GetBoundingBox());
+        else
+            queue.Submit(shader, buffer->MaterialForGroup(grp), grp, m_mTransformationMatrix, lod);
     }
-
-}
\ No newline at end of file
+}
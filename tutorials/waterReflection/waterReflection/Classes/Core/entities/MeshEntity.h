@@ -35,8 +35,15 @@ public:
     /** update mesh*/
     virtual void Update(float32 dt);
     
-    /** render*/
-    virtual void Render(CShader* shader, const mat4f &view, const mat4f &projection);
+    /** pick the level of detail of each mesh group for the size of the entity on screen
+     * @param viewport_height in pixels
+     */
+    void SelectLods(const mat4f& view, const mat4f& projection, float32 viewport_height);
+    
+    /** submit a draw packet per mesh group to the render queue, at the selected level of detail.
+     * the full meshes are culled per meshlet when a culler is given
+     */
+    virtual void Submit(CRenderQueue& queue, CShader* shader, CMeshletCuller* culler = NULL);
     
     /**reference to transformation matrix*/
     mat4f& GetTransfromationMatrix() {return m_mTransformationMatrix;}
@@ -44,10 +51,20 @@ public:
     /** reference to the mesh buffer*/
     CMeshBuffer& GetMeshBuffer() {return *m_pMesh->GetMeshBuffer();}
     
+    /** a static entity never moves, it is drawn by a CStaticBatcher instead of Submit*/
+    inline void SetStatic(bool is_static) {m_bStatic = is_static;}
+    inline bool IsStatic() const {return m_bStatic;}
+
 private:
     IMesh* m_pMesh;
     
     mat4f m_mTransformationMatrix;
+    
+    /** level of detail of each group*/
+    std::vector<uint32> m_vLods;
+    
+    /** merged in a static batch*/
+    bool m_bStatic;
 };
 
 #endif
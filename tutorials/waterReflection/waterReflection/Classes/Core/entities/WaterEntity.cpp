@@ -33,7 +33,7 @@ void CWaterEntity::CreatePlane(const vec2f& dimension)
     
     CMeshGroup* group = new CMeshGroup();
     std::vector<CGpuVertex> &vert = group->GetVertices();
-    std::vector<ushort16> &ind = group->GetIndices();
+    std::vector<uint32> &ind = group->GetIndices();
     group->SetMaterialIndex(0);
     
     
@@ -73,13 +73,13 @@ void CWaterEntity::CreatePlane(const vec2f& dimension)
         box.Add(vert[i].pos);
     
     group->SetBoundingBox(box);
-    ind.push_back((ushort16)0);
-    ind.push_back((ushort16)2);
-    ind.push_back((ushort16)1);
+    ind.push_back(0);
+    ind.push_back(2);
+    ind.push_back(1);
     
-    ind.push_back((ushort16)0);
-    ind.push_back((ushort16)1);
-    ind.push_back((ushort16)3);
+    ind.push_back(0);
+    ind.push_back(1);
+    ind.push_back(3);
     
     group->AllocateOnGpuMemory(kGL_BUFFER_USAGE_HINT_STATIC);
     m_pMeshBuffer->AddGroup(group);
@@ -89,18 +89,20 @@ void CWaterEntity::Update(float32 dt)
 {
 }
 
-void CWaterEntity::PrepareReflectionPass(CShader* shader, CCameraEntity* camera)
+void CWaterEntity::PrepareReflectionPass(CShader* shader)
 {
     //enable fbo for offscreen rendering
     m_pOffscreenRT->Enable();
     
-    //todo: replace the discard from the pixel shader by a clipping plane.
-    shader->SetUniform1i("enableDiscardScene",1) ;
+    //the shader is the clip plane permutation, it discards everything under the water
     shader->SetUniform1f("waterHeight", m_fWaterHeight);
     
     //clear context
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
-    
+}
+
+void CWaterEntity::UpdateReflectionCamera(CCameraEntity* camera)
+{
     //get the camera position,target
     vec3f camPos = camera->GetPosition();
     vec3f camTarget = camPos + camera->GetForwardVector();
@@ -127,8 +129,6 @@ void CWaterEntity::PrepareReflectionPass(CShader* shader, CCameraEntity* camera)
 
 void CWaterEntity::EndReflectionPass(CShader* shader)
 {
-    shader->SetUniform1i("enableDiscardScene",0) ;
-    
     //disable offscreen rendering context
     m_pOffscreenRT->Disable();
 
@@ -148,7 +148,7 @@ void CWaterEntity::Render(CShader* shader, const mat4f &view, const mat4f &proje
     if(shader->matprojviewmodel != -1 )
     {
         mat4f mat = projection * view * m_mTransformationMatrix;
-        glUniformMatrix4fv(shader->matprojviewmodel, 1, GL_FALSE, &mat[0]);
+        shader->SetUniformMatrix4x4fv("matProjViewModel", 1, GL_FALSE, &mat[0], shader->matprojviewmodel);
     }
     
     //send necessary params to the shader ( time, normal texure)
@@ -165,7 +165,7 @@ void CWaterEntity::Render(CShader* shader, const mat4f &view, const mat4f &proje
     //the water surface is composed of a simple quad. map the group and render it  
     CMeshGroup* grp = m_pMeshBuffer->GroupAtIndex(0);
     grp->MapToGPU(0);
-    glDrawElements(grp->GetDrawingMode(), grp->GetIndices().size(), GL_UNSIGNED_SHORT, 0);
+    glDrawElements(grp->GetDrawingMode(), grp->GetIndexCount(), grp->GetIndexType(), grp->GetIndexOffset());
 }
 
 void CWaterEntity::SetScreenWidthAndHeight(int32 width, int32 height)
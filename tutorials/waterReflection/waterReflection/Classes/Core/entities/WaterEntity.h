@@ -41,8 +41,11 @@ public:
     /** update mesh*/
     virtual void Update(float32 dt);
     
+    /** compute the mirrored camera of the reflection pass ( no gl call, GetViewMatrix is valid afterwards)*/
+    void UpdateReflectionCamera(CCameraEntity* camera);
+    
     /** prepare for the reflection pass  ( this should be balanced with EndReflectionPass)*/
-    void PrepareReflectionPass(CShader* shader, CCameraEntity* camera);
+    void PrepareReflectionPass(CShader* shader);
     
     /** end of the reflection pass ( this should be balanced with PrepareReflectionPass)*/
     void EndReflectionPass(CShader* shader);